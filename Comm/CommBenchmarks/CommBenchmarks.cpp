@@ -0,0 +1,636 @@
+/////////////////////////////////////////////////////////////////////
+// CommBenchmarks.cpp - loopback benchmarks for Sockets and Comm   //
+// ver 1.8                                                         //
+// Language:    C++, Visual Studio 2017                            //
+// Application: Remote Code Repository, CSE687 - OOD               //
+// Author:      Ritesh Nair (rgnair@syr.edu)                       //
+/////////////////////////////////////////////////////////////////////
+
+#include "CommBenchmarks.h"
+#include "../MsgPassingComm/Comm.h"
+#include "../Utilities/Utilities.h"
+#include <chrono>
+#include <iomanip>
+#include <sstream>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <thread>
+
+#ifdef __linux__
+#include <dirent.h>
+#endif
+
+using namespace MsgPassingCommunication;
+using Clock = std::chrono::steady_clock;
+
+//----< renders a result as a single line JSON object >--------------
+
+std::string MsgPassingCommunication::toJson(const CommBenchResult& result)
+{
+  std::ostringstream out;
+  out << std::fixed << std::setprecision(6)
+    << "{\"bench\":\"" << result.name << "\""
+    << ",\"messages\":" << result.messages
+    << ",\"seconds\":" << result.seconds
+    << std::setprecision(1)
+    << ",\"messagesPerSec\":" << result.messagesPerSec()
+    << ",\"bytesPerMessage\":" << result.bytesPerMessage
+    << std::setprecision(3)
+    << ",\"recvCallsPerMessage\":" << result.recvCallsPerMessage;
+  if (result.threads > 0)
+    out << ",\"threads\":" << result.threads;
+  if (result.p99Millisecs > 0.0)
+    out << ",\"p99Millisecs\":" << result.p99Millisecs;
+  if (result.dropped > 0)
+    out << ",\"dropped\":" << result.dropped;
+  out << "}";
+  return out.str();
+}
+//----< renders a result as an aligned line of text >----------------
+
+std::string MsgPassingCommunication::toText(const CommBenchResult& result)
+{
+  std::ostringstream out;
+  out << "  " << std::left << std::setw(34) << result.name << std::right
+    << std::setw(9) << result.messages << " msgs"
+    << std::fixed << std::setprecision(1)
+    << std::setw(12) << result.messagesPerSec() << " msgs/s"
+    << std::setw(8) << result.bytesPerMessage << " B/msg"
+    << std::setprecision(3)
+    << std::setw(10) << result.recvCallsPerMessage << " recv/msg";
+  if (result.threads > 0)
+    out << std::setw(7) << result.threads << " threads";
+  if (result.p99Millisecs > 0.0)
+    out << std::setw(9) << result.p99Millisecs << " ms p99";
+  if (result.dropped > 0)
+    out << std::setw(9) << result.dropped << " dropped";
+  return out.str();
+}
+//----< stores and prints one result >-------------------------------
+
+void CommBenchmarks::report(const CommBenchResult& result)
+{
+  results_.push_back(result);
+  out_ << (asText_ ? toText(result) : toJson(result)) << std::endl;
+}
+//----< name used for a wire format in results >--------------------
+
+std::string CommBenchmarks::formatName(WireFormat wire)
+{
+  return (wire == WireFormat::binary) ? "binary" : "text";
+}
+//----< ::recv calls made by Sockets and SocketReactor >-------------
+
+size_t CommBenchmarks::recvCalls()
+{
+  return Socket::recvCalls() + SocketReactor::recvCalls();
+}
+//----< number of threads in this process, 0 if unknown >----------
+
+size_t CommBenchmarks::threadCount()
+{
+  size_t count = 0;
+#ifdef __linux__
+  DIR* dir = opendir("/proc/self/task");
+  if (dir == nullptr)
+    return 0;
+  while (dirent* entry = readdir(dir))
+  {
+    if (entry->d_name[0] != '.')
+      ++count;
+  }
+  closedir(dir);
+#endif
+  return count;
+}
+//----< count messages with a command and custom attributes >-------
+
+std::vector<Message> CommBenchmarks::benchMessages(EndPoint to, EndPoint from, size_t count, size_t attributes)
+{
+  std::vector<Message> msgs;
+  msgs.reserve(count);
+  for (size_t i = 0; i < count; ++i)
+  {
+    Message msg(to, from);
+    msg.command("bench");
+    msg.name("msg #" + std::to_string(i));
+    for (size_t j = 0; j < attributes; ++j)
+      msg.attribute("attribute" + std::to_string(j), "value " + std::to_string(j) + " of msg #" + std::to_string(i));
+    msgs.push_back(msg);
+  }
+  return msgs;
+}
+//----< converting messages to and from each wire format >-----------
+/*
+*  - binary frames are converted with a key table, as on a connection
+*  - decoding is timed from strings holding one encoded message each,
+*    as ClientHandler has once a message is read
+*/
+void CommBenchmarks::codec(size_t messages, size_t attributes)
+{
+  std::vector<Message> msgs = benchMessages(EndPoint("localhost", 9700), EndPoint("localhost", 9701), messages, attributes);
+  std::vector<std::string> encoded(messages);
+  for (WireFormat wire : { WireFormat::text, WireFormat::binary })
+  {
+    bool binary = (wire == WireFormat::binary);
+    std::string prefix = "message." + formatName(wire);
+    std::string suffix = "." + std::to_string(attributes) + "attribs";
+
+    BinaryKeyTable sendKeys;
+    size_t bytes = 0;
+    Clock::time_point begin = Clock::now();
+    for (size_t i = 0; i < messages; ++i)
+    {
+      encoded[i] = binary ? msgs[i].toBinary(&sendKeys) : msgs[i].toString();
+      bytes += encoded[i].size();
+    }
+    std::chrono::duration<double> elapsed = Clock::now() - begin;
+
+    CommBenchResult result;
+    result.name = prefix + ".encode" + suffix;
+    result.messages = messages;
+    result.seconds = elapsed.count();
+    result.bytesPerMessage = bytes / (messages == 0 ? 1 : messages);
+    report(result);
+
+    BinaryKeyTable recvKeys;
+    size_t check = 0;
+    begin = Clock::now();
+    for (size_t i = 0; i < messages; ++i)
+    {
+      const std::string& src = encoded[i];
+      Message decoded = binary
+        ? Message::fromBinary(src.data() + BinaryFrame::HeaderSize, src.size() - BinaryFrame::HeaderSize, &recvKeys)
+        : Message::fromString(src);
+      check += decoded.attributes().size();
+    }
+    elapsed = Clock::now() - begin;
+
+    result.name = prefix + ".decode" + suffix;
+    result.seconds = elapsed.count();
+    report(result);
+    if (check != messages * (attributes + 4))
+      out_ << "\n  decoded messages lost attributes\n";
+  }
+}
+//----< one Comm posting to another over the loopback >--------------
+/*
+*  - timed from the first post until the last message is dequeued
+*    from the receiver's queue
+*  - recv calls are counted for the whole process, so include the
+*    receiver's only
+*  - the client posts faster than it sends, so it waits for room
+*    rather than rejecting what doesn't fit
+*/
+CommBenchResult CommBenchmarks::loopback(size_t messages, size_t attributes, WireFormat wire)
+{
+  EndPoint serverEP("localhost", takePort());
+  EndPoint clientEP("localhost", takePort());
+  Comm server(serverEP, "benchServer");
+  server.start();
+  Comm client(clientEP, "benchClient");
+  client.wireFormat(wire);
+  client.sendLimit(DefaultQueueLimit, OverflowPolicy::block);
+  client.start();
+
+  std::vector<Message> msgs = benchMessages(serverEP, clientEP, messages + 1, attributes);
+
+  // one message first, so that connecting isn't timed
+  client.postMessage(msgs[messages]);
+  server.getMessage();
+
+  size_t recvCallsBefore = recvCalls();
+  Clock::time_point begin = Clock::now();
+  for (size_t i = 0; i < messages; ++i)
+    client.postMessage(msgs[i]);
+  for (size_t i = 0; i < messages; ++i)
+    server.getMessage();
+  std::chrono::duration<double> elapsed = Clock::now() - begin;
+
+  CommBenchResult result;
+  result.name = "comm.loopback." + formatName(wire) + "." + std::to_string(attributes) + "attribs";
+  result.messages = messages;
+  result.seconds = elapsed.count();
+  BinaryKeyTable keys;
+  size_t bytes = 0;
+  for (size_t i = 0; i < messages; ++i)
+    bytes += (wire == WireFormat::binary) ? msgs[i].toBinary(&keys).size() : msgs[i].toString().size();
+  result.bytesPerMessage = bytes / (messages == 0 ? 1 : messages);
+  result.recvCallsPerMessage = (double)(recvCalls() - recvCallsBefore) / (messages == 0 ? 1 : messages);
+  report(result);
+
+  client.stop();
+  server.stop();
+  return result;
+}
+//----< one Comm posting to several in turn >-----------------------
+/*
+*  - message i goes to client i % clients, so each message changes
+*    destination
+*  - timed until every client has dequeued its messages
+*/
+CommBenchResult CommBenchmarks::replies(size_t clients, size_t messages)
+{
+  EndPoint serverEP("localhost", takePort());
+  Comm server(serverEP, "benchServer");
+  server.start();
+  std::vector<std::unique_ptr<Comm>> comms;
+  std::vector<std::vector<Message>> msgs;
+  for (size_t i = 0; i < clients; ++i)
+  {
+    EndPoint clientEP("localhost", takePort());
+    comms.emplace_back(new Comm(clientEP, "benchClient"));
+    comms.back()->start();
+    msgs.push_back(benchMessages(clientEP, serverEP, messages / clients + 1, 0));
+  }
+
+  // one message to each client first, so that connecting isn't timed
+  for (size_t i = 0; i < clients; ++i)
+    server.postMessage(msgs[i].back());
+  for (size_t i = 0; i < clients; ++i)
+    comms[i]->getMessage();
+
+  size_t recvCallsBefore = recvCalls();
+  Clock::time_point begin = Clock::now();
+  for (size_t i = 0; i < messages; ++i)
+    server.postMessage(msgs[i % clients][i / clients]);
+  for (size_t i = 0; i < messages; ++i)
+    comms[i % clients]->getMessage();
+  std::chrono::duration<double> elapsed = Clock::now() - begin;
+
+  CommBenchResult result;
+  result.name = "comm.replies." + std::to_string(clients) + "clients";
+  result.messages = messages;
+  result.seconds = elapsed.count();
+  result.bytesPerMessage = msgs[0][0].toBinary().size();
+  result.recvCallsPerMessage = (double)(recvCalls() - recvCallsBefore) / (messages == 0 ? 1 : messages);
+  report(result);
+
+  for (auto& comm : comms)
+    comm->stop();
+  server.stop();
+  return result;
+}
+/////////////////////////////////////////////////////////////////////
+// StalledPeer - SocketListener handler that reads nothing until told
+// - then reads until the connection closes, so senders can finish
+
+namespace
+{
+  struct StalledPeer
+  {
+    std::shared_ptr<std::atomic<bool>> reading;
+
+    void operator()(Socket socket)
+    {
+      while (!reading->load())
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      while (socket.validState() && !socket.readLine().empty())
+        ;
+    }
+  };
+}
+//----< rounds of one message to each client, timing each >---------
+/*
+*  - a round is posted, then each client dequeues its message
+*  - with slowPeer, each round also posts messages with 20 attributes
+*    to a peer that doesn't read them, so its connection backs up and
+*    its sends block; once its send queue is full, further messages
+*    to it are rejected rather than holding up the poster
+*/
+CommBenchResult CommBenchmarks::latency(size_t clients, size_t rounds, bool slowPeer)
+{
+  EndPoint serverEP("localhost", takePort());
+  EndPoint slowEP("localhost", takePort());
+  Comm server(serverEP, "benchServer");
+  server.sendLimit(DefaultQueueLimit, OverflowPolicy::reject);   // the slow peer's queue fills
+  server.start();
+  std::vector<std::unique_ptr<Comm>> comms;
+  std::vector<EndPoint> clientEPs;
+  for (size_t i = 0; i < clients; ++i)
+  {
+    clientEPs.push_back(EndPoint("localhost", takePort()));
+    comms.emplace_back(new Comm(clientEPs.back(), "benchClient"));
+    comms.back()->start();
+  }
+  StalledPeer stalled{ std::make_shared<std::atomic<bool>>(false) };
+  SocketListener slowListener(slowEP.port);
+  if (slowPeer)
+    slowListener.start(stalled);
+  std::vector<Message> slowMsgs = benchMessages(slowEP, serverEP, 8, 20);
+
+  std::vector<double> millisecs;
+  std::vector<Clock::time_point> posted(clients);
+  Clock::time_point begin = Clock::now();
+  for (size_t round = 0; round <= rounds; ++round)
+  {
+    if (slowPeer)
+    {
+      for (Message& msg : slowMsgs)
+        server.postMessage(msg);
+    }
+    for (size_t i = 0; i < clients; ++i)
+    {
+      Message msg(clientEPs[i], serverEP);
+      msg.command("bench");
+      posted[i] = Clock::now();
+      server.postMessage(msg);
+    }
+    for (size_t i = 0; i < clients; ++i)
+    {
+      comms[i]->getMessage();
+      std::chrono::duration<double, std::milli> waited = Clock::now() - posted[i];
+      if (round > 0)                // the first round connects
+        millisecs.push_back(waited.count());
+    }
+  }
+  std::chrono::duration<double> elapsed = Clock::now() - begin;
+
+  CommBenchResult result;
+  result.name = "comm.latency." + std::to_string(clients) + "clients" + (slowPeer ? ".slowpeer" : "");
+  result.messages = millisecs.size();
+  result.seconds = elapsed.count();
+  if (!millisecs.empty())
+  {
+    std::sort(millisecs.begin(), millisecs.end());
+    result.p99Millisecs = millisecs[(millisecs.size() - 1) * 99 / 100];
+  }
+  report(result);
+
+  stalled.reading->store(true);
+  for (auto& comm : comms)
+    comm->stop();
+  server.stop();
+  if (slowPeer)
+    slowListener.stop();
+  return result;
+}
+//----< many clients posting to one Comm >--------------------------
+/*
+*  - clients are plain SocketConnecters sending binary frames without
+*    a key table, so they need no threads of their own
+*  - one thread sends a message on each connection in turn; timed
+*    until the last is dequeued from the server's queue
+*  - ioThreads of 0 serves each connection with a ClientHandler thread
+*/
+CommBenchResult CommBenchmarks::fanIn(size_t clients, size_t messagesPerClient, size_t ioThreads)
+{
+  EndPoint serverEP("localhost", takePort());
+  EndPoint clientEP("localhost", takePort());
+  Comm server(serverEP, "benchServer");
+  server.ioThreads(ioThreads);
+  server.start();
+
+  std::vector<std::unique_ptr<SocketConnecter>> connecters;
+  for (size_t i = 0; i < clients; ++i)
+  {
+    std::unique_ptr<SocketConnecter> connecter(new SocketConnecter);
+    if (!connecter->connect(serverEP.address, serverEP.port))
+    {
+      out_ << "\n  connected only " << i << " of " << clients << " clients\n";
+      break;
+    }
+    connecters.push_back(std::move(connecter));
+  }
+
+  std::vector<Message> msgs = benchMessages(serverEP, clientEP, messagesPerClient, 4);
+  std::vector<std::string> frames;
+  for (Message& msg : msgs)
+    frames.push_back(msg.toBinary());
+
+  // one message on each connection first, so that accepting isn't timed
+  for (auto& connecter : connecters)
+    connecter->send(frames[0].size(), (Socket::byte*)frames[0].data());
+  for (size_t i = 0; i < connecters.size(); ++i)
+    server.getMessage();
+  size_t threads = threadCount();
+  size_t recvCallsBefore = recvCalls();
+
+  size_t total = connecters.size() * messagesPerClient;
+  Clock::time_point begin = Clock::now();
+  for (size_t m = 0; m < messagesPerClient; ++m)
+  {
+    for (auto& connecter : connecters)
+      connecter->send(frames[m].size(), (Socket::byte*)frames[m].data());
+  }
+  for (size_t i = 0; i < total; ++i)
+    server.getMessage();
+  std::chrono::duration<double> elapsed = Clock::now() - begin;
+
+  CommBenchResult result;
+  result.name = "comm.fanin." + std::string(ioThreads > 0 ? "reactor" : "threads")
+    + "." + std::to_string(clients) + "clients";
+  result.messages = total;
+  result.seconds = elapsed.count();
+  result.bytesPerMessage = frames.empty() ? 0 : frames[0].size();
+  result.recvCallsPerMessage = (double)(recvCalls() - recvCallsBefore) / (total == 0 ? 1 : total);
+  result.threads = threads;
+  report(result);
+
+  for (auto& connecter : connecters)
+    connecter->close();
+  connecters.clear();
+  server.stop();
+  return result;
+}
+//----< threads producers and consumers passing items through q >---
+/*
+*  - items are 32 character strings, longer than the short string
+*    buffer, so copying one allocates
+*  - take(q, taken) appends what a consumer takes from q to taken
+*  - consumers stop at an empty string, one queued for each once the
+*    producers are done; one that takes several puts the rest back
+*/
+namespace
+{
+  template<typename Queue, typename Take>
+  double passItems(Queue& q, size_t threads, size_t items, Take take)
+  {
+    size_t perThread = items / threads;
+    std::vector<std::thread> producers;
+    std::vector<std::thread> consumers;
+    Clock::time_point begin = Clock::now();
+    for (size_t i = 0; i < threads; ++i)
+    {
+      producers.push_back(std::thread([&q, perThread]() {
+        std::string item(32, 'x');
+        for (size_t j = 0; j < perThread; ++j)
+          q.enQ(std::string(item));
+      }));
+      consumers.push_back(std::thread([&q, &take]() {
+        std::vector<std::string> taken;
+        while (true)
+        {
+          taken.clear();
+          take(q, taken);
+          size_t stops = (size_t)std::count(taken.begin(), taken.end(), std::string());
+          if (stops == 0)
+            continue;
+          for (size_t j = 1; j < stops; ++j)
+            q.enQ(std::string());
+          return;
+        }
+      }));
+    }
+    for (std::thread& producer : producers)
+      producer.join();
+    for (size_t i = 0; i < threads; ++i)
+      q.enQ(std::string());
+    for (std::thread& consumer : consumers)
+      consumer.join();
+    std::chrono::duration<double> elapsed = Clock::now() - begin;
+    return elapsed.count();
+  }
+}
+//----< BlockingQueue and MpmcQueue under contention >---------------
+/*
+*  - threads producers and threads consumers pass items in all
+*/
+void CommBenchmarks::queues(size_t threads, size_t items)
+{
+  threads = (threads == 0) ? 1 : threads;
+  items = items / threads * threads;
+  std::string suffix = "." + std::to_string(threads) + "threads";
+  CommBenchResult result;
+  result.messages = items;
+
+  BlockingQueue<std::string> blocking;
+  result.name = "queue.blocking" + suffix;
+  result.seconds = passItems(blocking, threads, items,
+    [](BlockingQueue<std::string>& q, std::vector<std::string>& taken) { taken.push_back(q.deQ()); });
+  report(result);
+
+  MpmcQueue<std::string> mpmc;
+  result.name = "queue.mpmc" + suffix;
+  result.seconds = passItems(mpmc, threads, items,
+    [](MpmcQueue<std::string>& q, std::vector<std::string>& taken) { taken.push_back(q.deQ()); });
+  report(result);
+
+  result.name = "queue.mpmc.batch" + suffix;
+  result.seconds = passItems(mpmc, threads, items,
+    [](MpmcQueue<std::string>& q, std::vector<std::string>& taken) {
+      taken.push_back(q.deQ());
+      q.deQBatch(taken, 63);
+    });
+  report(result);
+}
+//----< a client flooding a Comm that takes messages slowly >-------
+/*
+*  - the server takes a message every 50 microseconds, well below the
+*    rate the client posts, and queues at most QueueLimit
+*  - timed until every message is dequeued or dropped; a final "done"
+*    message, posted once the queue has drained, stops the consumer
+*/
+CommBenchResult CommBenchmarks::overload(size_t messages, OverflowPolicy policy)
+{
+  const size_t QueueLimit = 256;
+  EndPoint serverEP("localhost", takePort());
+  EndPoint clientEP("localhost", takePort());
+  Comm server(serverEP, "benchServer");
+  server.receiveLimit(QueueLimit, policy);
+  server.start();
+  Comm client(clientEP, "benchClient");
+  client.start();
+
+  std::atomic<size_t> delivered{ 0 };
+  std::thread consumer([&server, &delivered]() {
+    while (server.getMessage().command() != "done")
+    {
+      ++delivered;
+      std::this_thread::sleep_for(std::chrono::microseconds(50));
+    }
+  });
+  std::vector<Message> msgs = benchMessages(serverEP, clientEP, messages, 4);
+  Clock::time_point begin = Clock::now();
+  for (Message& msg : msgs)
+    client.postMessage(msg);
+  while (delivered.load() + server.dropped() < messages)
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  std::chrono::duration<double> elapsed = Clock::now() - begin;
+  Message done(serverEP, clientEP);
+  done.command("done");
+  client.postMessage(done);
+  consumer.join();
+
+  CommBenchResult result;
+  const char* names[] = { "block", "dropOldest", "reject" };
+  result.name = std::string("comm.overload.") + names[(int)policy];
+  result.messages = delivered.load();
+  result.seconds = elapsed.count();
+  result.dropped = messages - result.messages;
+  report(result);
+
+  client.stop();
+  server.stop();
+  return result;
+}
+
+#ifdef TEST_COMMBENCHMARKS
+
+#ifndef _WIN32
+#include <csignal>
+#include <sys/resource.h>
+#endif
+
+int main(int argc, char* argv[])
+{
+#ifndef _WIN32
+  std::signal(SIGPIPE, SIG_IGN);   // a peer closing is seen as a failed send
+
+  rlimit files;                    // fanIn holds both ends of each connection
+  if (getrlimit(RLIMIT_NOFILE, &files) == 0 && files.rlim_cur < files.rlim_max)
+  {
+    files.rlim_cur = files.rlim_max;
+    setrlimit(RLIMIT_NOFILE, &files);
+  }
+#endif
+  size_t messages = 20000;
+  size_t attributes = 20;
+  size_t clients = 1000;
+  size_t port = 9700;
+  bool asText = false;
+
+  for (int i = 1; i < argc; ++i)
+  {
+    std::string arg = argv[i];
+    if (arg == "--messages" && i + 1 < argc)
+      messages = (size_t)std::stoull(argv[++i]);
+    else if (arg == "--attributes" && i + 1 < argc)
+      attributes = (size_t)std::stoull(argv[++i]);
+    else if (arg == "--clients" && i + 1 < argc)
+      clients = (size_t)std::stoull(argv[++i]);
+    else if (arg == "--port" && i + 1 < argc)
+      port = (size_t)std::stoull(argv[++i]);
+    else if (arg == "--text")
+      asText = true;
+    else
+    {
+      std::cout << "\n  usage: CommBenchmarks [--messages 20000] [--attributes 20] [--clients 1000] [--port 9700] [--text]\n";
+      return 1;
+    }
+  }
+
+  CommBenchmarks benchmarks(port, std::cout, asText);
+  benchmarks.codec(messages, 0);
+  benchmarks.codec(messages, attributes);
+  for (WireFormat wire : { WireFormat::text, WireFormat::binary })
+  {
+    benchmarks.loopback(messages, 0, wire);
+    benchmarks.loopback(messages, attributes, wire);
+  }
+  benchmarks.replies(8, messages);
+  benchmarks.latency(8, messages / 8, false);
+  benchmarks.latency(8, messages / 8, true);
+  size_t perClient = messages / (clients == 0 ? 1 : clients) + 1;
+  if (SocketReactor::supported())
+    benchmarks.fanIn(clients, perClient, SocketReactor::DefaultIoThreads);
+  benchmarks.fanIn(clients, perClient, 0);
+  for (size_t threads : { 1, 2, 4, 8, 16, 32 })
+    benchmarks.queues(threads, messages * 10);
+  for (OverflowPolicy policy : { OverflowPolicy::block, OverflowPolicy::dropOldest, OverflowPolicy::reject })
+    benchmarks.overload(messages / 4, policy);
+  return 0;
+}
+
+#endif
@@ -0,0 +1,152 @@
+#ifndef COMMBENCHMARKS_H
+#define COMMBENCHMARKS_H
+/////////////////////////////////////////////////////////////////////
+// CommBenchmarks.h - loopback benchmarks for Sockets and Comm     //
+// ver 1.8                                                         //
+// Language:    C++, Visual Studio 2017                            //
+// Application: Remote Code Repository, CSE687 - OOD               //
+// Author:      Ritesh Nair (rgnair@syr.edu)                       //
+/////////////////////////////////////////////////////////////////////
+/*
+*  Package Operations:
+*  -------------------
+*  Measures the message-passing layer over the loopback interface:
+*  - CommBenchResult holds messages per second, wire bytes per message
+*    and the number of ::recv calls the receiving side made per
+*    message (see Socket::recvCalls and SocketReactor::recvCalls).
+*  - CommBenchmarks::loopback posts messages carrying a number of
+*    custom attributes from one Comm to another, in text or binary
+*    wire format, and times their arrival in the receiver's queue.
+*  - CommBenchmarks::codec times converting the same messages to and
+*    from each wire format, without sockets.
+*  - CommBenchmarks::fanIn opens many client connections to one Comm and
+*    times messages sent round robin over all of them, served by the
+*    reactor or by a thread per connection.  Results also give the
+*    number of threads in the process (Linux only).
+*  - CommBenchmarks::replies posts messages from one Comm to several
+*    others in turn, as a server replying to interleaved clients.
+*  - CommBenchmarks::latency posts rounds of one message to each of
+*    several clients, giving the 99th percentile time from post to
+*    dequeue; optionally each round also sends to a slow peer that
+*    doesn't read until the benchmark ends.
+*  - CommBenchmarks::queues passes strings from a number of producer
+*    threads to as many consumers through a BlockingQueue and through
+*    an MpmcQueue, the latter also drained with deQBatch.
+*  - CommBenchmarks::overload floods a Comm that takes messages slowly
+*    and has a small receive queue, under each OverflowPolicy, giving
+*    the number of messages delivered and dropped.
+*  Messages have fixed to, from and command attributes; their name and
+*  custom attribute values differ from one message to the next, so
+*  binary frames gain from repeated keys but not repeated values.
+*  Results are written one JSON object per line, like NoSqlDb's
+*  Benchmarks, so that runs can be compared over time.
+*
+*  Required Files:
+*  ---------------
+*  CommBenchmarks.h, CommBenchmarks.cpp
+*  Comm.h, Comm.cpp, Sockets.h, Sockets.cpp,
+*  SocketReactor.h, SocketReactor.cpp,
+*  Message.h, Message.cpp, Logger.h, Logger.cpp,
+*  Cpp11-BlockingQueue.h, MpmcQueue.h,
+*  Utilities.h, Utilities.cpp, WindowsHelpers.h, WindowsHelpers.cpp
+*
+*  Build Process:
+*  --------------
+*  Define TEST_COMMBENCHMARKS and build in Release mode.  Usage:
+*    CommBenchmarks [--messages 20000] [--attributes 20] [--clients 1000]
+*                   [--port 9700] [--text]
+*  On Linux, from the root of the repository:
+*    g++ -std=c++17 -O2 -pthread -DTEST_COMMBENCHMARKS
+*      Comm/CommBenchmarks/CommBenchmarks.cpp Comm/MsgPassingComm/Comm.cpp
+*      Comm/Sockets/Sockets.cpp Comm/SocketReactor/SocketReactor.cpp
+*      Comm/Message/Message.cpp Comm/Logger/Logger.cpp
+*      Comm/Utilities/Utilities.cpp Comm/WindowsHelpers/WindowsHelpers.cpp
+*      -o CommBenchmarks
+*  Timings vary from run to run; compare medians of several runs.
+*
+*  Maintenance History:
+*  --------------------
+*  ver 1.8 : 19 Oct 2026
+*  - loopback's client blocks on a full send queue, now that a
+*    Sender rejects by default
+*  ver 1.7 : 19 Oct 2026
+*  - documented the Linux build
+*  ver 1.6 : 19 Oct 2026
+*  - added overload benchmark and dropped count of results
+*  ver 1.5 : 19 Oct 2026
+*  - added queue contention benchmarks
+*  ver 1.4 : 19 Oct 2026
+*  - added latency benchmark, with and without a slow peer
+*  ver 1.3 : 19 Oct 2026
+*  - added replies benchmark
+*  ver 1.2 : 19 Oct 2026
+*  - added fanIn benchmark and thread count of results
+*  ver 1.1 : 19 Oct 2026
+*  - added codec benchmarks and loopback in both wire formats
+*  ver 1.0 : 19 Oct 2026
+*  - first release
+*/
+
+#include "../Message/Message.h"
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace MsgPassingCommunication
+{
+  enum class OverflowPolicy;
+
+  /////////////////////////////////////////////////////////////////
+  // CommBenchResult struct
+
+  struct CommBenchResult
+  {
+    std::string name;
+    size_t messages = 0;
+    double seconds = 0.0;
+    size_t bytesPerMessage = 0;
+    double recvCallsPerMessage = 0.0;
+    size_t threads = 0;             // in the process, if known
+    double p99Millisecs = 0.0;      // post to dequeue, if measured
+    size_t dropped = 0;             // by a full queue
+
+    double messagesPerSec() const { return seconds > 0.0 ? messages / seconds : 0.0; }
+  };
+
+  std::string toJson(const CommBenchResult& result);
+  std::string toText(const CommBenchResult& result);
+
+  /////////////////////////////////////////////////////////////////
+  // CommBenchmarks class
+  // - each benchmark listens on its own ports, starting at basePort
+
+  class CommBenchmarks
+  {
+  public:
+    CommBenchmarks(size_t basePort = 9700, std::ostream& out = std::cout, bool asText = false)
+      : nextPort_(basePort), out_(out), asText_(asText) {}
+
+    CommBenchResult loopback(size_t messages, size_t attributes, WireFormat wire = WireFormat::binary);
+    void codec(size_t messages, size_t attributes);
+    CommBenchResult replies(size_t clients, size_t messages);
+    CommBenchResult latency(size_t clients, size_t rounds, bool slowPeer);
+    CommBenchResult fanIn(size_t clients, size_t messagesPerClient, size_t ioThreads);
+    void queues(size_t threads, size_t items);
+    CommBenchResult overload(size_t messages, OverflowPolicy policy);
+    const std::vector<CommBenchResult>& results() const { return results_; }
+
+  private:
+    void report(const CommBenchResult& result);
+    size_t takePort() { return nextPort_++; }
+    static std::vector<Message> benchMessages(EndPoint to, EndPoint from, size_t count, size_t attributes);
+    static std::string formatName(WireFormat wire);
+    static size_t threadCount();
+    static size_t recvCalls();
+
+    size_t nextPort_;
+    std::ostream& out_;
+    bool asText_;
+    std::vector<CommBenchResult> results_;
+  };
+}
+#endif
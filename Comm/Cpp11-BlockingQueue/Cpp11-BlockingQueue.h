@@ -2,7 +2,7 @@
 #define CPP11_BLOCKINGQUEUE_H
 ///////////////////////////////////////////////////////////////
 // Cpp11-BlockingQueue.h - Thread-safe Blocking Queue        //
-// ver 1.3                                                   //
+// ver 1.5                                                   //
 // Jim Fawcett, CSE687 - Object Oriented Design, Spring 2015 //
 ///////////////////////////////////////////////////////////////
 /*
@@ -14,6 +14,10 @@
  * std::condition_variable and std::mutex.  The underlying storage
  * is provided by the non-thread-safe std::queue<T>.
  *
+ * A queue may be given a capacity.  enQ then waits while the queue
+ * is full, and tryEnQ returns false, leaving its argument as it was.
+ * tryDeQ takes the front element only if there is one.
+ *
  * Required Files:
  * ---------------
  * Cpp11-BlockingQueue.h
@@ -24,6 +28,13 @@
  *
  * Maintenance History:
  * --------------------
+ * ver 1.5 : 19 Oct 2026
+ * - added capacity, tryEnQ and tryDeQ
+ * ver 1.4 : 19 Oct 2026
+ * - added enQ(T&&); deQ moves the front element out instead of
+ *   copying it
+ * - move constructor and move assignment move the underlying queue
+ *   instead of copying it
  * ver 1.3 : 04 Mar 2016
  * - changed behavior of front() to throw exception
  *   on empty queue.
@@ -50,6 +61,8 @@
 template <typename T>
 class BlockingQueue {
 public:
+  static const size_t Unbounded = (size_t)-1;
+
   BlockingQueue() {}
   BlockingQueue(BlockingQueue<T>&& bq);
   BlockingQueue<T>& operator=(BlockingQueue<T>&& bq);
@@ -57,22 +70,30 @@ public:
   BlockingQueue<T>& operator=(const BlockingQueue<T>&) = delete;
   T deQ();
   void enQ(const T& t);
+  void enQ(T&& t);
+  bool tryEnQ(T&& t);
+  bool tryDeQ(T& t);
   T& front();
   void clear();
   size_t size();
+  void capacity(size_t maxItems);
+  size_t capacity();
 private:
   std::queue<T> q_;
+  size_t capacity_ = Unbounded;
   std::mutex mtx_;
   std::condition_variable cv_;
+  std::condition_variable notFull_;
 };
 //----< move constructor >---------------------------------------------
 
 template<typename T>
 BlockingQueue<T>::BlockingQueue(BlockingQueue<T>&& bq) // need to lock so can't initialize
 {
-  std::lock_guard<std::mutex> l(mtx_);
-  q_ = bq.q_;
-  while (bq.q_.size() > 0)  // clear bq
+  std::lock_guard<std::mutex> l(bq.mtx_);
+  q_ = std::move(bq.q_);
+  capacity_ = bq.capacity_;
+  while (bq.q_.size() > 0)  // moved-from queue is valid but unspecified
     bq.q_.pop();
   /* can't copy  or move mutex or condition variable, so use default members */
 }
@@ -82,10 +103,14 @@ template<typename T>
 BlockingQueue<T>& BlockingQueue<T>::operator=(BlockingQueue<T>&& bq)
 {
   if (this == &bq) return *this;
-  std::lock_guard<std::mutex> l(mtx_);
-  q_ = bq.q_;
-  while (bq.q_.size() > 0)  // clear bq
+  std::lock(mtx_, bq.mtx_);
+  std::lock_guard<std::mutex> l(mtx_, std::adopt_lock);
+  std::lock_guard<std::mutex> lbq(bq.mtx_, std::adopt_lock);
+  q_ = std::move(bq.q_);
+  capacity_ = bq.capacity_;
+  while (bq.q_.size() > 0)  // moved-from queue is valid but unspecified
     bq.q_.pop();
+  notFull_.notify_all();
   /* can't move assign mutex or condition variable so use target's */
   return *this;
 }
@@ -107,18 +132,37 @@ T BlockingQueue<T>::deQ()
    */
   if(q_.size() > 0)
   {
-    T temp = q_.front();
+    T temp = std::move(q_.front());
     q_.pop();
+    l.unlock();
+    notFull_.notify_one();
     return temp;
   }
   // may have spurious returns so loop on !condition
 
   while (q_.size() == 0)
     cv_.wait(l, [this] () { return q_.size() > 0; });
-  T temp = q_.front();
+  T temp = std::move(q_.front());
   q_.pop();
+  l.unlock();
+  notFull_.notify_one();
   return temp;
 }
+//----< remove front element into t, if there is one >-----------------
+
+template<typename T>
+bool BlockingQueue<T>::tryDeQ(T& t)
+{
+  {
+    std::lock_guard<std::mutex> l(mtx_);
+    if (q_.size() == 0)
+      return false;
+    t = std::move(q_.front());
+    q_.pop();
+  }
+  notFull_.notify_one();
+  return true;
+}
 //----< push element onto back of queue >------------------------------
 
 template<typename T>
@@ -126,10 +170,37 @@ void BlockingQueue<T>::enQ(const T& t)
 {
   {
     std::unique_lock<std::mutex> l(mtx_);
+    notFull_.wait(l, [this]() { return q_.size() < capacity_; });
     q_.push(t);
   }
   cv_.notify_one();
 }
+//----< move element onto back of queue >------------------------------
+
+template<typename T>
+void BlockingQueue<T>::enQ(T&& t)
+{
+  {
+    std::unique_lock<std::mutex> l(mtx_);
+    notFull_.wait(l, [this]() { return q_.size() < capacity_; });
+    q_.push(std::move(t));
+  }
+  cv_.notify_one();
+}
+//----< move element onto back of queue unless it is full >------------
+
+template<typename T>
+bool BlockingQueue<T>::tryEnQ(T&& t)
+{
+  {
+    std::lock_guard<std::mutex> l(mtx_);
+    if (q_.size() >= capacity_)
+      return false;
+    q_.push(std::move(t));
+  }
+  cv_.notify_one();
+  return true;
+}
 //----< peek at next item to be popped >-------------------------------
 
 template <typename T>
@@ -145,9 +216,12 @@ T& BlockingQueue<T>::front()
 template <typename T>
 void BlockingQueue<T>::clear()
 {
-  std::lock_guard<std::mutex> l(mtx_);
-  while (q_.size() > 0)
-    q_.pop();
+  {
+    std::lock_guard<std::mutex> l(mtx_);
+    while (q_.size() > 0)
+      q_.pop();
+  }
+  notFull_.notify_all();
 }
 //----< return number of elements in queue >---------------------------
 
@@ -157,5 +231,27 @@ size_t BlockingQueue<T>::size()
   std::lock_guard<std::mutex> l(mtx_);
   return q_.size();
 }
+//----< limit number of elements, Unbounded for no limit >-------------
+/*
+ * - elements already queued beyond a new, smaller capacity stay;
+ *   enQ waits until the queue drains below it
+ */
+template<typename T>
+void BlockingQueue<T>::capacity(size_t maxItems)
+{
+  {
+    std::lock_guard<std::mutex> l(mtx_);
+    capacity_ = (maxItems == 0) ? 1 : maxItems;
+  }
+  notFull_.notify_all();
+}
+//----< return most elements queue holds >-----------------------------
+
+template<typename T>
+size_t BlockingQueue<T>::capacity()
+{
+  std::lock_guard<std::mutex> l(mtx_);
+  return capacity_;
+}
 
 #endif
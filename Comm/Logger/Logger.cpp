@@ -1,6 +1,6 @@
 /////////////////////////////////////////////////////////////////////
 // Logger.cpp - log text messages to std::ostream                  //
-// ver 1.0                                                         //
+// ver 1.2                                                         //
 //-----------------------------------------------------------------//
 // Jim Fawcett (c) copyright 2015                                  //
 // All rights granted provided this copyright notice is retained   //
@@ -11,43 +11,48 @@
 //              jfawcett@twcny.rr.com                              //
 /////////////////////////////////////////////////////////////////////
 
+#include <chrono>
 #include <functional>
-#include <Windows.h>
 #include "Logger.h"
 #include "../Utilities/Utilities.h"
 
 //----< send text message to std::ostream >--------------------------
 
-void Logger::write(const std::string& msg)
+template<typename Queue>
+void BasicLogger<Queue>::write(const std::string& msg)
 {
   if(_ThreadRunning)
     _queue.enQ(msg);
 }
 //----< flush ostream buffer >---------------------------------------
 
-void Logger::flush()
+template<typename Queue>
+void BasicLogger<Queue>::flush()
 {
   if (_ThreadRunning)
   {
     while (_queue.size() > 0)  // wait for logger queue to empty
-      ::Sleep(50);
+      std::this_thread::sleep_for(std::chrono::milliseconds(50));
     _pOut->flush();
   }
 }
-void Logger::title(const std::string& msg, char underline)
+template<typename Queue>
+void BasicLogger<Queue>::title(const std::string& msg, char underline)
 {
   std::string temp = "\n  " + msg + "\n " + std::string(msg.size() + 2, underline);
   write(temp);
 }
 //----< attach logger to existing std::ostream >---------------------
 
-void Logger::attach(std::ostream* pOut) 
+template<typename Queue>
+void BasicLogger<Queue>::attach(std::ostream* pOut) 
 { 
   _pOut = pOut; 
 }
 //----< start logging >----------------------------------------------
 
-void Logger::start()
+template<typename Queue>
+void BasicLogger<Queue>::start()
 {
   if (_ThreadRunning)
     return;
@@ -69,7 +74,8 @@ void Logger::start()
 }
 //----< stop logging >-----------------------------------------------
 
-void Logger::stop(const std::string& msg)
+template<typename Queue>
+void BasicLogger<Queue>::stop(const std::string& msg)
 {
   if (_ThreadRunning)
   {
@@ -83,11 +89,15 @@ void Logger::stop(const std::string& msg)
 }
 //----< stop logging thread >----------------------------------------
 
-Logger::~Logger()
+template<typename Queue>
+BasicLogger<Queue>::~BasicLogger()
 {
   stop(); 
 }
 
+template class BasicLogger<BlockingQueue<std::string>>;
+template class BasicLogger<MpmcQueue<std::string>>;
+
 #ifdef TEST_LOGGER
 
 Cosmetic cosmetic;
@@ -2,7 +2,7 @@
 #define LOGGER_H
 /////////////////////////////////////////////////////////////////////
 // Logger.h - log text messages to std::ostream                    //
-// ver 1.0                                                         //
+// ver 1.2                                                         //
 //-----------------------------------------------------------------//
 // Jim Fawcett (c) copyright 2015                                  //
 // All rights granted provided this copyright notice is retained   //
@@ -20,14 +20,25 @@
 * blocking queue and dequeuing with a single thread that writes to
 * the std::ostream.
 *
+* The queue type is a template parameter of BasicLogger.  Logger uses
+* BlockingQueue; BasicLogger<MpmcQueue<std::string>> suits loggers
+* written by many threads at once.  Logger.cpp instantiates both.
+*
 * Build Process:
 * --------------
-* Required Files: Logger.h, Logger.cpp, Utilities.h, Utilities.cpp
+* Required Files: Logger.h, Logger.cpp, Utilities.h, Utilities.cpp,
+*                 Cpp11-BlockingQueue.h, MpmcQueue.h
 *
 * Build Command: devenv logger.sln /rebuild debug
 *
 * Maintenance History:
 * --------------------
+* ver 1.2 : 19 Oct 2026
+* - flush waits with std::this_thread::sleep_for, so no longer needs
+*   Windows.h
+* ver 1.1 : 19 Oct 2026
+* - Logger is now BasicLogger with its queue type as a template
+*   parameter
 * ver 1.0 : 22 Feb 2016
 * - first release
 *
@@ -40,27 +51,31 @@
 #include <string>
 #include <thread>
 #include "Cpp11-BlockingQueue.h"
+#include "../MpmcQueue/MpmcQueue.h"
 
-class Logger
+template<typename Queue>
+class BasicLogger
 {
 public:
-  Logger() {}
+  BasicLogger() {}
   void attach(std::ostream* pOut);
   void start();
   void stop(const std::string& msg = "");
   void write(const std::string& msg);
   void flush();
   void title(const std::string& msg, char underline = '-');
-  ~Logger();
-  Logger(const Logger&) = delete;
-  Logger& operator=(const Logger&) = delete;
+  ~BasicLogger();
+  BasicLogger(const BasicLogger&) = delete;
+  BasicLogger& operator=(const BasicLogger&) = delete;
 private:
   std::thread* _pThr;
   std::ostream* _pOut;
-  BlockingQueue<std::string> _queue;
+  Queue _queue;
   bool _ThreadRunning = false;
 };
 
+using Logger = BasicLogger<BlockingQueue<std::string>>;
+
 template<int i>
 class StaticLogger
 {
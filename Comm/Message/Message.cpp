@@ -1,11 +1,13 @@
 ///////////////////////////////////////////////////////////////////////////
 // Message.cpp - defines message structure used in communication channel //
-// ver 1.2                                                               //
+// ver 1.4                                                               //
 // Jim Fawcett, CSE687-OnLine Object Oriented Design, Fall 2017          //
 ///////////////////////////////////////////////////////////////////////////
 
 #include "Message.h"
+#include <cstdint>
 #include <iostream>
+#include <stdexcept>
 
 using namespace MsgPassingCommunication;
 using SUtils = Utilities::StringHelper;
@@ -33,11 +35,12 @@ void Message::attribute(const Key& key, const Value& value)
 {
   attributes_[key] = value;
 }
-//----< clears all attributes >----------------------------------------
+//----< clears all attributes and the body >--------------------------
 
 void Message::clear()
 {
   attributes_.clear();
+  body_.clear();
 }
 //----< returns vector of attribute keys >-----------------------------
 
@@ -178,6 +181,23 @@ void Message::contentLength(size_t ln)
 {
   attributes_["content-length"] = Utilities::Converter<size_t>::toString(ln);
 }
+//----< get body >-----------------------------------------------------
+
+const std::string& Message::body()
+{
+  return body_;
+}
+//----< set body >-----------------------------------------------------
+
+void Message::body(const std::string& bytes)
+{
+  body_ = bytes;
+}
+
+void Message::body(std::string&& bytes)
+{
+  body_ = std::move(bytes);
+}
 //----< convert message to string representation >---------------------
 
 std::string Message::toString()
@@ -220,6 +240,232 @@ Message Message::fromString(const std::string& src)
   }
   return msg;
 }
+//----< keys sent as a one byte index in binary frames >--------------
+/*
+*  - the order is part of the frame format; add new keys at the end
+*/
+const std::vector<std::string>& BinaryFrame::commonKeys()
+{
+  static const std::vector<std::string> keys = {
+    "to", "from", "name", "command", "file", "content-length",
+    "requestId", "responseId", "verbose", "userId", "namespace",
+    "package", "version", "filename", "category", "description",
+    "success", "author"
+  };
+  return keys;
+}
+//----< payload length from a frame header, 0 if not a valid header >--
+
+size_t BinaryFrame::length(const char* header)
+{
+  const unsigned char* pHeader = reinterpret_cast<const unsigned char*>(header);
+  if (pHeader[0] != Magic)
+    return 0;
+  size_t length = (size_t)pHeader[1] | ((size_t)pHeader[2] << 8)
+    | ((size_t)pHeader[3] << 16) | ((size_t)pHeader[4] << 24);
+  return (length <= MaxLength) ? length : 0;
+}
+
+//----< key table holding just the common keys >---------------------
+
+BinaryKeyTable::BinaryKeyTable()
+{
+  clear();
+}
+//----< forgets added keys and all values >---------------------------
+
+void BinaryKeyTable::clear()
+{
+  entries_.clear();
+  index_.clear();
+  for (const std::string& key : BinaryFrame::commonKeys())
+    add(key);
+}
+//----< index of key, entries_.size() if not in the table >-----------
+
+size_t BinaryKeyTable::find(const std::string& key) const
+{
+  auto iter = index_.find(key);
+  return (iter == index_.end()) ? entries_.size() : iter->second;
+}
+//----< adds a key sent literally, if there is room for it >----------
+
+bool BinaryKeyTable::add(const std::string& key)
+{
+  if (entries_.size() >= MaxEntries || key.size() > MaxKeyLength)
+    return false;
+  index_[key] = entries_.size();
+  Entry entry;
+  entry.key = key;
+  entries_.push_back(entry);
+  return true;
+}
+
+namespace
+{
+  //----< the table used when converting without one >----------------
+
+  const BinaryKeyTable& commonKeyTable()
+  {
+    static const BinaryKeyTable table;
+    return table;
+  }
+  //----< appends a varint >------------------------------------------
+
+  void putVarint(std::string& dst, size_t value)
+  {
+    while (value >= 0x80)
+    {
+      dst += (char)((value & 0x7F) | 0x80);
+      value >>= 7;
+    }
+    dst += (char)value;
+  }
+  //----< appends a length-prefixed string >--------------------------
+
+  void putBytes(std::string& dst, const std::string& bytes)
+  {
+    putVarint(dst, bytes.size());
+    dst += bytes;
+  }
+  //----< reads a varint, throwing if it runs past end >--------------
+
+  size_t getVarint(const char*& pos, const char* end)
+  {
+    size_t value = 0;
+    for (size_t shift = 0; shift < 64; shift += 7)
+    {
+      if (pos == end)
+        break;
+      unsigned char byte = (unsigned char)*pos++;
+      value |= (size_t)(byte & 0x7F) << shift;
+      if ((byte & 0x80) == 0)
+        return value;
+    }
+    throw std::runtime_error("malformed binary message: bad varint");
+  }
+  //----< reads a length-prefixed string, throwing if it runs past end >
+
+  std::string getBytes(const char*& pos, const char* end)
+  {
+    size_t length = getVarint(pos, end);
+    if (length > (size_t)(end - pos))
+      throw std::runtime_error("malformed binary message: truncated string");
+    std::string bytes(pos, length);
+    pos += length;
+    return bytes;
+  }
+}
+//----< convert message to binary frame, header included >------------
+/*
+*  - pKeys is the key table of the connection the frame is sent on,
+*    and is updated; with none only the common keys are used
+*  - the length is written into the header once the frame is built
+*/
+std::string Message::toBinary(BinaryKeyTable* pKeys)
+{
+  const BinaryKeyTable& keys = pKeys ? *pKeys : commonKeyTable();
+
+  size_t estimate = BinaryFrame::HeaderSize + 8 + body_.size();
+  for (const auto& kv : attributes_)
+    estimate += kv.first.size() + kv.second.size() + 4;
+  std::string frame;
+  frame.reserve(estimate);
+  frame.append(BinaryFrame::HeaderSize, '\0');
+
+  putVarint(frame, attributes_.size());
+  for (const auto& kv : attributes_)
+  {
+    size_t index = keys.find(kv.first);
+    if (index == keys.size())
+    {
+      putVarint(frame, 0);
+      putBytes(frame, kv.first);
+      if (pKeys && pKeys->add(kv.first))
+        index = pKeys->size() - 1;
+    }
+    else if (pKeys && keys.entries_[index].hasValue && keys.entries_[index].value == kv.second)
+    {
+      putVarint(frame, ((index + 1) << 1) | 1);
+      continue;
+    }
+    else
+    {
+      putVarint(frame, (index + 1) << 1);
+    }
+    putBytes(frame, kv.second);
+    if (pKeys && index < pKeys->size())
+    {
+      pKeys->entries_[index].value = kv.second;
+      pKeys->entries_[index].hasValue = true;
+    }
+  }
+  putBytes(frame, body_);
+
+  size_t length = frame.size() - BinaryFrame::HeaderSize;
+  frame[0] = (char)BinaryFrame::Magic;
+  for (size_t i = 0; i < 4; ++i)
+    frame[1 + i] = (char)((length >> (8 * i)) & 0xFF);
+  return frame;
+}
+//----< creates message from the bytes that follow a frame header >---
+/*
+*  - pKeys is the key table of the connection the frame came from,
+*    and is updated; with none only the common keys are known
+*  - throws std::runtime_error if the bytes are not a well formed frame
+*/
+Message Message::fromBinary(const char* frame, size_t length, BinaryKeyTable* pKeys)
+{
+  const char* pos = frame;
+  const char* end = frame + length;
+  const BinaryKeyTable& keys = pKeys ? *pKeys : commonKeyTable();
+
+  Message msg;
+  size_t count = getVarint(pos, end);
+  if (count > length)
+    throw std::runtime_error("malformed binary message: bad attribute count");
+  msg.attributes_.reserve(count);
+  for (size_t i = 0; i < count; ++i)
+  {
+    size_t code = getVarint(pos, end);
+    bool same = (code & 1) != 0;
+    size_t index = (code >> 1) - 1;       // wraps for literal keys
+    if (code >> 1 == 0)
+    {
+      Key key = getBytes(pos, end);
+      index = (pKeys && !same && pKeys->add(key)) ? pKeys->size() - 1 : keys.size();
+      if (index == keys.size())
+      {
+        if (same)
+          throw std::runtime_error("malformed binary message: literal key with repeated value");
+        msg.attributes_[std::move(key)] = getBytes(pos, end);
+        continue;
+      }
+    }
+    else if (index >= keys.size())
+    {
+      throw std::runtime_error("malformed binary message: unknown key code");
+    }
+    if (same)
+    {
+      if (!pKeys || !keys.entries_[index].hasValue)
+        throw std::runtime_error("malformed binary message: no value to repeat");
+      msg.attributes_[keys.entries_[index].key] = keys.entries_[index].value;
+      continue;
+    }
+    Value value = getBytes(pos, end);
+    if (pKeys)
+    {
+      pKeys->entries_[index].value = value;
+      pKeys->entries_[index].hasValue = true;
+    }
+    msg.attributes_[keys.entries_[index].key] = std::move(value);
+  }
+  msg.body_ = getBytes(pos, end);
+  if (pos != end)
+    throw std::runtime_error("malformed binary message: trailing bytes");
+  return msg;
+}
 //----< displays message on std::ostream >-----------------------------
 /*
 *  - adds beginning newline and removes trailing newline
@@ -286,6 +532,39 @@ int main()
   newMsg.attribute("customName", "customValue");
   newMsg.show();
 
+  SUtils::title("testing Message msg = fromBinary(msg.toBinary())");
+  newMsg.body(std::string("\0\1\2 binary body", 16));
+  std::string frame = newMsg.toBinary();
+  std::cout << "\n  text size = " << newMsg.toString().size() << " bytes, binary frame size = " << frame.size() << " bytes";
+  size_t length = BinaryFrame::length(frame.c_str());
+  Message binMsg = Message::fromBinary(frame.c_str() + BinaryFrame::HeaderSize, length);
+  binMsg.show();
+  std::cout << "\n  body of " << binMsg.body().size() << " bytes "
+    << (binMsg.body() == newMsg.body() ? "survived" : "did not survive") << " the round trip";
+  try
+  {
+    Message::fromBinary(frame.c_str() + BinaryFrame::HeaderSize, length - 1);
+  }
+  catch (std::exception& ex)
+  {
+    std::cout << "\n  truncated frame refused: " << ex.what();
+  }
+  Utilities::putline();
+
+  SUtils::title("testing frames sent over one connection, with key tables");
+  BinaryKeyTable sendKeys, recvKeys;
+  newMsg.body("");
+  for (size_t i = 0; i < 3; ++i)
+  {
+    newMsg.name("msg#" + Utilities::Converter<size_t>::toString(i + 1));
+    frame = newMsg.toBinary(&sendKeys);
+    binMsg = Message::fromBinary(frame.c_str() + BinaryFrame::HeaderSize, BinaryFrame::length(frame.c_str()), &recvKeys);
+    std::cout << "\n  frame #" << i + 1 << " is " << frame.size() << " bytes, arrived as "
+      << binMsg.name() << " with " << binMsg.attributes().size() << " attributes"
+      << ", customName:" << binMsg.value("customName");
+  }
+  Utilities::putline();
+
   SUtils::title("testing assignment");
   Message srcMsg;
   srcMsg.name("srcMsg");
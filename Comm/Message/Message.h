@@ -1,7 +1,7 @@
 #pragma once
 /////////////////////////////////////////////////////////////////////////
 // Message.h - defines message structure used in communication channel //
-// ver 1.2                                                             //
+// ver 1.4                                                             //
 // Jim Fawcett, CSE687-OnLine Object Oriented Design, Fall 2017        //
 /////////////////////////////////////////////////////////////////////////
 /*
@@ -13,6 +13,33 @@
 *    name:value pairs.
 *  - Message have a number of getter, setter methods for common attributes, and allow
 *    definition of other "custom" attributes.
+*  - Messages have two wire representations:
+*    - text:   toString/fromString, one "name:value" line per attribute ending
+*              with an empty line
+*    - binary: toBinary/fromBinary, a length-prefixed frame, described below,
+*              that may also carry a body of arbitrary bytes
+*    Which one a connection uses is negotiated by Comm's Sender.
+*
+*  Binary frame:
+*  -------------
+*    byte     BinaryFrame::Magic, never the first byte of a text message
+*    uint32   length of the rest of the frame, little-endian
+*    varint   number of attributes, then for each attribute:
+*      varint   key code, (n << 1) | same, where n is 0 for a literal key
+*               and otherwise 1 + the key's index in the key table
+*      varint   key length and key bytes, if n is 0
+*      varint   value length and value bytes, unless same is 1, when the
+*               value is the last one sent with this key
+*    varint   body length and body bytes
+*  Varints are unsigned LEB128: seven bits per byte, low bits first, high
+*  bit set on all but the last byte.
+*
+*  The key table of a connection starts as BinaryFrame::commonKeys() and
+*  grows by each literal key sent on it (see BinaryKeyTable), so custom
+*  keys and repeated values, to and from say, cost a byte after their
+*  first use.  Frames converted without a table use only the common keys
+*  and never set same.  The common keys are part of the format, so keys
+*  may only ever be added to the end of that list.
 *
 *  Required Files:
 *  ---------------
@@ -20,6 +47,13 @@
 *
 *  Maintenance History:
 *  --------------------
+*  ver 1.4 : 19 Oct 2026
+*  - fromBinary throws std::runtime_error; std::exception has no
+*    message constructor outside Visual C++
+*  ver 1.3 : 19 Oct 2026
+*  - added binary frames: toBinary, fromBinary, BinaryFrame and
+*    BinaryKeyTable
+*  - added body, bytes carried only by binary frames
 *  ver 1.2 : 27 Mar 2018
 *  - added remove method to remove a message attribute, based on its key
 *  ver 1.1 : 25 Mar 2018
@@ -67,6 +101,55 @@ namespace MsgPassingCommunication
     ep.port = Utilities::Converter<size_t>::toValue(portStr);
     return ep;
   }
+  ///////////////////////////////////////////////////////////////////
+  // WireFormat - how a connection carries messages
+
+  enum class WireFormat { text, binary };
+
+  ///////////////////////////////////////////////////////////////////
+  // BinaryFrame - constants of the binary message format
+
+  struct BinaryFrame
+  {
+    static const unsigned char Magic = 0xB1;
+    static const size_t HeaderSize = 5;                   // magic and length
+    static const size_t MaxLength = 64 * 1024 * 1024;     // larger frames are refused
+    static const std::vector<std::string>& commonKeys();
+    static size_t length(const char* header);             // 0 if header isn't valid
+  };
+
+  ///////////////////////////////////////////////////////////////////
+  // BinaryKeyTable - keys and last values of one binary connection
+  // - the sending and receiving ends each keep one, which toBinary
+  //   and fromBinary update identically
+  // - literal keys of up to MaxKeyLength bytes are added until the
+  //   table holds MaxEntries keys
+
+  class BinaryKeyTable
+  {
+  public:
+    static const size_t MaxEntries = 1024;
+    static const size_t MaxKeyLength = 64;
+
+    BinaryKeyTable();
+    void clear();                          // back to the common keys
+    size_t size() const { return entries_.size(); }
+
+  private:
+    friend class Message;
+    struct Entry
+    {
+      std::string key;
+      std::string value;
+      bool hasValue = false;
+    };
+    size_t find(const std::string& key) const;   // index or entries_.size()
+    bool add(const std::string& key);
+
+    std::vector<Entry> entries_;
+    std::unordered_map<std::string, size_t> index_;
+  };
+
   ///////////////////////////////////////////////////////////////////
   // Message class
   // - follows the style, but not the implementation details of
@@ -105,13 +188,19 @@ namespace MsgPassingCommunication
     void file(const std::string& fl);
     size_t contentLength();
     void contentLength(size_t ln);
+    const std::string& body();
+    void body(const std::string& bytes);
+    void body(std::string&& bytes);
     void clear();
     std::string toString();
     static Message fromString(const std::string& src);
+    std::string toBinary(BinaryKeyTable* pKeys = nullptr);
+    static Message fromBinary(const char* frame, size_t length, BinaryKeyTable* pKeys = nullptr);
     std::ostream& show(std::ostream& out = std::cout);
 
   private:
     Attributes attributes_;
+    std::string body_;
     // name            : msgName
     // command         : msg Command
     // to              : dst EndPoint
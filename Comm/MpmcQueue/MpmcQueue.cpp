@@ -0,0 +1,107 @@
+/////////////////////////////////////////////////////////////////////
+// MpmcQueue.cpp - bounded lock-free multi-producer/consumer queue //
+// ver 1.2                                                         //
+// Language:    C++, Visual Studio 2017                            //
+// Application: Remote Code Repository, CSE687 - OOD               //
+// Author:      Ritesh Nair (rgnair@syr.edu)                       //
+/////////////////////////////////////////////////////////////////////
+
+#include "MpmcQueue.h"
+
+#ifdef TEST_MPMCQUEUE
+
+#include <iostream>
+#include <string>
+
+//----< producers and consumers pass numbered strings >--------------
+/*
+*  - each consumer sums what it takes, so that every item is seen to
+*    arrive exactly once
+*/
+int main()
+{
+  std::cout << "\n  Demonstrating MpmcQueue";
+  std::cout << "\n =========================";
+
+  MpmcQueue<std::string> q(64);
+  std::cout << "\n  capacity " << q.capacity();
+
+  const size_t Producers = 4;
+  const size_t Consumers = 4;
+  const size_t PerProducer = 100000;
+  std::atomic<size_t> sum{ 0 };
+  std::atomic<size_t> taken{ 0 };
+
+  std::vector<std::thread> threads;
+  for (size_t p = 0; p < Producers; ++p)
+  {
+    threads.push_back(std::thread([&q, p, PerProducer]() {
+      for (size_t i = 0; i < PerProducer; ++i)
+        q.enQ(std::to_string(p * PerProducer + i));
+    }));
+  }
+  for (size_t c = 0; c < Consumers; ++c)
+  {
+    bool batch = (c % 2 == 1);
+    threads.push_back(std::thread([&, batch]() {
+      std::vector<std::string> items;
+      while (taken.load() < Producers * PerProducer)
+      {
+        items.clear();
+        std::string item;
+        if (!q.deQ(item, std::chrono::milliseconds(10)))
+          continue;
+        items.push_back(std::move(item));
+        if (batch)
+          q.deQBatch(items, 16);
+        for (std::string& str : items)
+          sum += std::stoull(str);
+        taken += items.size();
+      }
+    }));
+  }
+  for (std::thread& t : threads)
+    t.join();
+
+  size_t n = Producers * PerProducer;
+  std::cout << "\n  took " << taken.load() << " of " << n << " items";
+  std::cout << "\n  sum " << (sum.load() == n * (n - 1) / 2 ? "matches" : "is wrong");
+
+  q.enQ("one");
+  q.enQ("two");
+  q.enQ("three");
+  std::vector<std::string> rest;
+  q.deQAll(rest);
+  std::cout << "\n  deQAll took " << rest.size() << " items, size now " << q.size();
+  std::string none;
+  std::cout << "\n  tryDeQ on empty queue returns " << std::boolalpha << q.tryDeQ(none);
+
+  // producers parked on a full queue must all wake when one deQAll
+  // frees room for them, with no consumer calling again
+  MpmcQueue<std::string> small(4);
+  for (size_t i = 0; i < small.capacity(); ++i)
+    small.enQ("full");
+  std::atomic<size_t> added{ 0 };
+  std::vector<std::thread> parked;
+  for (size_t p = 0; p < small.capacity(); ++p)
+  {
+    parked.push_back(std::thread([&small, &added]() {
+      small.enQ("parked");
+      ++added;
+    }));
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+  rest.clear();
+  small.deQAll(rest);
+  std::chrono::steady_clock::time_point until = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+  while (added.load() < parked.size() && std::chrono::steady_clock::now() < until)
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  std::cout << "\n  one deQAll woke " << added.load() << " of " << parked.size() << " parked producers";
+  while (added.load() < parked.size())
+    small.deQAll(rest);
+  for (std::thread& t : parked)
+    t.join();
+  std::cout << "\n\n";
+}
+
+#endif
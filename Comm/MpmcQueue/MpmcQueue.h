@@ -0,0 +1,385 @@
+#ifndef MPMCQUEUE_H
+#define MPMCQUEUE_H
+/////////////////////////////////////////////////////////////////////
+// MpmcQueue.h - bounded lock-free multi-producer/consumer queue   //
+// ver 1.2                                                         //
+// Language:    C++, Visual Studio 2017                            //
+// Application: Remote Code Repository, CSE687 - OOD               //
+// Author:      Ritesh Nair (rgnair@syr.edu)                       //
+/////////////////////////////////////////////////////////////////////
+/*
+*  Package Operations:
+*  -------------------
+*  MpmcQueue<T> is an alternative to BlockingQueue<T> for queues that
+*  many threads enQ and deQ at once.  BlockingQueue takes a mutex on
+*  every call; MpmcQueue is a ring of cells, after Dmitry Vyukov's
+*  bounded MPMC queue:
+*  - each cell has a sequence number saying whether it is ready to be
+*    written or read in the current lap of the ring, so producers and
+*    consumers claim cells with a single compare-exchange and don't
+*    otherwise touch each other's state
+*  - items are moved in and out, never copied; T must be movable and
+*    default constructible
+*  - capacity is rounded up to a power of two, and can be changed
+*    only while no other thread uses the queue
+*
+*  tryEnQ and tryDeQ return at once.  enQ waits while the queue is full
+*  and deQ while it is empty: they spin briefly, then park on a
+*  condition variable until the other side signals.  A thread that
+*  doesn't wait never takes the mutex, apart from waking one that does.
+*
+*  deQBatch and deQAll move out whatever is ready, up to a limit,
+*  without waiting, for consumers that drain the queue in bursts.
+*
+*  The interface matches BlockingQueue's enQ, deQ, size and clear, so
+*  classes that take their queue type as a template parameter, like
+*  Comm's BasicReceiver and the Logger, can use either.
+*
+*  Required Files:
+*  ---------------
+*  MpmcQueue.h, MpmcQueue.cpp
+*
+*  Build Process:
+*  --------------
+*  Define TEST_MPMCQUEUE to build the test stub.
+*
+*  Maintenance History:
+*  --------------------
+*  ver 1.2 : 19 Oct 2026
+*  - deQBatch and clear wake every parked producer when they free
+*    more than one cell, not just one
+*  ver 1.1 : 19 Oct 2026
+*  - added capacity(maxItems), so owners can size the queue after
+*    constructing it
+*  ver 1.0 : 19 Oct 2026
+*  - first release
+*/
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+template <typename T>
+class MpmcQueue
+{
+public:
+  static const size_t DefaultCapacity = 8192;
+  static const size_t SpinCount = 64;              // tries before parking
+
+  explicit MpmcQueue(size_t capacity = DefaultCapacity);
+  MpmcQueue(const MpmcQueue<T>&) = delete;
+  MpmcQueue<T>& operator=(const MpmcQueue<T>&) = delete;
+  ~MpmcQueue();
+
+  bool tryEnQ(T&& t);
+  void enQ(T&& t);
+  void enQ(const T& t) { enQ(T(t)); }
+  bool tryDeQ(T& t);
+  bool deQ(T& t, std::chrono::milliseconds timeout);
+  T deQ();
+  size_t deQBatch(std::vector<T>& out, size_t maxItems);
+  size_t deQAll(std::vector<T>& out) { return deQBatch(out, capacity()); }
+  size_t size() const;
+  size_t capacity() const { return mask_ + 1; }
+  void capacity(size_t maxItems);
+  void clear();
+
+private:
+  struct Cell
+  {
+    std::atomic<size_t> sequence;
+    typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+  };
+  static const size_t CacheLine = 64;
+
+  void allocate(size_t capacity);
+  bool put(T&& t);
+  bool claim(T& t);
+  void wakeConsumer();
+  void wakeProducer(size_t freed = 1);
+
+  std::unique_ptr<Cell[]> cells_;
+  size_t mask_;
+  alignas(CacheLine) std::atomic<size_t> enQPos_{ 0 };
+  alignas(CacheLine) std::atomic<size_t> deQPos_{ 0 };
+  alignas(CacheLine) std::atomic<size_t> parkedConsumers_{ 0 };
+  std::atomic<size_t> parkedProducers_{ 0 };
+  std::mutex parkMtx_;
+  std::condition_variable notEmpty_;
+  std::condition_variable notFull_;
+};
+//----< constructor allocates the ring >----------------------------
+
+template <typename T>
+MpmcQueue<T>::MpmcQueue(size_t capacity)
+{
+  allocate(capacity);
+}
+//----< allocates cells, sequenced for the first lap >--------------
+
+template <typename T>
+void MpmcQueue<T>::allocate(size_t capacity)
+{
+  size_t size = 2;
+  while (size < capacity)
+    size <<= 1;
+  cells_.reset(new Cell[size]);
+  mask_ = size - 1;
+  for (size_t i = 0; i < size; ++i)
+    cells_[i].sequence.store(i, std::memory_order_relaxed);
+  enQPos_.store(0, std::memory_order_relaxed);
+  deQPos_.store(0, std::memory_order_relaxed);
+}
+//----< replaces the ring with one of at least maxItems cells >-----
+/*
+*  - items still queued are destroyed
+*  - only while no other thread enQs or deQs
+*/
+template <typename T>
+void MpmcQueue<T>::capacity(size_t maxItems)
+{
+  clear();
+  allocate(maxItems);
+}
+//----< destructor destroys items still queued >--------------------
+
+template <typename T>
+MpmcQueue<T>::~MpmcQueue()
+{
+  clear();
+}
+//----< moves t into a free cell, without waking consumers >-------
+/*
+*  - t is left as it was if the queue is full
+*/
+template <typename T>
+bool MpmcQueue<T>::put(T&& t)
+{
+  Cell* cell;
+  size_t pos = enQPos_.load(std::memory_order_relaxed);
+  while (true)
+  {
+    cell = &cells_[pos & mask_];
+    size_t seq = cell->sequence.load(std::memory_order_acquire);
+    intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+    if (diff == 0)
+    {
+      if (enQPos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+        break;
+    }
+    else if (diff < 0)
+      return false;                   // a lap behind: full
+    else
+      pos = enQPos_.load(std::memory_order_relaxed);
+  }
+  new (&cell->storage) T(std::move(t));
+  cell->sequence.store(pos + 1, std::memory_order_release);
+  return true;
+}
+//----< moves t into the queue unless it is full >------------------
+
+template <typename T>
+bool MpmcQueue<T>::tryEnQ(T&& t)
+{
+  if (!put(std::move(t)))
+    return false;
+  wakeConsumer();
+  return true;
+}
+//----< moves t into the queue, waiting while it is full >----------
+
+template <typename T>
+void MpmcQueue<T>::enQ(T&& t)
+{
+  for (size_t i = 0; i < SpinCount; ++i)
+  {
+    if (tryEnQ(std::move(t)))
+      return;
+    std::this_thread::yield();
+  }
+  parkedProducers_.fetch_add(1);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  {
+    std::unique_lock<std::mutex> lock(parkMtx_);
+    while (!put(std::move(t)))
+      notFull_.wait(lock);
+  }
+  parkedProducers_.fetch_sub(1);
+  wakeConsumer();
+}
+//----< moves the oldest item into t, without waking producers >----
+
+template <typename T>
+bool MpmcQueue<T>::claim(T& t)
+{
+  Cell* cell;
+  size_t pos = deQPos_.load(std::memory_order_relaxed);
+  while (true)
+  {
+    cell = &cells_[pos & mask_];
+    size_t seq = cell->sequence.load(std::memory_order_acquire);
+    intptr_t diff = (intptr_t)seq - (intptr_t)(pos + 1);
+    if (diff == 0)
+    {
+      if (deQPos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+        break;
+    }
+    else if (diff < 0)
+      return false;                   // not written yet: empty
+    else
+      pos = deQPos_.load(std::memory_order_relaxed);
+  }
+  T* item = reinterpret_cast<T*>(&cell->storage);
+  t = std::move(*item);
+  item->~T();
+  cell->sequence.store(pos + mask_ + 1, std::memory_order_release);
+  return true;
+}
+//----< moves the oldest item into t unless the queue is empty >----
+
+template <typename T>
+bool MpmcQueue<T>::tryDeQ(T& t)
+{
+  if (!claim(t))
+    return false;
+  wakeProducer();
+  return true;
+}
+//----< waits up to timeout for an item >---------------------------
+
+template <typename T>
+bool MpmcQueue<T>::deQ(T& t, std::chrono::milliseconds timeout)
+{
+  for (size_t i = 0; i < SpinCount; ++i)
+  {
+    if (tryDeQ(t))
+      return true;
+    std::this_thread::yield();
+  }
+  std::chrono::steady_clock::time_point until = std::chrono::steady_clock::now() + timeout;
+  bool found = false;
+  parkedConsumers_.fetch_add(1);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  {
+    std::unique_lock<std::mutex> lock(parkMtx_);
+    while (!(found = claim(t)))
+    {
+      if (notEmpty_.wait_until(lock, until) == std::cv_status::timeout)
+      {
+        found = claim(t);
+        break;
+      }
+    }
+  }
+  parkedConsumers_.fetch_sub(1);
+  if (found)
+    wakeProducer();
+  return found;
+}
+//----< removes the oldest item, waiting while the queue is empty >-
+
+template <typename T>
+T MpmcQueue<T>::deQ()
+{
+  T t;
+  for (size_t i = 0; i < SpinCount; ++i)
+  {
+    if (tryDeQ(t))
+      return t;
+    std::this_thread::yield();
+  }
+  parkedConsumers_.fetch_add(1);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  {
+    std::unique_lock<std::mutex> lock(parkMtx_);
+    while (!claim(t))
+      notEmpty_.wait(lock);
+  }
+  parkedConsumers_.fetch_sub(1);
+  wakeProducer();
+  return t;
+}
+//----< appends up to maxItems ready items to out, without waiting >
+
+template <typename T>
+size_t MpmcQueue<T>::deQBatch(std::vector<T>& out, size_t maxItems)
+{
+  size_t count = 0;
+  T t;
+  while (count < maxItems && claim(t))
+  {
+    out.push_back(std::move(t));
+    ++count;
+  }
+  if (count > 0)
+    wakeProducer(count);
+  return count;
+}
+//----< number of items queued, exact only while no one enQs or deQs >
+
+template <typename T>
+size_t MpmcQueue<T>::size() const
+{
+  size_t deQPos = deQPos_.load(std::memory_order_acquire);
+  size_t enQPos = enQPos_.load(std::memory_order_acquire);
+  return (enQPos > deQPos) ? enQPos - deQPos : 0;
+}
+//----< removes all items >-----------------------------------------
+
+template <typename T>
+void MpmcQueue<T>::clear()
+{
+  T t;
+  size_t count = 0;
+  while (claim(t))
+    ++count;
+  if (count > 0)
+    wakeProducer(count);
+}
+//----< signals a parked consumer, if any >-------------------------
+/*
+*  - the fence pairs with the one a consumer makes after counting
+*    itself parked: either it sees the new item or this sees it
+*  - taking the mutex keeps the signal from falling between the
+*    consumer's last try and its wait, so is never done while holding
+*    it; parked threads use put and claim, which don't signal
+*/
+template <typename T>
+void MpmcQueue<T>::wakeConsumer()
+{
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (parkedConsumers_.load(std::memory_order_relaxed) == 0)
+    return;
+  {
+    std::lock_guard<std::mutex> lock(parkMtx_);
+  }
+  notEmpty_.notify_one();
+}
+//----< signals parked producers, if any, that freed cells are free >
+/*
+*  - one cell wakes one producer; more wake them all, as each parked
+*    producer may have room now and those that don't park again
+*/
+template <typename T>
+void MpmcQueue<T>::wakeProducer(size_t freed)
+{
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (parkedProducers_.load(std::memory_order_relaxed) == 0)
+    return;
+  {
+    std::lock_guard<std::mutex> lock(parkMtx_);
+  }
+  if (freed > 1)
+    notFull_.notify_all();
+  else
+    notFull_.notify_one();
+}
+
+#endif
@@ -1,6 +1,6 @@
 /////////////////////////////////////////////////////////////////////
 // Comm.h - message-passing communication facility                 //
-// ver 2.2                                                         //
+// ver 3.3                                                         //
 // Jim Fawcett, CSE687-OnLine Object Oriented Design, Fall 2017    //
 /////////////////////////////////////////////////////////////////////
 
@@ -12,7 +12,7 @@
 #include <fstream>
 #include <functional>
 #include <algorithm>
-#include <conio.h>
+#include <cstring>
 
 using namespace MsgPassingCommunication;
 using namespace Sockets;
@@ -21,191 +21,792 @@ using SUtils = Utilities::StringHelper;
 const std::string saveFilePath = "../SaveFiles";
 const std::string sendFilePath = "../SendFiles";
 const size_t BlockSize = 1024;
-Socket::byte rwBuffer[BlockSize];
 
+//----< frame text message string by reading lines from socket >-----
+
+std::string readMsgString(Socket& socket)
+{
+  std::string temp, msgString;
+  while (socket.validState())
+  {
+    temp = socket.readLine();        // read attribute
+    msgString += temp;
+    if (temp.length() < 2)           // if empty line we are done
+      break;
+  }
+  return msgString;
+}
+//----< reply to a wire format hello >-------------------------------
+
+std::string wireAck(Message& hello)
+{
+  Message ack;
+  ack.command(WireAck);
+  if (hello.value("wire") == WireBinaryVersion)
+    ack.attribute("wire", WireBinaryVersion);
+  return ack.toString();
+}
 //----< constructor sets port >--------------------------------------
 
-Receiver::Receiver(EndPoint ep, const std::string& name) : listener(ep.port), rcvrName(name)
+template<typename Queue>
+BasicReceiver<Queue>::BasicReceiver(EndPoint ep, const std::string& name) : listener(ep.port), port_(ep.port), rcvrName(name)
 {
   StaticLogger<1>::write("\n  -- starting Receiver");
+  rcvQ.capacity(DefaultQueueLimit);
 }
 //----< returns reference to receive queue >-------------------------
 
-BlockingQueue<Message>* Receiver::queue()
+template<typename Queue>
+Queue* BasicReceiver<Queue>::queue()
 {
   return &rcvQ;
 }
 //----< starts listener thread running callable object >-------------
 
+template<typename Queue>
 template<typename CallableObject>
-void Receiver::start(CallableObject& co)
+void BasicReceiver<Queue>::start(CallableObject& co)
 {
   listener.start(co);
 }
-//----< stops listener thread >--------------------------------------
+//----< starts reactor, with a handler from factory per connection >-
+/*
+*  - SocketListener and SocketConnecter pass the port through htons
+*    before resolving it, so the reactor listens on that port too
+*  - returns false if the reactor isn't supported or can't listen
+*/
+template<typename Queue>
+bool BasicReceiver<Queue>::start(SocketReactor::HandlerFactory factory, size_t ioThreads)
+{
+  if (!SocketReactor::supported())
+    return false;
+  reactor_.reset(new SocketReactor(ioThreads));
+  if (reactor_->listen(htons((u_short)port_), factory))
+    return true;
+  reactor_.reset();
+  return false;
+}
+//----< stops listener thread or reactor >---------------------------
 
-void Receiver::stop()
+template<typename Queue>
+void BasicReceiver<Queue>::stop()
 {
-  listener.stop();
+  if (reactor_)
+    reactor_->stop();
+  else
+    listener.stop();
 }
 //----< retrieves received message >---------------------------------
 
-Message Receiver::getMessage()
+template<typename Queue>
+Message BasicReceiver<Queue>::getMessage()
 {
   StaticLogger<1>::write("\n  -- " + rcvrName + " deQing message");
   return rcvQ.deQ();
 }
-//----< constructor initializes endpoint object >--------------------
+//----< bounds the receive queue and sets what overflow does >-------
+/*
+*  - call before start(); an MpmcQueue drops what it holds
+*/
+template<typename Queue>
+void BasicReceiver<Queue>::queueLimit(size_t maxMessages, OverflowPolicy policy)
+{
+  rcvQ.capacity(maxMessages);
+  policy_ = policy;
+}
+//----< sets function called with each rejected message >------------
+
+template<typename Queue>
+void BasicReceiver<Queue>::onReject(std::function<void(Message&)> handler)
+{
+  onReject_ = handler;
+}
+//----< queues msg, unless the queue is full and policy_ is block >--
+/*
+*  - moves msg out unless returning false
+*  - never waits, so reactor handlers can hold on to msg and pause
+*    their connection instead
+*/
+template<typename Queue>
+bool BasicReceiver<Queue>::offer(Message& msg)
+{
+  if (rcvQ.tryEnQ(std::move(msg)))
+    return true;
+  if (policy_ == OverflowPolicy::block)
+    return false;
+  if (policy_ == OverflowPolicy::reject)
+  {
+    StaticLogger<1>::write("\n  -- " + rcvrName + " queue full, rejecting " + msg.name());
+    ++dropped_;
+    if (onReject_)
+      onReject_(msg);
+    return true;
+  }
+  Message oldest;
+  while (!rcvQ.tryEnQ(std::move(msg)))
+  {
+    if (rcvQ.tryDeQ(oldest))
+      ++dropped_;
+  }
+  return true;
+}
+//----< queues msg, waiting for room if policy_ is block >-----------
+
+template<typename Queue>
+void BasicReceiver<Queue>::deliver(Message& msg)
+{
+  if (!offer(msg))
+    rcvQ.enQ(std::move(msg));
+}
+//----< returns number of messages dropped or rejected >-------------
 
-Sender::Sender(const std::string& name) : sndrName(name)
+template<typename Queue>
+size_t BasicReceiver<Queue>::dropped()
 {
-  lastEP = EndPoint();  // used to detect change in destination
+  return dropped_.load();
 }
-//----< destructor waits for send thread to terminate >--------------
+//----< constructor sets name >-------------------------------------
+
+Sender::Sender(const std::string& name) : sndrName(name) {}
+
+//----< destructor sends what was posted and waits for workers >----
 
 Sender::~Sender()
 {
-  if (sendThread.joinable())
-    sendThread.join();
+  stop();
+  for (std::thread& worker : workers_)
+  {
+    if (worker.joinable())
+      worker.join();
+  }
+  closeAll();
 }
-//----< starts send thread deQ, inspect, and send loop >-------------
+//----< starts send workers >----------------------------------------
 
 void Sender::start()
 {
-  std::function <void()> threadProc = [&]() {
-    while (true)
+  std::lock_guard<std::mutex> lock(mtx_);
+  stopping_ = false;
+  for (size_t i = 0; i < sendThreads_; ++i)
+  {
+    workers_.push_back(std::thread(&Sender::work, this));
+    ++running_;
+  }
+}
+//----< stops workers once they have sent what was posted >----------
+
+void Sender::stop()
+{
+  std::lock_guard<std::mutex> lock(mtx_);
+  stopping_ = true;
+  readyCv_.notify_all();
+  roomCv_.notify_all();
+}
+//----< send worker takes ready destinations until stopped >---------
+/*
+*  - a destination goes to the back of ready_ after each batch, so a
+*    busy one doesn't keep a worker from the others
+*  - a destination that can't be reached backs off; see backOff
+*  - the last worker to stop closes the connections
+*/
+void Sender::work()
+{
+  std::unique_lock<std::mutex> lock(mtx_);
+  while (true)
+  {
+    Destination* pDest = takeReady(lock);
+    if (pDest == nullptr)
+      break;
+    Destination& dest = *pDest;
+    evictIdle();
+
+    std::vector<Message> batch;
+    while (!dest.pending.empty() && batch.size() < MaxBatch)
+    {
+      batch.push_back(std::move(dest.pending.front()));
+      dest.pending.pop_front();
+    }
+    roomCv_.notify_all();
+    lock.unlock();
+    size_t sent = 0;
+    bool reached = true;
+    for (Message& msg : batch)
     {
-      Message msg = sndQ.deQ();
-      if (msg.containsKey("verbose"))
-      {
-        //::Beep(1000, 100);
-        //::Beep(1000, 100);
-        //::Beep(1000, 100);
-      }
-      if (msg.command() == "quit")
-      {
-        StaticLogger<1>::write("\n  -- send thread shutting down");
-        return;
-      }
       StaticLogger<1>::write("\n  -- " + sndrName + " send thread sending " + msg.name());
-      std::string msgStr = msg.toString();
-
-      if (msg.to().address != lastEP.address || msg.to().port != lastEP.port)
-      {
-        connecter.shutDown();
-        //connecter.close();
-        StaticLogger<1>::write("\n  -- attempting to connect to new endpoint: " + msg.to().toString());
-        if (!connect(msg.to()))
-        {
-          StaticLogger<1>::write("\n can't connect");
-          continue;
-        }
-        else
-        {
-          StaticLogger<1>::write("\n  connected to " + msg.to().toString());
-        }
-      }
-      if (msg.containsKey("file"))
+      if (!open(dest))
       {
-        sendFile(msg);
+        reached = false;
+        break;
       }
-      else
+      sendTo(dest, msg);
+      ++sent;
+    }
+    lock.lock();
+    dest.lastUsed = std::chrono::steady_clock::now();
+    if (reached)
+      dest.failures = 0;
+    else
+      backOff(dest, batch, sent);
+    release(dest);
+  }
+  if (--running_ == 0)
+  {
+    lock.unlock();
+    StaticLogger<1>::write("\n  -- send threads shutting down");
+    closeAll();
+  }
+}
+//----< waits for a destination to send to; nullptr once stopped >--
+/*
+*  - destinations backing off are moved to ready_ when their retryAt
+*    comes, or at once when stopping, for a last try
+*/
+Destination* Sender::takeReady(std::unique_lock<std::mutex>& lock)
+{
+  while (true)
+  {
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    std::chrono::steady_clock::time_point nextRetry = std::chrono::steady_clock::time_point::max();
+    for (auto iter = waiting_.begin(); iter != waiting_.end(); )
+    {
+      if (stopping_ || (*iter)->retryAt <= now)
       {
-        bool sendRslt = connecter.send(msgStr.length(), (Socket::byte*)msgStr.c_str());
+        ready_.push_back(*iter);
+        iter = waiting_.erase(iter);
+        continue;
       }
+      nextRetry = (std::min)(nextRetry, (*iter)->retryAt);
+      ++iter;
     }
-  };
-  std::thread t(threadProc);
-  sendThread = std::move(t);
+    if (!ready_.empty())
+    {
+      Destination* pDest = ready_.front();
+      ready_.pop_front();
+      return pDest;
+    }
+    if (stopping_)
+      return nullptr;
+    if (waiting_.empty())
+      readyCv_.wait(lock);
+    else
+      readyCv_.wait_until(lock, nextRetry);
+  }
 }
-//----< stops send thread by posting quit message >------------------
+//----< handles a failed connect to dest, called with mtx_ held >----
+/*
+*  - the messages of batch not yet sent go back to the front of dest's
+*    queue, and dest is retried after RetryDelay milliseconds, doubled
+*    for each failure in a row
+*  - after ConnectRetries failures, or when stopping, dest's messages
+*    are dropped
+*/
+void Sender::backOff(Destination& dest, std::vector<Message>& batch, size_t sent)
+{
+  ++dest.failures;
+  if (dest.failures >= ConnectRetries || stopping_)
+  {
+    size_t count = batch.size() - sent + dest.pending.size();
+    StaticLogger<1>::write("\n  -- can't connect to " + dest.ep.toString() + " after "
+      + std::to_string(dest.failures) + " tries, dropping " + std::to_string(count) + " messages");
+    dropped_ += count;
+    dest.pending.clear();
+    dest.failures = 0;
+    roomCv_.notify_all();
+    return;
+  }
+  for (size_t i = batch.size(); i > sent; --i)
+    dest.pending.push_front(std::move(batch[i - 1]));
+  size_t delay = RetryDelay << (dest.failures - 1);
+  dest.retryAt = std::chrono::steady_clock::now() + std::chrono::milliseconds(delay);
+  StaticLogger<1>::write("\n  -- can't connect to " + dest.ep.toString() + ", retrying in "
+    + std::to_string(delay) + " ms");
+}
+//----< sends msg on dest's open connection >------------------------
+/*
+*  - a message whose send fails, perhaps on a connection the peer
+*    closed, is sent once more on a new connection
+*/
+void Sender::sendTo(Destination& dest, Message& msg)
+{
+  if (send(*dest.conn, msg))
+    return;
+  StaticLogger<1>::write("\n  -- send to " + dest.ep.toString() + " failed, reconnecting");
+  closeConnection(dest);
+  if (open(dest))
+    send(*dest.conn, msg);
+}
+//----< connects to dest's endpoint unless its connection is usable >
+/*
+*  - called by the worker holding dest; connects without the lock
+*/
+bool Sender::open(Destination& dest)
+{
+  if (dest.conn)
+  {
+    if (!dest.conn->connecter.peerClosed())
+    {
+      wire_ = dest.conn->wire;
+      return true;
+    }
+    StaticLogger<1>::write("\n  -- " + dest.ep.toString() + " closed pooled connection");
+    closeConnection(dest);
+  }
+  StaticLogger<1>::write("\n  -- attempting to connect to new endpoint: " + dest.ep.toString());
+  std::unique_ptr<SenderConnection> pConn(new SenderConnection);
+  if (!pConn->connecter.connect(dest.ep.address, dest.ep.port))
+    return false;
+  StaticLogger<1>::write("\n  connected to " + dest.ep.toString());
+  if (preferred_ == WireFormat::binary && negotiate(*pConn))
+    pConn->wire = WireFormat::binary;
+  wire_ = pConn->wire;
+
+  std::lock_guard<std::mutex> lock(mtx_);
+  dest.conn = std::move(pConn);
+  evictLeastRecent(poolSize_);
+  return true;
+}
+//----< closes dest's connection >-----------------------------------
 
-void Sender::stop()
+void Sender::closeConnection(Destination& dest)
 {
-  Message msg;
-  msg.name("quit");
-  msg.command("quit");
-  postMessage(msg);
-  connecter.shutDown();
+  std::lock_guard<std::mutex> lock(mtx_);
+  if (dest.conn)
+    dest.conn->connecter.shutDown();
+  dest.conn.reset();
+}
+//----< returns destination for ep, adding it if new >---------------
+/*
+*  - caller holds mtx_, as for release, evictIdle and evictLeastRecent
+*/
+Destination& Sender::destination(EndPoint ep)
+{
+  std::unique_ptr<Destination>& pDest = destinations_[ep.toString()];
+  if (!pDest)
+  {
+    pDest.reset(new Destination);
+    pDest->ep = ep;
+    pDest->lastUsed = std::chrono::steady_clock::now();
+  }
+  return *pDest;
+}
+//----< hands back a destination taken by a worker or connect >------
+/*
+*  - goes back on ready_ if more messages were posted meanwhile, or
+*    on waiting_, still busy, if it is backing off
+*  - removed if it has neither messages nor a connection
+*/
+void Sender::release(Destination& dest)
+{
+  releasedCv_.notify_all();
+  if (!dest.pending.empty() && dest.failures > 0)
+  {
+    waiting_.push_back(&dest);
+    readyCv_.notify_all();          // a waiting worker may need to wake sooner
+    return;
+  }
+  if (!dest.pending.empty())
+  {
+    ready_.push_back(&dest);
+    readyCv_.notify_one();
+    return;
+  }
+  dest.failures = 0;
+  dest.busy = false;
+  if (!dest.conn)
+    destinations_.erase(dest.ep.toString());
 }
-//----< attempts to connect to endpoint ep >-------------------------
+//----< closes idle connections unused for idleTimeout_ >------------
+/*
+*  - a destination that isn't busy has no messages, so goes with its
+*    connection
+*/
+void Sender::evictIdle()
+{
+  std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+  for (auto iter = destinations_.begin(); iter != destinations_.end(); )
+  {
+    Destination& dest = *iter->second;
+    if (dest.busy || now - dest.lastUsed < idleTimeout_)
+    {
+      ++iter;
+      continue;
+    }
+    StaticLogger<1>::write("\n  -- closing idle connection to " + iter->first);
+    if (dest.conn)
+      dest.conn->connecter.shutDown();
+    iter = destinations_.erase(iter);
+  }
+}
+//----< closes least recently used idle connections, keeping count >-
 
+void Sender::evictLeastRecent(size_t count)
+{
+  size_t open = 0;
+  for (auto& item : destinations_)
+  {
+    if (item.second->conn)
+      ++open;
+  }
+  while (open > count)
+  {
+    auto oldest = destinations_.end();
+    for (auto pos = destinations_.begin(); pos != destinations_.end(); ++pos)
+    {
+      if (pos->second->busy || !pos->second->conn)
+        continue;
+      if (oldest == destinations_.end() || pos->second->lastUsed < oldest->second->lastUsed)
+        oldest = pos;
+    }
+    if (oldest == destinations_.end())
+      return;                       // the rest are in use
+    oldest->second->conn->connecter.shutDown();
+    destinations_.erase(oldest);
+    --open;
+  }
+}
+//----< closes all idle connections >--------------------------------
+
+void Sender::closeAll()
+{
+  std::lock_guard<std::mutex> lock(mtx_);
+  for (auto iter = destinations_.begin(); iter != destinations_.end(); )
+  {
+    if (iter->second->busy)
+    {
+      ++iter;
+      continue;
+    }
+    if (iter->second->conn)
+      iter->second->conn->connecter.shutDown();
+    iter = destinations_.erase(iter);
+  }
+}
+//----< connects to endpoint ep, if not already connected >----------
+/*
+*  - waits while a worker is sending to ep
+*/
 bool Sender::connect(EndPoint ep)
 {
-  lastEP = ep;
-  return connecter.connect(ep.address, ep.port);
+  std::unique_lock<std::mutex> lock(mtx_);
+  Destination* pDest = nullptr;
+  releasedCv_.wait(lock, [&]() { pDest = &destination(ep); return !pDest->busy; });
+  pDest->busy = true;
+  lock.unlock();
+  bool connected = open(*pDest);
+  lock.lock();
+  pDest->lastUsed = std::chrono::steady_clock::now();
+  release(*pDest);
+  return connected;
+}
+//----< asks the receiver whether it reads binary frames >-----------
+/*
+*  - the hello is a text message, so any receiver can read it
+*  - returns false if the receiver didn't answer in time
+*/
+bool Sender::negotiate(SenderConnection& conn)
+{
+  Message hello;
+  hello.command(WireHello);
+  hello.attribute("wire", WireBinaryVersion);
+  std::string helloStr = hello.toString();
+  if (!conn.connecter.send(helloStr.length(), (Socket::byte*)helloStr.c_str()))
+    return false;
+  if (!conn.connecter.waitForData(WireHelloTimeout, 1))
+  {
+    StaticLogger<1>::write("\n  -- " + sndrName + " got no wire format answer, using text");
+    return false;
+  }
+  Message ack = Message::fromString(readMsgString(conn.connecter));
+  return ack.command() == WireAck && ack.value("wire") == WireBinaryVersion;
+}
+//----< sets the wire format asked for on later connections >--------
+
+void Sender::wireFormat(WireFormat preferred)
+{
+  preferred_ = preferred;
+}
+//----< returns the wire format of the last connection used >--------
+
+WireFormat Sender::wireFormat()
+{
+  return wire_;
+}
+//----< sets the number of send workers started by start() >--------
+
+void Sender::sendThreads(size_t count)
+{
+  std::lock_guard<std::mutex> lock(mtx_);
+  sendThreads_ = (count == 0) ? 1 : count;
+}
+//----< sets the most idle connections kept open >-------------------
+
+void Sender::poolSize(size_t maxConnections)
+{
+  std::lock_guard<std::mutex> lock(mtx_);
+  poolSize_ = (maxConnections == 0) ? 1 : maxConnections;
+  evictLeastRecent(poolSize_);
 }
-//----< posts message to send queue >--------------------------------
+//----< sets how long an unused connection is kept open >------------
 
-void Sender::postMessage(Message msg)
+void Sender::idleTimeout(size_t milliseconds)
 {
-  sndQ.enQ(msg);
+  std::lock_guard<std::mutex> lock(mtx_);
+  idleTimeout_ = std::chrono::milliseconds(milliseconds);
+}
+//----< returns the number of open connections >---------------------
+
+size_t Sender::connections()
+{
+  std::lock_guard<std::mutex> lock(mtx_);
+  size_t open = 0;
+  for (auto& item : destinations_)
+  {
+    if (item.second->conn)
+      ++open;
+  }
+  return open;
+}
+//----< bounds each destination's queue and sets what overflow does >
+
+void Sender::queueLimit(size_t maxMessages, OverflowPolicy policy)
+{
+  std::lock_guard<std::mutex> lock(mtx_);
+  queueLimit_ = (maxMessages == 0) ? 1 : maxMessages;
+  policy_ = policy;
+  roomCv_.notify_all();
+}
+//----< returns number of messages dropped or rejected >-------------
+
+size_t Sender::dropped()
+{
+  std::lock_guard<std::mutex> lock(mtx_);
+  return dropped_;
+}
+//----< posts message to its destination's queue >------------------
+/*
+*  - returns false if msg was dropped
+*/
+bool Sender::postMessage(Message msg)
+{
+  return post(msg, true);
+}
+//----< posts message unless that means waiting for room >-----------
+/*
+*  - a full queue drops msg even if policy_ is block
+*/
+bool Sender::tryPostMessage(Message msg)
+{
+  return post(msg, false);
+}
+//----< queues msg for its destination, applying policy_ if full >---
+/*
+*  - a "quit" message stops the Sender, as it stopped the send thread
+*  - messages posted after stop() are dropped
+*  - the destination is looked up again after waiting, as it may have
+*    been released and removed meanwhile
+*  - under block, msg is dropped if there is still no room after
+*    BlockTimeout
+*/
+bool Sender::post(Message& msg, bool mayWait)
+{
+  if (msg.command() == "quit")
+  {
+    stop();
+    return true;
+  }
+  std::chrono::steady_clock::time_point until = std::chrono::steady_clock::now() + std::chrono::milliseconds(BlockTimeout);
+  bool timedOut = false;
+  std::unique_lock<std::mutex> lock(mtx_);
+  while (true)
+  {
+    if (stopping_)
+    {
+      StaticLogger<1>::write("\n  -- " + sndrName + " stopped, dropping " + msg.name());
+      return false;
+    }
+    Destination& dest = destination(msg.to());
+    if (dest.pending.size() < queueLimit_)
+      break;
+    if (policy_ == OverflowPolicy::dropOldest)
+    {
+      dest.pending.pop_front();
+      ++dropped_;
+      break;
+    }
+    if (policy_ == OverflowPolicy::reject || !mayWait || timedOut)
+    {
+      StaticLogger<1>::write("\n  -- " + sndrName + " queue for " + dest.ep.toString() + " full, dropping " + msg.name());
+      ++dropped_;
+      return false;
+    }
+    timedOut = (roomCv_.wait_until(lock, until) == std::cv_status::timeout);
+  }
+  Destination& dest = destination(msg.to());
+  dest.pending.push_back(std::move(msg));
+  if (!dest.busy)
+  {
+    dest.busy = true;
+    ready_.push_back(&dest);
+    readyCv_.notify_one();
+  }
+  return true;
+}
+//----< sends message or file on conn, returning false if it fails >-
+
+bool Sender::send(SenderConnection& conn, Message& msg)
+{
+  if (msg.containsKey("file"))
+    return sendFile(conn, msg);
+  std::string msgStr = (conn.wire == WireFormat::binary) ? msg.toBinary(&conn.sendKeys) : msg.toString();
+  return conn.connecter.send(msgStr.length(), (Socket::byte*)msgStr.c_str());
 }
 //----< sends binary file >------------------------------------------
 /*
-*  - not implemented yet
+*  - on a binary connection each block is the body of a frame,
+*    otherwise a text message precedes each block
+*  - both end with a message with content-length 0
+*  - returns false only if sending fails; a file that can't be opened
+*    isn't sent
 */
-bool Sender::sendFile(Message msg)
+bool Sender::sendFile(SenderConnection& conn, Message msg)
 {
-  if (!msg.containsKey("file"))
-    return false;
   std::string fileSpec = sendFilePath + "/" + msg.file();
   std::ifstream sendFile(fileSpec, std::ios::binary);
   if (!sendFile.good())
-    return false;
-  while (true)
   {
-    sendFile.read(rwBuffer, BlockSize);
-    size_t blockSize = (size_t)sendFile.gcount();
-    msg.contentLength(blockSize);
-    std::string msgString = msg.toString();
-    connecter.sendString(msgString);
-    if (blockSize == 0)
-      break;
-    connecter.send(blockSize, rwBuffer);
+    StaticLogger<1>::write("\n  -- can't open " + fileSpec);
+    return true;
+  }
+  bool sent = true;
+  if (conn.wire == WireFormat::binary)
+  {
+    while (sent)
+    {
+      std::string block(BinaryBlockSize, '\0');
+      sendFile.read(&block[0], BinaryBlockSize);
+      size_t blockSize = (size_t)sendFile.gcount();
+      block.resize(blockSize);
+      msg.contentLength(blockSize);
+      msg.body(std::move(block));
+      std::string frame = msg.toBinary(&conn.sendKeys);
+      sent = conn.connecter.send(frame.length(), (Socket::byte*)frame.c_str());
+      if (blockSize == 0)
+        break;
+    }
+  }
+  else
+  {
+    Socket::byte block[BlockSize];
+    while (sent)
+    {
+      sendFile.read(block, BlockSize);
+      size_t blockSize = (size_t)sendFile.gcount();
+      msg.contentLength(blockSize);
+      sent = conn.connecter.sendString(msg.toString());
+      if (blockSize == 0 || !sent)
+        break;
+      sent = conn.connecter.send(blockSize, block);
+    }
   }
   sendFile.close();
-  return true;
+  return sent;
 }
 //----< callable object posts incoming message to rcvQ >-------------
 /*
 *  This is ClientHandler for receiving messages and posting
 *  to the receive queue.
 */
-class ClientHandler
+template<typename Queue>
+class BasicClientHandler
 {
 public:
-  //----< acquire reference to shared rcvQ >-------------------------
+  //----< acquire reference to receiver whose rcvQ is shared >-------
 
-  ClientHandler(BlockingQueue<Message>* pQ, const std::string& name = "clientHandler") : pQ_(pQ), clientHandlerName(name)
+  BasicClientHandler(BasicReceiver<Queue>* pRcvr, const std::string& name = "clientHandler") : pRcvr_(pRcvr), clientHandlerName(name)
   {
     StaticLogger<1>::write("\n  -- starting ClientHandler");
   }
   //----< shutdown message >-----------------------------------------
 
-  ~ClientHandler() 
+  ~BasicClientHandler() 
   { 
     StaticLogger<1>::write("\n  -- ClientHandler destroyed;"); 
   }
-  //----< set BlockingQueue >----------------------------------------
+  //----< set receiver >---------------------------------------------
 
-  void setQueue(BlockingQueue<Message>* pQ)
+  void setReceiver(BasicReceiver<Queue>* pRcvr)
   {
-    pQ_ = pQ;
+    pRcvr_ = pRcvr;
   }
-  //----< frame message string by reading bytes from socket >--------
+  //----< frame message string by reading lines from socket >--------
 
   std::string readMsg(Socket& socket)
   {
-    std::string temp, msgString;
+    return readMsgString(socket);
+  }
+  //----< read one binary frame from socket >------------------------
+  /*
+  *  - returns false if the connection closed or the frame is
+  *    malformed, after which the connection can't be read further
+  */
+  bool readFrame(Socket& socket, Message& msg)
+  {
+    Socket::byte header[BinaryFrame::HeaderSize];
+    if (!socket.readExact(BinaryFrame::HeaderSize, header))
+      return false;
+    size_t length = BinaryFrame::length(header);
+    if (length == 0)
+    {
+      StaticLogger<1>::write("\n  -- " + clientHandlerName + " read invalid frame header");
+      return false;
+    }
+    std::string payload(length, '\0');
+    if (!socket.readExact(length, &payload[0]))
+      return false;
+    try
+    {
+      msg = Message::fromBinary(payload.data(), length, &keys_);
+    }
+    catch (std::exception& ex)
+    {
+      StaticLogger<1>::write("\n  -- " + clientHandlerName + " " + ex.what());
+      return false;
+    }
+    return true;
+  }
+  //----< read next message in whichever format it arrives >---------
+  /*
+  *  - answers a wire format hello and reads on
+  *  - returns false when no more messages can be read
+  */
+  bool readMessage(Socket& socket, Message& msg, WireFormat& wire)
+  {
     while (socket.validState())
     {
-      temp = socket.recvString('\n');  // read attribute
-      msgString += temp;
-      if (temp.length() < 2)           // if empty line we are done
-        break;
+      Socket::byte first;
+      if (!socket.peek(first))
+        return false;
+      if (first == '\0')
+      {
+        socket.readExact(1, &first);   // terminator after a text file's last message
+        continue;
+      }
+      if ((unsigned char)first == BinaryFrame::Magic)
+      {
+        wire = WireFormat::binary;
+        return readFrame(socket, msg);
+      }
+      wire = WireFormat::text;
+      std::string msgString = readMsg(socket);
+      if (msgString.length() == 0)
+        return false;
+      msg = Message::fromString(msgString);
+      if (msg.command() != WireHello)
+        return true;
+      std::string ackStr = wireAck(msg);
+      socket.send(ackStr.length(), (Socket::byte*)ackStr.c_str());
     }
-    return msgString;
+    return false;
   }
   //----< receive file blocks >--------------------------------------
   /*
@@ -213,7 +814,7 @@ public:
   *  - expects to be connected to appropriate destination
   *  - these requirements are established in Sender::start()
   */
-  bool receiveFile(Message msg)
+  bool receiveFile(Message msg, WireFormat wire)
   {
     std::string fileName = msg.file();
     std::string fileSpec = saveFilePath + "/" + fileName;
@@ -227,10 +828,18 @@ public:
       size_t blockSize = msg.contentLength();
       if (blockSize == 0)
         break;
+      if (wire == WireFormat::binary)
+      {
+        saveStream.write(msg.body().data(), msg.body().size());
+        if (!readFrame(*pSocket, msg))
+          break;
+        continue;
+      }
       Socket::byte terminator;
-      pSocket->recv(1, &terminator);
-      pSocket->recv(blockSize, rwBuffer);
-      saveStream.write(rwBuffer, blockSize);
+      block_.resize(blockSize);
+      if (!pSocket->readExact(1, &terminator) || !pSocket->readExact(blockSize, block_.data()))
+        break;
+      saveStream.write(block_.data(), blockSize);
       std::string msgString = readMsg(*pSocket);
       if (msgString.length() == 0)
       {
@@ -242,48 +851,287 @@ public:
     }
     saveStream.flush();
     saveStream.close();
-    pQ_->enQ(msg);
+    pRcvr_->deliver(msg);
     return true;
   }
   //----< reads messages from socket and enQs in rcvQ >--------------
-
+  /*
+  *  - while the receiver waits for room in rcvQ, this connection
+  *    isn't read
+  */
   void operator()(Socket socket)
   {
     pSocket = &socket;
+    Message msg;
+    WireFormat wire;
     while (socket.validState())
     {
-      std::string msgString = readMsg(socket);
-      if (msgString.length() == 0)
+      if (!readMessage(socket, msg, wire))
       {
-        // invalid message
+        // connection closed or invalid message
         break;
       }
-      Message msg = Message::fromString(msgString);
       StaticLogger<1>::write("\n  -- " + clientHandlerName + " RecvThread read message: " + msg.name());
       //std::cout << "\n  -- " + clientHandlerName + " RecvThread read message: " + msg.name();
       if (msg.containsKey("file"))
       {
-        receiveFile(msg);
+        receiveFile(msg, wire);
+        msg.body(std::string());   // the first block is in the file
       }
-      pQ_->enQ(msg);
+      bool quit = (msg.command() == "quit");
+      pRcvr_->deliver(msg);
       //std::cout << "\n  -- message enqueued in rcvQ";
-      if (msg.command() == "quit")
+      if (quit)
         break;
     }
     StaticLogger<1>::write("\n  -- terminating ClientHandler thread");
   }
 private:
-  BlockingQueue<Message>* pQ_;
+  BasicReceiver<Queue>* pRcvr_;
   std::string clientHandlerName;
   Socket* pSocket = nullptr;
+  BinaryKeyTable keys_;                // copied, empty, for each connection
+  std::vector<Socket::byte> block_;    // file block being received
+};
+
+using ClientHandler = BasicClientHandler<BlockingQueue<Message>>;
+
+/////////////////////////////////////////////////////////////////////
+// ReactorClientHandler class
+// - does for one reactor connection what ClientHandler does for a
+//   Socket, but is handed bytes as they arrive, so keeps what it is
+//   part way through between calls: the file being received, and
+//   the size of a text file block still to come
+// - blocks of a file that can't be opened are read and dropped
+// - messages the receiver can't take yet are held, in order, and the
+//   connection paused until they are taken
+
+template<typename Queue>
+class ReactorClientHandler : public ConnectionHandler
+{
+public:
+  ReactorClientHandler(BasicReceiver<Queue>* pRcvr, const std::string& name) : pRcvr_(pRcvr), clientHandlerName(name) {}
+
+  //----< frames and handles every complete message received >-------
+  /*
+  *  - held messages go first; none is framed while any is left
+  */
+  void onData(ReactorConnection& connection)
+  {
+    while (!held_.empty())
+    {
+      bool quit = (held_.front().command() == "quit");
+      if (!pRcvr_->offer(held_.front()))
+      {
+        connection.pause();
+        return;
+      }
+      held_.pop_front();
+      if (quit)
+      {
+        connection.close();
+        return;
+      }
+    }
+    while (!connection.closing() && !connection.paused() && nextMessage(connection))
+      ;
+  }
+  //----< abandons a file left part way >----------------------------
+
+  void onClose(ReactorConnection&)
+  {
+    if (saveStream_.is_open())
+      saveStream_.close();
+    StaticLogger<1>::write("\n  -- " + clientHandlerName + " connection closed");
+  }
+private:
+  //----< handles the message at the front, false if incomplete >----
+
+  bool nextMessage(ReactorConnection& connection)
+  {
+    const char* pData = connection.data();
+    size_t size = connection.size();
+    if (size == 0)
+      return false;
+    if (pData[0] == '\0' && !blockPending_)
+    {
+      connection.consume(1);           // terminator after a text file's last message
+      return true;
+    }
+    if (blockPending_)
+    {
+      if (size < 1 + blockSize_)       // terminator and block
+        return false;
+      if (saveStream_.is_open())
+        saveStream_.write(pData + 1, blockSize_);
+      connection.consume(1 + blockSize_);
+      blockPending_ = false;
+      return true;
+    }
+    Message msg;
+    WireFormat wire;
+    if ((unsigned char)pData[0] == BinaryFrame::Magic)
+    {
+      if (size < BinaryFrame::HeaderSize)
+        return false;
+      size_t length = BinaryFrame::length(pData);
+      if (length == 0)
+      {
+        StaticLogger<1>::write("\n  -- " + clientHandlerName + " read invalid frame header");
+        connection.close();
+        return false;
+      }
+      if (size < BinaryFrame::HeaderSize + length)
+        return false;
+      try
+      {
+        msg = Message::fromBinary(pData + BinaryFrame::HeaderSize, length, &keys_);
+      }
+      catch (std::exception& ex)
+      {
+        StaticLogger<1>::write("\n  -- " + clientHandlerName + " " + ex.what());
+        connection.close();
+        return false;
+      }
+      connection.consume(BinaryFrame::HeaderSize + length);
+      wire = WireFormat::binary;
+    }
+    else
+    {
+      size_t length = textLength(pData, size);
+      if (length == 0)
+        return false;
+      msg = Message::fromString(std::string(pData, length));
+      connection.consume(length);
+      scanned_ = 0;
+      if (msg.command() == WireHello)
+      {
+        connection.send(wireAck(msg));
+        return true;
+      }
+      wire = WireFormat::text;
+    }
+    handle(connection, msg, wire);
+    return true;
+  }
+  //----< length of text message ending with an empty line, or 0 >---
+  /*
+  *  - remembers how far it looked, so a long message arriving in
+  *    pieces isn't scanned from its start each time
+  */
+  size_t textLength(const char* pData, size_t size)
+  {
+    if (pData[0] == '\n')
+      return 1;
+    size_t pos = (scanned_ > 0) ? scanned_ - 1 : 0;
+    while (pos < size)
+    {
+      const char* pFound = (const char*)memchr(pData + pos, '\n', size - pos);
+      if (pFound == nullptr)
+        break;
+      pos = pFound - pData + 1;
+      if (pos < size && pData[pos] == '\n')
+        return pos + 1;
+    }
+    scanned_ = size;
+    return 0;
+  }
+  //----< queues message, or takes it as part of a file >------------
+
+  void handle(ReactorConnection& connection, Message& msg, WireFormat wire)
+  {
+    StaticLogger<1>::write("\n  -- " + clientHandlerName + " reactor read message: " + msg.name());
+    if (!receiving_ && msg.containsKey("file"))
+    {
+      receiving_ = true;
+      firstMsg_ = msg;
+      firstMsg_.body(std::string());   // the first block goes to the file
+      saveStream_.open(saveFilePath + "/" + msg.file(), std::ios::binary);
+      if (!saveStream_.good())
+        saveStream_.close();
+    }
+    if (!receiving_)
+    {
+      queue(connection, msg);
+      return;
+    }
+    if (msg.contentLength() > 0)
+    {
+      if (wire == WireFormat::binary && saveStream_.is_open())
+        saveStream_.write(msg.body().data(), msg.body().size());
+      blockPending_ = (wire == WireFormat::text);
+      blockSize_ = msg.contentLength();
+      return;
+    }
+    // last message of a file, queued before the first, as ClientHandler does
+    if (saveStream_.is_open())
+      saveStream_.close();
+    receiving_ = false;
+    queue(connection, msg);
+    queue(connection, firstMsg_);
+  }
+  //----< offers msg to the receiver, holding it if there's no room >-
+  /*
+  *  - once a message is held, later ones are held behind it, so they
+  *    are queued in the order received
+  */
+  void queue(ReactorConnection& connection, Message& msg)
+  {
+    bool quit = (msg.command() == "quit");
+    if (!held_.empty() || !pRcvr_->offer(msg))
+    {
+      held_.push_back(std::move(msg));
+      connection.pause();
+      return;
+    }
+    if (quit)
+      connection.close();
+  }
+
+  BasicReceiver<Queue>* pRcvr_;
+  std::string clientHandlerName;
+  BinaryKeyTable keys_;
+  size_t scanned_ = 0;            // bytes of a partial text message looked at
+  bool receiving_ = false;        // a file is being received
+  Message firstMsg_;              // message that started it
+  std::ofstream saveStream_;
+  bool blockPending_ = false;     // a text file block is to come
+  size_t blockSize_ = 0;
+  std::deque<Message> held_;      // waiting for room in the receive queue
 };
 
-Comm::Comm(EndPoint ep, const std::string& name) : rcvr(ep, name), sndr(name), commName(name) {}
+//----< constructor answers messages rcvr rejects >-----------------
+/*
+*  - no answer to a busy reply, or to a message without a from address
+*/
+template<typename Queue>
+BasicComm<Queue>::BasicComm(EndPoint ep, const std::string& name) : sndr(name), rcvr(ep, name), commName(name)
+{
+  Sender* pSndr = &sndr;
+  rcvr.onReject([pSndr](Message& msg) {
+    if (msg.command() == BusyCommand || msg.from().address == "")
+      return;
+    Message busy(msg.from(), msg.to());
+    busy.command(BusyCommand);
+    busy.name(msg.name());
+    pSndr->tryPostMessage(busy);
+  });
+}
 
-void Comm::start()
+template<typename Queue>
+void BasicComm<Queue>::start()
 {
-  BlockingQueue<Message>* pQ = rcvr.queue();
-  ClientHandler* pCh = new ClientHandler(pQ, commName);
+  BasicReceiver<Queue>* pRcvr = &rcvr;
+  std::string name = commName;
+  SocketReactor::HandlerFactory factory = [pRcvr, name]() {
+    return std::unique_ptr<ConnectionHandler>(new ReactorClientHandler<Queue>(pRcvr, name));
+  };
+  if (ioThreads_ > 0 && rcvr.start(factory, ioThreads_))
+  {
+    sndr.start();
+    return;
+  }
+  BasicClientHandler<Queue>* pCh = new BasicClientHandler<Queue>(&rcvr, commName);
   /*
     There is a trivial memory leak here.  
     This ClientHandler is a prototype used to make ClientHandler copies for each connection.
@@ -297,27 +1145,84 @@ void Comm::start()
   sndr.start();
 }
 
-void Comm::stop()
+template<typename Queue>
+void BasicComm<Queue>::stop()
 {
   rcvr.stop();
   sndr.stop();
 }
 
-void Comm::postMessage(Message msg)
+template<typename Queue>
+void BasicComm<Queue>::postMessage(Message msg)
 {
   sndr.postMessage(msg);
 }
 
-Message Comm::getMessage()
+template<typename Queue>
+Message BasicComm<Queue>::getMessage()
 {
   return rcvr.getMessage();
 }
 
-std::string Comm::name()
+template<typename Queue>
+std::string BasicComm<Queue>::name()
 {
   return commName;
 }
 
+template<typename Queue>
+void BasicComm<Queue>::wireFormat(WireFormat preferred)
+{
+  sndr.wireFormat(preferred);
+}
+
+template<typename Queue>
+void BasicComm<Queue>::ioThreads(size_t count)
+{
+  ioThreads_ = count;
+}
+
+template<typename Queue>
+void BasicComm<Queue>::sendThreads(size_t count)
+{
+  sndr.sendThreads(count);
+}
+
+template<typename Queue>
+void BasicComm<Queue>::poolSize(size_t maxConnections)
+{
+  sndr.poolSize(maxConnections);
+}
+
+template<typename Queue>
+void BasicComm<Queue>::idleTimeout(size_t milliseconds)
+{
+  sndr.idleTimeout(milliseconds);
+}
+
+template<typename Queue>
+void BasicComm<Queue>::receiveLimit(size_t maxMessages, OverflowPolicy policy)
+{
+  rcvr.queueLimit(maxMessages, policy);
+}
+
+template<typename Queue>
+void BasicComm<Queue>::sendLimit(size_t maxMessages, OverflowPolicy policy)
+{
+  sndr.queueLimit(maxMessages, policy);
+}
+
+template<typename Queue>
+size_t BasicComm<Queue>::dropped()
+{
+  return rcvr.dropped() + sndr.dropped();
+}
+
+template class MsgPassingCommunication::BasicReceiver<BlockingQueue<Message>>;
+template class MsgPassingCommunication::BasicReceiver<MpmcQueue<Message>>;
+template class MsgPassingCommunication::BasicComm<BlockingQueue<Message>>;
+template class MsgPassingCommunication::BasicComm<MpmcQueue<Message>>;
+
 //----< test stub >--------------------------------------------------
 
 #ifdef TEST_COMM
@@ -334,23 +1239,21 @@ void DemoSndrRcvr(const std::string& machineName)
   ep1.port = 9091;
   ep1.address = "localhost";
   Receiver rcvr1(ep1);
-  BlockingQueue<Message>* pQ1 = rcvr1.queue();
 
-  ClientHandler ch1(pQ1);
+  ClientHandler ch1(&rcvr1);
   rcvr1.start(ch1);
 
   EndPoint ep2;
   ep2.port = 9092;
   ep2.address = "localhost";
   Receiver rcvr2(ep2);
-  BlockingQueue<Message>* pQ2 = rcvr2.queue();
 
-  ClientHandler ch2(pQ2);
+  ClientHandler ch2(&rcvr2);
   rcvr2.start(ch2);
 
   Sender sndr;
   sndr.start();
-  bool connected = sndr.connect(ep1);
+  sndr.connect(ep1);
   Message msg;
   msg.name("msg #1");
   msg.to(ep1);
@@ -402,7 +1305,7 @@ void DemoSndrRcvr(const std::string& machineName)
   StaticLogger<1>::flush();
 
   std::cout << "\n  press enter to quit DemoSndrRcvr";
-  _getche();
+  std::cin.get();
   std::cout << "\n";
 }
 
@@ -411,7 +1314,7 @@ void DemoSndrRcvr(const std::string& machineName)
 //           sending and receiving messages from two Comm
 //           instances.
 
-void DemoCommClass(const std::string& machineName)
+void DemoCommClass(const std::string&)
 {
   SUtils::title("Demonstrating Comm class");
 
@@ -478,7 +1381,7 @@ void DemoCommClass(const std::string& machineName)
   comm2.stop();
   StaticLogger<1>::flush();
   std::cout << "\n  press enter to quit DemoComm";
-  _getche();
+  std::cin.get();
 }
 /////////////////////////////////////////////////////////////////////
 // Test #3 - Demonstrate server with two concurrent clients
@@ -501,13 +1404,13 @@ void ThreadProcClnt1()
     comm.postMessage(msg);
     Message rply = comm.getMessage();
     std::cout << "\n  " + comm.name() + " received: " << rply.name();
-    ::Sleep(100);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
   }
   Message fileMsg(serverEP, clientEP);
   fileMsg.name("fileSender");
   fileMsg.file("logger.cpp");
   comm.postMessage(fileMsg);
-  ::Sleep(200);
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
 
   Message stop;
   stop.name("stop");
@@ -537,7 +1440,7 @@ void ThreadProcClnt2()
   fileMsg.name("fileSender");
   fileMsg.file("logger.h");
   comm.postMessage(fileMsg);
-  ::Sleep(200);
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
 }
 //----< server demonstrates two-way asynchronous communication >-----
 /*
@@ -591,7 +1494,83 @@ void DemoClientServer()
   comm.stop();
   StaticLogger<1>::flush();
   std::cout << "\n  press enter to quit DemoClientServer";
-  _getche();
+  std::cin.get();
+}
+
+/////////////////////////////////////////////////////////////////////
+// Test #4 - Demonstrates that a peer which never reads holds up
+//           only its own destination
+
+//----< posts to a stalled peer and a live one from one Sender >----
+/*
+*  - the stalled peer queues one message and is never asked for it,
+*    so its connection pauses and the Sender's sends to it back up
+*  - under the default reject policy, posts to it fail once its queue
+*    is full, and messages to the live peer keep arriving
+*/
+bool DemoNeverDrainingPeer()
+{
+  SUtils::title("Demonstrating a Sender with one peer that never reads");
+
+  SocketSystem ss;
+
+  EndPoint stalledEP("localhost", 9892);
+  EndPoint liveEP("localhost", 9893);
+  EndPoint senderEP("localhost", 9894);
+  Comm stalled(stalledEP, "stalledComm");
+  stalled.receiveLimit(1, OverflowPolicy::block);
+  stalled.start();
+  Comm live(liveEP, "liveComm");
+  live.start();
+
+  std::atomic<size_t> received{ 0 };
+  std::thread consumer([&live, &received]() {
+    while (live.getMessage().command() != "done")
+      ++received;
+  });
+
+  Sender sndr("stalledSender");
+  sndr.start();
+  const size_t MaxPosts = 2 * DefaultQueueLimit;
+  size_t posted = 0;
+  Message msg(stalledEP, senderEP);
+  msg.name("to stalled peer");
+  msg.body(std::string(4096, 'x'));
+  while (posted < MaxPosts && sndr.postMessage(msg))
+    ++posted;
+  std::cout << "\n  posted " << posted << " messages to the stalled peer, then it was rejected";
+
+  const size_t LiveMessages = 100;
+  std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < LiveMessages; ++i)
+  {
+    Message liveMsg(liveEP, senderEP);
+    liveMsg.name("to live peer #" + Utilities::Converter<size_t>::toString(i + 1));
+    sndr.postMessage(liveMsg);
+  }
+  std::chrono::steady_clock::time_point until = begin + std::chrono::seconds(5);
+  while (received.load() < LiveMessages && std::chrono::steady_clock::now() < until)
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - begin;
+  std::cout << "\n  live peer received " << received.load() << " of " << LiveMessages
+    << " messages in " << (size_t)elapsed.count() << " ms";
+
+  bool passed = (posted < MaxPosts && received.load() == LiveMessages);
+  std::cout << "\n  " << (passed ? "passed" : "failed") << ": the stalled peer "
+    << (passed ? "did not hold up" : "held up") << " the live one\n";
+
+  Sender closer("closer");
+  closer.start();
+  Message done(liveEP, senderEP);
+  done.command("done");
+  closer.postMessage(done);
+  consumer.join();
+  closer.stop();
+
+  stalled.stop();   // fails the send held up on the stalled connection
+  sndr.stop();
+  live.stop();
+  return passed;
 }
 
 Cosmetic cosmetic;
@@ -614,7 +1593,9 @@ int main()
   //DemoSndrRcvr("Odin");  // replace "Odin" with your machine name
   //DemoCommClass("Odin");
   DemoClientServer();
+  bool passed = DemoNeverDrainingPeer();
+  StaticLogger<1>::flush();
 
-  return 0;
+  return passed ? 0 : 1;
 }
 #endif
@@ -1,29 +1,147 @@
 #pragma once
 /////////////////////////////////////////////////////////////////////
 // Comm.h - message-passing communication facility                 //
-// ver 2.2                                                         //
+// ver 3.3                                                         //
 // Jim Fawcett, CSE687-OnLine Object Oriented Design, Fall 2017    //
 /////////////////////////////////////////////////////////////////////
 /*
 *  Package Operations:
 *  -------------------
 *  This package defines Sender and Receiver classes.
-*  - Sender uses a SocketConnecter and supports connecting to multiple
-*    sequential endpoints and posting messages.
-*  - Receiver uses a SocketListener which returns a Socket on connection.
+*  - Sender queues messages for each destination separately, and sends
+*    them with a few worker threads over a pool of connections, one
+*    SocketConnecter for each endpoint it has recently sent to.
+*  - Receiver uses a SocketListener which returns a Socket on connection,
+*    or, where SocketReactor is supported, a reactor that serves all of
+*    its connections with a few I/O threads.
 *  It also defines a Comm class
 *  - Comm simply composes a Sender and a Receiver, exposing methods:
 *    postMessage(Message) and getMessage()
+*  - the receive queue's type is a template parameter of BasicReceiver
+*    and BasicComm; Receiver and Comm use BlockingQueue, and
+*    BasicComm<MpmcQueue<Message>> the lock-free MpmcQueue.  Comm.cpp
+*    instantiates both.
+*  - Comm::ioThreads sets the number of reactor I/O threads before
+*    start(); 0 gives each connection its own ClientHandler thread, as
+*    on platforms without the reactor
+*
+*  Send queues and connection pool:
+*  --------------------------------
+*  postMessage puts a message on its destination's queue.  A worker
+*  takes a destination with messages waiting and sends up to MaxBatch
+*  of them, then moves on to the next; no other worker sends to that
+*  destination meanwhile, so each destination gets its messages in the
+*  order posted.  A slow or unreachable peer holds up only the worker
+*  sending to it, so replies to other clients go on as long as one of
+*  sendThreads workers is free.
+*  - a destination's connection is made the first time a worker sends
+*    there, and kept for later messages
+*  - a connection unused for idleTimeout milliseconds is closed, as are
+*    the least recently used ones beyond poolSize; connections in use
+*    are never closed, so more than poolSize may be open for a while
+*  - a connection the peer has closed while idle is replaced before
+*    use, and a message whose send fails is sent once more on a new
+*    connection
+*  - if a destination can't be reached, its messages stay queued and
+*    it is tried again after RetryDelay milliseconds, doubling after
+*    each failure; workers serve other destinations meanwhile.  After
+*    ConnectRetries failures in a row its queued messages are dropped.
+*  - stop() sends whatever was posted before it, then closes the
+*    connections; a message with command "quit" does the same
+*
+*  Queue limits and overflow:
+*  --------------------------
+*  The receive queue and each destination's send queue hold at most
+*  DefaultQueueLimit messages, or the limit set with receiveLimit and
+*  sendLimit, so a server that falls behind uses bounded memory.  What
+*  happens to one more message depends on the OverflowPolicy:
+*  - block: a Sender's postMessage waits for room, for at most
+*    BlockTimeout milliseconds before dropping the message.  A receiver
+*    stops reading the connection the message came on: ClientHandler
+*    threads wait to enQ it, and reactor connections are paused.  The
+*    peer's sends then back up over TCP, so its Sender slows to the pace
+*    the receiving application takes messages.
+*  - dropOldest: the oldest queued message is dropped to make room
+*  - reject: the new message is dropped.  A Comm answers a rejected
+*    message with one whose command is BusyCommand, sent to its from
+*    address, so the client can back off and try again later.
+*  Receivers block by default.  Senders reject by default, so a peer
+*  that stops reading fills only its own queue, and posts to other
+*  destinations go on at once.  Under block, each post to that peer
+*  would hold up the posting thread for BlockTimeout.
+*  Dropped messages are counted by dropped().  An MpmcQueue receive
+*  queue's limit is rounded up to a power of two, and must be set
+*  before start().
+*
+*  Wire formats:
+*  -------------
+*  Each connection carries either text messages or binary frames (see
+*  Message.h).  A Sender preferring binary, the default, sends a text
+*  message with command WireHello after connecting.  A receiver that
+*  reads binary frames answers on the same connection with WireAck and
+*  doesn't queue the hello.  If no answer arrives within
+*  WireHelloTimeout milliseconds the connection stays text, so older
+*  receivers still work, but will queue the hello message.
+*  - receivers accept both formats on any connection, telling them
+*    apart by the first byte of each message
+*  - each end keeps a BinaryKeyTable for the connection, so repeated
+*    keys and values are sent as a byte
+*  - binary frames send files in blocks of BinaryBlockSize bytes, each
+*    carried as the body of one frame
+*  - message bodies travel only in binary frames; a text connection
+*    sends the attributes alone
 *
 *  Required Files:
 *  ---------------
 *  Comm.h, Comm.cpp,
 *  Sockets.h, Sockets.cpp,
+*  SocketReactor.h, SocketReactor.cpp,
 *  Message.h, Message.cpp,
+*  Cpp11-BlockingQueue.h, MpmcQueue.h,
 *  Utilities.h, Utilities.cpp
 *
 *  Maintenance History:
 *  --------------------
+*  ver 3.3 : 19 Oct 2026
+*  - the test stub keeps no unused locals or parameter names
+*  ver 3.2 : 19 Oct 2026
+*  - Sender's default OverflowPolicy is reject, and under block
+*    postMessage gives up after BlockTimeout, so a peer that never
+*    reads can't hold up posts to other destinations for good
+*  - added DemoNeverDrainingPeer to the test stub
+*  - Sender's constants are static constexpr, as DefaultIdleTimeout
+*    and BlockTimeout are bound to references by std::chrono
+*  ver 3.1 : 19 Oct 2026
+*  - Sender backs off from a destination it can't connect to, and
+*    drops its messages after ConnectRetries failures, instead of
+*    retrying in a tight loop
+*  - BasicComm initializes sndr before rcvr, as they are declared
+*  ver 3.0 : 19 Oct 2026
+*  - builds on Linux, where Receiver serves connections with the epoll
+*    reactor; the test stub no longer needs conio.h or ::Sleep
+*  ver 2.9 : 19 Oct 2026
+*  - receive and send queues are bounded, with an OverflowPolicy for
+*    messages that don't fit
+*  ver 2.8 : 19 Oct 2026
+*  - Receiver and Comm take the receive queue type as a template
+*    parameter, as BasicReceiver and BasicComm
+*  ver 2.7 : 19 Oct 2026
+*  - Sender keeps a queue for each destination, drained by a pool of
+*    send threads, instead of a single sndQ and send thread
+*  ver 2.6 : 19 Oct 2026
+*  - Sender keeps a pool of connections keyed by endpoint, instead of
+*    reconnecting whenever the destination changes
+*  ver 2.5 : 19 Oct 2026
+*  - Receiver can serve its connections with a SocketReactor, framing
+*    messages with a ReactorClientHandler per connection
+*  - file blocks are read and written through per connection and per
+*    Sender buffers; the shared rwBuffer raced between concurrent
+*    uploads
+*  ver 2.4 : 19 Oct 2026
+*  - added binary wire format, negotiated by Sender for each connection
+*  ver 2.3 : 19 Oct 2026
+*  - ClientHandler reads message lines and file blocks through the
+*    Socket receive buffer instead of a byte at a time
 *  ver 2.2 : 27 Mar 2018
 *  - added interface IComm and object factory (static method in IComm)
 *  - Comm now implements the IComm interface
@@ -39,70 +157,201 @@
 
 #include "../Message/Message.h"
 #include "../Cpp11-BlockingQueue/Cpp11-BlockingQueue.h"
+#include "../MpmcQueue/MpmcQueue.h"
 #include "../Sockets/Sockets.h"
+#include "../SocketReactor/SocketReactor.h"
 #include "IComm.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <thread>
+#include <unordered_map>
+#include <vector>
 
 using namespace Sockets;
 
 namespace MsgPassingCommunication
 {
+  const std::string WireHello = "__wire-hello";
+  const std::string WireAck = "__wire-ack";
+  const std::string WireBinaryVersion = "binary/1";
+  const size_t WireHelloTimeout = 1000;
+  const size_t BinaryBlockSize = 64 * 1024;
+  const std::string BusyCommand = "busy";
+  const size_t DefaultQueueLimit = 8192;
+
+  ///////////////////////////////////////////////////////////////////
+  // OverflowPolicy - what a full queue does with one more message
+
+  enum class OverflowPolicy
+  {
+    block,        // wait for room, holding up the connection it came on
+    dropOldest,   // drop the oldest queued message
+    reject        // drop the new message, answering it with BusyCommand
+  };
+
   ///////////////////////////////////////////////////////////////////
-  // Receiver class
+  // BasicReceiver class
+  // - Queue is BlockingQueue<Message> or MpmcQueue<Message>
 
-  class Receiver
+  template<typename Queue>
+  class BasicReceiver
   {
   public:
-    Receiver(EndPoint ep, const std::string& name = "Receiver");
+    BasicReceiver(EndPoint ep, const std::string& name = "Receiver");
     template<typename CallableObject>
     void start(CallableObject& co);
+    bool start(SocketReactor::HandlerFactory factory, size_t ioThreads);
     void stop();
     Message getMessage();
-    BlockingQueue<Message>* queue();
+    Queue* queue();
+    void queueLimit(size_t maxMessages, OverflowPolicy policy);
+    void onReject(std::function<void(Message&)> handler);
+    bool offer(Message& msg);
+    void deliver(Message& msg);
+    size_t dropped();
   private:
-	  BlockingQueue<Message> rcvQ;
+	  Queue rcvQ;
+    OverflowPolicy policy_ = OverflowPolicy::block;
+    std::function<void(Message&)> onReject_;
+    std::atomic<size_t> dropped_{ 0 };
     SocketListener listener;
+    std::unique_ptr<SocketReactor> reactor_;
+    size_t port_;
     std::string rcvrName;
   };
 
+  using Receiver = BasicReceiver<BlockingQueue<Message>>;
+
+  ///////////////////////////////////////////////////////////////////
+  // SenderConnection - one pooled connection of a Sender
+
+  struct SenderConnection
+  {
+    SocketConnecter connecter;
+    WireFormat wire = WireFormat::text;
+    BinaryKeyTable sendKeys;
+  };
+
+  ///////////////////////////////////////////////////////////////////
+  // Destination - messages waiting for one endpoint, and its connection
+  // - busy while waiting for, or held by, a send worker; only that
+  //   worker uses conn, which is replaced only under the Sender's lock
+
+  struct Destination
+  {
+    EndPoint ep;
+    std::deque<Message> pending;
+    bool busy = false;
+    std::unique_ptr<SenderConnection> conn;
+    std::chrono::steady_clock::time_point lastUsed;
+    size_t failures = 0;                              // connects failed in a row
+    std::chrono::steady_clock::time_point retryAt;    // next connect, while failing
+  };
+
   ///////////////////////////////////////////////////////////////////
   // Sender class
 
   class Sender
   {
   public:
+    static constexpr size_t DefaultSendThreads = 4;
+    static constexpr size_t DefaultPoolSize = 64;
+    static constexpr size_t DefaultIdleTimeout = 60000;   // milliseconds
+    static constexpr size_t MaxBatch = 64;                // messages a worker takes at once
+    static constexpr size_t ConnectRetries = 5;           // failed connects before dropping
+    static constexpr size_t RetryDelay = 100;             // milliseconds, doubled each retry
+    static constexpr size_t BlockTimeout = 5000;          // milliseconds a post waits for room
+
     Sender(const std::string& name = "Sender");
     ~Sender();
     void start();
     void stop();
     bool connect(EndPoint ep);
-    void postMessage(Message msg);
+    bool postMessage(Message msg);
+    bool tryPostMessage(Message msg);
+    void wireFormat(WireFormat preferred);
+    WireFormat wireFormat();
+    void sendThreads(size_t count);
+    void poolSize(size_t maxConnections);
+    void idleTimeout(size_t milliseconds);
+    size_t connections();
+    void queueLimit(size_t maxMessages, OverflowPolicy policy);
+    size_t dropped();
   private:
-  	bool sendFile(Message msg);
-	  BlockingQueue<Message> sndQ;
-    SocketConnecter connecter;
-    std::thread sendThread;
-    EndPoint lastEP;
+    bool post(Message& msg, bool mayWait);
+    void work();
+    Destination* takeReady(std::unique_lock<std::mutex>& lock);
+    void backOff(Destination& dest, std::vector<Message>& batch, size_t sent);
+    void sendTo(Destination& dest, Message& msg);
+    bool open(Destination& dest);
+    void closeConnection(Destination& dest);
+    Destination& destination(EndPoint ep);
+    void release(Destination& dest);
+    void evictIdle();
+    void evictLeastRecent(size_t count);
+    void closeAll();
+    bool send(SenderConnection& conn, Message& msg);
+    bool sendFile(SenderConnection& conn, Message msg);
+    bool negotiate(SenderConnection& conn);
+    std::vector<std::thread> workers_;
     std::string sndrName;
+    WireFormat preferred_ = WireFormat::binary;
+    std::atomic<WireFormat> wire_{ WireFormat::text };    // of the last connection used
+    std::mutex mtx_;
+    std::condition_variable readyCv_;                       // a destination is ready
+    std::condition_variable releasedCv_;                    // a destination isn't busy
+    std::condition_variable roomCv_;                        // a destination's queue has room
+    std::deque<Destination*> ready_;
+    std::vector<Destination*> waiting_;                     // backing off until their retryAt
+    std::unordered_map<std::string, std::unique_ptr<Destination>> destinations_;   // by EndPoint::toString
+    bool stopping_ = false;
+    size_t running_ = 0;
+    size_t sendThreads_ = DefaultSendThreads;
+    size_t poolSize_ = DefaultPoolSize;
+    std::chrono::milliseconds idleTimeout_{ DefaultIdleTimeout };
+    size_t queueLimit_ = DefaultQueueLimit;                 // messages waiting per destination
+    OverflowPolicy policy_ = OverflowPolicy::reject;
+    size_t dropped_ = 0;
   };
 
-  class Comm : public IComm
+  ///////////////////////////////////////////////////////////////////
+  // BasicComm class
+  // - Queue is BlockingQueue<Message> or MpmcQueue<Message>
+
+  template<typename Queue>
+  class BasicComm : public IComm
   {
   public:
-    Comm(EndPoint ep, const std::string& name = "Comm");
+    BasicComm(EndPoint ep, const std::string& name = "Comm");
     void start();
     void stop();
     void postMessage(Message msg);
     Message getMessage();
     std::string name();
+    void wireFormat(WireFormat preferred);
+    void ioThreads(size_t count);
+    void sendThreads(size_t count);
+    void poolSize(size_t maxConnections);
+    void idleTimeout(size_t milliseconds);
+    void receiveLimit(size_t maxMessages, OverflowPolicy policy);
+    void sendLimit(size_t maxMessages, OverflowPolicy policy);
+    size_t dropped();
   private:
     Sender sndr;
-    Receiver rcvr;
+    BasicReceiver<Queue> rcvr;
     std::string commName;
+    size_t ioThreads_ = SocketReactor::supported() ? SocketReactor::DefaultIoThreads : 0;
     Sockets::SocketSystem socksys_;
   };
 
+  using Comm = BasicComm<BlockingQueue<Message>>;
+
   inline IComm* IComm::create(const std::string& machineAddress, size_t port)
   {
     std::cout << "\n  creating an instance of Comm on the native heap";
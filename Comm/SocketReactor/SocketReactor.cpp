@@ -0,0 +1,580 @@
+/////////////////////////////////////////////////////////////////////
+// SocketReactor.cpp - epoll reactor serving many connections      //
+// ver 1.3                                                         //
+// Language:    C++, Visual Studio 2017                            //
+// Application: Remote Code Repository, CSE687 - OOD               //
+// Author:      Ritesh Nair (rgnair@syr.edu)                       //
+/////////////////////////////////////////////////////////////////////
+
+#include "SocketReactor.h"
+#include <iostream>
+#include <chrono>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+
+#ifdef __linux__
+#include <cerrno>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+using namespace Sockets;
+
+std::atomic<size_t> SocketReactor::recvCalls_{ 0 };
+
+#ifdef __linux__
+
+/////////////////////////////////////////////////////////////////////
+// IoThread - an epoll set and the connections registered in it
+// - connections is touched only by the thread itself; accepted
+//   sockets are handed over through pending
+
+struct SocketReactor::IoThread
+{
+  struct Entry
+  {
+    std::unique_ptr<ReactorConnection> connection;
+    std::unique_ptr<ConnectionHandler> handler;
+  };
+
+  int epollFd = -1;
+  int wakeFd = -1;
+  std::thread thread;
+  std::mutex mutex;
+  std::vector<int> pending;
+  std::unordered_map<int, Entry> connections;
+  std::unordered_set<int> paused;
+  std::chrono::steady_clock::time_point nextRetry;
+  std::vector<char> scratch;
+
+  ~IoThread()
+  {
+    if (wakeFd >= 0)
+      ::close(wakeFd);
+    if (epollFd >= 0)
+      ::close(epollFd);
+  }
+  void wake()
+  {
+    uint64_t one = 1;
+    ssize_t written = ::write(wakeFd, &one, sizeof(one));
+    (void)written;
+  }
+};
+
+namespace
+{
+  //----< makes fd non-blocking >--------------------------------------
+
+  bool setNonBlocking(int fd)
+  {
+    int flags = ::fcntl(fd, F_GETFL, 0);
+    return flags >= 0 && ::fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+  }
+  //----< registers or re-registers fd with an epoll set >-------------
+
+  bool watch(int epollFd, int op, int fd, uint32_t events)
+  {
+    epoll_event event = {};
+    event.events = events;
+    event.data.fd = fd;
+    return ::epoll_ctl(epollFd, op, fd, &event) == 0;
+  }
+  //----< non-blocking listening socket, IPv6 with IPv4 mapped, or IPv4 >
+
+  int openListener(size_t port)
+  {
+    int on = 1, off = 0;
+    int fd = ::socket(AF_INET6, SOCK_STREAM, 0);
+    if (fd >= 0)
+    {
+      ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+      ::setsockopt(fd, IPPROTO_IPV6, IPV6_V6ONLY, &off, sizeof(off));
+      sockaddr_in6 addr = {};
+      addr.sin6_family = AF_INET6;
+      addr.sin6_addr = in6addr_any;
+      addr.sin6_port = htons((uint16_t)port);
+      if (::bind(fd, (sockaddr*)&addr, sizeof(addr)) != 0)
+      {
+        ::close(fd);
+        fd = -1;
+      }
+    }
+    if (fd < 0)
+    {
+      fd = ::socket(AF_INET, SOCK_STREAM, 0);
+      if (fd < 0)
+        return -1;
+      ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+      sockaddr_in addr = {};
+      addr.sin_family = AF_INET;
+      addr.sin_addr.s_addr = htonl(INADDR_ANY);
+      addr.sin_port = htons((uint16_t)port);
+      if (::bind(fd, (sockaddr*)&addr, sizeof(addr)) != 0)
+      {
+        ::close(fd);
+        return -1;
+      }
+    }
+    if (::listen(fd, SOMAXCONN) != 0 || !setNonBlocking(fd))
+    {
+      ::close(fd);
+      return -1;
+    }
+    return fd;
+  }
+}
+//----< removes bytes from the front of the receive buffer >---------
+
+void ReactorConnection::consume(size_t bytes)
+{
+  rcvHead_ += (bytes < size()) ? bytes : size();
+  if (rcvHead_ == rcvBuffer_.size())
+  {
+    rcvBuffer_.clear();
+    rcvHead_ = 0;
+  }
+}
+//----< sends bytes, keeping what the socket won't take yet >--------
+/*
+*  - returns false once the connection has failed or is closing
+*/
+bool ReactorConnection::send(const char* bytes, size_t count)
+{
+  if (closing_)
+    return false;
+  sndBuffer_.append(bytes, count);
+  return flush();
+}
+//----< writes buffered bytes until done or the socket is full >-----
+
+bool ReactorConnection::flush()
+{
+  size_t sent = 0;
+  while (sent < sndBuffer_.size())
+  {
+    ssize_t result = ::send(fd_, sndBuffer_.data() + sent, sndBuffer_.size() - sent, MSG_NOSIGNAL);
+    if (result > 0)
+    {
+      sent += (size_t)result;
+      continue;
+    }
+    if (result < 0 && errno == EINTR)
+      continue;
+    if (result < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+      break;
+    closing_ = true;
+    sndBuffer_.clear();
+    return false;
+  }
+  sndBuffer_.erase(0, sent);
+  writeWaiting_ = !sndBuffer_.empty();
+  watch();
+  return true;
+}
+//----< registers for reading unless paused, and writing if waiting >
+
+void ReactorConnection::watch()
+{
+  unsigned events = 0;
+  if (!paused_)
+    events |= EPOLLIN;
+  if (writeWaiting_)
+    events |= EPOLLOUT;
+  if (events == watched_)
+    return;
+  ::watch(epollFd_, EPOLL_CTL_MOD, fd_, events);
+  watched_ = events;
+}
+//----< reactor with ioThreads I/O threads, started by listen >------
+
+SocketReactor::SocketReactor(size_t ioThreads) : ioThreadCount_(ioThreads == 0 ? 1 : ioThreads) {}
+
+//----< stops I/O threads, closing all connections >-----------------
+
+SocketReactor::~SocketReactor()
+{
+  stop();
+}
+//----< epoll is Linux only >----------------------------------------
+
+bool SocketReactor::supported()
+{
+  return true;
+}
+//----< listens on port, serving connections with factory's handlers >
+/*
+*  - may be called once; returns false if the port can't be used
+*/
+bool SocketReactor::listen(size_t port, HandlerFactory factory)
+{
+  if (listenFd_ >= 0 || stopping_.load())
+    return false;
+  listenFd_ = openListener(port);
+  if (listenFd_ < 0)
+  {
+    std::cout << "\n  -- SocketReactor can't listen on port " << port;
+    return false;
+  }
+  factory_ = factory;
+
+  for (size_t i = 0; i < ioThreadCount_; ++i)
+  {
+    std::unique_ptr<IoThread> io(new IoThread);
+    io->epollFd = ::epoll_create1(0);
+    io->wakeFd = ::eventfd(0, EFD_NONBLOCK);
+    io->scratch.resize(ReadSize);
+    if (io->epollFd < 0 || io->wakeFd < 0 || !watch(io->epollFd, EPOLL_CTL_ADD, io->wakeFd, EPOLLIN))
+    {
+      stop();
+      return false;
+    }
+    io_.push_back(std::move(io));
+  }
+  watch(io_[0]->epollFd, EPOLL_CTL_ADD, listenFd_, EPOLLIN);
+  for (auto& io : io_)
+  {
+    IoThread* pIo = io.get();
+    io->thread = std::thread([this, pIo]() { run(*pIo); });
+  }
+  return true;
+}
+//----< stops listening and closes every connection >----------------
+
+void SocketReactor::stop()
+{
+  if (stopping_.exchange(true))
+    return;
+  for (auto& io : io_)
+    io->wake();
+  for (auto& io : io_)
+  {
+    if (io->thread.joinable())
+      io->thread.join();
+  }
+  if (listenFd_ >= 0)
+    ::close(listenFd_);
+  listenFd_ = -1;
+  for (auto& io : io_)
+  {
+    for (int fd : io->pending)
+      ::close(fd);
+  }
+  io_.clear();
+}
+//----< event loop of one I/O thread >-------------------------------
+
+void SocketReactor::run(IoThread& io)
+{
+  const int MaxEvents = 256;
+  epoll_event events[MaxEvents];
+  while (!stopping_.load())
+  {
+    int timeout = io.paused.empty() ? -1 : (int)PauseRetry;
+    int count = ::epoll_wait(io.epollFd, events, MaxEvents, timeout);
+    if (count < 0 && errno != EINTR)
+      break;
+    for (int i = 0; i < count && !stopping_.load(); ++i)
+    {
+      int fd = events[i].data.fd;
+      if (fd == io.wakeFd)
+      {
+        uint64_t ignored;
+        ssize_t bytes = ::read(io.wakeFd, &ignored, sizeof(ignored));
+        (void)bytes;
+        std::vector<int> adopted;
+        {
+          std::lock_guard<std::mutex> lock(io.mutex);
+          adopted.swap(io.pending);
+        }
+        for (int newFd : adopted)
+        {
+          IoThread::Entry& entry = io.connections[newFd];
+          entry.connection.reset(new ReactorConnection(newFd, ++nextId_, io.epollFd));
+          entry.handler = factory_();
+          entry.connection->watched_ = EPOLLIN;
+          if (!watch(io.epollFd, EPOLL_CTL_ADD, newFd, EPOLLIN))
+            closeConnection(io, *entry.connection);
+        }
+        continue;
+      }
+      if (fd == listenFd_)
+      {
+        accept();
+        continue;
+      }
+      auto iter = io.connections.find(fd);
+      if (iter == io.connections.end())
+        continue;
+      ReactorConnection& connection = *iter->second.connection;
+      if (events[i].events & EPOLLOUT)
+        connection.flush();
+      if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR))
+        read(io, connection);
+      if (connection.closing() && (connection.sndBuffer_.empty() || (events[i].events & (EPOLLHUP | EPOLLERR))))
+        closeConnection(io, connection);
+    }
+    if (!io.paused.empty() && std::chrono::steady_clock::now() >= io.nextRetry)
+      retryPaused(io);
+  }
+  while (!io.connections.empty())
+    closeConnection(io, *io.connections.begin()->second.connection);
+}
+//----< accepts waiting connections, handing them to I/O threads >---
+
+void SocketReactor::accept()
+{
+  while (true)
+  {
+    int fd = ::accept4(listenFd_, nullptr, nullptr, SOCK_NONBLOCK);
+    if (fd < 0)
+    {
+      if (errno == EINTR || errno == ECONNABORTED)
+        continue;
+      return;   // EAGAIN, or out of descriptors until some close
+    }
+    int on = 1;
+    ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+    ++connections_;
+    IoThread& target = *io_[nextThread_++ % io_.size()];
+    {
+      std::lock_guard<std::mutex> lock(target.mutex);
+      target.pending.push_back(fd);
+    }
+    target.wake();
+  }
+}
+//----< reads what has arrived and lets the handler frame it >-------
+/*
+*  - reads at most a few times before returning to epoll_wait, so
+*    one busy connection can't starve the others of its thread
+*/
+void SocketReactor::read(IoThread& io, ReactorConnection& connection)
+{
+  const size_t MaxReads = 4;
+  bool closed = false;
+  bool received = false;
+  for (size_t i = 0; i < MaxReads; ++i)
+  {
+    ssize_t result = ::recv(connection.fd_, io.scratch.data(), io.scratch.size(), 0);
+    ++recvCalls_;
+    if (result > 0)
+    {
+      if (connection.rcvHead_ > 0)
+      {
+        connection.rcvBuffer_.erase(0, connection.rcvHead_);
+        connection.rcvHead_ = 0;
+      }
+      connection.rcvBuffer_.append(io.scratch.data(), (size_t)result);
+      received = true;
+      if ((size_t)result < io.scratch.size())
+        break;
+      continue;
+    }
+    if (result < 0 && errno == EINTR)
+      continue;
+    if (result < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+      break;
+    closed = true;   // orderly shutdown by the peer, or a failure
+    break;
+  }
+  auto iter = io.connections.find(connection.fd_);
+  if (received && !connection.closing_)
+    handle(io, connection, *iter->second.handler);
+  if (connection.size() > MaxBuffered)
+  {
+    std::cout << "\n  -- SocketReactor closing connection " << connection.id_ << ", message too large";
+    connection.closing_ = true;
+  }
+  if (closed)
+  {
+    connection.closing_ = true;
+    connection.sndBuffer_.clear();
+  }
+}
+//----< lets the handler take what is buffered, noting if it pauses >
+
+void SocketReactor::handle(IoThread& io, ReactorConnection& connection, ConnectionHandler& handler)
+{
+  connection.paused_ = false;
+  handler.onData(connection);
+  if (connection.paused_)
+    io.paused.insert(connection.fd_);
+  else
+    io.paused.erase(connection.fd_);
+  connection.watch();
+}
+//----< offers paused connections' handlers their data again >-------
+/*
+*  - a handler still unable to take it pauses again, and is retried
+*    after another PauseRetry milliseconds
+*/
+void SocketReactor::retryPaused(IoThread& io)
+{
+  std::vector<int> fds(io.paused.begin(), io.paused.end());
+  for (int fd : fds)
+  {
+    auto iter = io.connections.find(fd);
+    if (iter == io.connections.end())
+      continue;
+    ReactorConnection& connection = *iter->second.connection;
+    handle(io, connection, *iter->second.handler);
+    if (connection.closing_ && connection.sndBuffer_.empty())
+      closeConnection(io, connection);
+  }
+  io.nextRetry = std::chrono::steady_clock::now() + std::chrono::milliseconds(PauseRetry);
+}
+//----< tells the handler, then closes and forgets the connection >--
+
+void SocketReactor::closeConnection(IoThread& io, ReactorConnection& connection)
+{
+  int fd = connection.fd_;
+  auto iter = io.connections.find(fd);
+  if (iter == io.connections.end())
+    return;
+  if (iter->second.handler)
+    iter->second.handler->onClose(connection);
+  ::epoll_ctl(io.epollFd, EPOLL_CTL_DEL, fd, nullptr);
+  ::close(fd);
+  io.paused.erase(fd);
+  io.connections.erase(iter);
+  --connections_;
+}
+
+#else
+
+/////////////////////////////////////////////////////////////////////
+// without epoll the reactor never starts; see supported()
+
+struct SocketReactor::IoThread {};
+
+void ReactorConnection::consume(size_t bytes) { rcvHead_ += bytes; }
+bool ReactorConnection::send(const char*, size_t) { return false; }
+bool ReactorConnection::flush() { return false; }
+void ReactorConnection::watch() {}
+SocketReactor::SocketReactor(size_t ioThreads) : ioThreadCount_(ioThreads == 0 ? 1 : ioThreads) {}
+SocketReactor::~SocketReactor() {}
+bool SocketReactor::supported() { return false; }
+bool SocketReactor::listen(size_t, HandlerFactory) { return false; }
+void SocketReactor::stop() {}
+void SocketReactor::run(IoThread&) {}
+void SocketReactor::accept() {}
+void SocketReactor::read(IoThread&, ReactorConnection&) {}
+void SocketReactor::handle(IoThread&, ReactorConnection&, ConnectionHandler&) {}
+void SocketReactor::retryPaused(IoThread&) {}
+void SocketReactor::closeConnection(IoThread&, ReactorConnection&) {}
+
+#endif
+
+//----< test stub >--------------------------------------------------
+
+#ifdef TEST_SOCKETREACTOR
+
+#ifdef __linux__
+#include <arpa/inet.h>
+#include <sys/resource.h>
+#include <chrono>
+#include <cstring>
+
+/////////////////////////////////////////////////////////////////////
+// LineEcho - echoes each line it receives
+
+class LineEcho : public ConnectionHandler
+{
+public:
+  void onData(ReactorConnection& connection)
+  {
+    while (true)
+    {
+      const char* pEnd = (const char*)memchr(connection.data(), '\n', connection.size());
+      if (pEnd == nullptr)
+        return;
+      size_t length = pEnd - connection.data() + 1;
+      connection.send(connection.data(), length);
+      connection.consume(length);
+    }
+  }
+};
+//----< blocking client: connects, sends a line, reads it back >-----
+
+bool echoClient(size_t port, const std::string& line, int& fd)
+{
+  fd = ::socket(AF_INET, SOCK_STREAM, 0);
+  sockaddr_in addr = {};
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons((uint16_t)port);
+  ::inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+  if (::connect(fd, (sockaddr*)&addr, sizeof(addr)) != 0)
+    return false;
+  if (::send(fd, line.data(), line.size(), MSG_NOSIGNAL) != (ssize_t)line.size())
+    return false;
+  std::string reply;
+  char buffer[256];
+  while (reply.size() < line.size())
+  {
+    ssize_t bytes = ::recv(fd, buffer, sizeof(buffer), 0);
+    if (bytes <= 0)
+      return false;
+    reply.append(buffer, (size_t)bytes);
+  }
+  return reply == line;
+}
+
+int main()
+{
+  std::cout << "\n  Testing SocketReactor";
+  std::cout << "\n =======================";
+
+  const size_t port = 9780;
+  const size_t clients = 2000;
+
+  rlimit limit;                      // each client uses two descriptors here
+  if (::getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max)
+  {
+    limit.rlim_cur = limit.rlim_max;
+    ::setrlimit(RLIMIT_NOFILE, &limit);
+  }
+  SocketReactor reactor(2);
+  if (!reactor.listen(port, []() { return std::unique_ptr<ConnectionHandler>(new LineEcho); }))
+  {
+    std::cout << "\n  can't listen\n\n";
+    return 1;
+  }
+  std::vector<int> fds(clients, -1);
+  size_t echoed = 0;
+  for (size_t i = 0; i < clients; ++i)
+  {
+    if (echoClient(port, "line from client #" + std::to_string(i) + "\n", fds[i]))
+      ++echoed;
+  }
+  std::cout << "\n  " << echoed << " of " << clients << " clients had their line echoed";
+  std::cout << "\n  " << reactor.connections() << " connections open, served by "
+    << reactor.ioThreads() << " I/O threads";
+
+  for (int fd : fds)
+    ::close(fd);
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (reactor.connections() > 0 && std::chrono::steady_clock::now() < deadline)
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  std::cout << "\n  " << reactor.connections() << " connections open after clients closed";
+  reactor.stop();
+  std::cout << "\n\n";
+  return (echoed == clients) ? 0 : 1;
+}
+
+#else
+
+int main()
+{
+  std::cout << "\n  SocketReactor needs epoll, which this platform lacks\n\n";
+  return 0;
+}
+
+#endif
+#endif
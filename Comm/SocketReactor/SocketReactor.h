@@ -0,0 +1,172 @@
+#ifndef SOCKETREACTOR_H
+#define SOCKETREACTOR_H
+/////////////////////////////////////////////////////////////////////
+// SocketReactor.h - epoll reactor serving many connections        //
+// ver 1.3                                                         //
+// Language:    C++, Visual Studio 2017                            //
+// Application: Remote Code Repository, CSE687 - OOD               //
+// Author:      Ritesh Nair (rgnair@syr.edu)                       //
+/////////////////////////////////////////////////////////////////////
+/*
+*  Package Operations:
+*  -------------------
+*  SocketListener starts a thread for every connection it accepts, so a
+*  server with thousands of clients runs thousands of threads.  This
+*  package provides the alternative, a reactor:
+*  - SocketReactor listens on a port and spreads accepted connections
+*    over a fixed number of I/O threads.  Each thread waits on all of
+*    its non-blocking sockets at once with epoll and reads whatever
+*    is ready.
+*  - every connection has its own receive and send buffers, and its
+*    own ConnectionHandler, made by the factory passed to listen()
+*  - a handler's onData is called, on its connection's I/O thread
+*    only, each time bytes arrive.  It consumes the complete messages
+*    at the front of the buffer and leaves any partial one for later.
+*  - ReactorConnection::send writes what the socket will take and
+*    keeps the rest until the socket is writable again
+*
+*  - a handler that can't take more, because the queue it feeds is
+*    full, calls pause() on its connection.  The reactor then stops
+*    reading from it, so the peer's sends back up through TCP, and
+*    calls onData again every PauseRetry milliseconds, with whatever
+*    is buffered, until the handler no longer pauses.
+*
+*  Handlers must not block for long, as every connection of their I/O
+*  thread waits meanwhile; complete messages are best handed on to a
+*  queue.
+*
+*  The reactor is built on epoll, so is only available on Linux;
+*  supported() says whether it is.  Elsewhere listen() fails and
+*  callers keep to SocketListener.
+*
+*  Required Files:
+*  ---------------
+*  SocketReactor.h, SocketReactor.cpp
+*
+*  Build Process:
+*  --------------
+*  Define TEST_SOCKETREACTOR to build the test stub.
+*
+*  Maintenance History:
+*  --------------------
+*  ver 1.3 : 19 Oct 2026
+*  - constants are static constexpr, so passing PauseRetry by
+*    reference, as std::chrono::milliseconds does, needs no definition
+*    in SocketReactor.cpp
+*  ver 1.2 : 19 Oct 2026
+*  - builds without -Wextra warnings: accept() no longer takes the
+*    unused I/O thread, and unused parameters are unnamed
+*  ver 1.1 : 19 Oct 2026
+*  - added ReactorConnection::pause, for flow control
+*  ver 1.0 : 19 Oct 2026
+*  - first release
+*/
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Sockets
+{
+  class SocketReactor;
+
+  /////////////////////////////////////////////////////////////////
+  // ReactorConnection - one accepted connection
+  // - used only on the I/O thread that owns it
+
+  class ReactorConnection
+  {
+  public:
+    ReactorConnection(const ReactorConnection&) = delete;
+    ReactorConnection& operator=(const ReactorConnection&) = delete;
+
+    const char* data() const { return rcvBuffer_.data() + rcvHead_; }
+    size_t size() const { return rcvBuffer_.size() - rcvHead_; }
+    void consume(size_t bytes);
+
+    bool send(const char* bytes, size_t count);
+    bool send(const std::string& str) { return send(str.data(), str.size()); }
+    void close() { closing_ = true; }
+    bool closing() const { return closing_; }
+    void pause() { paused_ = true; }            // until the next onData
+    bool paused() const { return paused_; }
+    size_t id() const { return id_; }
+
+  private:
+    friend class SocketReactor;
+    ReactorConnection(int fd, size_t id, int epollFd) : fd_(fd), id_(id), epollFd_(epollFd) {}
+    bool flush();
+    void watch();
+
+    int fd_;
+    size_t id_;
+    int epollFd_;
+    bool closing_ = false;
+    bool writeWaiting_ = false;     // wants to know when writable
+    bool paused_ = false;           // handler asked not to read
+    unsigned watched_ = 0;          // epoll events registered
+    std::string rcvBuffer_;         // unread bytes are from rcvHead_ on
+    size_t rcvHead_ = 0;
+    std::string sndBuffer_;         // bytes the socket hasn't taken yet
+  };
+
+  /////////////////////////////////////////////////////////////////
+  // ConnectionHandler - per connection state and message framing
+
+  struct ConnectionHandler
+  {
+    virtual ~ConnectionHandler() {}
+    virtual void onData(ReactorConnection& connection) = 0;
+    virtual void onClose(ReactorConnection&) {}
+  };
+
+  /////////////////////////////////////////////////////////////////
+  // SocketReactor class
+
+  class SocketReactor
+  {
+  public:
+    using HandlerFactory = std::function<std::unique_ptr<ConnectionHandler>()>;
+
+    static constexpr size_t DefaultIoThreads = 2;
+    static constexpr size_t ReadSize = 64 * 1024;             // bytes read per call
+    static constexpr size_t MaxBuffered = 64 * 1024 * 1024;   // per connection
+    static constexpr size_t PauseRetry = 5;                   // milliseconds
+
+    SocketReactor(size_t ioThreads = DefaultIoThreads);
+    SocketReactor(const SocketReactor&) = delete;
+    SocketReactor& operator=(const SocketReactor&) = delete;
+    ~SocketReactor();
+
+    bool listen(size_t port, HandlerFactory factory);
+    void stop();
+    size_t ioThreads() const { return ioThreadCount_; }
+    size_t connections() const { return connections_.load(); }
+
+    static bool supported();
+    static size_t recvCalls() { return recvCalls_.load(); }     // by all reactors, for benchmarks
+
+  private:
+    struct IoThread;
+    void run(IoThread& io);
+    void accept();
+    void read(IoThread& io, ReactorConnection& connection);
+    void handle(IoThread& io, ReactorConnection& connection, ConnectionHandler& handler);
+    void retryPaused(IoThread& io);
+    void closeConnection(IoThread& io, ReactorConnection& connection);
+
+    size_t ioThreadCount_;
+    std::vector<std::unique_ptr<IoThread>> io_;
+    HandlerFactory factory_;
+    int listenFd_ = -1;
+    size_t nextThread_ = 0;
+    std::atomic<size_t> nextId_{ 0 };
+    std::atomic<size_t> connections_{ 0 };
+    std::atomic<bool> stopping_{ false };
+    static std::atomic<size_t> recvCalls_;
+  };
+}
+#endif
@@ -1,6 +1,6 @@
 /////////////////////////////////////////////////////////////////////////
-// Sockets.cpp - C++ wrapper for Win32 socket api                      //
-// ver 5.2                                                             //
+// Sockets.cpp - C++ wrapper for Win32 and Berkeley socket apis       //
+// ver 5.7                                                             //
 // Jim Fawcett, CSE687 - Object Oriented Design, Spring 2016           //
 // CST 4-187, Syracuse University, 315 443-3948, jfawcett@twcny.rr.com //
 //---------------------------------------------------------------------//
@@ -18,8 +18,14 @@
 #include <memory>
 #include <functional>
 #include <exception>
+#include <cstring>
+#include <chrono>
 #include "../Utilities/Utilities.h"
 
+#ifndef _WIN32
+#include <csignal>
+#endif
+
 using namespace Sockets;
 using Util = Utilities::StringHelper;
 template<typename T>
@@ -31,29 +37,41 @@ using Show = StaticLogger<1>;
 
 //----< constructor starts up sockets by loading winsock lib >---------------
 
+/*
+*  - POSIX systems need no start up, but raise SIGPIPE on a send to a
+*    closed peer; it is ignored so the send fails instead
+*/
 SocketSystem::SocketSystem()
 {
+#ifdef _WIN32
   int iResult = WSAStartup(MAKEWORD(2, 2), &wsaData);
   if (iResult != 0) {
     Show::write("\n  WSAStartup failed with error = " + Conv<int>::toString(iResult));
   }
+#else
+  std::signal(SIGPIPE, SIG_IGN);
+#endif
 }
 //-----< destructor frees winsock lib >--------------------------------------
 
 SocketSystem::~SocketSystem()
 {
-  int error = WSACleanup();
+#ifdef _WIN32
+  WSACleanup();
+#endif
   Show::write("\n  -- Socket System cleaning up\n");
 }
 
 /////////////////////////////////////////////////////////////////////////////
 // Socket class members
 
+std::atomic<size_t> Socket::recvCalls_{ 0 };
+
 //----< constructor sets TCP protocol and Stream mode >----------------------
 
 Socket::Socket(IpVer ipver) : ipver_(ipver)
 {
-  ZeroMemory(&hints, sizeof(hints));
+  std::memset(&hints, 0, sizeof(hints));
   hints.ai_family = AF_UNSPEC;
   hints.ai_socktype = SOCK_STREAM;
   hints.ai_protocol = IPPROTO_TCP;
@@ -66,7 +84,7 @@ Socket::Socket(IpVer ipver) : ipver_(ipver)
 Socket::Socket(::SOCKET sock) : socket_(sock)
 {
   ipver_ = IP4;
-  ZeroMemory(&hints, sizeof(hints));
+  std::memset(&hints, 0, sizeof(hints));
   hints.ai_family = AF_UNSPEC;
   hints.ai_socktype = SOCK_STREAM;
   hints.ai_protocol = IPPROTO_TCP;
@@ -77,8 +95,9 @@ Socket::Socket(Socket&& s)
 {
   socket_ = s.socket_;
   s.socket_ = INVALID_SOCKET;
+  moveBuffer(s);
   ipver_ = s.ipver_;
-  ZeroMemory(&hints, sizeof(hints));
+  std::memset(&hints, 0, sizeof(hints));
   hints.ai_family = s.hints.ai_family;
   hints.ai_socktype = s.hints.ai_socktype;
   hints.ai_protocol = s.hints.ai_protocol;
@@ -90,12 +109,23 @@ Socket& Socket::operator=(Socket&& s)
   if (this == &s) return *this;
   socket_ = s.socket_;
   s.socket_ = INVALID_SOCKET;
+  moveBuffer(s);
   ipver_ = s.ipver_;
   hints.ai_family = s.hints.ai_family;
   hints.ai_socktype = s.hints.ai_socktype;
   hints.ai_protocol = s.hints.ai_protocol;
   return *this;
 }
+//----< take over unread bytes of a socket being moved >---------------------
+
+void Socket::moveBuffer(Socket& s)
+{
+  rcvBuffer_ = std::move(s.rcvBuffer_);
+  rcvHead_ = s.rcvHead_;
+  rcvTail_ = s.rcvTail_;
+  s.rcvBuffer_.clear();
+  s.rcvHead_ = s.rcvTail_ = 0;
+}
 //----< get, set IP version >------------------------------------------------
 /*
 *  Note: 
@@ -160,9 +190,10 @@ bool Socket::send(size_t bytes, byte* buffer)
   int blocks = 0;
   while (bytesLeft > 0)
   {
-    bytesSent = ::send(socket_, pBuf, bytesLeft, 0);
-    if (socket_ == INVALID_SOCKET || bytesSent == 0)
+    int result = (int)::send(socket_, pBuf, (int)bytesLeft, 0);
+    if (socket_ == INVALID_SOCKET || result == SOCKET_ERROR || result == 0)
       return false;
+    bytesSent = (size_t)result;
     bytesLeft -= bytesSent;
     pBuf += bytesSent;
     blocks++;
@@ -182,17 +213,7 @@ bool Socket::send(size_t bytes, byte* buffer)
 */
 bool Socket::recv(size_t bytes, byte* buffer)
 {
-  size_t bytesRecvd = 0, bytesLeft = bytes;
-  byte* pBuf = buffer;
-  while (bytesLeft > 0)
-  {
-    bytesRecvd = ::recv(socket_, pBuf, bytesLeft, 0);
-    if (socket_ == INVALID_SOCKET || bytesRecvd == 0)
-      return false;
-    bytesLeft -= bytesRecvd;
-    pBuf += bytesRecvd;
-  }
-  return true;
+  return readExact(bytes, buffer);
 }
 //----< sends a terminator terminated string >-------------------------------
 /*
@@ -202,12 +223,13 @@ bool Socket::recv(size_t bytes, byte* buffer)
 bool Socket::sendString(const std::string& str, byte terminator)
 {
   size_t bytesSent, bytesRemaining = str.size();
-  const byte* pBuf = &(*str.begin());
+  const byte* pBuf = str.data();
   while (bytesRemaining > 0)
   {
-    bytesSent = ::send(socket_, pBuf, bytesRemaining, 0);
-    if (bytesSent == INVALID_SOCKET || bytesSent == 0)
+    int result = (int)::send(socket_, pBuf, (int)bytesRemaining, 0);
+    if (result == SOCKET_ERROR || result == 0)
       return false;
+    bytesSent = (size_t)result;
     bytesRemaining -= bytesSent;
     pBuf += bytesSent;
   }
@@ -218,35 +240,119 @@ bool Socket::sendString(const std::string& str, byte terminator)
 /*
  * - Doesn't return until a terminator byte as been received.
  * - result includes terminator
- * ToDo:
- * - needs reads of one byte to be replaced by bulk reads into a
- *   stream buffer to improve efficiency.
- * - That will require building a circular buffer.
- * - performance seems acceptable, so won't do this now
  */
 std::string Socket::recvString(byte terminator)
 {
-  static const int buflen = 1;
-  char buffer[1];
+  return readUntil(terminator);
+}
+//----< one ::recv call, counted >-------------------------------------------
+
+int Socket::recvNative(byte* buffer, size_t bytes)
+{
+  ++recvCalls_;
+  return ::recv(socket_, buffer, (int)bytes, 0);
+}
+//----< read whatever the network has ready into the receive buffer >--------
+/*
+ * - unread bytes are moved to the front first, so the buffer is never
+ *   scanned across a wrap
+ * - returns number of bytes added, 0 if the connection closed or failed
+ */
+size_t Socket::fillBuffer()
+{
+  if (rcvBuffer_.empty())
+    rcvBuffer_.resize(RecvBufferSize);
+  if (rcvHead_ == rcvTail_)
+    rcvHead_ = rcvTail_ = 0;
+  else if (rcvHead_ > 0 && rcvTail_ == rcvBuffer_.size())
+  {
+    std::memmove(&rcvBuffer_[0], &rcvBuffer_[rcvHead_], rcvTail_ - rcvHead_);
+    rcvTail_ -= rcvHead_;
+    rcvHead_ = 0;
+  }
+  if (socket_ == INVALID_SOCKET)
+    return 0;
+  iResult = recvNative(&rcvBuffer_[rcvTail_], rcvBuffer_.size() - rcvTail_);
+  if (iResult <= 0)
+    return 0;
+  rcvTail_ += iResult;
+  return (size_t)iResult;
+}
+//----< receives bytes up to and including terminator >---------------------
+/*
+ * - returns what was read before the connection closed if no
+ *   terminator arrived, as recvString always has
+ */
+std::string Socket::readUntil(byte terminator)
+{
   std::string str;
-  bool first = true;
   while (true)
   {
-    iResult = ::recv(socket_, buffer, buflen, 0);
-    if (iResult == 0 || iResult == INVALID_SOCKET)
+    const byte* pStart = rcvBuffer_.data() + rcvHead_;
+    size_t available = rcvTail_ - rcvHead_;
+    const byte* pFound = (available > 0) ? (const byte*)std::memchr(pStart, terminator, available) : nullptr;
+    if (pFound != nullptr)
     {
-      //StaticLogger<1>::write("\n  -- invalid socket in Socket::recvString");
-      break;
-    }
-    if (buffer[0] == terminator)
-    {
-      // added 9/29/2017
-      str += terminator;
-      break;
+      size_t length = pFound - pStart + 1;
+      str.append(pStart, length);
+      rcvHead_ += length;
+      return str;
     }
-    str += buffer[0];
+    str.append(pStart, available);
+    rcvHead_ = rcvTail_;
+    if (fillBuffer() == 0)
+      return str;
   }
-  return str;
+}
+//----< receives exactly bytes bytes >---------------------------------------
+/*
+ * - buffered bytes are used first; a remainder larger than the receive
+ *   buffer goes straight into the caller's buffer
+ * - returns false if the connection closed first
+ */
+bool Socket::readExact(size_t bytes, byte* buffer)
+{
+  size_t fromBuffer = (std::min)(bytes, bytesBuffered());
+  if (fromBuffer > 0)
+  {
+    std::memcpy(buffer, &rcvBuffer_[rcvHead_], fromBuffer);
+    rcvHead_ += fromBuffer;
+    buffer += fromBuffer;
+    bytes -= fromBuffer;
+  }
+  while (bytes >= RecvBufferSize)
+  {
+    if (socket_ == INVALID_SOCKET)
+      return false;
+    iResult = recvNative(buffer, bytes);
+    if (iResult <= 0)
+      return false;
+    buffer += iResult;
+    bytes -= iResult;
+  }
+  while (bytes > 0)
+  {
+    if (fillBuffer() == 0)
+      return false;
+    size_t chunk = (std::min)(bytes, bytesBuffered());
+    std::memcpy(buffer, &rcvBuffer_[rcvHead_], chunk);
+    rcvHead_ += chunk;
+    buffer += chunk;
+    bytes -= chunk;
+  }
+  return true;
+}
+//----< returns the next byte without consuming it >-------------------------
+/*
+ * - waits for it if nothing is buffered
+ * - returns false if the connection closed first
+ */
+bool Socket::peek(byte& next)
+{
+  if (bytesBuffered() == 0 && fillBuffer() == 0)
+    return false;
+  next = rcvBuffer_[rcvHead_];
+  return true;
 }
 //----< strips terminator character that recvString includes >---------------
 
@@ -268,26 +374,52 @@ size_t Socket::sendStream(size_t bytes, byte* pBuf)
 */
 size_t Socket::recvStream(size_t bytes, byte* pBuf)
 {
-  return ::recv(socket_, pBuf, bytes, 0);
+  if (bytesBuffered() > 0)
+  {
+    size_t chunk = (std::min)(bytes, bytesBuffered());
+    std::memcpy(pBuf, &rcvBuffer_[rcvHead_], chunk);
+    rcvHead_ += chunk;
+    return chunk;
+  }
+  return recvNative(pBuf, bytes);
 }
 //----< returns bytes available in recv buffer >-----------------------------
 
 size_t Socket::bytesWaiting()
 {
-  unsigned long int ret;
+  unsigned long int ret = 0;
   ::ioctlsocket(socket_, FIONREAD, &ret);
-  return (size_t)ret;
+  return bytesBuffered() + (size_t)ret;
+}
+//----< does the peer appear to have closed or reset the connection? >------
+/*
+*  - doesn't block; unread data, buffered or not, means not closed
+*/
+bool Socket::peerClosed()
+{
+  if (socket_ == INVALID_SOCKET)
+    return true;
+  if (bytesBuffered() > 0)
+    return false;
+  fd_set readSet;
+  FD_ZERO(&readSet);
+  FD_SET(socket_, &readSet);
+  timeval noWait = { 0, 0 };
+  if (::select((int)socket_ + 1, &readSet, NULL, NULL, &noWait) <= 0)
+    return false;
+  char next;
+  return ::recv(socket_, &next, 1, MSG_PEEK) <= 0;
 }
 //----< waits for server data, checking every timeToCheck millisec >---------
 
 bool Socket::waitForData(size_t timeToWait, size_t timeToCheck)
 {
   size_t MaxCount = timeToWait / timeToCheck;
-  static size_t count = 0;
+  size_t count = 0;
   while (bytesWaiting() == 0)
   {
     if (++count < MaxCount)
-      ::Sleep(timeToCheck);
+      std::this_thread::sleep_for(std::chrono::milliseconds(timeToCheck));
     else
       return false;
   }
@@ -308,6 +440,7 @@ SocketConnecter::SocketConnecter(SocketConnecter&& s) : Socket()
 {
   socket_ = s.socket_;
   s.socket_ = INVALID_SOCKET;
+  moveBuffer(s);
   ipver_ = s.ipver_;
   hints.ai_family = s.hints.ai_family;
   hints.ai_socktype = s.hints.ai_socktype;
@@ -320,6 +453,7 @@ SocketConnecter& SocketConnecter::operator=(SocketConnecter&& s)
   if (this == &s) return *this;
   socket_ = s.socket_;
   s.socket_ = INVALID_SOCKET;
+  moveBuffer(s);
   ipver_ = s.ipver_;
   hints.ai_family = s.hints.ai_family;
   hints.ai_socktype = s.hints.ai_socktype;
@@ -347,29 +481,28 @@ bool SocketConnecter::connect(const std::string& ip, size_t port)
     return false;
   }
 
+  discardBuffered();  // unread bytes belong to the last connection
+
   // Attempt to connect to an address until one succeeds
   for (ptr = result; ptr != NULL; ptr = ptr->ai_next) {
 
     char ipstr[INET6_ADDRSTRLEN];
     void *addr;
-    char *ipver;
 
     // get pointer to address - different fields in IPv4 and IPv6:
 
     if (ptr->ai_family == AF_INET) { // IPv4
       struct sockaddr_in *ipv4 = (struct sockaddr_in *)ptr->ai_addr;
       addr = &(ipv4->sin_addr);
-      ipver = "IPv4";
     }
     else { // IPv6
       struct sockaddr_in6 *ipv6 = (struct sockaddr_in6 *)ptr->ai_addr;
       addr = &(ipv6->sin6_addr);
-      ipver = "IPv6";
     }
 
     // convert the IP to a string and print it:
     inet_ntop(ptr->ai_family, addr, ipstr, sizeof ipstr);
-    //printf("\n  %s: %s", ipver, ipstr);
+    //printf("\n  %s", ipstr);
 
     // Create a SOCKET for connecting to server
     socket_ = socket(ptr->ai_family, ptr->ai_socktype, ptr->ai_protocol);
@@ -406,7 +539,7 @@ bool SocketConnecter::connect(const std::string& ip, size_t port)
 SocketListener::SocketListener(size_t port, IpVer ipv) : Socket(ipv), port_(port)
 {
   socket_ = INVALID_SOCKET;
-  ZeroMemory(&hints, sizeof(hints));
+  std::memset(&hints, 0, sizeof(hints));
   if (ipv == Socket::IP6)
     hints.ai_family = AF_INET6;       // use this if you want an IP6 address
   else
@@ -550,7 +683,7 @@ void SocketListener::stop()
 class ClientHandler
 {
 public:
-  void operator()(Socket& socket_);
+  void operator()(Socket socket_);
   bool testStringHandling(Socket& socket_);
   bool testBufferHandling(Socket& socket_);
 };
@@ -563,7 +696,7 @@ void clearBuffer(Socket::byte* buffer, size_t BufLen)
     buffer[i] = '\0';
 }
 
-void ClientHandler::operator()(Socket& socket_)
+void ClientHandler::operator()(Socket socket_)
 {
   while (true)
   {
@@ -698,7 +831,7 @@ bool ClientHandler::testBufferHandling(Socket& socket_)
     }
   }
   Show::write("\n  End of buffer handling test in ClientHandler");
-  ::Sleep(4000);
+  std::this_thread::sleep_for(std::chrono::seconds(4));
   return true;
 }
 
@@ -802,7 +935,7 @@ void clientTestBufferHandling(Socket& si)
 }
 //----< demonstration >------------------------------------------------------
 
-int main(int argc, char* argv[])
+int main(int, char*[])
 {
   Show::attach(&std::cout);
   Show::start();
@@ -819,7 +952,7 @@ int main(int argc, char* argv[])
     while (!si.connect("localhost", 9070))
     {
       Show::write("\n  client waiting to connect");
-      ::Sleep(100);
+      std::this_thread::sleep_for(std::chrono::milliseconds(100));
     }
 
     Show::title("Starting string test on client");
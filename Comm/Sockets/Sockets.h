@@ -1,8 +1,8 @@
 #ifndef SOCKETS_H
 #define SOCKETS_H
 /////////////////////////////////////////////////////////////////////////
-// Sockets.h - C++ wrapper for Win32 socket api                        //
-// ver 5.2                                                             //
+// Sockets.h - C++ wrapper for Win32 and Berkeley socket apis         //
+// ver 5.7                                                             //
 // Jim Fawcett, CSE687 - Object Oriented Design, Spring 2016           //
 // CST 4-187, Syracuse University, 315 443-3948, jfawcett@twcny.rr.com //
 //---------------------------------------------------------------------//
@@ -15,11 +15,16 @@
 /*
 *  Package Operations:
 *  -------------------
-*  Provides four classes that wrap the Winsock API:
+*  Provides four classes that wrap the Winsock API, or Berkeley sockets
+*  on Linux and other POSIX systems:
 *  Socket:
 *  - provides all the functionality necessary to handle server clients
 *  - created by SocketListener after accepting a request
 *  - usually passed to a client handling thread
+*  - reads are served from a receive buffer owned by the socket, which
+*    is refilled with as much as the network has ready in one recv, so
+*    readLine, readUntil and readExact cost about one system call per
+*    buffer full, not one per byte
 *  SocketConnecter:
 *  - adds the ability to connect to a server
 *  SocketListener:
@@ -27,7 +32,9 @@
 *  - instances of this class are the only ones influenced by ipVer().
 *    clients will use whatever protocol the server provides.
 *  SocketSystem:
-*  - Loads and unloads winsock2 library.  
+*  - Loads and unloads winsock2 library.  On POSIX systems it instead
+*    ignores SIGPIPE, so a send to a closed peer fails rather than
+*    ending the process.
 *  - Declared once at beginning of execution
 *
 *  Required Files:
@@ -39,6 +46,25 @@
 *
 *  Maintenance History:
 *  --------------------
+*  ver 5.7 : 19 Oct 2026
+*  - connect no longer sets an ipver it never reads, and the test
+*    stub leaves main's unused parameters unnamed
+*  ver 5.6 : 19 Oct 2026
+*  - builds on Linux: Winsock headers are included only on Windows,
+*    elsewhere the few Winsock names used map to Berkeley sockets
+*  - send and sendString stop on a failed ::send; its -1 result was
+*    taken as a byte count
+*  ver 5.5 : 19 Oct 2026
+*  - added peerClosed, used by Comm's Sender before reusing a pooled
+*    connection
+*  ver 5.4 : 19 Oct 2026
+*  - added peek, used by Comm to tell binary frames from text messages
+*  - waitForData's check count was static, so it stopped waiting
+*    altogether after enough calls; it is now counted per call
+*  ver 5.3 : 19 Oct 2026
+*  - added a receive buffer to Socket with readLine, readUntil and
+*    readExact; recvString, recv and recvStream now read through it
+*  - added recvCalls() which counts ::recv calls, for benchmarks
 *  ver 5.2 : 05 Oct 2017
 *  - changed Socket::recvString to append the terminating character, 
 *    newline by default
@@ -105,10 +131,6 @@
 /*
 * ToDo:
 * - make SocketSystem a reference counted instance of Socket
-* - write buffered recv which efficiently returns string or line
-*   - reads and concatenates everything available into circular buffer
-*   - parses out first string or line and moves start of buffer pointer
-*     to begining of next
 * -----------------------------------------------------------------------
 *  Wait for The next items until Students have submitted their code
 * -----------------------------------------------------------------------
@@ -117,6 +139,8 @@
 * - Test and Display packages
 */
 
+#ifdef _WIN32
+
 #ifndef WIN32_LEAN_AND_MEAN  // prevents duplicate includes of core parts of windows.h in winsock2.h
 #define WIN32_LEAN_AND_MEAN
 #endif
@@ -126,17 +150,54 @@
 #include <WS2tcpip.h>     // support for IPv6 and other things
 #include <IPHlpApi.h>     // ip helpers
 
+#pragma warning(disable:4522)
+#pragma comment(lib, "Ws2_32.lib")
+
+#else
+
+#include <sys/types.h>    // Berkeley sockets
+#include <sys/socket.h>
+#include <sys/ioctl.h>
+#include <sys/select.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <unistd.h>
+#include <cerrno>
+
+/////////////////////////////////////////////////////////////////////////////
+// the few Winsock names this package uses, mapped to Berkeley sockets
+
+using SOCKET = int;
+const SOCKET INVALID_SOCKET = -1;
+const int SOCKET_ERROR = -1;
+const int SD_RECEIVE = SHUT_RD;
+const int SD_SEND = SHUT_WR;
+const int SD_BOTH = SHUT_RDWR;
+struct WSADATA {};
+
+inline int closesocket(SOCKET sock) { return ::close(sock); }
+inline int WSAGetLastError() { return errno; }
+
+inline int ioctlsocket(SOCKET sock, unsigned long request, unsigned long* arg)
+{
+  int value = 0;
+  int result = ::ioctl(sock, request, &value);
+  *arg = (unsigned long)value;
+  return result;
+}
+
+#endif
+
 #include <vector>
 #include <string>
 #include <atomic>
+#include <thread>
 
 #include "../WindowsHelpers/WindowsHelpers.h"
 #include "../Utilities/Utilities.h"
 #include "../Logger/Logger.h"
 
-#pragma warning(disable:4522)
-#pragma comment(lib, "Ws2_32.lib")
-
 namespace Sockets
 {
   /////////////////////////////////////////////////////////////////////////////
@@ -182,7 +243,18 @@ namespace Sockets
     bool sendString(const std::string& str, byte terminator = '\0');
     std::string recvString(byte terminator = '\0');
     static std::string removeTerminator(const std::string& src);
+
+    // buffered reads; strings include the terminator, and are cut
+    // short only if the connection closes
+    std::string readUntil(byte terminator);
+    std::string readLine() { return readUntil('\n'); }
+    bool readExact(size_t bytes, byte* buffer);
+    bool peek(byte& next);
+    size_t bytesBuffered() const { return rcvTail_ - rcvHead_; }
+    static size_t recvCalls() { return recvCalls_.load(); }
+
     size_t bytesWaiting();
+    bool peerClosed();
     bool waitForData(size_t timeToWait, size_t timeToCheck);
     bool shutDownSend();
     bool shutDownRecv();
@@ -191,12 +263,26 @@ namespace Sockets
 
     bool validState() { return socket_ != INVALID_SOCKET; }
 
+    static const size_t RecvBufferSize = 16 * 1024;
+
   protected:
     WSADATA wsaData;
     ::SOCKET socket_;
     struct addrinfo *result = NULL, *ptr = NULL, hints;
     int iResult;
     IpVer ipver_ = IP4;
+
+    void moveBuffer(Socket& s);
+    void discardBuffered() { rcvHead_ = rcvTail_ = 0; }
+
+  private:
+    size_t fillBuffer();
+    int recvNative(byte* buffer, size_t bytes);
+
+    std::vector<byte> rcvBuffer_;    // unread bytes are [rcvHead_, rcvTail_)
+    size_t rcvHead_ = 0;
+    size_t rcvTail_ = 0;
+    static std::atomic<size_t> recvCalls_;
   };
 
   /////////////////////////////////////////////////////////////////////////////
@@ -1,6 +1,6 @@
 ///////////////////////////////////////////////////////////////////////
 // WindowsHelper.cpp - small helper functions for using Windows API  //
-// ver 1.0                                                           //
+// ver 1.1                                                           //
 //-------------------------------------------------------------------//
 // Jim Fawcett (c) copyright 2015                                    //
 // All rights granted provided this copyright notice is retained     //
@@ -11,17 +11,27 @@
 //              jfawcett@twcny.rr.com                                //
 ///////////////////////////////////////////////////////////////////////
 
+#ifdef _WIN32
+
 #define WIN32_LEAN_AND_MEAN
 
 #include <Windows.h>
-#include <string>
 #include <winsock2.h>
+
+#pragma comment(lib, "Ws2_32.lib")
+
+#else
+
+#include <cerrno>
+#include <cstring>
+
+#endif
+
+#include <string>
 #include "WindowsHelpers.h"
 
 using namespace WindowsHelpers;
 
-#pragma comment(lib, "Ws2_32.lib")
-
 std::string WindowsHelpers::wstringToString(const std::wstring& wstr)
 {
   std::string rtn;
@@ -42,6 +52,8 @@ std::wstring WindowsHelpers::stringToWideString(const std::string& str)
 
 //----< get socket error message string >----------------------------
 
+#ifdef _WIN32
+
 std::string WindowsHelpers::GetLastMsg(bool WantSocketMsg) {
 
   // ask system what type of error occurred
@@ -75,6 +87,19 @@ std::string WindowsHelpers::GetLastMsg(bool WantSocketMsg) {
   return _msg;
 }
 
+#else
+
+// sockets and the rest of the system both report errors in errno
+
+std::string WindowsHelpers::GetLastMsg(bool) {
+  int errorCode = errno;
+  if (errorCode == 0)
+    return "no error";
+  return std::strerror(errorCode);
+}
+
+#endif
+
 #ifdef TEST_WINDOWSHELPERS
 
 int main()
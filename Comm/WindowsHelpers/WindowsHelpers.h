@@ -2,7 +2,7 @@
 #define WINDOWSHELPERS_H
 /////////////////////////////////////////////////////////////////////
 // WindowsHelper.h - small helper functions for using Windows API  //
-// ver 1.0                                                         //
+// ver 1.1                                                         //
 //-----------------------------------------------------------------//
 // Jim Fawcett (c) copyright 2015                                  //
 // All rights granted provided this copyright notice is retained   //
@@ -27,6 +27,8 @@
 *
 * Maintenance History:
 * --------------------
+* ver 1.1 : 19 Oct 2026
+* - builds on POSIX systems, where GetLastMsg describes errno
 * ver 1.0 : 22 Feb 2016
 * - first release
 *
@@ -0,0 +1,418 @@
+///////////////////////////////////////////////////////////////////////
+// Benchmarks.cpp - Throughput and latency benchmarks for NoSqlDb    //
+// ver 2.3                                                           //
+// Language:    C++, Visual Studio 2017                              //
+// Application: NoSqlDb, CSE687 - Object Oriented Design             //
+// Author:      Ritesh Nair (rgnair@syr.edu)                         //
+///////////////////////////////////////////////////////////////////////
+
+/*
+* Maintenance History:
+* --------------------
+* ver 2.3 : 19 Oct 2026
+* - XML parser, scanner and DOM benchmarks moved to XmlBenchmarks
+* ver 2.2 : 19 Oct 2026
+* - peakRssBytes() replaces residentBytes()
+* ver 2.1 : 19 Oct 2026
+* - results carry the resident set growth of the benchmark instead of
+*   the peak resident set of the process
+* - dataset sizes of 0 are rejected
+* ver 2.0 : 19 Oct 2026
+* - added XmlDocument serialization benchmarks, indented and compact
+* ver 1.9 : 19 Oct 2026
+* - added XmlPullReader benchmarks: every event, and keys only with records skipped
+* ver 1.8 : 19 Oct 2026
+* - added record splitting, parallel parse and parallel import benchmarks
+* ver 1.7 : 19 Oct 2026
+* - added XmlDocument query benchmarks: tree walk, tag index and XmlPath
+* ver 1.6 : 19 Oct 2026
+* - added arena DOM and arena import benchmarks
+* ver 1.5 : 19 Oct 2026
+* - tokenizer and structural scan benchmarks for each XmlScanner level
+* ver 1.4 : 19 Oct 2026
+* - added XML parse throughput benchmarks for XmlParser and XmlViewParser
+* ver 1.3 : 19 Oct 2026
+* - added payload conversion benchmarks
+* ver 1.2 : 19 Oct 2026
+* - added importDb benchmark with lazy payload decoding
+* ver 1.1 : 19 Oct 2026
+* - added sharded exportDb and importDb benchmarks
+* ver 1.0 : 19 Oct 2026
+* - first release
+*/
+
+#include "Benchmarks.h"
+#include "../Query/Query.h"
+#include "../Persistence/Persistence.h"
+#include "../../SoftwareRepository/RepoUtilities/RepoUtilities.h"
+
+#include <cstdio>
+#include <iomanip>
+#include <memory>
+#include <sstream>
+#include <thread>
+
+#ifdef _WIN32
+#include <Windows.h>
+#include <Psapi.h>
+#pragma comment(lib, "Psapi.lib")
+#else
+#include <sys/resource.h>
+#endif
+
+using namespace NoSqlDbBenchmarks;
+using namespace NoSqlDb;
+
+/////////////////////////////////////////////////////////////////////
+// result reporting
+
+//----< peak resident set size of this process in bytes >------------
+
+size_t NoSqlDbBenchmarks::peakRssBytes()
+{
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+        return 0;
+    return counters.PeakWorkingSetSize;
+#else
+    rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0;
+#ifdef __APPLE__
+    return (size_t)usage.ru_maxrss;
+#else
+    return (size_t)usage.ru_maxrss * 1024;
+#endif
+#endif
+}
+
+//----< renders a result as a single line JSON object >--------------
+
+std::string NoSqlDbBenchmarks::toJson(const BenchResult& result)
+{
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(6)
+        << "{\"bench\":\"" << result.name << "\""
+        << ",\"records\":" << result.records
+        << ",\"ops\":" << result.ops
+        << ",\"seconds\":" << result.seconds
+        << std::setprecision(1)
+        << ",\"opsPerSec\":" << result.opsPerSec()
+        << ",\"p50Ns\":" << result.p50Ns
+        << ",\"p99Ns\":" << result.p99Ns
+        << ",\"peakRssBytes\":" << result.peakRssBytes;
+    if (result.bytesPerOp > 0)
+        out << ",\"mbPerSec\":" << result.mbPerSec();
+    out << "}";
+    return out.str();
+}
+
+//----< renders a result as an aligned line of text >----------------
+
+std::string NoSqlDbBenchmarks::toText(const BenchResult& result)
+{
+    std::ostringstream out;
+    out << "  " << std::left << std::setw(26) << result.name << std::right
+        << std::setw(10) << result.records << " records"
+        << std::setw(14) << std::fixed << std::setprecision(1) << result.opsPerSec() << " ops/s"
+        << "  p50 " << std::setw(10) << result.p50Ns << " ns"
+        << "  p99 " << std::setw(10) << result.p99Ns << " ns"
+        << "  rss " << result.peakRssBytes / (1024 * 1024) << " MB";
+    if (result.bytesPerOp > 0)
+        out << "  " << std::setprecision(1) << result.mbPerSec() << " MB/s";
+    return out.str();
+}
+
+/////////////////////////////////////////////////////////////////////
+// FileResourceDataset methods
+
+//----< versioned db key of a record, as the properties db builds it >---
+
+FileResourceDataset::Key FileResourceDataset::keyOf(size_t record)
+{
+    size_t file = record / VERSIONS;
+    size_t version = record % VERSIONS + 1;
+    std::string identity = "ns" + std::to_string(file % NAMESPACES) + "::" + nameOf(record);
+    return SoftwareRepository::getDbKeyForVersion(identity, (SoftwareRepository::ResourceVersion)version);
+}
+
+//----< file name of a record; every version shares it >-------------
+
+std::string FileResourceDataset::nameOf(size_t record)
+{
+    return "package" + std::to_string(record / VERSIONS / 10) + "/file" + std::to_string(record / VERSIONS) + ".cpp";
+}
+
+//----< owner of a record >------------------------------------------
+
+std::string FileResourceDataset::authorOf(size_t record)
+{
+    return "author" + std::to_string((record / VERSIONS) % AUTHORS);
+}
+
+//----< builds the element stored under keyOf(record) >--------------
+/*
+*  - a record depends on up to three records added before it
+*  - records are spread over the last records minutes
+*/
+NoSqlDb::DbElement<Payload> FileResourceDataset::elementOf(size_t record, size_t records)
+{
+    DbElement<Payload> elem;
+    elem.metadata().name(nameOf(record));
+    elem.metadata().descrip("Implements the " + nameOf(record) + " package of the repository");
+    DateTime now = DateTime().now();
+    elem.metadata().dateTime(now - DateTime::makeDuration(0, (int)(records - record), 0, 0));
+
+    for (size_t dep = 1; dep <= 3 && dep * 7 <= record; ++dep)
+        elem.metadata().addRelationship(keyOf(record - dep * 7));
+
+    elem.payLoad()
+        .setAuthor(authorOf(record))
+        .setState(record % VERSIONS == VERSIONS - 1 ? SoftwareRepository::OPEN : SoftwareRepository::CLOSED)
+        .setNamespace("ns" + std::to_string((record / VERSIONS) % NAMESPACES))
+        .setPackageName("package" + std::to_string(record / VERSIONS / 10))
+        .setVersion((SoftwareRepository::ResourceVersion)(record % VERSIONS + 1))
+        .addCategory("category" + std::to_string(record % 7))
+        .addCategory("category" + std::to_string(record % 11));
+    return elem;
+}
+
+//----< adds records 0 .. records-1 to the db >-----------------------
+
+void FileResourceDataset::populate(Db& db, size_t records)
+{
+    for (size_t i = 0; i < records; ++i)
+        db.add(keyOf(i), elementOf(i, records));
+}
+
+/////////////////////////////////////////////////////////////////////
+// BenchmarkSuite methods
+
+//----< runs every benchmark over every dataset size >---------------
+/*
+*  - lookups and queries pick records from the dataset, so an empty
+*    dataset is rejected before anything is run
+*/
+void NoSqlDbBenchmarks::BenchmarkSuite::run()
+{
+    for (size_t records : sizes_)
+    {
+        if (records == 0)
+            throw(std::exception("dataset size must be at least 1"));
+    }
+    for (size_t records : sizes_)
+        runDataset(records);
+}
+
+//----< number of full-scan operations to time for a dataset >-------
+/*
+*  - keeps the work per benchmark roughly constant across sizes
+*/
+size_t NoSqlDbBenchmarks::BenchmarkSuite::scanOps(size_t records)
+{
+    size_t ops = 1000000 / (records == 0 ? 1 : records);
+    return std::max<size_t>(1, std::min<size_t>(ops, 100));
+}
+
+//----< stores and prints one result >-------------------------------
+
+void NoSqlDbBenchmarks::BenchmarkSuite::report(const BenchResult& result)
+{
+    results_.push_back(result);
+    out_ << (asText_ ? toText(result) : toJson(result)) << std::endl;
+}
+
+//----< runs every benchmark over one dataset >----------------------
+
+void NoSqlDbBenchmarks::BenchmarkSuite::runDataset(size_t records)
+{
+    using Keys = Db::Keys;
+    using Dataset = FileResourceDataset;
+
+    // elements are built up front so insert measures the db only
+    std::vector<Dataset::Key> keys;
+    std::vector<DbElement<Payload>> elements;
+    keys.reserve(records);
+    elements.reserve(records);
+    for (size_t i = 0; i < records; ++i)
+    {
+        keys.push_back(Dataset::keyOf(i));
+        elements.push_back(Dataset::elementOf(i, records));
+    }
+
+    Db db;
+    report(measure("insert", records, records,
+        [&](size_t i) { db.add(keys[i], elements[i]); }));
+    elements.clear();
+    elements.shrink_to_fit();
+
+    size_t lookups = std::min<size_t>(records, 1000000);
+    size_t stride = 7919;   // prime, so lookups visit the keys out of insertion order
+    report(measure("lookup", records, lookups,
+        [&](size_t i) { db[keys[(i * stride) % records]].payLoad().getVersion(); }));
+
+    size_t scans = scanOps(records);
+    report(measure("keys", records, scans, [&](size_t) { db.keys(); }));
+
+    Query<Payload> query;
+    Dataset::Key someKey = keys[records / 2];
+    std::string someName = Dataset::nameOf(records / 2);
+    std::string someAuthor = Dataset::authorOf(records / 2);
+    DateTime now = DateTime().now();
+    DateTime from = now - DateTime::makeDuration(0, (int)(records / 2), 0, 0);
+    DateTime to = now - DateTime::makeDuration(0, (int)(records / 4), 0, 0);
+
+    report(measure("query.key.eq", records, scans,
+        [&](size_t) { query.from(db).where.key.eq(someKey).end(); }));
+    report(measure("query.key.eqRegex", records, scans,
+        [&](size_t) { query.from(db).where.key.eqRegex("^ns7::.*").end(); }));
+    report(measure("query.metadata.eqRegex", records, scans,
+        [&](size_t) { query.from(db).where.metadata.eqRegex(".*file1[0-9]\\.cpp.*").end(); }));
+    report(measure("query.metadata.eqName", records, scans,
+        [&](size_t) { query.from(db).where.metadata.eqName(someName).end(); }));
+    report(measure("query.metadata.eqNameRegex", records, scans,
+        [&](size_t) { query.from(db).where.metadata.eqNameRegex("^package1/.*").end(); }));
+    report(measure("query.dateTime.between", records, scans,
+        [&](size_t) { query.from(db).where.dateTime.between(from, to).end(); }));
+    report(measure("query.child.eq", records, scans,
+        [&](size_t) { query.from(db).where.child.eq(someKey).end(); }));
+    report(measure("query.payload.has", records, scans,
+        [&](size_t) {
+            query.from(db).where.payload.has(
+                [&](Payload payload) { return payload.getAuthor() == someAuthor; }).end();
+        }));
+    report(measure("query.orThese", records, scans,
+        [&](size_t) {
+            query.orThese({
+                query.from(db).where.key.eqRegex("^ns7::.*").end(),
+                query.from(db).where.child.eq(someKey).end()
+            }).end();
+        }));
+
+    // payload conversions generated from the payload schema
+    size_t codecOps = std::min<size_t>(records, 100000);
+    std::vector<Payload> payloads;
+    payloads.reserve(codecOps);
+    for (size_t i = 0; i < codecOps; ++i)
+        payloads.push_back(db[keys[i]].payLoad());
+    std::vector<Payload::Sptr> payloadElems(codecOps);
+    std::vector<std::string> payloadBytes(codecOps);
+    report(measure("payload.toXmlElement", records, codecOps,
+        [&](size_t i) { payloadElems[i] = payloads[i].toXmlElement(); }));
+    report(measure("payload.fromXmlElement", records, codecOps,
+        [&](size_t i) { Payload::fromXmlElement(payloadElems[i]); }));
+    report(measure("payload.toBinary", records, codecOps,
+        [&](size_t i) { payloadBytes[i] = payloads[i].toBinary(); }));
+    report(measure("payload.fromBinary", records, codecOps,
+        [&](size_t i) { Payload::fromBinary(payloadBytes[i]); }));
+    payloads.clear();
+    payloadElems.clear();
+    payloadBytes.clear();
+
+    std::string filePath = "NoSqlDbBenchmarks.xml";
+    size_t persistOps = std::max<size_t>(1, std::min<size_t>(scans, 5));
+    Keys allKeys = db.keys();
+    report(measure("exportDb", records, persistOps,
+        [&](size_t) { Persistence<Payload>(db).exportDb(allKeys, filePath); }));
+
+    report(measure("importDb", records, persistOps,
+        [&](size_t) {
+            Db imported;
+            Persistence<Payload>(imported).importDb(filePath);
+        }));
+
+    report(measure("importDb.lazy", records, persistOps,
+        [&](size_t) {
+            Db imported;
+            Persistence<Payload>(imported).lazyPayLoads(true).importDb(filePath);
+        }));
+
+    report(measure("importDb.arena", records, persistOps,
+        [&](size_t) {
+            Db imported;
+            Persistence<Payload>(imported).importMode(Persistence<Payload>::arena).importDb(filePath);
+        }));
+
+    report(measure("importDb.parallel", records, persistOps,
+        [&](size_t) {
+            Db imported;
+            Persistence<Payload>(imported).importMode(Persistence<Payload>::parallel).importDb(filePath);
+        }));
+    std::remove(filePath.c_str());
+
+    // sharded persistence, one shard file per core
+    size_t shards = std::max<size_t>(1, std::thread::hardware_concurrency());
+    report(measure("exportDb.sharded", records, persistOps,
+        [&](size_t) { Persistence<Payload>(db).shards(shards).exportDb(allKeys, filePath); }));
+
+    report(measure("importDb.sharded", records, persistOps,
+        [&](size_t) {
+            Db imported;
+            Persistence<Payload>(imported).importDb(filePath);
+        }));
+
+    report(measure("importDb.sharded.arena", records, persistOps,
+        [&](size_t) {
+            Db imported;
+            Persistence<Payload>(imported).importMode(Persistence<Payload>::arena).importDb(filePath);
+        }));
+    std::remove(filePath.c_str());
+    for (size_t i = 0; i < shards; ++i)
+        std::remove(("NoSqlDbBenchmarks." + std::to_string(i) + ".xml").c_str());
+}
+
+//----< benchmark entry point >--------------------------------------
+
+#ifdef TEST_BENCHMARKS
+
+//----< parses a comma separated list of dataset sizes >-------------
+/*
+*  - returns no sizes if any of them is 0, which main reports as misuse
+*/
+NoSqlDbBenchmarks::BenchmarkSuite::Sizes parseSizes(const std::string& list)
+{
+    NoSqlDbBenchmarks::BenchmarkSuite::Sizes sizes;
+    std::istringstream in(list);
+    std::string item;
+    while (std::getline(in, item, ','))
+    {
+        if (item.empty())
+            continue;
+        size_t size = (size_t)std::stoull(item);
+        if (size == 0)
+            return NoSqlDbBenchmarks::BenchmarkSuite::Sizes();
+        sizes.push_back(size);
+    }
+    return sizes;
+}
+
+int main(int argc, char* argv[])
+{
+    NoSqlDbBenchmarks::BenchmarkSuite::Sizes sizes = NoSqlDbBenchmarks::BenchmarkSuite::defaultSizes();
+    bool asText = false;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if (arg == "--sizes" && i + 1 < argc)
+            sizes = parseSizes(argv[++i]);
+        else if (arg == "--text")
+            asText = true;
+        else
+            sizes.clear();
+
+        if (sizes.empty())
+        {
+            std::cout << "\n  usage: Benchmarks [--sizes 1000,10000,...] [--text]"
+                << "\n  every size must be at least 1\n";
+            return 1;
+        }
+    }
+
+    NoSqlDbBenchmarks::BenchmarkSuite benchmarks(sizes, std::cout, asText);
+    benchmarks.run();
+    return 0;
+}
+
+#endif // TEST_BENCHMARKS
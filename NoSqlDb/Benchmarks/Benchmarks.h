@@ -0,0 +1,201 @@
+#pragma once
+///////////////////////////////////////////////////////////////////////
+// Benchmarks.h - Throughput and latency benchmarks for NoSqlDb      //
+// ver 2.0                                                           //
+// Language:    C++, Visual Studio 2017                              //
+// Application: NoSqlDb, CSE687 - Object Oriented Design             //
+// Author:      Ritesh Nair (rgnair@syr.edu)                         //
+///////////////////////////////////////////////////////////////////////
+/*
+* Package Operations:
+* -------------------
+* The TestExecutive checks what the db does; this package measures how
+* fast it does it. It provides:
+* - BenchResult which holds the outcome of one benchmark: operations per
+*   second, p50/p99 latency of a single operation and the peak resident
+*   set of the process once it has run. The peak only ever grows, so a
+*   benchmark only shows its own footprint if it needs more memory than
+*   every benchmark run before it; run a single dataset size to compare
+*   footprints.
+* - measure() which times every call of an operation into a
+*   LatencyHistogram (see DbInstrumentation.h).
+* - FileResourceDataset which fills a db with synthetic records shaped
+*   like the ones the repository keeps in its properties db: versioned
+*   keys, dependencies as children and FileResourcePayload payloads.
+* - BenchmarkSuite which runs insert, lookup, keys(), every query
+*   type, orThese, the payload XML and binary conversions, exportDb and
+*   importDb (single file, lazy payloads, arena, parallel and sharded
+*   over one file per core) over datasets of the requested sizes and
+*   writes one JSON object per benchmark so that runs can be compared
+*   over time.
+* The XmlProcessing parsers, scanners and serializers are measured on
+* their own by XmlBenchmarks (NoSqlDb/XmlDocument/XmlBenchmarks).
+*
+* Required Files:
+* ---------------
+* Benchmarks.h, Benchmarks.cpp
+* DbCore.h, DbCore.cpp, DbInstrumentation.h
+* Query.h, Persistence.h
+* FileResourcePayload.h, ResourceProperties.cpp
+* RepoUtilities.h, RepoUtilities.cpp
+* XmlDocument, XmlStreamReader, XmlWriter, XmlArena and XmlParallelParser
+*   packages, as Persistence requires them
+*
+* Build Process:
+* --------------
+* Define TEST_BENCHMARKS and build in Release mode. Usage:
+*   Benchmarks [--sizes 1000,10000,100000,1000000] [--text]
+* Datasets of 10M records need several GB of memory and are only run
+* when asked for with --sizes. Every size must be at least 1.
+* The Benchmarks project of RemoteCodeRepository.sln builds it with
+* TEST_BENCHMARKS defined, as the XmlBenchmarks project does for
+* XmlBenchmarks.
+*
+* Maintenance History:
+* --------------------
+* ver 2.0 : 19 Oct 2026
+* - XML parser, scanner and DOM benchmarks moved to XmlBenchmarks
+* - Benchmarks.vcxproj is no longer kept in the repository, as no other
+*   package's project file is
+* ver 1.9 : 19 Oct 2026
+* - reports the peak resident set of the process again, from
+*   getrusage or PeakWorkingSetSize
+* ver 1.8 : 19 Oct 2026
+* - BenchResult reports the resident set growth of each benchmark
+*   instead of the peak resident set of the process
+* ver 1.7 : 19 Oct 2026
+* - added XmlDocument query benchmarks: tree walk, tag index and XmlPath
+* ver 1.6 : 19 Oct 2026
+* - added arena DOM and arena import benchmarks
+* ver 1.5 : 19 Oct 2026
+* - tokenizer and structural scan benchmarks for each XmlScanner level
+* ver 1.4 : 19 Oct 2026
+* - added XML parse throughput benchmarks, BenchResult::mbPerSec
+* ver 1.3 : 19 Oct 2026
+* - added payload conversion benchmarks
+* ver 1.2 : 19 Oct 2026
+* - added importDb benchmark with lazy payload decoding
+* ver 1.1 : 19 Oct 2026
+* - added sharded exportDb and importDb benchmarks
+* ver 1.0 : 19 Oct 2026
+* - first release
+*/
+
+#ifndef BENCHMARKS_H
+#define BENCHMARKS_H
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "../DbCore/DbCore.h"
+#include "../DbCore/DbInstrumentation.h"
+#include "../../SoftwareRepository/ResourceProperties/FileResourcePayload.h"
+
+namespace NoSqlDbBenchmarks
+{
+    using Payload = SoftwareRepository::FileResourcePayload;
+    using Db = NoSqlDb::DbCore<Payload>;
+
+    /////////////////////////////////////////////////////////////////////
+    // BenchResult struct
+    // - outcome of one benchmark over one dataset
+
+    struct BenchResult
+    {
+        std::string name;
+        size_t records = 0;
+        size_t ops = 0;
+        double seconds = 0.0;
+        uint64_t p50Ns = 0;
+        uint64_t p99Ns = 0;
+        size_t peakRssBytes = 0;    // peak resident set of the process so far
+        size_t bytesPerOp = 0;      // input bytes per op, for throughput benchmarks
+
+        double opsPerSec() const { return seconds > 0.0 ? ops / seconds : 0.0; }
+        double mbPerSec() const { return opsPerSec() * bytesPerOp / (1024.0 * 1024.0); }
+    };
+
+    std::string toJson(const BenchResult& result);
+    std::string toText(const BenchResult& result);
+    size_t peakRssBytes();
+
+    //----< times ops calls of op(i) and returns the result >-----------
+
+    template<typename Op>
+    BenchResult measure(const std::string& name, size_t records, size_t ops, Op op)
+    {
+        using Clock = std::chrono::steady_clock;
+        NoSqlDb::LatencyHistogram histogram;
+
+        Clock::time_point begin = Clock::now();
+        for (size_t i = 0; i < ops; ++i)
+        {
+            Clock::time_point start = Clock::now();
+            op(i);
+            histogram.record((uint64_t)std::chrono::nanoseconds(Clock::now() - start).count());
+        }
+        std::chrono::duration<double> elapsed = Clock::now() - begin;
+
+        BenchResult result;
+        result.name = name;
+        result.records = records;
+        result.ops = ops;
+        result.seconds = elapsed.count();
+        result.p50Ns = histogram.percentile(0.50);
+        result.p99Ns = histogram.percentile(0.99);
+        result.peakRssBytes = peakRssBytes();
+        return result;
+    }
+
+    /////////////////////////////////////////////////////////////////////
+    // FileResourceDataset class
+    // - deterministic synthetic properties db records
+
+    class FileResourceDataset
+    {
+    public:
+        using Key = std::string;
+
+        static const size_t NAMESPACES = 50;
+        static const size_t AUTHORS = 200;
+        static const size_t VERSIONS = 3;
+
+        static Key keyOf(size_t record);
+        static std::string nameOf(size_t record);
+        static std::string authorOf(size_t record);
+        static NoSqlDb::DbElement<Payload> elementOf(size_t record, size_t records);
+        static void populate(Db& db, size_t records);
+    };
+
+    /////////////////////////////////////////////////////////////////////
+    // BenchmarkSuite class
+    // - runs every benchmark over every dataset size
+
+    class BenchmarkSuite
+    {
+    public:
+        using Sizes = std::vector<size_t>;
+
+        BenchmarkSuite(const Sizes& sizes, std::ostream& out = std::cout, bool asText = false)
+            : sizes_(sizes), out_(out), asText_(asText) {}
+
+        void run();
+        const std::vector<BenchResult>& results() const { return results_; }
+
+        static Sizes defaultSizes() { return { 1000, 10000, 100000, 1000000 }; }
+
+    private:
+        void runDataset(size_t records);
+        void report(const BenchResult& result);
+        static size_t scanOps(size_t records);
+
+        Sizes sizes_;
+        std::ostream& out_;
+        bool asText_;
+        std::vector<BenchResult> results_;
+    };
+}
+
+#endif // !BENCHMARKS_H
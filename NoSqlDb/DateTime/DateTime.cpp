@@ -17,7 +17,7 @@
 char* DateTime::ctime(const std::time_t* pTime)
 {
   const rsize_t buffSize = 26;
-  static char buffer[buffSize];
+  static thread_local char buffer[buffSize];
   errno_t err = ctime_s(buffer, buffSize, pTime);
   return buffer;
 }
@@ -25,7 +25,7 @@ char* DateTime::ctime(const std::time_t* pTime)
 
 std::tm* DateTime::localtime(const std::time_t* pTime)
 {
-  static std::tm result;
+  static thread_local std::tm result;
   errno_t err = localtime_s(&result, pTime);
   return &result;
 }
@@ -55,7 +55,7 @@ int readDateTimePart(int& part, std::istringstream& in)
 */
 DateTime::DateTime(std::string dtStr)
 {
-  static std::unordered_map<std::string, size_t> months = {
+  static const std::unordered_map<std::string, size_t> months = {
     { "Jan", 1 }, { "Feb", 2 }, { "Mar", 3 }, { "Apr", 4 }, 
     { "May", 5 }, { "Jun", 6 }, { "Jul", 7 }, { "Aug", 8 }, 
     { "Sep", 9 }, { "Oct", 10 }, { "Nov", 11 }, { "Dec", 12 } 
@@ -64,10 +64,11 @@ DateTime::DateTime(std::string dtStr)
   std::string day, month;
   in >> day;
   in >> month;
-  if (!in.good())
+  auto iter = months.find(month);
+  if (!in.good() || iter == months.end())
     throw std::exception("invalid DateTime string");
   std::tm date;
-  date.tm_mon = months[month] - 1;
+  date.tm_mon = iter->second - 1;
   readDateTimePart(date.tm_mday, in);
   readDateTimePart(date.tm_hour, in);
   readDateTimePart(date.tm_min, in);
@@ -1,7 +1,7 @@
 #pragma once
 /////////////////////////////////////////////////////////////////////
 // DateTime.h - represents clock time                              //
-// ver 1.0                                                         //
+// ver 1.1                                                         //
 // Jim Fawcett, CSE687 - Object Oriented Design, Spring 2017       //
 /////////////////////////////////////////////////////////////////////
 /*
@@ -21,6 +21,10 @@
  *
  * Maintenance History:
  * --------------------
+ * ver 1.1 : 19 Oct 2026
+ * - ctime and localtime use per-thread buffers and month names are looked up
+ *   without modifying the shared table, so DateTimes can be formatted and parsed
+ *   on several threads at once
  * ver 1.0 : 18 Feb 2017
 */
 
@@ -0,0 +1,299 @@
+#pragma once
+///////////////////////////////////////////////////////////////////////
+// DbChangeStream.h - Change-data-capture stream for DbCore          //
+// ver 1.2                                                           //
+// Language:    C++, Visual Studio 2017                              //
+// Application: NoSqlDb, CSE687 - Object Oriented Design             //
+// Author:      Ritesh Nair (rgnair@syr.edu)                         //
+///////////////////////////////////////////////////////////////////////
+/*
+* Package Operations:
+* -------------------
+* This package provides the classes used by DbCore<T> to publish the
+* mutations made to the database:
+* - DbChangeEvent carries a single change i.e. its sequence number,
+*   the type of change, the key and a snapshot of the element after
+*   the change was applied (empty for removals). Changes made by a
+*   DbTransaction are published together at commit and share its id.
+* - DbChangeStream is a bounded ring of change events. The database is
+*   the only writer; any number of readers consume it at their own pace.
+*   The slots and their events are allocated once, up front. Each slot
+*   carries an atomic sequence number which says which event it holds
+*   and a count of the readers copying it. Readers never wait; the
+*   writer only waits for readers that are copying the slot it is about
+*   to overwrite.
+* - DbChangeCursor is a reader's position in the stream. A cursor can be
+*   created from any sequence number which lets a consumer resume from
+*   the last event it processed without rescanning the database.
+*
+* Sequence numbers start at 1 and increase by one for every event.
+* The ring only retains the last "capacity" events. A reader which falls
+* further behind than that gets a GAP status and must resync from the
+* database contents (lastSequence() tells it where to resume from).
+* A resync event, published when the db's store was handed out for
+* direct editing, is reported the same way.
+*
+* Required Files:
+* ---------------
+* DbChangeStream.h
+*
+* Maintenance History:
+* --------------------
+* ver 1.2 : 19 Oct 2026
+* - slots are preallocated and guarded by atomic sequence numbers
+*   instead of atomic shared_ptr operations, which take a lock
+* - added resync events, which cursors report as a gap
+* ver 1.1 : 19 Oct 2026
+* - events carry the id of the transaction which made them
+* ver 1.0 : 19 Oct 2026
+* - first release
+*/
+
+#ifndef DBCHANGESTREAM_H
+#define DBCHANGESTREAM_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace NoSqlDb
+{
+    template<typename T>
+    class DbElement;
+
+    // types of mutations published by the db
+
+    enum class ChangeType
+    {
+        added,                  // new element or element overwritten in full
+        removed,                // element erased from the db
+        metadataChanged,        // name, description or date edited
+        payloadChanged,         // payload edited or replaced
+        relationshipChanged,    // child relationship added or removed
+        resync                  // store handed out wholesale; reload the db
+    };
+
+    inline std::string toString(ChangeType type)
+    {
+        switch (type)
+        {
+        case ChangeType::added: return "added";
+        case ChangeType::removed: return "removed";
+        case ChangeType::metadataChanged: return "metadataChanged";
+        case ChangeType::payloadChanged: return "payloadChanged";
+        case ChangeType::relationshipChanged: return "relationshipChanged";
+        case ChangeType::resync: return "resync";
+        }
+        return "unknown";
+    }
+
+    /////////////////////////////////////////////////////////////////////
+    // DbChangeEvent class
+    // - a single published mutation
+
+    template<typename T>
+    struct DbChangeEvent
+    {
+        using Key = std::string;
+        using ElementPtr = std::shared_ptr<const DbElement<T>>;
+
+        uint64_t sequence = 0;
+        ChangeType type = ChangeType::added;
+        Key key;
+        ElementPtr element;     // state after the change; empty when removed
+        uint64_t txId = 0;      // transaction which made the change; 0 if none
+    };
+
+    template<typename T>
+    class DbChangeStream;
+
+    /////////////////////////////////////////////////////////////////////
+    // DbChangeCursor class
+    // - a reader's position in a DbChangeStream
+
+    template<typename T>
+    class DbChangeCursor
+    {
+    public:
+        enum class ReadStatus { OK, EMPTY, GAP };
+
+        DbChangeCursor(const DbChangeStream<T>& stream, uint64_t nextSequence)
+            : pStream_(&stream), next_(nextSequence) {}
+
+        ReadStatus next(DbChangeEvent<T>& event);
+        size_t drain(std::vector<DbChangeEvent<T>>& events, size_t maxEvents = SIZE_MAX);
+
+        uint64_t position() const { return next_; }
+        void seek(uint64_t nextSequence) { next_ = nextSequence; }
+        uint64_t pending() const;
+
+    private:
+        const DbChangeStream<T>* pStream_;
+        uint64_t next_;
+    };
+
+    /////////////////////////////////////////////////////////////////////
+    // DbChangeStream class
+    // - bounded single-writer, multi-reader ring of change events
+
+    template<typename T>
+    class DbChangeStream
+    {
+    public:
+        using Key = std::string;
+        using Event = DbChangeEvent<T>;
+        using Cursor = DbChangeCursor<T>;
+
+        static const size_t DEFAULT_CAPACITY = 4096;
+
+        explicit DbChangeStream(size_t capacity = DEFAULT_CAPACITY)
+            : capacity_(capacity == 0 ? 1 : capacity), slots_(new Slot[capacity_]) {}
+
+        DbChangeStream(const DbChangeStream&) = delete;
+        DbChangeStream& operator=(const DbChangeStream&) = delete;
+
+        uint64_t publish(ChangeType type, const Key& key,
+            typename Event::ElementPtr element, uint64_t txId = 0);
+
+        // sequence number of the most recently published event; 0 if none
+        uint64_t lastSequence() const { return last_.load(std::memory_order_acquire); }
+        size_t capacity() const { return capacity_; }
+
+        // subscribe from a given sequence number or from the next event
+        Cursor subscribe(uint64_t fromSequence) const { return Cursor(*this, fromSequence); }
+        Cursor subscribe() const { return Cursor(*this, lastSequence() + 1); }
+
+    private:
+        friend class DbChangeCursor<T>;
+
+        // sequence of a slot whose event is being replaced
+        static const uint64_t WRITING = UINT64_MAX;
+
+        struct Slot
+        {
+            std::atomic<uint64_t> sequence{ 0 };
+            mutable std::atomic<uint32_t> readers{ 0 };
+            Event event;
+        };
+
+        bool read(uint64_t sequence, Event& event) const;
+
+        size_t capacity_;
+        std::unique_ptr<Slot[]> slots_;
+        std::atomic<uint64_t> last_{ 0 };
+    };
+
+    /////////////////////////////////////////////////////////////////////
+    // DbChangeStream<T> methods
+
+    //----< appends an event to the ring and returns its sequence number >---
+    /*
+    *  - Only the owning db calls this so there is a single writer.
+    *  - The slot is marked WRITING before the old event is overwritten, so
+    *    a reader arriving late sees a sequence that does not match and
+    *    reports a gap. Readers that registered before the mark are still
+    *    copying the old event and are waited for.
+    *  - The slot is filled before the sequence is advanced, so a reader
+    *    that sees lastSequence() >= n will find event n (or a newer one,
+    *    if it has already been overwritten).
+    */
+    template<typename T>
+    uint64_t DbChangeStream<T>::publish(ChangeType type, const Key& key,
+        typename Event::ElementPtr element, uint64_t txId)
+    {
+        uint64_t sequence = last_.load(std::memory_order_relaxed) + 1;
+        Slot& slot = slots_[sequence % capacity_];
+
+        slot.sequence.store(WRITING, std::memory_order_seq_cst);
+        while (slot.readers.load(std::memory_order_seq_cst) != 0)
+            std::this_thread::yield();
+
+        slot.event.sequence = sequence;
+        slot.event.type = type;
+        slot.event.key = key;
+        slot.event.element = std::move(element);
+        slot.event.txId = txId;
+
+        slot.sequence.store(sequence, std::memory_order_release);
+        last_.store(sequence, std::memory_order_release);
+        return sequence;
+    }
+
+    //----< copies event with sequence number if it is still in the ring >---
+    /*
+    *  - Registering as a reader before checking the sequence pairs with
+    *    the writer marking the slot before checking for readers: either
+    *    the writer waits for this copy or the copy is not attempted.
+    */
+    template<typename T>
+    bool DbChangeStream<T>::read(uint64_t sequence, Event& event) const
+    {
+        const Slot& slot = slots_[sequence % capacity_];
+        slot.readers.fetch_add(1, std::memory_order_seq_cst);
+        bool found = (slot.sequence.load(std::memory_order_seq_cst) == sequence);
+        if (found)
+            event = slot.event;
+        slot.readers.fetch_sub(1, std::memory_order_release);
+        return found;
+    }
+
+    /////////////////////////////////////////////////////////////////////
+    // DbChangeCursor<T> methods
+
+    //----< reads the next event, if any >-------------------------------
+    /*
+    *  - OK: event is filled and the cursor advances
+    *  - EMPTY: nothing new has been published yet
+    *  - GAP: the event at the cursor has already been overwritten, or it
+    *    is a resync event. The cursor is left in place so the caller can
+    *    inspect position(), resync from the db and seek() to
+    *    lastSequence() + 1.
+    */
+    template<typename T>
+    typename DbChangeCursor<T>::ReadStatus DbChangeCursor<T>::next(DbChangeEvent<T>& event)
+    {
+        if (next_ == 0)
+            next_ = 1;
+
+        if (next_ > pStream_->lastSequence())
+            return ReadStatus::EMPTY;
+
+        if (!pStream_->read(next_, event) || event.type == ChangeType::resync)
+            return ReadStatus::GAP;
+
+        ++next_;
+        return ReadStatus::OK;
+    }
+
+    //----< reads up to maxEvents events into the supplied vector >------
+    /*
+    *  - returns the number of events appended; stops early at a gap
+    */
+    template<typename T>
+    size_t DbChangeCursor<T>::drain(std::vector<DbChangeEvent<T>>& events, size_t maxEvents)
+    {
+        size_t count = 0;
+        DbChangeEvent<T> event;
+        while (count < maxEvents && next(event) == ReadStatus::OK)
+        {
+            events.push_back(std::move(event));
+            ++count;
+        }
+        return count;
+    }
+
+    //----< number of published events this cursor has not read yet >---
+
+    template<typename T>
+    uint64_t DbChangeCursor<T>::pending() const
+    {
+        uint64_t last = pStream_->lastSequence();
+        uint64_t next = (next_ == 0 ? 1 : next_);
+        return (last >= next ? last - next + 1 : 0);
+    }
+}
+
+#endif // !DBCHANGESTREAM_H
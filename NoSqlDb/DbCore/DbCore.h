@@ -1,7 +1,7 @@
 #pragma once
 ///////////////////////////////////////////////////////////////////////
 // DbCore.h - Implements NoSql database prototype                    //
-// ver 1.5                                                           //
+// ver 1.15                                                          //
 // Language:    C++, Visual Studio 2017                              //
 // Application: NoSqlDb, CSE687 - Object Oriented Design             //
 // Author:      Ritesh Nair                                          //
@@ -17,8 +17,22 @@
 *   exercises for students.
 * - DbElement provides the value part of our key-value database.
 *   It contains a metadata field & a payload field of the template type.
+*   The payload can be left encoded (e.g. as read from a file) and is
+*   then decoded the first time it is accessed.
 * - DbElementMetadata stores the metadata part of the DbElement.
 *   It contains fields for name, description, date, child collection.
+* - DbCore optionally publishes every mutation to a DbChangeStream
+*   (see DbChangeStream.h). The stream is created on first use of
+*   changes() so there is no cost for dbs nobody subscribes to.
+*   Elements handed out by the non-const operator[] may be edited by
+*   the caller; they are published in full by the next mutation,
+*   changes() or flushEdits(). Handing out the whole store publishes a
+*   resync event.
+* - DbJournal records the before-images and deferred change events of
+*   a db while it takes part in a DbTransaction (see DbTransaction.h).
+* - DbCore optionally counts its operations and reports the memory held
+*   by its records (see DbInstrumentation.h). Counting starts with the
+*   first call to stats() or enableStats().
 * The package also provides functions for displaying:
 * - set of all database keys
 * - database elements
@@ -27,11 +41,40 @@
 * Required Files:
 * ---------------
 * DbCore.h, DbCore.cpp
+* DbChangeStream.h
+* DbInstrumentation.h
 * DateTime.h, DateTime.cpp
 * Utilities.h, Utilities.cpp
 *
 * Maintenance History:
 * --------------------
+* ver 1.15 : 19 Oct 2026
+* - const getters of DbElementMetadata and DbElement return references
+* - added DbElement::encodedPayLoad, the bytes of a payload not yet decoded
+* ver 1.14 : 19 Oct 2026
+* - a lazy payload is decoded under std::call_once in the shared
+*   EncodedPayLoad; the const payLoad() no longer writes to the element,
+*   so concurrent reads of one element are safe
+* ver 1.13 : 19 Oct 2026
+* - add() or modify() over an existing key is counted as an update
+* - operator[] is counted as one lookup, including the const one
+* ver 1.12 : 19 Oct 2026
+* - modify() creates a missing element again, as operator[] does
+* - edits made through operator[] and dbStore() reach the change stream
+* - operator[] no longer journals elements that it only reads
+* - added value() for reads that must not create or publish an element
+* ver 1.11 : 19 Oct 2026
+* - added add() overload which moves the element into the db
+* ver 1.10 : 19 Oct 2026
+* - DbElement can hold its payload encoded until first access
+* ver 1.9 : 19 Oct 2026
+* - added find() for lookups that must not create or journal an element
+* ver 1.8 : 19 Oct 2026
+* - added operation counters, footprint and stats reports
+* ver 1.7 : 19 Oct 2026
+* - added DbJournal and the hooks used by DbTransaction
+* ver 1.6 : 19 Oct 2026
+* - added change-data-capture stream and modify() for in-place edits
 * ver 1.5 : 16 Apr 2018
 * - Fixed bug in add function
 * ver 1.4 : 15 Apr 2018
@@ -56,7 +99,14 @@
 #include <iostream>
 #include <iomanip>
 #include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_set>
+#include <utility>
 #include "../DateTime/DateTime.h"
+#include "DbChangeStream.h"
+#include "DbInstrumentation.h"
 
 namespace NoSqlDb
 {
@@ -78,12 +128,12 @@ namespace NoSqlDb
 
     public:
         std::string& name() { return name_; }
-        std::string name() const { return name_; }
+        const std::string& name() const { return name_; }
         void name(const std::string& name) { name_ = name; }
 
 
         std::string& descrip() { return descrip_; }
-        std::string descrip() const { return descrip_; }
+        const std::string& descrip() const { return descrip_; }
         void descrip(const std::string& name) { descrip_ = name; }
 
         DateTime& dateTime() { return dateTime_; }
@@ -91,16 +141,49 @@ namespace NoSqlDb
         void dateTime(const DateTime& dateTime) { dateTime_ = dateTime; }
 
         Children& children() { return children_; }
-        Children children() const { return children_; }
+        const Children& children() const { return children_; }
         void children(const Children& children) { children_ = children; }
 
         DbElementMetadata& addRelationship(const Key& child);
         DbElementMetadata& removeRelationship(const Key& child);
     };
 
+    /////////////////////////////////////////////////////////////////////
+    // EncodedPayLoad class
+    // - a payload as read from storage, with the function that decodes it
+    // - decoded() runs the decoder once, however many threads call it; a
+    //   decoder that throws leaves it to be run again by the next call
+
+    template<typename T>
+    class EncodedPayLoad
+    {
+    public:
+        using Decoder = T(*)(const std::string&);
+
+        EncodedPayLoad(const std::string& bytes, Decoder decoder) : bytes_(bytes), decoder_(decoder) {}
+
+        const T& decoded() const
+        {
+            std::call_once(once_, [this]() { payLoad_ = decoder_(bytes_); });
+            return payLoad_;
+        }
+        const std::string& bytes() const { return bytes_; }
+        size_t footprint() const { return sizeof(*this) + bytes_.capacity(); }
+
+    private:
+        std::string bytes_;
+        Decoder decoder_;
+        mutable std::once_flag once_;
+        mutable T payLoad_;
+    };
+
     /////////////////////////////////////////////////////////////////////
     // DbElement class
     // - provides the value part of a NoSql key-value database
+    // - the payload may be left encoded until it is first accessed (see
+    //   lazyPayLoad); copies of the element share the encoded bytes
+    // - the const payLoad() leaves the element as it is, so concurrent
+    //   readers are safe; the non-const one moves the decoded payload in
 
     template<typename T>
     class DbElement
@@ -111,16 +194,46 @@ namespace NoSqlDb
     private:
         DbElementMetadata metadata_;
         T payLoad_;
+        std::shared_ptr<const EncodedPayLoad<T>> pEncoded_;
 
     public:
         // methods to get and set DbElement fields
         DbElementMetadata& metadata() { return metadata_; }
-        DbElementMetadata metadata() const { return metadata_; }
+        const DbElementMetadata& metadata() const { return metadata_; }
         void metadata(const DbElementMetadata& metadata) { metadata_ = metadata; }
         
-        T& payLoad() { return payLoad_; }
-        T payLoad() const { return payLoad_; }
-        void payLoad(const T& payLoad) { payLoad_ = payLoad; }
+        T& payLoad()
+        {
+            if (pEncoded_)
+            {
+                payLoad_ = pEncoded_->decoded();
+                pEncoded_.reset();
+            }
+            return payLoad_;
+        }
+        const T& payLoad() const { return pEncoded_ ? pEncoded_->decoded() : payLoad_; }
+        void payLoad(const T& payLoad) { pEncoded_.reset(); payLoad_ = payLoad; }
+
+        // keeps the payload encoded; it is decoded by the first payLoad() call,
+        // which throws what the decoder throws
+        void lazyPayLoad(const std::string& bytes, typename EncodedPayLoad<T>::Decoder decoder)
+        {
+            payLoad_ = T();
+            pEncoded_ = std::make_shared<const EncodedPayLoad<T>>(bytes, decoder);
+        }
+        bool payLoadDecoded() const { return !pEncoded_; }
+
+        // the payload as it was read from storage; empty once it has been
+        // decoded into the element or replaced
+        const std::string& encodedPayLoad() const
+        {
+            static const std::string none;
+            return pEncoded_ ? pEncoded_->bytes() : none;
+        }
+        size_t encodedPayLoadBytes() const
+        {
+            return pEncoded_ ? pEncoded_->footprint() : 0;
+        }
 
         DbElement<T>& addRelationship(const Key& childKey) 
         { 
@@ -130,6 +243,38 @@ namespace NoSqlDb
         DbElement<T>& removeRelationship(const Key& childKey) { metadata_.removeRelationship(childKey); return *this; }
     };
 
+    /////////////////////////////////////////////////////////////////////
+    // DbJournal class
+    // - keeps what is needed to commit or roll back a transaction on a db
+    // - the before-image of a key is recorded the first time it is touched
+    //   (an empty pointer means the key did not exist)
+
+    template<typename T>
+    class DbJournal
+    {
+    public:
+        using Key = std::string;
+        using Store = std::unordered_map<Key, DbElement<T>>;
+        using BeforeImages = std::unordered_map<Key, std::shared_ptr<DbElement<T>>>;
+        using Deferred = std::vector<std::pair<ChangeType, Key>>;
+
+        void record(const Key& key, const Store& store)
+        {
+            if (before_.find(key) != before_.end())
+                return;
+            typename Store::const_iterator iter = store.find(key);
+            before_[key] = (iter == store.end()) ? nullptr : std::make_shared<DbElement<T>>(iter->second);
+        }
+        void defer(ChangeType type, const Key& key) { deferred_.push_back({ type, key }); }
+
+        const BeforeImages& before() const { return before_; }
+        const Deferred& deferred() const { return deferred_; }
+
+    private:
+        BeforeImages before_;
+        Deferred deferred_;
+    };
+
     /////////////////////////////////////////////////////////////////////
     // DbCore class
     // - provides core NoSql db operations
@@ -150,6 +295,8 @@ namespace NoSqlDb
 
         Keys keys();
         bool contains(const Key& key);
+        iterator find(const Key& key);
+        DbElement<T> value(const Key& key);
         size_t size();
         void throwOnIndexNotFound(bool doThrow) { doThrow_ = doThrow; }
         DbElement<T>& operator[](const Key& key);
@@ -157,39 +304,110 @@ namespace NoSqlDb
 
         // methods for CRUD operations
         bool add(const Key& key, const DbElement<T>& element);
+        bool add(const Key& key, DbElement<T>&& element);
         bool add(const Pairs& keyValuePairs);
         bool remove(const Key& key);
         bool truncate();
 
         DbCore<T>& addRelationship(const Key& dbKey, const Key& childKey)
         { 
+            touch(dbKey);
             dbStore_[dbKey].addRelationship(childKey);
+            publish(ChangeType::relationshipChanged, dbKey);
             return *this;
         }
         DbCore<T>& removeRelationship(const Key& dbKey, const Key& childKey)
         { 
+            touch(dbKey);
             dbStore_[dbKey].removeRelationship(childKey);
+            publish(ChangeType::relationshipChanged, dbKey);
             return *this;
         }
         DbCore<T>& replacePayLoad(const Key& key, const T& payLoad)
         { 
+            touch(key);
             dbStore_[key].payLoad(payLoad); 
+            publish(ChangeType::payloadChanged, key);
             return *this;  
         }
 
+        template<typename EditFn>
+        bool modify(const Key& key, ChangeType type, EditFn edit);
+
+        // change-data-capture
+
+        DbChangeStream<T>& changes();
+        void enableChanges(size_t capacity = DbChangeStream<T>::DEFAULT_CAPACITY);
+        bool hasChanges() const { return (bool)changes_.ptr; }
+        void flushEdits();
+
+        // instrumentation
+
+        DbStats& stats();
+        void enableStats();
+        bool hasStats() const { return INSTRUMENTATION_COMPILED && (bool)stats_.ptr; }
+        const std::shared_ptr<DbStats>& statsHandle() const { return stats_.ptr; }
+        DbFootprint footprint();
+        DbStatsReport statsReport();
+
+        // transaction hooks, used by DbTransaction
+
+        bool inTransaction() const { return (bool)journal_.ptr; }
+        void beginTransaction();
+        void commitTransaction(uint64_t txId);
+        void rollbackTransaction();
+
         // iterator implementation
-        typename iterator begin() { return dbStore_.begin(); }
+        typename iterator begin() { handOutStore(); return dbStore_.begin(); }
         typename iterator end() { return dbStore_.end(); }
 
         // methods to get and set the private database hash-map storage
 
-        DbStore& dbStore() { return dbStore_; }
+        DbStore& dbStore() { handOutStore(); return dbStore_; }
         DbStore dbStore() const { return dbStore_; }
         void dbStore(const DbStore& dbStore) { dbStore_ = dbStore; }
 
     private:
+        void publish(ChangeType type, const Key& key);
+        void touch(const Key& key)
+        {
+            flushEdits();
+            if (journal_.ptr)
+                journal_.ptr->record(key, dbStore_);
+        }
+        void handOut(const Key& key) { if (changes_.ptr || journal_.ptr) handedOut_.insert(key); }
+        void handOutStore() { if (changes_.ptr || journal_.ptr) storeHandedOut_ = true; }
+        void count(DbCounter counter, uint64_t n = 1) const { if (hasStats()) stats_.ptr->count(counter, n); }
+        void countWrite(size_t sizeBefore, size_t bucketsBefore)
+        {
+            if (!hasStats())
+                return;
+            stats_.ptr->count(dbStore_.size() != sizeBefore ? DbCounter::inserts : DbCounter::updates);
+            if (dbStore_.bucket_count() != bucketsBefore)
+                stats_.ptr->count(DbCounter::rehashes);
+        }
+
+        // holds state which belongs to this db instance only
+        // - copies of a db (e.g. the ones made by Query) start without a
+        //   change stream, journal or stats so that editing the copy is
+        //   neither reported as a change to the original, part of its
+        //   transaction nor counted against it
+        template<typename P>
+        struct InstanceOnly
+        {
+            std::shared_ptr<P> ptr;
+            InstanceOnly() {}
+            InstanceOnly(const InstanceOnly&) {}
+            InstanceOnly& operator=(const InstanceOnly&) { return *this; }
+        };
+
         DbStore dbStore_;
         bool doThrow_ = false;
+        std::unordered_set<Key> handedOut_;     // by operator[] since the last flush
+        bool storeHandedOut_ = false;           // by dbStore() or begin()
+        InstanceOnly<DbChangeStream<T>> changes_;
+        InstanceOnly<DbJournal<T>> journal_;
+        InstanceOnly<DbStats> stats_;
     };
 
     /////////////////////////////////////////////////////////////////////
@@ -201,7 +419,44 @@ namespace NoSqlDb
     bool DbCore<T>::contains(const Key& key)
     {
         iterator iter = dbStore_.find(key);
-        return iter != dbStore_.end();
+        count(DbCounter::lookups);
+        if (iter == dbStore_.end())
+        {
+            count(DbCounter::misses);
+            return false;
+        }
+        return true;
+    }
+    //----< finds element with key without creating it; end() if absent >---
+    /*
+    *  - unlike operator[] this is not recorded by an open transaction
+    */
+    template<typename T>
+    typename DbCore<T>::iterator DbCore<T>::find(const Key& key)
+    {
+        iterator iter = dbStore_.find(key);
+        count(DbCounter::lookups);
+        if (iter == dbStore_.end())
+            count(DbCounter::misses);
+        return iter;
+    }
+    //----< returns a copy of the element with key >---------------------
+    /*
+    *  - for reads: unlike operator[] it never creates the element or
+    *    hands it out for editing, so nothing is journaled or published
+    *  - a missing key gives a default element (or throws, see doThrow_)
+    */
+    template<typename T>
+    DbElement<T> DbCore<T>::value(const Key& key)
+    {
+        iterator iter = find(key);
+        if (iter == dbStore_.end())
+        {
+            if (doThrow_)
+                throw(std::exception("key does not exist in db"));
+            return DbElement<T>();
+        }
+        return iter->second;
     }
     //----< returns current key set for db >-----------------------------
 
@@ -209,7 +464,7 @@ namespace NoSqlDb
     typename DbCore<T>::Keys DbCore<T>::keys()
     {
         DbCore<T>::Keys dbKeys;
-        DbStore& dbs = dbStore();
+        DbStore& dbs = dbStore_;
         size_t size = dbs.size();
         dbKeys.reserve(size);
         for (auto item : dbs)
@@ -237,18 +492,27 @@ namespace NoSqlDb
     *  - The behavior we get is determined by doThrow_.  If false we create
     *    a new element, if true, we throw. Creating new elements is the default
     *    behavior.
+    *  - The returned element may be edited, so it is published by the next
+    *    flush of handed out elements. Only a created element is journaled;
+    *    use value() for reads.
     */
     template<typename T>
     DbElement<T>& DbCore<T>::operator[](const Key& key)
     {
-        if (!contains(key))
+        iterator iter = find(key);
+        if (iter == dbStore_.end())
         {
             if (doThrow_)
                 throw(std::exception("key does not exist in db"));
-            else
-                return (dbStore_[key] = DbElement<T>());
+
+            touch(key);
+            size_t size = dbStore_.size();
+            size_t buckets = dbStore_.bucket_count();
+            iter = dbStore_.emplace(key, DbElement<T>()).first;
+            countWrite(size, buckets);
         }
-        return dbStore_[key];
+        handOut(key);
+        return iter->second;
     }
     //----< extracts value from db with key >----------------------------
     /*
@@ -257,11 +521,14 @@ namespace NoSqlDb
     template<typename T>
     DbElement<T> DbCore<T>::operator[](const Key& key) const
     {
-        if (!contains(key))
+        typename DbStore::const_iterator iter = dbStore_.find(key);
+        count(DbCounter::lookups);
+        if (iter == dbStore_.end())
         {
+            count(DbCounter::misses);
             throw(std::exception("key does not exist in db"));
         }
-        return dbStore_[key];
+        return iter->second;
     }
 
     //----< adds a value to db with key >----------------------------
@@ -273,11 +540,32 @@ namespace NoSqlDb
     *    you can write
     *       db.add(newKey, newDbElement);
     *  - If the key exists then the metadata and the payload wil be overridden.
+    *  - Unlike db[newKey] = newDbElement, this is reported to subscribers
+    *    of the change stream right away.
     */
     template<typename T>
     bool DbCore<T>::add(const Key& key, const DbElement<T>& element)
     {
+        touch(key);
+        size_t size = dbStore_.size();
+        size_t buckets = dbStore_.bucket_count();
         dbStore_[key] = element;
+        countWrite(size, buckets);
+        publish(ChangeType::added, key);
+        return true;
+    }
+
+    //----< adds a value to db with key, taking over its contents >--------
+
+    template<typename T>
+    bool DbCore<T>::add(const Key& key, DbElement<T>&& element)
+    {
+        touch(key);
+        size_t size = dbStore_.size();
+        size_t buckets = dbStore_.bucket_count();
+        dbStore_[key] = std::move(element);
+        countWrite(size, buckets);
+        publish(ChangeType::added, key);
         return true;
     }
 
@@ -317,21 +605,312 @@ namespace NoSqlDb
             else
                 return false;
         }
-        return (dbStore_.erase(key) == 1);
+        touch(key);
+        if (dbStore_.erase(key) != 1)
+            return false;
+
+        count(DbCounter::removes);
+        publish(ChangeType::removed, key);
+        return true;
     }
 
     //----< truncates the db >----------------------------
     /*
     *  - Removes all entries from the database.
     *  - Returns a boolean which indicates if the operation was successful.
+    *  - Subscribers of the change stream receive a removal for every key.
     */
     template<typename T>
     bool DbCore<T>::truncate()
     {
+        Keys removedKeys;
+        if (hasChanges() || inTransaction())
+            removedKeys = keys();
+        for (const Key& key : removedKeys)
+            touch(key);
+
+        count(DbCounter::removes, dbStore_.size());
         dbStore_.clear();
+        for (const Key& key : removedKeys)
+            publish(ChangeType::removed, key);
         return true;
     }
 
+    //----< edits an element in place >---------------------------------
+    /*
+    *  - Calls edit(DbElement<T>&) on the element with the supplied key and
+    *    publishes a change of the given type once the edit returns.
+    *  - Unlike editing through operator[], the change is published right
+    *    away and with its type, so code which mutates shared dbs should
+    *    go through modify().
+    *  - A missing element is created first, as operator[] does, and the
+    *    change is then published as added. If doThrow_ is set we throw
+    *    instead.
+    *  - Returns true if the element already existed.
+    */
+    template<typename T>
+    template<typename EditFn>
+    bool DbCore<T>::modify(const Key& key, ChangeType type, EditFn edit)
+    {
+        iterator iter = dbStore_.find(key);
+        count(DbCounter::lookups);
+        bool existed = (iter != dbStore_.end());
+        if (!existed)
+        {
+            count(DbCounter::misses);
+            if (doThrow_)
+                throw(std::exception("key does not exist in db"));
+        }
+
+        touch(key);
+        if (!existed)
+        {
+            size_t size = dbStore_.size();
+            size_t buckets = dbStore_.bucket_count();
+            iter = dbStore_.emplace(key, DbElement<T>()).first;
+            countWrite(size, buckets);
+            type = ChangeType::added;
+        }
+        else
+        {
+            count(DbCounter::updates);
+        }
+
+        edit(iter->second);
+        publish(type, key);
+        return existed;
+    }
+
+    //----< returns the change stream, creating it on first use >--------
+
+    template<typename T>
+    DbChangeStream<T>& DbCore<T>::changes()
+    {
+        if (!changes_.ptr)
+            enableChanges();
+        flushEdits();
+        return *changes_.ptr;
+    }
+
+    //----< creates the change stream with the requested capacity >------
+    /*
+    *  - Has no effect if the stream already exists since cursors held by
+    *    subscribers refer to it.
+    */
+    template<typename T>
+    void DbCore<T>::enableChanges(size_t capacity)
+    {
+        if (!changes_.ptr)
+            changes_.ptr = std::make_shared<DbChangeStream<T>>(capacity);
+    }
+
+    //----< returns the db's stats, enabling collection on first use >---
+
+    template<typename T>
+    DbStats& DbCore<T>::stats()
+    {
+        if (!stats_.ptr)
+            enableStats();
+        return *stats_.ptr;
+    }
+
+    //----< starts counting operations on this db >----------------------
+    /*
+    *  - has no effect when NOSQLDB_NO_INSTRUMENTATION is defined, apart
+    *    from making stats() return an object that stays empty
+    */
+    template<typename T>
+    void DbCore<T>::enableStats()
+    {
+        if (!stats_.ptr)
+            stats_.ptr = std::make_shared<DbStats>();
+    }
+
+    //----< computes the bytes held in keys, metadata and payloads >-----
+    /*
+    *  - walks the whole db so it is meant for reporting, not hot paths
+    *  - strings are counted by capacity plus their fixed size
+    */
+    template<typename T>
+    DbFootprint DbCore<T>::footprint()
+    {
+        DbFootprint footprint;
+        for (auto& item : dbStore_)
+        {
+            DbElement<T>& element = item.second;
+            DbElementMetadata& metadata = element.metadata();
+
+            footprint.keyBytes += sizeof(Key) + item.first.capacity();
+            footprint.metadataBytes += sizeof(DbElementMetadata)
+                + metadata.name().capacity() + metadata.descrip().capacity();
+            for (const Key& child : metadata.children())
+                footprint.metadataBytes += sizeof(Key) + child.capacity();
+            // encoded payloads are counted as they are, not decoded for it
+            if (element.payLoadDecoded())
+                footprint.payloadBytes += payloadBytes(element.payLoad());
+            else
+                footprint.payloadBytes += sizeof(T) + element.encodedPayLoadBytes();
+        }
+        footprint.records = dbStore_.size();
+        return footprint;
+    }
+
+    //----< snapshot of the counters, query latencies and footprint >----
+
+    template<typename T>
+    DbStatsReport DbCore<T>::statsReport()
+    {
+        return stats().report(footprint());
+    }
+
+    //----< publishes a snapshot of the element to the change stream >---
+    /*
+    *  - inside a transaction the change is deferred until commit
+    */
+    template<typename T>
+    void DbCore<T>::publish(ChangeType type, const Key& key)
+    {
+        if (journal_.ptr)
+        {
+            journal_.ptr->defer(type, key);
+            return;
+        }
+        if (!changes_.ptr)
+            return;
+
+        typename DbChangeEvent<T>::ElementPtr pElem;
+        if (type != ChangeType::removed && type != ChangeType::resync)
+        {
+            iterator iter = dbStore_.find(key);
+            if (iter != dbStore_.end())
+                pElem = std::make_shared<const DbElement<T>>(iter->second);
+        }
+        changes_.ptr->publish(type, key, pElem);
+    }
+
+    //----< publishes the elements handed out since the last flush >----
+    /*
+    *  - Each element handed out by operator[] is published once, in full,
+    *    as added; whether the caller edited it is not known.
+    *  - If the whole store was handed out a single resync event replaces
+    *    them, since the edits made through it cannot be traced to keys.
+    */
+    template<typename T>
+    void DbCore<T>::flushEdits()
+    {
+        if (handedOut_.empty() && !storeHandedOut_)
+            return;
+
+        std::unordered_set<Key> handedOut;
+        handedOut.swap(handedOut_);
+        if (storeHandedOut_)
+        {
+            storeHandedOut_ = false;
+            publish(ChangeType::resync, Key());
+            return;
+        }
+        for (const Key& key : handedOut)
+        {
+            if (dbStore_.find(key) != dbStore_.end())
+                publish(ChangeType::added, key);
+        }
+    }
+
+    //----< starts recording before-images and deferring change events >---
+
+    template<typename T>
+    void DbCore<T>::beginTransaction()
+    {
+        if (journal_.ptr)
+            throw(std::exception("db is already part of a transaction"));
+        flushEdits();
+        journal_.ptr = std::make_shared<DbJournal<T>>();
+    }
+
+    //----< publishes the deferred changes as one batch >----------------
+    /*
+    *  - Keys touched several times are published once, with their final
+    *    state, in the order of their last change. Every event carries the
+    *    transaction id so subscribers can apply the batch as a unit.
+    *  - Elements only handed out by operator[] have no before-image; they
+    *    existed before the transaction.
+    */
+    template<typename T>
+    void DbCore<T>::commitTransaction(uint64_t txId)
+    {
+        flushEdits();
+        std::shared_ptr<DbJournal<T>> pJournal = journal_.ptr;
+        journal_.ptr = nullptr;
+        if (!pJournal || !changes_.ptr)
+            return;
+
+        const typename DbJournal<T>::Deferred& deferred = pJournal->deferred();
+        std::unordered_map<Key, size_t> lastChange;
+        for (size_t i = 0; i < deferred.size(); ++i)
+            lastChange[deferred[i].second] = i;
+
+        for (size_t i = 0; i < deferred.size(); ++i)
+        {
+            const Key& key = deferred[i].second;
+            if (lastChange[key] != i)
+                continue;
+
+            ChangeType type = deferred[i].first;
+            if (type == ChangeType::resync)
+            {
+                changes_.ptr->publish(type, key, nullptr, txId);
+                continue;
+            }
+            typename DbJournal<T>::BeforeImages::const_iterator before = pJournal->before().find(key);
+            bool existedBefore = (before == pJournal->before().end() || before->second != nullptr);
+            iterator iter = dbStore_.find(key);
+            typename DbChangeEvent<T>::ElementPtr pElem;
+            if (iter == dbStore_.end())
+            {
+                if (!existedBefore)
+                    continue;   // created and removed within the transaction
+                type = ChangeType::removed;
+            }
+            else
+            {
+                if (!existedBefore)
+                    type = ChangeType::added;
+                pElem = std::make_shared<const DbElement<T>>(iter->second);
+            }
+            changes_.ptr->publish(type, key, pElem, txId);
+        }
+    }
+
+    //----< restores the before-images and drops the deferred changes >---
+    /*
+    *  - Elements only handed out by operator[] cannot be restored; they
+    *    stay queued for publishing instead.
+    */
+    template<typename T>
+    void DbCore<T>::rollbackTransaction()
+    {
+        std::shared_ptr<DbJournal<T>> pJournal = journal_.ptr;
+        journal_.ptr = nullptr;
+        if (!pJournal)
+            return;
+
+        for (auto& change : pJournal->deferred())
+        {
+            if (change.first == ChangeType::resync)
+                storeHandedOut_ = true;
+            else if (pJournal->before().find(change.second) == pJournal->before().end())
+                handedOut_.insert(change.second);
+        }
+
+        for (auto& item : pJournal->before())
+        {
+            if (item.second)
+                dbStore_[item.first] = *item.second;
+            else
+                dbStore_.erase(item.first);
+        }
+    }
+
     /////////////////////////////////////////////////////////////////////
     // display functions
 
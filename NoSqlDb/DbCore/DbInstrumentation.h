@@ -0,0 +1,435 @@
+#pragma once
+///////////////////////////////////////////////////////////////////////
+// DbInstrumentation.h - Operation counters and query latencies      //
+// ver 1.2                                                           //
+// Language:    C++, Visual Studio 2017                              //
+// Application: NoSqlDb, CSE687 - Object Oriented Design             //
+// Author:      Ritesh Nair (rgnair@syr.edu)                         //
+///////////////////////////////////////////////////////////////////////
+/*
+* Package Operations:
+* -------------------
+* This package provides the classes used by DbCore<T> and Query<T> to
+* report what the database spends its time on:
+* - LatencyHistogram is a log-linear (HDR style) histogram of durations
+*   in nanoseconds. Every power of two is split into 16 buckets so any
+*   recorded value is reported within ~6% of its true value.
+* - DbStats holds the operation counters of a db (lookups, inserts,
+*   removes, misses, rehashes and updates) and, for every query type, a latency
+*   histogram and the number of rows scanned and returned.
+* - DbFootprint is the number of bytes held in keys, metadata and
+*   payloads. It is computed on demand by DbCore<T>::footprint().
+* - DbStatsReport is a point-in-time copy of all of the above which can
+*   be rendered with toText() or toJson().
+*
+* Instrumentation is off by default. A db starts collecting once
+* enableStats() or stats() is called on it; until then each hook costs
+* a single null pointer test. Defining NOSQLDB_NO_INSTRUMENTATION
+* removes the hooks at compile time.
+*
+* Counters are updated with relaxed atomics so readers on other threads
+* may take a report while the db is in use.
+*
+* Required Files:
+* ---------------
+* DbInstrumentation.h
+*
+* Maintenance History:
+* --------------------
+* ver 1.2 : 19 Oct 2026
+* - includes <cstdint> for uint64_t
+* ver 1.1 : 19 Oct 2026
+* - added updates counter for writes over an existing key
+* - corrected the range covered by the histogram buckets
+* ver 1.0 : 19 Oct 2026
+* - first release
+*/
+
+#ifndef DBINSTRUMENTATION_H
+#define DBINSTRUMENTATION_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace NoSqlDb
+{
+#ifdef NOSQLDB_NO_INSTRUMENTATION
+    const bool INSTRUMENTATION_COMPILED = false;
+#else
+    const bool INSTRUMENTATION_COMPILED = true;
+#endif
+
+    // operation counters kept by DbCore
+
+    enum class DbCounter { lookups, inserts, removes, misses, rehashes, updates };
+    const size_t DB_COUNTER_COUNT = 6;
+
+    inline std::string toString(DbCounter counter)
+    {
+        switch (counter)
+        {
+        case DbCounter::lookups: return "lookups";
+        case DbCounter::inserts: return "inserts";
+        case DbCounter::removes: return "removes";
+        case DbCounter::misses: return "misses";
+        case DbCounter::rehashes: return "rehashes";
+        case DbCounter::updates: return "updates";
+        }
+        return "unknown";
+    }
+
+    // query types timed by Query
+
+    enum class QueryKind { key, metadata, dateTime, children, payload };
+    const size_t QUERY_KIND_COUNT = 5;
+
+    inline std::string toString(QueryKind kind)
+    {
+        switch (kind)
+        {
+        case QueryKind::key: return "key";
+        case QueryKind::metadata: return "metadata";
+        case QueryKind::dateTime: return "dateTime";
+        case QueryKind::children: return "children";
+        case QueryKind::payload: return "payload";
+        }
+        return "unknown";
+    }
+
+    /////////////////////////////////////////////////////////////////////
+    // LatencyHistogram class
+    // - log-linear histogram of nanosecond durations
+    // - values below 32 have a bucket each; above that every power of
+    //   two is split into 16 equal buckets
+
+    class LatencyHistogram
+    {
+    public:
+        using Nanoseconds = uint64_t;
+
+        static const size_t SUB_BUCKETS = 16;
+        static const size_t BUCKETS = 640;      // covers values up to 2^44 ns (~4.9 hours)
+
+        LatencyHistogram() : buckets_(BUCKETS) {}
+
+        void record(Nanoseconds value);
+        void reset();
+
+        uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+        Nanoseconds max() const { return max_.load(std::memory_order_relaxed); }
+        Nanoseconds mean() const;
+        Nanoseconds percentile(double fraction) const;
+
+        static size_t bucketOf(Nanoseconds value);
+        static Nanoseconds lowestOf(size_t bucket);
+
+    private:
+        std::vector<std::atomic<uint64_t>> buckets_;
+        std::atomic<uint64_t> count_{ 0 };
+        std::atomic<uint64_t> sum_{ 0 };
+        std::atomic<uint64_t> max_{ 0 };
+    };
+
+    //----< bucket index of a value >------------------------------------
+
+    inline size_t LatencyHistogram::bucketOf(Nanoseconds value)
+    {
+        if (value < 2 * SUB_BUCKETS)
+            return (size_t)value;
+
+        size_t msb = 0;
+        for (Nanoseconds v = value; v > 1; v >>= 1)
+            ++msb;
+
+        size_t shift = msb - 4;                 // keep the top five bits
+        size_t bucket = SUB_BUCKETS * shift + (size_t)(value >> shift);
+        return bucket < BUCKETS ? bucket : BUCKETS - 1;
+    }
+
+    //----< smallest value which falls into a bucket >-------------------
+
+    inline LatencyHistogram::Nanoseconds LatencyHistogram::lowestOf(size_t bucket)
+    {
+        if (bucket < 2 * SUB_BUCKETS)
+            return bucket;
+
+        size_t shift = bucket / SUB_BUCKETS - 1;
+        Nanoseconds top = bucket % SUB_BUCKETS + SUB_BUCKETS;
+        return top << shift;
+    }
+
+    //----< adds a value >-----------------------------------------------
+
+    inline void LatencyHistogram::record(Nanoseconds value)
+    {
+        buckets_[bucketOf(value)].fetch_add(1, std::memory_order_relaxed);
+        count_.fetch_add(1, std::memory_order_relaxed);
+        sum_.fetch_add(value, std::memory_order_relaxed);
+
+        Nanoseconds current = max_.load(std::memory_order_relaxed);
+        while (value > current && !max_.compare_exchange_weak(current, value, std::memory_order_relaxed))
+            ;
+    }
+
+    //----< clears all recorded values >---------------------------------
+
+    inline void LatencyHistogram::reset()
+    {
+        for (std::atomic<uint64_t>& bucket : buckets_)
+            bucket.store(0, std::memory_order_relaxed);
+        count_.store(0, std::memory_order_relaxed);
+        sum_.store(0, std::memory_order_relaxed);
+        max_.store(0, std::memory_order_relaxed);
+    }
+
+    //----< average of the recorded values >-----------------------------
+
+    inline LatencyHistogram::Nanoseconds LatencyHistogram::mean() const
+    {
+        uint64_t n = count();
+        return n == 0 ? 0 : sum_.load(std::memory_order_relaxed) / n;
+    }
+
+    //----< value below which the given fraction of values fall >--------
+    /*
+    *  - returns the lower bound of the bucket holding that value, capped
+    *    at the largest value recorded
+    */
+    inline LatencyHistogram::Nanoseconds LatencyHistogram::percentile(double fraction) const
+    {
+        uint64_t n = count();
+        if (n == 0)
+            return 0;
+
+        uint64_t rank = (uint64_t)(fraction * n + 0.5);
+        if (rank == 0)
+            rank = 1;
+
+        uint64_t seen = 0;
+        for (size_t i = 0; i < BUCKETS; ++i)
+        {
+            seen += buckets_[i].load(std::memory_order_relaxed);
+            if (seen >= rank)
+                return std::min(lowestOf(i), max());
+        }
+        return max();
+    }
+
+    /////////////////////////////////////////////////////////////////////
+    // DbFootprint struct
+    // - bytes held by the records of a db
+
+    struct DbFootprint
+    {
+        size_t records = 0;
+        size_t keyBytes = 0;
+        size_t metadataBytes = 0;
+        size_t payloadBytes = 0;
+
+        size_t total() const { return keyBytes + metadataBytes + payloadBytes; }
+    };
+
+    //----< bytes held by a payload >------------------------------------
+    /*
+    *  - payload types which own heap memory should provide an overload of
+    *    payloadBytes in their own namespace; it is found by DbCore<T>
+    *    through argument dependent lookup
+    */
+    template<typename T>
+    size_t payloadBytes(const T&) { return sizeof(T); }
+
+    inline size_t payloadBytes(const std::string& payload) { return sizeof(payload) + payload.capacity(); }
+
+    /////////////////////////////////////////////////////////////////////
+    // DbStatsReport struct
+    // - point in time copy of a db's instrumentation
+
+    struct DbStatsReport
+    {
+        struct QueryReport
+        {
+            uint64_t count = 0;
+            uint64_t rowsScanned = 0;
+            uint64_t rowsReturned = 0;
+            uint64_t p50 = 0;
+            uint64_t p90 = 0;
+            uint64_t p99 = 0;
+            uint64_t max = 0;
+            uint64_t mean = 0;
+        };
+
+        uint64_t counters[DB_COUNTER_COUNT] = {};
+        QueryReport queries[QUERY_KIND_COUNT];
+        DbFootprint footprint;
+
+        uint64_t counter(DbCounter c) const { return counters[(size_t)c]; }
+        const QueryReport& query(QueryKind kind) const { return queries[(size_t)kind]; }
+    };
+
+    /////////////////////////////////////////////////////////////////////
+    // DbStats class
+    // - instrumentation collected for a single db
+
+    class DbStats
+    {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        DbStats() {}
+        DbStats(const DbStats&) = delete;
+        DbStats& operator=(const DbStats&) = delete;
+
+        void count(DbCounter counter, uint64_t n = 1)
+        {
+            counters_[(size_t)counter].fetch_add(n, std::memory_order_relaxed);
+        }
+        uint64_t counter(DbCounter counter) const
+        {
+            return counters_[(size_t)counter].load(std::memory_order_relaxed);
+        }
+
+        void recordQuery(QueryKind kind, Clock::time_point start, size_t rowsScanned, size_t rowsReturned);
+        const LatencyHistogram& latency(QueryKind kind) const { return queries_[(size_t)kind].latency; }
+
+        DbStatsReport report(const DbFootprint& footprint) const;
+        void reset();
+
+    private:
+        struct QueryStats
+        {
+            LatencyHistogram latency;
+            std::atomic<uint64_t> rowsScanned{ 0 };
+            std::atomic<uint64_t> rowsReturned{ 0 };
+        };
+
+        std::atomic<uint64_t> counters_[DB_COUNTER_COUNT] = {};
+        QueryStats queries_[QUERY_KIND_COUNT];
+    };
+
+    //----< records one executed query >---------------------------------
+
+    inline void DbStats::recordQuery(QueryKind kind, Clock::time_point start, size_t rowsScanned, size_t rowsReturned)
+    {
+        QueryStats& stats = queries_[(size_t)kind];
+        std::chrono::nanoseconds elapsed = Clock::now() - start;
+        stats.latency.record((uint64_t)elapsed.count());
+        stats.rowsScanned.fetch_add(rowsScanned, std::memory_order_relaxed);
+        stats.rowsReturned.fetch_add(rowsReturned, std::memory_order_relaxed);
+    }
+
+    //----< copies the current values into a report >--------------------
+
+    inline DbStatsReport DbStats::report(const DbFootprint& footprint) const
+    {
+        DbStatsReport report;
+        for (size_t i = 0; i < DB_COUNTER_COUNT; ++i)
+            report.counters[i] = counters_[i].load(std::memory_order_relaxed);
+
+        for (size_t i = 0; i < QUERY_KIND_COUNT; ++i)
+        {
+            const QueryStats& stats = queries_[i];
+            DbStatsReport::QueryReport& query = report.queries[i];
+            query.count = stats.latency.count();
+            query.rowsScanned = stats.rowsScanned.load(std::memory_order_relaxed);
+            query.rowsReturned = stats.rowsReturned.load(std::memory_order_relaxed);
+            query.p50 = stats.latency.percentile(0.50);
+            query.p90 = stats.latency.percentile(0.90);
+            query.p99 = stats.latency.percentile(0.99);
+            query.max = stats.latency.max();
+            query.mean = stats.latency.mean();
+        }
+
+        report.footprint = footprint;
+        return report;
+    }
+
+    //----< clears all counters and histograms >-------------------------
+
+    inline void DbStats::reset()
+    {
+        for (std::atomic<uint64_t>& counter : counters_)
+            counter.store(0, std::memory_order_relaxed);
+        for (QueryStats& stats : queries_)
+        {
+            stats.latency.reset();
+            stats.rowsScanned.store(0, std::memory_order_relaxed);
+            stats.rowsReturned.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    /////////////////////////////////////////////////////////////////////
+    // report formatting
+
+    //----< renders a report as an aligned text table >------------------
+
+    inline std::string toText(const DbStatsReport& report)
+    {
+        std::ostringstream out;
+        out << "\n  operations:";
+        for (size_t i = 0; i < DB_COUNTER_COUNT; ++i)
+            out << "\n    " << std::left << std::setw(10) << toString((DbCounter)i) << report.counters[i];
+
+        out << "\n  queries (latency in ns):";
+        out << "\n    " << std::left << std::setw(10) << "type" << std::right
+            << std::setw(8) << "count" << std::setw(10) << "scanned" << std::setw(10) << "returned"
+            << std::setw(10) << "p50" << std::setw(10) << "p90" << std::setw(10) << "p99"
+            << std::setw(10) << "max";
+        for (size_t i = 0; i < QUERY_KIND_COUNT; ++i)
+        {
+            const DbStatsReport::QueryReport& query = report.queries[i];
+            out << "\n    " << std::left << std::setw(10) << toString((QueryKind)i) << std::right
+                << std::setw(8) << query.count << std::setw(10) << query.rowsScanned
+                << std::setw(10) << query.rowsReturned << std::setw(10) << query.p50
+                << std::setw(10) << query.p90 << std::setw(10) << query.p99
+                << std::setw(10) << query.max;
+        }
+
+        const DbFootprint& footprint = report.footprint;
+        out << "\n  footprint: " << footprint.records << " records, " << footprint.total() << " bytes"
+            << " (keys " << footprint.keyBytes << ", metadata " << footprint.metadataBytes
+            << ", payloads " << footprint.payloadBytes << ")";
+        return out.str();
+    }
+
+    //----< renders a report as a single line JSON object >--------------
+
+    inline std::string toJson(const DbStatsReport& report)
+    {
+        std::ostringstream out;
+        out << "{\"operations\":{";
+        for (size_t i = 0; i < DB_COUNTER_COUNT; ++i)
+            out << (i ? "," : "") << "\"" << toString((DbCounter)i) << "\":" << report.counters[i];
+
+        out << "},\"queries\":{";
+        for (size_t i = 0; i < QUERY_KIND_COUNT; ++i)
+        {
+            const DbStatsReport::QueryReport& query = report.queries[i];
+            out << (i ? "," : "") << "\"" << toString((QueryKind)i) << "\":{"
+                << "\"count\":" << query.count
+                << ",\"rowsScanned\":" << query.rowsScanned
+                << ",\"rowsReturned\":" << query.rowsReturned
+                << ",\"p50Ns\":" << query.p50
+                << ",\"p90Ns\":" << query.p90
+                << ",\"p99Ns\":" << query.p99
+                << ",\"maxNs\":" << query.max
+                << ",\"meanNs\":" << query.mean << "}";
+        }
+
+        const DbFootprint& footprint = report.footprint;
+        out << "},\"footprint\":{"
+            << "\"records\":" << footprint.records
+            << ",\"keyBytes\":" << footprint.keyBytes
+            << ",\"metadataBytes\":" << footprint.metadataBytes
+            << ",\"payloadBytes\":" << footprint.payloadBytes
+            << ",\"totalBytes\":" << footprint.total() << "}}";
+        return out.str();
+    }
+}
+
+#endif // !DBINSTRUMENTATION_H
@@ -0,0 +1,155 @@
+#pragma once
+///////////////////////////////////////////////////////////////////////
+// DbTransaction.h - Groups writes to one or more dbs into one unit  //
+// ver 1.1                                                           //
+// Language:    C++, Visual Studio 2017                              //
+// Application: NoSqlDb, CSE687 - Object Oriented Design             //
+// Author:      Ritesh Nair (rgnair@syr.edu)                         //
+///////////////////////////////////////////////////////////////////////
+/*
+* Package Operations:
+* -------------------
+* This package provides the DbTransaction class. A transaction enlists
+* any number of DbCore<T> instances, possibly of different payload
+* types. Writes made to an enlisted db are applied right away, so code
+* running inside the transaction reads its own writes, but:
+* - the db journals the before-image of every key it writes, and
+* - change events are held back instead of being published.
+* Reads are not journaled. Elements handed out by the non-const
+* operator[] are published at commit but cannot be rolled back, so
+* code running inside a transaction should write through the DbCore
+* mutators (add, modify, remove, ...).
+*
+* commit() publishes the held back events of every enlisted db as one
+* batch: one event per key holding its final state, all tagged with the
+* transaction id. Consumers of the change streams (replication, for one)
+* therefore see a check-in as a single group write instead of a dozen
+* small ones. abort() restores the before-images and publishes nothing.
+* A transaction that is destroyed without being committed is aborted.
+*
+* A db can take part in only one transaction at a time. Transactions
+* do not lock anything - callers serialize writers as they did before.
+*
+* Required Files:
+* ---------------
+* DbTransaction.h
+* DbCore.h, DbCore.cpp
+*
+* Maintenance History:
+* --------------------
+* ver 1.1 : 19 Oct 2026
+* - operator[] no longer journals the elements it reads
+* ver 1.0 : 19 Oct 2026
+* - first release
+*/
+
+#ifndef DBTRANSACTION_H
+#define DBTRANSACTION_H
+
+#include <atomic>
+#include <functional>
+#include <vector>
+#include "DbCore.h"
+
+namespace NoSqlDb
+{
+    /////////////////////////////////////////////////////////////////////
+    // DbTransaction class
+    // - atomic unit of work over one or more dbs
+
+    class DbTransaction
+    {
+    public:
+        using TxId = uint64_t;
+
+        DbTransaction() : id_(nextId()) {}
+        ~DbTransaction() { if (active_) abort(); }
+
+        DbTransaction(const DbTransaction&) = delete;
+        DbTransaction& operator=(const DbTransaction&) = delete;
+
+        template<typename T>
+        DbTransaction& enlist(DbCore<T>& db);
+
+        void commit();
+        void abort();
+
+        TxId id() const { return id_; }
+        bool active() const { return active_; }
+        size_t participants() const { return participants_.size(); }
+
+    private:
+        struct Participant
+        {
+            const void* pDb;
+            std::function<void(TxId)> commit;
+            std::function<void()> rollback;
+        };
+
+        static TxId nextId()
+        {
+            static std::atomic<TxId> counter{ 0 };
+            return ++counter;
+        }
+
+        TxId id_;
+        bool active_ = true;
+        std::vector<Participant> participants_;
+    };
+
+    //----< adds a db to the transaction >-------------------------------
+    /*
+    *  - enlisting the same db twice has no effect
+    *  - throws if the transaction is finished or the db is already part
+    *    of another transaction
+    */
+    template<typename T>
+    DbTransaction& DbTransaction::enlist(DbCore<T>& db)
+    {
+        if (!active_)
+            throw std::exception("transaction has already finished");
+
+        for (Participant& participant : participants_)
+        {
+            if (participant.pDb == &db)
+                return *this;
+        }
+
+        db.beginTransaction();
+        DbCore<T>* pDb = &db;
+        participants_.push_back({
+            pDb,
+            [pDb](TxId txId) { pDb->commitTransaction(txId); },
+            [pDb]() { pDb->rollbackTransaction(); }
+        });
+        return *this;
+    }
+
+    //----< publishes the writes of every enlisted db >------------------
+
+    inline void DbTransaction::commit()
+    {
+        if (!active_)
+            throw std::exception("transaction has already finished");
+
+        active_ = false;
+        for (Participant& participant : participants_)
+            participant.commit(id_);
+    }
+
+    //----< undoes the writes of every enlisted db >---------------------
+    /*
+    *  - dbs are rolled back in the reverse order they were enlisted
+    */
+    inline void DbTransaction::abort()
+    {
+        if (!active_)
+            return;
+
+        active_ = false;
+        for (auto iter = participants_.rbegin(); iter != participants_.rend(); ++iter)
+            iter->rollback();
+    }
+}
+
+#endif // !DBTRANSACTION_H
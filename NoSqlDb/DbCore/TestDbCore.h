@@ -1,7 +1,7 @@
 #pragma once
 ///////////////////////////////////////////////////////////////////////
 // TestDbCore.h - Implements all test cases for DbCore               //
-// ver 1.0                                                           //
+// ver 1.3                                                           //
 // Language:    C++, Visual Studio 2017                              //
 // Application: NoSqlDb, CSE687 - Object Oriented Design             //
 // Author:      Ritesh Nair (rgnair@syr.edu)                         //
@@ -20,6 +20,12 @@
 *
 * Maintenance History:
 * --------------------
+* ver 1.3 : 19 Oct 2026
+* - added test5g
+* ver 1.2 : 19 Oct 2026
+* - added test5f
+* ver 1.1 : 19 Oct 2026
+* - added test for the change-data-capture stream
 * ver 1.0 : 09 Feb 2018
 * - first release
 */
@@ -96,6 +102,21 @@ namespace NoSqlDbTests {
         test5d(TestCore::AbstractTest::TestTitle title) : TestCore::AbstractTest(title) {  }
         virtual bool operator()();
     };
+    class test5e : public TestCore::AbstractTest {
+    public:
+        test5e(TestCore::AbstractTest::TestTitle title) : TestCore::AbstractTest(title) {  }
+        virtual bool operator()();
+    };
+    class test5f : public TestCore::AbstractTest {
+    public:
+        test5f(TestCore::AbstractTest::TestTitle title) : TestCore::AbstractTest(title) {  }
+        virtual bool operator()();
+    };
+    class test5g : public TestCore::AbstractTest {
+    public:
+        test5g(TestCore::AbstractTest::TestTitle title) : TestCore::AbstractTest(title) {  }
+        virtual bool operator()();
+    };
 
 }
 
@@ -1,6 +1,6 @@
 ///////////////////////////////////////////////////////////////////////
 // RepoPayload.cpp - Implements the persistence APIs                 //
-// ver 1.3                                                           //
+// ver 1.5                                                           //
 // Language:    C++, Visual Studio 2017                              //
 // Application: NoSqlDb, CSE687 - Object Oriented Design             //
 // Author:      Ritesh Nair (rgnair@syr.edu)                         //
@@ -9,6 +9,11 @@
 /*
 * Maintenance History:
 * --------------------
+* ver 1.5 : 19 Oct 2026
+* - StringPayload and RepoPayload conversions are generated from their schema
+* - added test9a
+* ver 1.4 : 19 Oct 2026
+* - added writeXml for StringPayload and RepoPayload
 * ver 1.3 : 19 Apr 2018
 * - payload query uses lambda for criteria definition instead of functor
 * - modified test case to support this change
@@ -27,76 +32,13 @@
 #include "../Query/Query.h"
 
 #include <iostream>
+#include <sstream>
 
 using namespace NoSqlDbTests;
 using namespace NoSqlDb;
 using namespace XmlProcessing;
 using namespace Repository;
 
-//----< converts payload to an xml element >---------------------
-
-IPayload<StringPayload>::Sptr StringPayload::toXmlElement() 
-{
-    return makeTaggedElement("payload", toString());
-}
-
-//----< constructs payload from an xml element >---------------------
-
-StringPayload StringPayload::fromXmlElement(IPayload<StringPayload>::Sptr pPayloadElem)
-{
-    if (pPayloadElem->children().size() > 0)
-    {
-        return StringPayload(pPayloadElem->children()[0]->value());
-    }
-    else
-    {
-        return StringPayload("");
-    }
-}
-
-//----< converts payload to an xml element >---------------------
-
-IPayload<RepoPayload>::Sptr RepoPayload::toXmlElement()
-{
-    IPayload<RepoPayload>::Sptr pPayload = makeTaggedElement("payload");
-
-    pPayload->addChild(makeTaggedElement("filepath", filePath_));
-
-    IPayload<RepoPayload>::Sptr pCategories = makeTaggedElement("categories");
-    for (Category category : categories_)
-    {
-        pCategories->addChild(makeTaggedElement("category", category));
-    }
-    pPayload->addChild(pCategories);
-
-    return pPayload;
-}
-
-//----< constructs payload from an xml element >---------------------
-
-RepoPayload RepoPayload::fromXmlElement(IPayload<RepoPayload>::Sptr pPayloadElem)
-{
-    RepoPayload payload;
-
-    for (auto pValueChild : pPayloadElem->children())
-    {
-        if (pValueChild->tag() == "filepath"
-            && pValueChild->children().size() > 0)
-        {
-            payload.filePath(pValueChild->children()[0]->value());
-        }
-        else if (pValueChild->tag() == "categories")
-        {
-            for (auto pCategory : pValueChild->children())
-            {
-                payload.categories().push_back(pCategory->children()[0]->value());
-            }
-        }
-    }
-
-    return payload;
-}
-
 //----< serializes the payload for writing to an output stream >---------------------
 
 std::ostream& Repository::operator<<(std::ostream& outputStream, const RepoPayload& payload)
@@ -228,6 +170,109 @@ bool test9::operator()()
 }
 
 
+//----< demo conversions generated from the payload schema >---------------------
+
+bool test9a::operator()()
+{
+    RepoPayload payload;
+    payload.filePath("/home/user/<NoSqlDb> & \"DbCore\"/");
+    payload.categories({ "Header", "", "Storage" });
+
+    auto same = [](const RepoPayload& left, const RepoPayload& right) {
+        return left.filePath() == right.filePath() && left.categories() == right.categories();
+    };
+
+    std::cout << "\n  payload: " << payload;
+
+    // xml element round trip, same layout as the streaming writer
+    IPayload<RepoPayload>::Sptr pElem = payload.toXmlElement();
+    if (!same(RepoPayload::fromXmlElement(pElem), payload))
+    {
+        setMessage("Payload did not survive toXmlElement/fromXmlElement");
+        return false;
+    }
+    std::ostringstream fromElem, fromWriter;
+    {
+        XmlWriter elemWriter(fromElem), payloadWriter(fromWriter);
+        elemWriter.element(pElem);
+        payload.writeXml(payloadWriter);
+    }
+    std::cout << "\n\n  xml:\n" << fromWriter.str();
+    if (fromElem.str() != fromWriter.str())
+    {
+        setMessage("writeXml and toXmlElement wrote different xml");
+        return false;
+    }
+
+    // element in the hand written layout, with a tag the schema doesn't know
+    IPayload<RepoPayload>::Sptr pOld = makeTaggedElement("payload");
+    pOld->addChild(makeTaggedElement("owner", "Jim"));
+    pOld->addChild(makeTaggedElement("filepath", "/home/user/"));
+    IPayload<RepoPayload>::Sptr pCategories = makeTaggedElement("categories");
+    pCategories->addChild(makeTaggedElement("category", "Header"));
+    pOld->addChild(pCategories);
+    RepoPayload old = RepoPayload::fromXmlElement(pOld);
+    if (old.filePath() != "/home/user/" || old.categories() != RepoPayload::Categories{ "Header" })
+    {
+        setMessage("Payload in the old xml layout was not read correctly");
+        return false;
+    }
+
+    // binary round trip, including data written before a field was added
+    std::string bytes = payload.toBinary();
+    std::cout << "\n\n  binary form is " << bytes.size() << " bytes";
+    if (!same(RepoPayload::fromBinary(bytes), payload))
+    {
+        setMessage("Payload did not survive toBinary/fromBinary");
+        return false;
+    }
+    bool threw = false;
+    try
+    {
+        RepoPayload::fromBinary(bytes.substr(0, bytes.size() - 1));
+    }
+    catch (std::exception& ex)
+    {
+        std::cout << "\n  truncated binary: " << ex.what();
+        threw = true;
+    }
+    std::string older;
+    PayloadBinary::putVarint(older, 1);
+    PayloadBinary::putBytes(older, "/home/user/");
+    RepoPayload fromOlder = RepoPayload::fromBinary(older);
+    if (!threw || fromOlder.filePath() != "/home/user/" || !fromOlder.categories().empty())
+    {
+        setMessage("Binary decoding did not handle truncated or older data");
+        return false;
+    }
+
+    // message attributes round trip
+    PayloadAttributes attributes;
+    payload.toAttributes(attributes, "payload-");
+    std::cout << "\n\n  attributes:";
+    for (auto& attribute : attributes)
+        std::cout << "\n    " << attribute.first << " = " << attribute.second;
+    if (!same(RepoPayload::fromAttributes(attributes, "payload-"), payload))
+    {
+        setMessage("Payload did not survive toAttributes/fromAttributes");
+        return false;
+    }
+
+    // payload stored as the element's own text
+    StringPayload text("a < b");
+    if (StringPayload::fromXmlElement(text.toXmlElement()).value() != "a < b"
+        || StringPayload::fromBinary(text.toBinary()).value() != "a < b"
+        || StringPayload::fromXmlElement(StringPayload().toXmlElement()).value() != "")
+    {
+        setMessage("StringPayload did not survive its conversions");
+        return false;
+    }
+
+    std::cout << "\n\n";
+    setMessage("Payload conversions generated from the schema");
+    return true;
+}
+
 //----< test stub >----------------------------------------------------
 
 using namespace TestCore;
@@ -238,7 +283,8 @@ int main()
 {
     TestSuite repoPayloadTestSuite("Testing Queries - The Titans database");
     test9 test9("Demonstrating Requirement #9 - custom payload");
-    repoPayloadTestSuite.registerEx(test9);
+    test9a test9a("Demonstrating schema generated payload conversions");
+    repoPayloadTestSuite.registerEx({ test9, test9a });
 
     repoPayloadTestSuite.executeAll();
 
@@ -1,7 +1,7 @@
 #pragma once
 /////////////////////////////////////////////////////////////////////////////////
 // IPayload.h - Interface for NoSQlDb compatible payloads                      //
-// ver 1.0                                                                     //
+// ver 1.2                                                                     //
 // Language:    C++, Visual Studio 2017                                        //
 // Application: NoSqlDb, CSE687 - Object Oriented Design                       //
 // Author:      Ritesh Nair (rgnair@syr.edu)                                   //
@@ -16,6 +16,10 @@
 *   which would be compatible for use with the NoSqlDb.
 * - The interface ensures that the payload provides means to persist/read from 
 *   XML source
+* - writeXml lets a payload write itself straight to an XmlWriter. The default
+*   writes the element returned by toXmlElement, so only payloads which want to
+*   avoid building that element need to override it. It is const, so a record
+*   can be exported from a const db element.
 *
 * Required Files:
 * ---------------
@@ -23,6 +27,10 @@
 *
 * Maintenance History:
 * --------------------
+* ver 1.2 : 19 Oct 2026
+* - writeXml is const
+* ver 1.1 : 19 Oct 2026
+* - added writeXml so payloads can write themselves to an XmlWriter
 * ver 1.0 : 16 Apr 2018
 * - first release
 */
@@ -31,6 +39,7 @@
 #define IPAYLOAD_H
 
 #include "../XmlDocument/XmlElement/XmlElement.h"
+#include "../XmlDocument/XmlWriter/XmlWriter.h"
 #include <string>
 
 namespace NoSqlDb
@@ -47,6 +56,12 @@ namespace NoSqlDb
 
         virtual std::string toString() = 0;
         virtual Sptr toXmlElement() = 0;
+        virtual void writeXml(XmlProcessing::XmlWriter& writer) const
+        {
+            // toXmlElement is not const, so the default works on a copy
+            T copy = static_cast<const T&>(*this);
+            writer.element(copy.toXmlElement());
+        }
         static T fromXmlElement(Sptr);
     };
 }
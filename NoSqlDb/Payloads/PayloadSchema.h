@@ -0,0 +1,801 @@
+#pragma once
+/////////////////////////////////////////////////////////////////////////////////
+// PayloadSchema.h - Payload conversions generated from a field schema         //
+// ver 1.3                                                                     //
+// Language:    C++, Visual Studio 2017                                        //
+// Application: NoSqlDb, CSE687 - Object Oriented Design                       //
+// Author:      Ritesh Nair (rgnair@syr.edu)                                   //
+/////////////////////////////////////////////////////////////////////////////////
+/*
+* Package Operations:
+* -------------------
+* Payloads used to write their XML conversions by hand and decoded each child
+* element with a chain of tag comparisons. This package lets a payload describe
+* its fields once and has the conversions generated from that description:
+* - field, listField and textField describe one member each: the tag it is
+*   stored under and a pointer to the member.
+* - a payload returns its fields from a static constexpr schema() function,
+*   derives from SchemaPayload<T> instead of IPayload<T> and makes
+*   PayloadCodec<T> a friend so that the codec can reach private members.
+* - PayloadCodec<T> converts between T and
+*     XML        - toXmlElement, writeXml and fromXmlElement, using the same
+*                  layout the hand written conversions used; fromXmlNode
+*                  reads the same layout from an XmlArenaDocument node
+*     binary     - field count followed by the fields in schema order, strings
+*                  and lists length prefixed, integers as varints
+*     attributes - flat name/value pairs as carried by a comm Message, lists
+*                  as "<tag>" = count and "<tag>.<i>" = item
+* - FieldCodec<M> says how a member of type M is written as text and binary.
+*   std::string and integral types are provided; a payload with a member of
+*   any other type specializes FieldCodec for it.
+*
+* Tags are hashed at compile time and a static_assert checks that no two
+* fields of a schema share a hash. Decoding hashes a child's tag once and the
+* field loop, unrolled at compile time, compares integers; the string compare
+* only confirms a hit.
+*
+* Binary data with fewer fields than the schema decodes with the missing
+* fields left at their defaults, so fields may be appended to a schema.
+* uniqueListField describes a list which drops duplicate items as it is
+* decoded, for payloads whose add method keeps the list free of them.
+*
+* Required Files:
+* ---------------
+* IPayload.h
+* XmlElement.h, XmlElement.cpp
+* XmlWriter.h, XmlWriter.cpp
+* XmlArena.h, XmlArena.cpp
+*
+* Build Process:
+* --------------
+* Needs C++17 (std::apply, fold expressions, std::string_view). The
+* Directory.Build.props at the root of the repository sets /std:c++17 for
+* every project of the solution.
+*
+* Maintenance History:
+* --------------------
+* ver 1.3 : 19 Oct 2026
+* - SchemaPayload::writeXml is const, as in IPayload
+* ver 1.2 : 19 Oct 2026
+* - added uniqueListField, whose decoded items skip duplicates
+* - integral fields decode empty text as 0 instead of throwing from std::stoll
+* ver 1.1 : 19 Oct 2026
+* - added fromXmlNode for payloads read into an XmlArenaDocument
+* ver 1.0 : 19 Oct 2026
+* - first release
+*/
+
+#ifndef PAYLOAD_SCHEMA_H
+#define PAYLOAD_SCHEMA_H
+
+#include "IPayload.h"
+#include "../XmlDocument/XmlArena/XmlArena.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <exception>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace NoSqlDb
+{
+    using PayloadAttributes = std::unordered_map<std::string, std::string>;
+
+    //----< FNV-1a hash of a tag, usable at compile time >---------------------
+
+    constexpr uint32_t hashTag(const char* tag, size_t length)
+    {
+        uint32_t hash = 2166136261u;
+        for (size_t i = 0; i < length; ++i)
+        {
+            hash ^= static_cast<unsigned char>(tag[i]);
+            hash *= 16777619u;
+        }
+        return hash;
+    }
+
+    constexpr size_t tagLength(const char* tag)
+    {
+        size_t length = 0;
+        while (tag[length] != '\0')
+            ++length;
+        return length;
+    }
+
+    constexpr uint32_t hashTag(const char* tag)
+    {
+        return hashTag(tag, tagLength(tag));
+    }
+
+    /////////////////////////////////////////////////////////////////////
+    // field descriptors
+    // - Field      member stored as <tag>value</tag>
+    // - ListField  vector member stored as <tag><itemTag>value</itemTag>...</tag>
+    // - TextField  member stored as the text of the payload element itself;
+    //              tag only names it in the attribute form
+
+    template <typename C, typename M>
+    struct Field
+    {
+        const char* tag;
+        uint32_t hash;
+        M C::* member;
+    };
+
+    template <typename C, typename M>
+    struct ListField
+    {
+        const char* tag;
+        const char* itemTag;
+        uint32_t hash;
+        std::vector<M> C::* member;
+        bool unique;            // items already in the list are not added again
+    };
+
+    template <typename C, typename M>
+    struct TextField
+    {
+        const char* tag;
+        uint32_t hash;
+        M C::* member;
+    };
+
+    template <typename C, typename M>
+    constexpr Field<C, M> field(const char* tag, M C::* member)
+    {
+        return { tag, hashTag(tag), member };
+    }
+
+    template <typename C, typename M>
+    constexpr ListField<C, M> listField(const char* tag, const char* itemTag, std::vector<M> C::* member)
+    {
+        return { tag, itemTag, hashTag(tag), member, false };
+    }
+
+    // a list whose decoded items skip duplicates, as an add method that
+    // checks for the item first would
+    template <typename C, typename M>
+    constexpr ListField<C, M> uniqueListField(const char* tag, const char* itemTag, std::vector<M> C::* member)
+    {
+        return { tag, itemTag, hashTag(tag), member, true };
+    }
+
+    template <typename C, typename M>
+    constexpr TextField<C, M> textField(const char* tag, M C::* member)
+    {
+        return { tag, hashTag(tag), member };
+    }
+
+    /////////////////////////////////////////////////////////////////////
+    // binary helpers
+
+    namespace PayloadBinary
+    {
+        inline void putVarint(std::string& dst, uint64_t value)
+        {
+            while (value >= 0x80)
+            {
+                dst += static_cast<char>((value & 0x7f) | 0x80);
+                value >>= 7;
+            }
+            dst += static_cast<char>(value);
+        }
+
+        inline uint64_t getVarint(const char*& pos, const char* end)
+        {
+            uint64_t value = 0;
+            for (int shift = 0; shift < 64; shift += 7)
+            {
+                if (pos == end)
+                    throw(std::exception("PayloadCodec: truncated binary payload"));
+                unsigned char byte = static_cast<unsigned char>(*pos++);
+                value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+                if ((byte & 0x80) == 0)
+                    return value;
+            }
+            throw(std::exception("PayloadCodec: malformed varint in binary payload"));
+        }
+
+        inline void putBytes(std::string& dst, const std::string& src)
+        {
+            putVarint(dst, src.size());
+            dst += src;
+        }
+
+        inline void getBytes(const char*& pos, const char* end, std::string& dst)
+        {
+            uint64_t length = getVarint(pos, end);
+            if (length > static_cast<uint64_t>(end - pos))
+                throw(std::exception("PayloadCodec: truncated binary payload"));
+            dst.assign(pos, static_cast<size_t>(length));
+            pos += length;
+        }
+    }
+
+    /////////////////////////////////////////////////////////////////////
+    // FieldCodec
+    // - toText returns the text form of a value; scratch is used for
+    //   values which are not already strings so no allocation is needed
+    //   for string members
+    // - fromText, toBinary and fromBinary convert the other ways
+
+    template <typename M, typename Enable = void>
+    struct FieldCodec;
+
+    template <>
+    struct FieldCodec<std::string>
+    {
+        static const std::string& toText(const std::string& value, std::string&) { return value; }
+        static void fromText(const std::string& text, std::string& value) { value = text; }
+        static void toBinary(std::string& dst, const std::string& value) { PayloadBinary::putBytes(dst, value); }
+        static void fromBinary(const char*& pos, const char* end, std::string& value) { PayloadBinary::getBytes(pos, end, value); }
+    };
+
+    template <typename M>
+    struct FieldCodec<M, typename std::enable_if<std::is_integral<M>::value>::type>
+    {
+        static const std::string& toText(const M& value, std::string& scratch)
+        {
+            scratch = std::to_string(value);
+            return scratch;
+        }
+
+        // empty text, e.g. from an empty element or attribute, is 0
+        static void fromText(const std::string& text, M& value)
+        {
+            if (text.empty())
+                value = 0;
+            else if (std::is_signed<M>::value)
+                value = static_cast<M>(std::stoll(text));
+            else
+                value = static_cast<M>(std::stoull(text));
+        }
+
+        // signed values are zigzag encoded so small negatives stay short
+        static void toBinary(std::string& dst, const M& value)
+        {
+            if (std::is_signed<M>::value)
+            {
+                int64_t wide = static_cast<int64_t>(value);
+                PayloadBinary::putVarint(dst, (static_cast<uint64_t>(wide) << 1) ^ static_cast<uint64_t>(wide >> 63));
+            }
+            else
+                PayloadBinary::putVarint(dst, static_cast<uint64_t>(value));
+        }
+
+        static void fromBinary(const char*& pos, const char* end, M& value)
+        {
+            uint64_t raw = PayloadBinary::getVarint(pos, end);
+            if (std::is_signed<M>::value)
+                value = static_cast<M>(static_cast<int64_t>(raw >> 1) ^ -static_cast<int64_t>(raw & 1));
+            else
+                value = static_cast<M>(raw);
+        }
+    };
+
+    /////////////////////////////////////////////////////////////////////
+    // schema checks
+
+    template <typename Schema, size_t... I>
+    constexpr bool distinctTags(const Schema& schema, std::index_sequence<I...>)
+    {
+        // leading 0 keeps the array non-empty for an empty schema
+        const uint32_t hashes[] = { 0u, std::get<I>(schema).hash... };
+        for (size_t i = 1; i < sizeof(hashes) / sizeof(hashes[0]); ++i)
+            for (size_t j = i + 1; j < sizeof(hashes) / sizeof(hashes[0]); ++j)
+                if (hashes[i] == hashes[j])
+                    return false;
+        return true;
+    }
+
+    template <typename Schema>
+    constexpr bool distinctTags(const Schema& schema)
+    {
+        return distinctTags(schema, std::make_index_sequence<std::tuple_size<Schema>::value>());
+    }
+
+    /////////////////////////////////////////////////////////////////////
+    // PayloadCodec
+    // - conversions for a payload type T which provides schema()
+
+    template <typename T>
+    class PayloadCodec
+    {
+    public:
+        using Sptr = typename IPayload<T>::Sptr;
+
+        static Sptr toXmlElement(const T& payload);
+        static void writeXml(const T& payload, XmlProcessing::XmlWriter& writer);
+        static T fromXmlElement(Sptr pPayloadElem);
+        static T fromXmlNode(const XmlProcessing::XmlNode& payloadNode);
+
+        static void toBinary(const T& payload, std::string& dst);
+        static T fromBinary(const std::string& bytes);
+
+        static void toAttributes(const T& payload, PayloadAttributes& attributes, const std::string& prefix = "");
+        static T fromAttributes(const PayloadAttributes& attributes, const std::string& prefix = "");
+
+    private:
+        static constexpr auto schema()
+        {
+            constexpr auto fields = T::schema();
+            static_assert(distinctTags(fields), "PayloadCodec: two fields of the schema have the same tag hash");
+            return fields;
+        }
+
+        static std::string childText(const Sptr& pElem);
+        template <typename M> static void addItem(const ListField<T, M>& field, std::vector<M>& items, M&& item);
+
+        template <typename M> static void addElement(const Field<T, M>& field, const T& payload, const Sptr& pPayload, std::string& scratch);
+        template <typename M> static void addElement(const ListField<T, M>& field, const T& payload, const Sptr& pPayload, std::string& scratch);
+        template <typename M> static void addElement(const TextField<T, M>& field, const T& payload, const Sptr& pPayload, std::string& scratch);
+
+        template <typename M> static void write(const Field<T, M>& field, const T& payload, XmlProcessing::XmlWriter& writer, std::string& scratch);
+        template <typename M> static void write(const ListField<T, M>& field, const T& payload, XmlProcessing::XmlWriter& writer, std::string& scratch);
+        template <typename M> static void write(const TextField<T, M>& field, const T& payload, XmlProcessing::XmlWriter& writer, std::string& scratch);
+
+        template <typename M> static bool read(const Field<T, M>& field, uint32_t hash, const std::string& tag, const Sptr& pChild, T& payload);
+        template <typename M> static bool read(const ListField<T, M>& field, uint32_t hash, const std::string& tag, const Sptr& pChild, T& payload);
+        template <typename M> static bool read(const TextField<T, M>& field, uint32_t hash, const std::string& tag, const Sptr& pChild, T& payload);
+
+        using Node = XmlProcessing::XmlNode;
+        template <typename M> static bool read(const Field<T, M>& field, uint32_t hash, const Node& child, T& payload, std::string& scratch);
+        template <typename M> static bool read(const ListField<T, M>& field, uint32_t hash, const Node& child, T& payload, std::string& scratch);
+        template <typename M> static bool read(const TextField<T, M>& field, uint32_t hash, const Node& child, T& payload, std::string& scratch);
+
+        template <typename M> static void putBinary(const Field<T, M>& field, const T& payload, std::string& dst);
+        template <typename M> static void putBinary(const ListField<T, M>& field, const T& payload, std::string& dst);
+        template <typename M> static void putBinary(const TextField<T, M>& field, const T& payload, std::string& dst);
+
+        template <typename M> static void getBinary(const Field<T, M>& field, const char*& pos, const char* end, T& payload);
+        template <typename M> static void getBinary(const ListField<T, M>& field, const char*& pos, const char* end, T& payload);
+        template <typename M> static void getBinary(const TextField<T, M>& field, const char*& pos, const char* end, T& payload);
+
+        template <typename M> static void putAttributes(const Field<T, M>& field, const T& payload, PayloadAttributes& attributes, const std::string& prefix);
+        template <typename M> static void putAttributes(const ListField<T, M>& field, const T& payload, PayloadAttributes& attributes, const std::string& prefix);
+        template <typename M> static void putAttributes(const TextField<T, M>& field, const T& payload, PayloadAttributes& attributes, const std::string& prefix);
+
+        template <typename M> static void getAttributes(const Field<T, M>& field, const PayloadAttributes& attributes, const std::string& prefix, T& payload);
+        template <typename M> static void getAttributes(const ListField<T, M>& field, const PayloadAttributes& attributes, const std::string& prefix, T& payload);
+        template <typename M> static void getAttributes(const TextField<T, M>& field, const PayloadAttributes& attributes, const std::string& prefix, T& payload);
+    };
+
+    /////////////////////////////////////////////////////////////////////
+    // SchemaPayload
+    // - IPayload implemented from the payload's schema
+
+    template <typename T>
+    class SchemaPayload : public IPayload<T>
+    {
+    public:
+        using Sptr = typename IPayload<T>::Sptr;
+
+        virtual Sptr toXmlElement() override { return PayloadCodec<T>::toXmlElement(self()); }
+        virtual void writeXml(XmlProcessing::XmlWriter& writer) const override { PayloadCodec<T>::writeXml(self(), writer); }
+        static T fromXmlElement(Sptr pPayloadElem) { return PayloadCodec<T>::fromXmlElement(pPayloadElem); }
+        static T fromXmlNode(const XmlProcessing::XmlNode& payloadNode) { return PayloadCodec<T>::fromXmlNode(payloadNode); }
+
+        std::string toBinary() const
+        {
+            std::string bytes;
+            PayloadCodec<T>::toBinary(self(), bytes);
+            return bytes;
+        }
+        static T fromBinary(const std::string& bytes) { return PayloadCodec<T>::fromBinary(bytes); }
+
+        void toAttributes(PayloadAttributes& attributes, const std::string& prefix = "") const
+        {
+            PayloadCodec<T>::toAttributes(self(), attributes, prefix);
+        }
+        static T fromAttributes(const PayloadAttributes& attributes, const std::string& prefix = "")
+        {
+            return PayloadCodec<T>::fromAttributes(attributes, prefix);
+        }
+
+    private:
+        const T& self() const { return static_cast<const T&>(*this); }
+    };
+
+    /////////////////////////////////////////////////////////////////////
+    // PayloadCodec methods
+
+    //----< text of an element's first child, empty if it has none >---------------------
+
+    template <typename T>
+    std::string PayloadCodec<T>::childText(const Sptr& pElem)
+    {
+        std::vector<Sptr> children = pElem->children();
+        return children.empty() ? std::string() : children[0]->value();
+    }
+
+    //----< appends a decoded item to a list field, unless it is unique and already there >---------------------
+
+    template <typename T>
+    template <typename M>
+    void PayloadCodec<T>::addItem(const ListField<T, M>& field, std::vector<M>& items, M&& item)
+    {
+        if (field.unique && std::find(items.begin(), items.end(), item) != items.end())
+            return;
+        items.push_back(std::move(item));
+    }
+
+    //----< converts the payload to an xml element >---------------------
+
+    template <typename T>
+    typename PayloadCodec<T>::Sptr PayloadCodec<T>::toXmlElement(const T& payload)
+    {
+        Sptr pPayload = XmlProcessing::makeTaggedElement("payload");
+        std::string scratch;
+        std::apply([&](const auto&... field) { (addElement(field, payload, pPayload, scratch), ...); }, schema());
+        return pPayload;
+    }
+
+    template <typename T>
+    template <typename M>
+    void PayloadCodec<T>::addElement(const Field<T, M>& field, const T& payload, const Sptr& pPayload, std::string& scratch)
+    {
+        pPayload->addChild(XmlProcessing::makeTaggedElement(field.tag, FieldCodec<M>::toText(payload.*field.member, scratch)));
+    }
+
+    template <typename T>
+    template <typename M>
+    void PayloadCodec<T>::addElement(const ListField<T, M>& field, const T& payload, const Sptr& pPayload, std::string& scratch)
+    {
+        Sptr pList = XmlProcessing::makeTaggedElement(field.tag);
+        for (const M& item : payload.*field.member)
+            pList->addChild(XmlProcessing::makeTaggedElement(field.itemTag, FieldCodec<M>::toText(item, scratch)));
+        pPayload->addChild(pList);
+    }
+
+    template <typename T>
+    template <typename M>
+    void PayloadCodec<T>::addElement(const TextField<T, M>& field, const T& payload, const Sptr& pPayload, std::string& scratch)
+    {
+        const std::string& text = FieldCodec<M>::toText(payload.*field.member, scratch);
+        if (!text.empty())
+            pPayload->addChild(XmlProcessing::makeTextElement(text));
+    }
+
+    //----< writes the payload to an xml writer >---------------------
+
+    template <typename T>
+    void PayloadCodec<T>::writeXml(const T& payload, XmlProcessing::XmlWriter& writer)
+    {
+        writer.startElement("payload");
+        std::string scratch;
+        std::apply([&](const auto&... field) { (write(field, payload, writer, scratch), ...); }, schema());
+        writer.endElement();
+    }
+
+    template <typename T>
+    template <typename M>
+    void PayloadCodec<T>::write(const Field<T, M>& field, const T& payload, XmlProcessing::XmlWriter& writer, std::string& scratch)
+    {
+        writer.element(field.tag, FieldCodec<M>::toText(payload.*field.member, scratch));
+    }
+
+    template <typename T>
+    template <typename M>
+    void PayloadCodec<T>::write(const ListField<T, M>& field, const T& payload, XmlProcessing::XmlWriter& writer, std::string& scratch)
+    {
+        writer.startElement(field.tag);
+        for (const M& item : payload.*field.member)
+            writer.element(field.itemTag, FieldCodec<M>::toText(item, scratch));
+        writer.endElement();
+    }
+
+    template <typename T>
+    template <typename M>
+    void PayloadCodec<T>::write(const TextField<T, M>& field, const T& payload, XmlProcessing::XmlWriter& writer, std::string& scratch)
+    {
+        writer.text(FieldCodec<M>::toText(payload.*field.member, scratch));
+    }
+
+    //----< constructs the payload from an xml element >---------------------
+    /*
+    *  - each child's tag is hashed once; the unrolled field loop stops at
+    *    the first field which takes the child
+    *  - children with unknown tags are ignored
+    */
+    template <typename T>
+    T PayloadCodec<T>::fromXmlElement(Sptr pPayloadElem)
+    {
+        T payload;
+        std::vector<Sptr> children = pPayloadElem->children();
+        for (const Sptr& pChild : children)
+        {
+            const std::string tag = pChild->tag();
+            const uint32_t hash = hashTag(tag.data(), tag.size());
+            std::apply([&](const auto&... field) { (read(field, hash, tag, pChild, payload) || ...); }, schema());
+        }
+        return payload;
+    }
+
+    template <typename T>
+    template <typename M>
+    bool PayloadCodec<T>::read(const Field<T, M>& field, uint32_t hash, const std::string& tag, const Sptr& pChild, T& payload)
+    {
+        if (hash != field.hash || tag != field.tag)
+            return false;
+        std::vector<Sptr> children = pChild->children();
+        if (!children.empty())
+            FieldCodec<M>::fromText(children[0]->value(), payload.*field.member);
+        return true;
+    }
+
+    template <typename T>
+    template <typename M>
+    bool PayloadCodec<T>::read(const ListField<T, M>& field, uint32_t hash, const std::string& tag, const Sptr& pChild, T& payload)
+    {
+        if (hash != field.hash || tag != field.tag)
+            return false;
+        std::vector<M>& items = payload.*field.member;
+        std::vector<Sptr> children = pChild->children();
+        items.reserve(items.size() + children.size());
+        for (const Sptr& pItem : children)
+        {
+            M item{};
+            FieldCodec<M>::fromText(childText(pItem), item);
+            addItem(field, items, std::move(item));
+        }
+        return true;
+    }
+
+    template <typename T>
+    template <typename M>
+    bool PayloadCodec<T>::read(const TextField<T, M>& field, uint32_t, const std::string& tag, const Sptr& pChild, T& payload)
+    {
+        // text children have no tag
+        if (!tag.empty())
+            return false;
+        FieldCodec<M>::fromText(pChild->value(), payload.*field.member);
+        return true;
+    }
+
+    //----< constructs the payload from an arena document node >---------------------
+    /*
+    *  - same dispatch as fromXmlElement; children are walked in place and
+    *    text reaches FieldCodec through one reused string
+    */
+    template <typename T>
+    T PayloadCodec<T>::fromXmlNode(const XmlProcessing::XmlNode& payloadNode)
+    {
+        T payload;
+        std::string scratch;
+        for (const Node& child : payloadNode.children())
+        {
+            const std::string_view tag = child.tag();
+            const uint32_t hash = hashTag(tag.data(), tag.size());
+            std::apply([&](const auto&... field) { (read(field, hash, child, payload, scratch) || ...); }, schema());
+        }
+        return payload;
+    }
+
+    template <typename T>
+    template <typename M>
+    bool PayloadCodec<T>::read(const Field<T, M>& field, uint32_t hash, const Node& child, T& payload, std::string& scratch)
+    {
+        if (hash != field.hash || child.tag() != field.tag)
+            return false;
+        if (child.firstChild() != nullptr)
+        {
+            scratch.assign(child.firstChild()->value());
+            FieldCodec<M>::fromText(scratch, payload.*field.member);
+        }
+        return true;
+    }
+
+    template <typename T>
+    template <typename M>
+    bool PayloadCodec<T>::read(const ListField<T, M>& field, uint32_t hash, const Node& child, T& payload, std::string& scratch)
+    {
+        if (hash != field.hash || child.tag() != field.tag)
+            return false;
+        std::vector<M>& items = payload.*field.member;
+        for (const Node& itemNode : child.children())
+        {
+            M item{};
+            scratch.assign(itemNode.childText());
+            FieldCodec<M>::fromText(scratch, item);
+            addItem(field, items, std::move(item));
+        }
+        return true;
+    }
+
+    template <typename T>
+    template <typename M>
+    bool PayloadCodec<T>::read(const TextField<T, M>& field, uint32_t, const Node& child, T& payload, std::string& scratch)
+    {
+        if (child.kind() != Node::text)
+            return false;
+        scratch.assign(child.value());
+        FieldCodec<M>::fromText(scratch, payload.*field.member);
+        return true;
+    }
+
+    //----< appends the binary form of the payload to dst >---------------------
+
+    template <typename T>
+    void PayloadCodec<T>::toBinary(const T& payload, std::string& dst)
+    {
+        PayloadBinary::putVarint(dst, std::tuple_size<decltype(schema())>::value);
+        std::apply([&](const auto&... field) { (putBinary(field, payload, dst), ...); }, schema());
+    }
+
+    template <typename T>
+    template <typename M>
+    void PayloadCodec<T>::putBinary(const Field<T, M>& field, const T& payload, std::string& dst)
+    {
+        FieldCodec<M>::toBinary(dst, payload.*field.member);
+    }
+
+    template <typename T>
+    template <typename M>
+    void PayloadCodec<T>::putBinary(const ListField<T, M>& field, const T& payload, std::string& dst)
+    {
+        const std::vector<M>& items = payload.*field.member;
+        PayloadBinary::putVarint(dst, items.size());
+        for (const M& item : items)
+            FieldCodec<M>::toBinary(dst, item);
+    }
+
+    template <typename T>
+    template <typename M>
+    void PayloadCodec<T>::putBinary(const TextField<T, M>& field, const T& payload, std::string& dst)
+    {
+        FieldCodec<M>::toBinary(dst, payload.*field.member);
+    }
+
+    //----< constructs the payload from its binary form >---------------------
+    /*
+    *  - throws if the data is truncated, or has more fields than the schema
+    *    or bytes left over
+    */
+    template <typename T>
+    T PayloadCodec<T>::fromBinary(const std::string& bytes)
+    {
+        T payload;
+        const char* pos = bytes.data();
+        const char* end = pos + bytes.size();
+        uint64_t count = PayloadBinary::getVarint(pos, end);
+        if (count > std::tuple_size<decltype(schema())>::value)
+            throw(std::exception("PayloadCodec: binary payload has more fields than the schema"));
+
+        uint64_t index = 0;
+        std::apply([&](const auto&... field) {
+            ((index++ < count ? getBinary(field, pos, end, payload) : void()), ...);
+        }, schema());
+
+        if (pos != end)
+            throw(std::exception("PayloadCodec: unexpected bytes after binary payload"));
+        return payload;
+    }
+
+    template <typename T>
+    template <typename M>
+    void PayloadCodec<T>::getBinary(const Field<T, M>& field, const char*& pos, const char* end, T& payload)
+    {
+        FieldCodec<M>::fromBinary(pos, end, payload.*field.member);
+    }
+
+    template <typename T>
+    template <typename M>
+    void PayloadCodec<T>::getBinary(const ListField<T, M>& field, const char*& pos, const char* end, T& payload)
+    {
+        uint64_t count = PayloadBinary::getVarint(pos, end);
+        // every item takes at least one byte, so a bad count can't force a huge reserve
+        if (count > static_cast<uint64_t>(end - pos))
+            throw(std::exception("PayloadCodec: truncated binary payload"));
+        std::vector<M>& items = payload.*field.member;
+        items.clear();
+        items.reserve(static_cast<size_t>(count));
+        for (uint64_t i = 0; i < count; ++i)
+        {
+            M item{};
+            FieldCodec<M>::fromBinary(pos, end, item);
+            addItem(field, items, std::move(item));
+        }
+    }
+
+    template <typename T>
+    template <typename M>
+    void PayloadCodec<T>::getBinary(const TextField<T, M>& field, const char*& pos, const char* end, T& payload)
+    {
+        FieldCodec<M>::fromBinary(pos, end, payload.*field.member);
+    }
+
+    //----< adds the payload's fields to a set of attributes >---------------------
+
+    template <typename T>
+    void PayloadCodec<T>::toAttributes(const T& payload, PayloadAttributes& attributes, const std::string& prefix)
+    {
+        std::apply([&](const auto&... field) { (putAttributes(field, payload, attributes, prefix), ...); }, schema());
+    }
+
+    template <typename T>
+    template <typename M>
+    void PayloadCodec<T>::putAttributes(const Field<T, M>& field, const T& payload, PayloadAttributes& attributes, const std::string& prefix)
+    {
+        std::string scratch;
+        attributes[prefix + field.tag] = FieldCodec<M>::toText(payload.*field.member, scratch);
+    }
+
+    template <typename T>
+    template <typename M>
+    void PayloadCodec<T>::putAttributes(const ListField<T, M>& field, const T& payload, PayloadAttributes& attributes, const std::string& prefix)
+    {
+        const std::vector<M>& items = payload.*field.member;
+        const std::string name = prefix + field.tag;
+        std::string scratch;
+        attributes[name] = std::to_string(items.size());
+        for (size_t i = 0; i < items.size(); ++i)
+            attributes[name + "." + std::to_string(i)] = FieldCodec<M>::toText(items[i], scratch);
+    }
+
+    template <typename T>
+    template <typename M>
+    void PayloadCodec<T>::putAttributes(const TextField<T, M>& field, const T& payload, PayloadAttributes& attributes, const std::string& prefix)
+    {
+        std::string scratch;
+        attributes[prefix + field.tag] = FieldCodec<M>::toText(payload.*field.member, scratch);
+    }
+
+    //----< constructs the payload from a set of attributes >---------------------
+    /*
+    *  - fields without an attribute keep their default value
+    */
+    template <typename T>
+    T PayloadCodec<T>::fromAttributes(const PayloadAttributes& attributes, const std::string& prefix)
+    {
+        T payload;
+        std::apply([&](const auto&... field) { (getAttributes(field, attributes, prefix, payload), ...); }, schema());
+        return payload;
+    }
+
+    template <typename T>
+    template <typename M>
+    void PayloadCodec<T>::getAttributes(const Field<T, M>& field, const PayloadAttributes& attributes, const std::string& prefix, T& payload)
+    {
+        auto found = attributes.find(prefix + field.tag);
+        if (found != attributes.end())
+            FieldCodec<M>::fromText(found->second, payload.*field.member);
+    }
+
+    template <typename T>
+    template <typename M>
+    void PayloadCodec<T>::getAttributes(const ListField<T, M>& field, const PayloadAttributes& attributes, const std::string& prefix, T& payload)
+    {
+        const std::string name = prefix + field.tag;
+        auto found = attributes.find(name);
+        if (found == attributes.end())
+            return;
+        size_t count = std::stoul(found->second);
+        std::vector<M>& items = payload.*field.member;
+        items.clear();
+        for (size_t i = 0; i < count; ++i)
+        {
+            auto item = attributes.find(name + "." + std::to_string(i));
+            if (item == attributes.end())
+                throw(std::exception("PayloadCodec: list attribute is missing an item"));
+            M value{};
+            FieldCodec<M>::fromText(item->second, value);
+            addItem(field, items, std::move(value));
+        }
+    }
+
+    template <typename T>
+    template <typename M>
+    void PayloadCodec<T>::getAttributes(const TextField<T, M>& field, const PayloadAttributes& attributes, const std::string& prefix, T& payload)
+    {
+        auto found = attributes.find(prefix + field.tag);
+        if (found != attributes.end())
+            FieldCodec<M>::fromText(found->second, payload.*field.member);
+    }
+}
+
+#endif // !PAYLOAD_SCHEMA_H
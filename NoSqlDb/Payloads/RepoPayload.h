@@ -1,7 +1,7 @@
 #pragma once
 /////////////////////////////////////////////////////////////////////////////////
 // RepoPayload.h - Implements payload type for the Project#2 repository        //
-// ver 1.1                                                                     //
+// ver 1.3                                                                     //
 // Language:    C++, Visual Studio 2017                                        //
 // Application: NoSqlDb, CSE687 - Object Oriented Design                       //
 // Author:      Ritesh Nair (rgnair@syr.edu)                                   //
@@ -19,6 +19,10 @@
 *
 * Maintenance History:
 * --------------------
+* ver 1.3 : 19 Oct 2026
+* - conversions are generated from schema()
+* ver 1.2 : 19 Oct 2026
+* - writes itself straight to an XmlWriter
 * ver 1.1 : 16 Apr 2018
 * - implements IPayload interface so that it is comptible for use with DbCore
 * ver 1.0 : 08 Feb 2018
@@ -28,7 +32,7 @@
 #ifndef REPO_PAYLOAD_H
 #define REPO_PAYLOAD_H
 
-#include "IPayload.h"
+#include "PayloadSchema.h"
 
 #include <iostream>
 #include <iterator>
@@ -43,8 +47,9 @@ namespace Repository {
     // - Provides a NoSqlDb Payload that can hold the File Path and a 
     //   list of categories for the file which will be stored in the 
     //   database.
+    // - XML, binary and attribute forms are generated from schema()
 
-    class RepoPayload : public NoSqlDb::IPayload<RepoPayload> {
+    class RepoPayload : public NoSqlDb::SchemaPayload<RepoPayload> {
     public:
         using FilePath = std::string;
         using Category = std::string;
@@ -61,12 +66,19 @@ namespace Repository {
 
         virtual std::string toString() override { return toString(); }
 
-        virtual NoSqlDb::IPayload<RepoPayload>::Sptr toXmlElement() override;
-        static RepoPayload fromXmlElement(NoSqlDb::IPayload<RepoPayload>::Sptr pPayloadElem);
-
         friend std::ostream& operator<<(std::ostream& os, const RepoPayload& payload);
 
     private:
+        friend class NoSqlDb::PayloadCodec<RepoPayload>;
+
+        static constexpr auto schema()
+        {
+            return std::make_tuple(
+                NoSqlDb::field("filepath", &RepoPayload::filePath_),
+                NoSqlDb::listField("categories", "category", &RepoPayload::categories_)
+            );
+        }
+
         FilePath filePath_;
         Categories categories_;
 
@@ -1,7 +1,7 @@
 #pragma once
 /////////////////////////////////////////////////////////////////////////////////
 // StringPayload.h - Implements payload type for string-only payloads          //
-// ver 1.0                                                                     //
+// ver 1.3                                                                     //
 // Language:    C++, Visual Studio 2017                                        //
 // Application: NoSqlDb, CSE687 - Object Oriented Design                       //
 // Author:      Ritesh Nair (rgnair@syr.edu)                                   //
@@ -18,6 +18,12 @@
 *
 * Maintenance History:
 * --------------------
+* ver 1.3 : 19 Oct 2026
+* - conversions are generated from schema()
+* ver 1.2 : 19 Oct 2026
+* - writes itself straight to an XmlWriter
+* ver 1.1 : 19 Oct 2026
+* - added payloadBytes for footprint reporting
 * ver 1.0 : 16 Apr 2018
 * - first release
 */
@@ -25,15 +31,16 @@
 #ifndef STRINGPAYLOAD_H
 #define STRINGPAYLOAD_H
 
-#include "IPayload.h"
+#include "PayloadSchema.h"
 
 namespace NoSqlDb
 {
     /////////////////////////////////////////////////////////////////////
     // StringPayload class
     // - Provides a NoSqlDb Payload that can hold a std::string object
+    // - the string is the text of the payload element
 
-    class StringPayload : public IPayload<StringPayload>
+    class StringPayload : public SchemaPayload<StringPayload>
     {
     public:
         StringPayload() {}
@@ -45,15 +52,25 @@ namespace NoSqlDb
 
         virtual std::string toString() override { return value_; }
 
-        virtual IPayload<StringPayload>::Sptr toXmlElement() override;
-        static StringPayload fromXmlElement(IPayload<StringPayload>::Sptr pPayloadElem);
-
         friend std::ostream& operator<<(std::ostream& os, const StringPayload& payload)
         {
             return os << payload.value();
         };
 
+        // bytes held by the payload, used by DbCore<T>::footprint()
+        friend size_t payloadBytes(const StringPayload& payload)
+        {
+            return sizeof(payload) + payload.value_.capacity();
+        }
+
     private:
+        friend class PayloadCodec<StringPayload>;
+
+        static constexpr auto schema()
+        {
+            return std::make_tuple(textField("value", &StringPayload::value_));
+        }
+
         std::string value_;
     };
 }
@@ -1,7 +1,7 @@
 #pragma once
 ///////////////////////////////////////////////////////////////////////
 // TestRepoPayload.h - Implements all test cases for RepoPayload     //
-// ver 1.2                                                           //
+// ver 1.3                                                           //
 // Language:    C++, Visual Studio 2017                              //
 // Application: NoSqlDb, CSE687 - Object Oriented Design             //
 // Author:      Ritesh Nair (rgnair@syr.edu)                         //
@@ -22,6 +22,8 @@
 *
 * Maintenance History:
 * --------------------
+* ver 1.3 : 19 Oct 2026
+* - added test9a for schema generated payload conversions
 * ver 1.2 : 15 Apr 2018
 * - Moved implementation into cpp file
 * ver 1.1 : 10 Feb 2018
@@ -47,6 +49,17 @@ namespace NoSqlDbTests
         test9(AbstractTest::TestTitle title) : AbstractTest(title) {};
         virtual bool operator()();
     };
+
+    /////////////////////////////////////////////////////////////////////
+    // test9a functor
+    // - Implements test case for the conversions generated from a payload schema
+
+    class test9a : public TestCore::AbstractTest
+    {
+    public:
+        test9a(AbstractTest::TestTitle title) : AbstractTest(title) {};
+        virtual bool operator()();
+    };
 }
 
 #endif // !TEST_REPO_PAYLOAD_H
@@ -1,7 +1,7 @@
 #pragma once
 ///////////////////////////////////////////////////////////////////////
 // Persistence.h - Implements the persistence layer for NoSqlDb       //
-// ver 1.2                                                           //
+// ver 2.6                                                           //
 // Language:    C++, Visual Studio 2017                              //
 // Application: NoSqlDb, CSE687 - Object Oriented Design             //
 // Author:      Ritesh Nair (rgnair@syr.edu)                         //
@@ -14,6 +14,31 @@
 * - Persistence is an implementation of IPersistence interface which, as per the contract,
     provides an API to exports selected DB records to a file. It also provides an API to 
     restore/augment DB records from a file.
+* - Imports are streamed by default: records are read with XmlStreamReader and each one
+    is added to the db as soon as its </record> tag is read, so memory use does not grow
+    with the size of the shard. importMode(dom) restores the original behavior of
+    building an XmlDocument for the whole shard first; as XmlParser keeps text as it
+    was written, the entity references made by the export are decoded per record.
+* - Exports are written record by record with XmlWriter, straight from the db into a
+    buffered stream, without building an XmlDocument or copying any DbElement.
+* - With shards(N), N > 1, exportDb splits the records by key hash over N shard files
+    which are written in parallel, and writes a manifest listing them to the requested
+    path. importDb recognizes a manifest and reads its shard files in parallel, each
+    into its own staging db with the configured import mode. The staging dbs are
+    merged into the db only once every shard file has been read, so a failed import
+    changes nothing. A shard file is an ordinary single file export and can be
+    imported on its own. When an export replaces a manifest, the shard files that
+    manifest listed and the new export does not overwrite are deleted; no other
+    file is.
+* - With lazyPayLoads(true), imports decode keys and metadata but keep each payload as
+    its XML text; DbElement<T>::payLoad() decodes it the first time it is called.
+    An export writes a payload that was never decoded back out as that text.
+* - importMode(arena) maps the shard file and parses it into an XmlArenaDocument,
+    walking each record in place; a lazy payload is the slice of the file holding it.
+* - importMode(parallel) maps the shard file, finds the byte range of each record with
+    XmlParallelParser and parses the records on importThreads() worker threads.  The
+    decoded records are merged into the db in file order, so the result is the same
+    as that of a streamed import whatever the number of threads.
 
 * Required Files:
 * ---------------
@@ -21,9 +46,48 @@
 * DateTime.h, DateTime.cpp
 * XmlDocument.h, XmlDocument.cpp
 * XmlElement.h, XmlElement.cpp
+* XmlStreamReader.h, XmlStreamReader.cpp
+* XmlWriter.h, XmlWriter.cpp
+* XmlArena.h, XmlArena.cpp, XmlViewParser.h, XmlViewParser.cpp
+* XmlParallelParser.h, XmlParallelParser.cpp
 *
 * Maintenance History:
 * --------------------
+* ver 2.6 : 19 Oct 2026
+* - writeRecord takes a const element and writes a still encoded payload as it
+*   was read, so exporting a lazily imported db decodes nothing
+* ver 2.5 : 19 Oct 2026
+* - exports only delete shard files listed by the manifest they replace,
+*   never files matched by name
+* - sharded imports merge the staging dbs once every shard file is read
+* ver 2.4 : 19 Oct 2026
+* - decodePayLoad throws on ill-formed payload XML instead of returning a default payload
+* ver 2.3 : 19 Oct 2026
+* - exports delete the shard files of an earlier sharded export that the new one
+*   does not overwrite
+* - manifest imports read each shard file with the configured import mode
+* ver 2.2 : 19 Oct 2026
+* - dom imports decode the entity references written by exports
+* ver 2.1 : 19 Oct 2026
+* - added parallel import mode, which parses the records of a shard on worker threads
+* ver 2.0 : 19 Oct 2026
+* - dom imports query the shard through the XmlDocument tag index
+* ver 1.9 : 19 Oct 2026
+* - added arena import mode
+* ver 1.8 : 19 Oct 2026
+* - added lazy payload decoding on import
+* ver 1.7 : 19 Oct 2026
+* - added sharded export and import over multiple files
+* ver 1.6 : 19 Oct 2026
+* - exportDb and exportDbToString stream records through XmlWriter
+* - text and attribute values are escaped on export
+* ver 1.5 : 19 Oct 2026
+* - added streaming import mode, used by default by importDb and importDbFromString
+* ver 1.4 : 19 Oct 2026
+* - added exportDbToString and importDbFromString for shipping records
+*   without going through a file
+* ver 1.3 : 19 Oct 2026
+* - imported records are added with DbCore::add so they show up in the db change stream
 * ver 1.2 : 16 Apr 2018
 * - restricts Payload to be of type IPayload
 * - uses the interface's methods to serialize the payload to and from XML
@@ -40,13 +104,28 @@
 #include "../DbCore/DbCore.h"
 #include "../XmlDocument/XmlDocument/XmlDocument.h"
 #include "../XmlDocument/XmlElement/XmlElement.h"
+#include "../XmlDocument/XmlStreamReader/XmlStreamReader.h"
+#include "../XmlDocument/XmlWriter/XmlWriter.h"
+#include "../XmlDocument/XmlArena/XmlArena.h"
+#include "../XmlDocument/XmlParallelParser/XmlParallelParser.h"
 
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <exception>
 #include <fstream>
+#include <functional>
+#include <mutex>
+#include <sstream>
 #include <string>
+#include <string_view>
+#include <thread>
 #include <vector>
 
 const std::string DEFAULT_SHARD_NAME = "New Shard";
 const bool DEFAULT_PRESERVE_ORIGINAL = true;
+const size_t DEFAULT_SHARD_COUNT = 1;
+const bool DEFAULT_LAZY_PAYLOADS = false;
 
 namespace NoSqlDb {
 
@@ -92,6 +171,12 @@ namespace NoSqlDb {
     //          ...
     //      </shard>
     // - Supported datetime format (example: Tue Feb  6 02:32:54 2018)
+    // - A sharded export writes the manifest below to the requested path and the
+    //   records to <name>.<i>.xml files, in the format above, next to it
+    //      <manifest name="SHARD_NAME" shards="N">
+    //          <shardfile records="COUNT">NAME.0.xml</shardfile>
+    //          ...
+    //      </manifest>
 
     template <typename T>
     class Persistence: public IPersistence<T>
@@ -103,33 +188,162 @@ namespace NoSqlDb {
         using Keys = std::vector<Key>;
         using Sptr = std::shared_ptr<XmlProcessing::AbstractXmlElement>;
 
+        // dom: parse the whole shard into an XmlDocument, then save its records;
+        //      the document's tag index answers the shard and record queries
+        // streaming: save each record as soon as it has been read
+        // arena: parse the whole shard in place into an XmlArenaDocument, then save its records
+        // parallel: parse the records of the shard on several threads, then save them in order
+        enum ImportMode { dom, streaming, arena, parallel };
+
     private:
         DbCore<T>& db_;
         ShardName shardName_ = DEFAULT_SHARD_NAME;
+        ImportMode importMode_ = streaming;
+        size_t shards_ = DEFAULT_SHARD_COUNT;
+        bool lazyPayLoads_ = DEFAULT_LAZY_PAYLOADS;
+        size_t importThreads_ = 0;
+
+        // builds the AST of each record; with lazy payloads the <payload>
+        // element is kept as XML text instead of being added to the AST
+        class RecordHandler : public XmlProcessing::XmlStreamHandler
+        {
+        public:
+            using Callback = std::function<void(Sptr pRecord, const std::string& encodedPayLoad)>;
+
+            RecordHandler(bool capturePayLoad, Callback callback)
+                : records_("record", [this](Sptr pRecord) { callback_(pRecord, encoded_); encoded_.clear(); }),
+                capture_(capturePayLoad), callback_(callback) {}
+
+            void startElement(const std::string& tag, const Attribs& attribs) override;
+            void endElement(const std::string& tag) override;
+            void text(const std::string& text) override;
+            const std::string& rootTag() const { return records_.rootTag(); }
+
+        private:
+            XmlProcessing::XmlSubtreeHandler records_;
+            bool capture_;
+            Callback callback_;
+            size_t depth_ = 0;
+            std::string encoded_;
+        };
 
         DbElement<T> createDbElement(std::vector<Sptr> pValue) const;
         DbElementMetadata createDbElementMetadata(std::vector<Sptr> pMetadata) const;
-        XmlProcessing::XmlDocument makeXml(const Keys& keys, ShardName shardName) const;
-        Keys parseXmlAndSaveToDb(const FilePath& filePath, bool preserverOriginal) const;
-        Key saveRecordToDb(std::vector<Sptr> pXmlElem, bool preserverOriginal) const;
+        DbElement<T> createDbElement(const XmlProcessing::XmlNode& value, std::string_view xml) const;
+        DbElementMetadata createDbElementMetadata(const XmlProcessing::XmlNode& metadata) const;
+        void forEachRecord(const XmlProcessing::XmlArenaDocument& doc,
+            std::function<void(const Key& key, const XmlProcessing::XmlNode* pValue)> save) const;
+        Keys arenaXmlAndSaveToDb(std::string_view xml, bool preserveOriginal) const;
+        Keys parallelXmlAndSaveToDb(std::string_view xml, bool preserveOriginal) const;
+        void writeXml(const Keys& keys, XmlProcessing::XmlWriter& writer) const;
+        void writeRecord(const Key& dbKey, const DbElement<T>& element, XmlProcessing::XmlWriter& writer) const;
+        Keys parseXmlAndSaveToDb(XmlProcessing::XmlDocument& xmlDoc, bool preserverOriginal) const;
+        static Sptr decodeEntities(Sptr pElem);
+        Keys streamXmlAndSaveToDb(std::istream& in, bool preserveOriginal) const;
+        Key saveRecordToDb(std::vector<Sptr> pXmlElem, bool preserverOriginal,
+            const std::string& encodedPayLoad = "") const;
+        static T decodePayLoad(const std::string& xml);
         bool validateXml(XmlProcessing::XmlDocument* xmlDoc) const;
-        bool writeXmlToFile(const FilePath& filePath, XmlProcessing::XmlDocument xmlDoc) const;
+        bool writeXmlToFile(const FilePath& filePath, const Keys& keys) const;
+        bool isManifest(const FilePath& filePath) const;
+        bool exportShards(const Keys& keys, const FilePath& manifestPath) const;
+        Keys importShards(const FilePath& manifestPath, bool preserveOriginal) const;
+        std::vector<std::string> manifestFiles(const FilePath& manifestPath) const;
+        static void removeShardFiles(const FilePath& manifestPath, const std::vector<std::string>& stale,
+            const std::vector<std::string>& keep = {});
+        static void runParallel(size_t tasks, std::function<void(size_t)> task);
 
     public:
         Persistence(DbCore<T>& db) : db_(db) {}
         Persistence(DbCore<T>& db, ShardName shardName) : db_(db), shardName_(shardName) {}
 
+        ImportMode importMode() const { return importMode_; }
+        Persistence& importMode(ImportMode mode) { importMode_ = mode; return *this; }
+
+        // number of files exportDb spreads the records over; 1 writes a single file
+        size_t shards() const { return shards_; }
+        Persistence& shards(size_t count) { shards_ = (count == 0 ? 1 : count); return *this; }
+
+        // leave imported payloads encoded until they are first accessed
+        bool lazyPayLoads() const { return lazyPayLoads_; }
+        Persistence& lazyPayLoads(bool lazy) { lazyPayLoads_ = lazy; return *this; }
+
+        // worker threads of a parallel import; 0 uses one per core
+        size_t importThreads() const { return importThreads_; }
+        Persistence& importThreads(size_t count) { importThreads_ = count; return *this; }
+
         virtual bool exportDb(const Keys& keys, const FilePath& filePath, 
             IPersistence<T>::StoreType storeType = IPersistence<T>::xml) const override
         {
-            return writeXmlToFile(filePath, makeXml(keys, shardName_));
+            if (shards_ > 1)
+                return exportShards(keys, filePath);
+
+            // a single file replaces a manifest; its shard files go with it
+            std::vector<std::string> previous;
+            if (isManifest(filePath))
+                previous = manifestFiles(filePath);
+            if (!writeXmlToFile(filePath, keys))
+                return false;
+            removeShardFiles(filePath, previous);
+            return true;
         }
 
         virtual Keys importDb(const FilePath& filePath, 
             bool preserveOriginal = DEFAULT_PRESERVE_ORIGINAL,
             IPersistence<T>::StoreType storeType = IPersistence<T>::xml) const override
         {
-            return parseXmlAndSaveToDb(filePath, preserveOriginal);
+            if (isManifest(filePath))
+                return importShards(filePath, preserveOriginal);
+
+            if (importMode_ == dom)
+            {
+                XmlProcessing::XmlDocument xmlDoc(filePath, XmlProcessing::XmlDocument::file, true);
+                return parseXmlAndSaveToDb(xmlDoc, preserveOriginal);
+            }
+            if (importMode_ == arena)
+            {
+                XmlProcessing::XmlSource source = XmlProcessing::XmlSource::fromFile(filePath);
+                return arenaXmlAndSaveToDb(source.view(), preserveOriginal);
+            }
+            if (importMode_ == parallel)
+            {
+                XmlProcessing::XmlSource source = XmlProcessing::XmlSource::fromFile(filePath);
+                return parallelXmlAndSaveToDb(source.view(), preserveOriginal);
+            }
+
+            std::ifstream in(filePath, std::ios::binary);
+            if (!in.good())
+                throw(std::exception(("can't open source file " + filePath).c_str()));
+            return streamXmlAndSaveToDb(in, preserveOriginal);
+        }
+
+        // in-memory variants used to ship records over the wire
+
+        std::string exportDbToString(const Keys& keys) const
+        {
+            std::ostringstream out;
+            {
+                XmlProcessing::XmlWriter writer(out);
+                writeXml(keys, writer);
+            }
+            return out.str();
+        }
+
+        Keys importDbFromString(const std::string& xml,
+            bool preserveOriginal = DEFAULT_PRESERVE_ORIGINAL) const
+        {
+            if (importMode_ == dom)
+            {
+                XmlProcessing::XmlDocument xmlDoc(xml, XmlProcessing::XmlDocument::str, true);
+                return parseXmlAndSaveToDb(xmlDoc, preserveOriginal);
+            }
+            if (importMode_ == arena)
+                return arenaXmlAndSaveToDb(xml, preserveOriginal);
+            if (importMode_ == parallel)
+                return parallelXmlAndSaveToDb(xml, preserveOriginal);
+
+            std::istringstream in(xml);
+            return streamXmlAndSaveToDb(in, preserveOriginal);
         }
     };
 
@@ -153,7 +367,16 @@ namespace NoSqlDb {
             }
             else if (pValueChild->tag() == "payload")
             {
-                dbElem.payLoad(T::fromXmlElement(pValueChild));
+                if (lazyPayLoads_)
+                {
+                    std::ostringstream out;
+                    XmlProcessing::XmlWriter(out, XmlProcessing::XmlWriter::DEFAULT_BUFFER_SIZE, false).element(pValueChild);
+                    dbElem.lazyPayLoad(out.str(), &Persistence<T>::decodePayLoad);
+                }
+                else
+                {
+                    dbElem.payLoad(T::fromXmlElement(pValueChild));
+                }
             }
         }
 
@@ -199,109 +422,216 @@ namespace NoSqlDb {
         return metadata;
     }
 
-    //----< helper function for Persistence<T>::makeXml >---------------------
+    //----< returns db element object from a record's value node >---------------------
+    /*
+    *  - xml is the buffer the node was parsed from; a lazy payload is copied
+    *    from it as it stands
+    */
+    template <typename T>
+    DbElement<T> Persistence<T>::createDbElement(const XmlProcessing::XmlNode& value, std::string_view xml) const
+    {
+        DbElement<T> dbElem;
+
+        for (const XmlProcessing::XmlNode& valueChild : value.children())
+        {
+            if (valueChild.tag() == "metadata")
+            {
+                dbElem.metadata(createDbElementMetadata(valueChild));
+            }
+            else if (valueChild.tag() == "payload")
+            {
+                if (lazyPayLoads_)
+                {
+                    std::string_view encoded = xml.substr(valueChild.sourceOffset(), valueChild.sourceLength());
+                    dbElem.lazyPayLoad(std::string(encoded), &Persistence<T>::decodePayLoad);
+                }
+                else
+                {
+                    dbElem.payLoad(T::fromXmlNode(valueChild));
+                }
+            }
+        }
+
+        return dbElem;
+    }
+
+    //----< returns db element metadata object from a metadata node >---------------------
 
     template <typename T>
-    void _addToXml(std::shared_ptr<XmlProcessing::AbstractXmlElement> pShard, 
-        std::string dbKey, DbCore<T>& db)
+    DbElementMetadata Persistence<T>::createDbElementMetadata(const XmlProcessing::XmlNode& metadataNode) const
     {
-        using namespace XmlProcessing;
-        using Sptr = std::shared_ptr<XmlProcessing::AbstractXmlElement>;
-        using Key = std::string;
-        using Keys = std::vector<Key>;
+        DbElementMetadata metadata;
 
-        // create a "record" tag
-        // this will hold the key and value of the DB record
-        Sptr pRecord = makeTaggedElement("record");
-        pShard->addChild(pRecord);
-
-        // add the db key
-        Sptr pKey = makeTaggedElement("key", dbKey);
-        pRecord->addChild(pKey);
-
-        // create a "value" tag
-        // this will hold the metadata and payload of the DB element
-        DbElement<T> thisElement = db[dbKey];
-        Sptr pValue = makeTaggedElement("value");
-        pRecord->addChild(pValue);
-
-        // metadata tag and its children
-        Sptr pMetadata = makeTaggedElement("metadata");
-        pValue->addChild(pMetadata);
-        Sptr pName = makeTaggedElement("name", thisElement.metadata().name());
-        pMetadata->addChild(pName);
-        Sptr pDescrip = makeTaggedElement("description", thisElement.metadata().descrip());
-        pMetadata->addChild(pDescrip);
-        Sptr pDateTime = makeTaggedElement("datetime", thisElement.metadata().dateTime());
-        pMetadata->addChild(pDateTime);
+        for (const XmlProcessing::XmlNode& metadataChild : metadataNode.children())
+        {
+            if (metadataChild.firstChild() == nullptr)
+                continue;
+
+            std::string_view tag = metadataChild.tag();
+            if (tag == "name")
+            {
+                metadata.name(std::string(metadataChild.childText()));
+            }
+            else if (tag == "description")
+            {
+                metadata.descrip(std::string(metadataChild.childText()));
+            }
+            else if (tag == "datetime")
+            {
+                DateTime dt(std::string(metadataChild.childText()));
+                metadata.dateTime(dt);
+            }
+            else if (tag == "relationships")
+            {
+                for (const XmlProcessing::XmlNode& child : metadataChild.children())
+                {
+                    if (child.firstChild() != nullptr)
+                        metadata.children().push_back(std::string(child.childText()));
+                }
+            }
+        }
+
+        return metadata;
+    }
+
+    //----< writes one db record >---------------------
+    /*
+    *  - a payload that is still encoded is written as the xml it was read
+    *    from, without decoding it
+    */
+    template <typename T>
+    void Persistence<T>::writeRecord(const Key& dbKey, const DbElement<T>& element, XmlProcessing::XmlWriter& writer) const
+    {
+        // "record" holds the key and value of the DB record
+        writer.startElement("record");
+        writer.element("key", dbKey);
+
+        // "value" holds the metadata and payload of the DB element
+        writer.startElement("value");
+
+        const DbElementMetadata& metadata = element.metadata();
+        writer.startElement("metadata");
+        writer.element("name", metadata.name());
+        writer.element("description", metadata.descrip());
+        writer.element("datetime", std::string(metadata.dateTime()));
 
         // relationships... its part of the record's metadata
-        Keys children = thisElement.metadata().children();
-        if (children.size() > 0)
+        if (metadata.children().size() > 0)
         {
-            Sptr pRelationships = makeTaggedElement("relationships");
-            pMetadata->addChild(pRelationships);
-            for (Key childkey : children)
+            writer.startElement("relationships");
+            for (const Key& childKey : metadata.children())
             {
-                Sptr pChildKey = makeTaggedElement("childkey", childkey);
-                pRelationships->addChild(pChildKey);
+                writer.element("childkey", childKey);
             }
+            writer.endElement();
         }
+        writer.endElement();
 
         // the payload...
-        Sptr pPayLoad = thisElement.payLoad().toXmlElement();
-        pValue->addChild(pPayLoad);
-    }
+        if (!element.payLoadDecoded())
+            writer.markup(element.encodedPayLoad());
+        else
+            element.payLoad().writeXml(writer);
 
-    //----< returns an Xml document serialization of the provided DB records >---------------------
+        writer.endElement();
+        writer.endElement();
+    }
 
+    //----< writes the selected db records as a shard >---------------------
+    /*
+    *  - records are written straight from the db, nothing is copied or built
+    *  - keys which are not in the db are skipped
+    */
     template <typename T>
-    XmlProcessing::XmlDocument Persistence<T>::makeXml(const Keys& keys, ShardName shardName) const
+    void Persistence<T>::writeXml(const Keys& keys, XmlProcessing::XmlWriter& writer) const
     {
-        using namespace XmlProcessing;
-
-        // create an Xml Document object with the root tag "shard"
-        Sptr pShard = makeTaggedElement("shard");
-        pShard->addAttrib("name", shardName);
-        Sptr pDocElem = makeDocElement(pShard);
-        XmlDocument xmlDoc(pDocElem);
+        writer.startElement("shard");
+        writer.attribute("name", shardName_);
 
-        // iterate over the list of keys whose records have to be persisted 
-        for (Key dbKey : keys)
+        for (const Key& dbKey : keys)
         {
-            _addToXml<T>(pShard, dbKey, db_);
+            typename DbCore<T>::iterator iter = db_.find(dbKey);
+            if (iter != db_.end())
+                writeRecord(dbKey, iter->second, writer);
         }
 
-        return xmlDoc;
+        writer.endElement();
     }
 
     //----< validates & deserializes a xml document and saves records to DB >---------------------
 
     template <typename T>
-    typename Persistence<T>::Keys Persistence<T>::parseXmlAndSaveToDb(const FilePath& filePath, bool preserveOriginal) const
+    typename Persistence<T>::Keys Persistence<T>::parseXmlAndSaveToDb(XmlProcessing::XmlDocument& xmlDoc, bool preserveOriginal) const
     {
         using namespace XmlProcessing;
 
         Keys keys;
 
-        XmlDocument xmlDoc(filePath, XmlDocument::file);
         if (!validateXml(&xmlDoc))
             return keys;
 
         std::vector<Sptr> records = xmlDoc.descendents("record").select();
         for (auto pRecord : records)
         {
-            std::vector<Sptr> pKeyValue = pRecord->children();
+            std::vector<Sptr> pKeyValue = decodeEntities(pRecord)->children();
             keys.push_back(saveRecordToDb(pKeyValue, preserveOriginal));
         }
 
         return keys;
     }
 
+    //----< copy of an element with the entity references in its text and attributes decoded >---------------------
+    /*
+    *  - XmlParser keeps text and attribute values as written, escapes included
+    */
+    template <typename T>
+    typename Persistence<T>::Sptr Persistence<T>::decodeEntities(Sptr pElem)
+    {
+        using namespace XmlProcessing;
+
+        if (dynamic_cast<TextElement*>(pElem.get()) != nullptr)
+            return makeTextElement(XmlStreamReader::decodeEntities(pElem->value()));
+        if (pElem->tag().empty())
+            return pElem;
+
+        Sptr pCopy = makeTaggedElement(pElem->tag());
+        for (auto& attrib : pElem->attributes())
+            pCopy->addAttrib(attrib.first, XmlStreamReader::decodeEntities(attrib.second));
+        for (auto pChild : pElem->children())
+            pCopy->addChild(decodeEntities(pChild));
+        return pCopy;
+    }
+
+    //----< reads a shard from a stream and saves each record as soon as it is read >---------------------
+    /*
+    *  - only one record is held in memory at a time
+    *  - a document whose root is not "shard" yields no records, as with validateXml
+    *  - throws on ill-formed xml; records read before the error remain in the db
+    */
+    template <typename T>
+    typename Persistence<T>::Keys Persistence<T>::streamXmlAndSaveToDb(std::istream& in, bool preserveOriginal) const
+    {
+        using namespace XmlProcessing;
+
+        Keys keys;
+        RecordHandler handler(lazyPayLoads_, [&](Sptr pRecord, const std::string& encodedPayLoad) {
+            // the root tag has been read by the time the first record closes
+            if (handler.rootTag() == "shard")
+                keys.push_back(saveRecordToDb(pRecord->children(), preserveOriginal, encodedPayLoad));
+        });
+
+        XmlStreamReader reader(in);
+        if (!reader.parse(handler))
+            throw(std::exception(("ill-formed XML: " + reader.error()).c_str()));
+
+        return keys;
+    }
+
     //----< parses DB records serialized as Xml and saves to DB >---------------------
 
     template <typename T>
-    typename Persistence<T>::Key Persistence<T>::saveRecordToDb(std::vector<Sptr> pKeyValue, bool preserveOriginal) const
+    typename Persistence<T>::Key Persistence<T>::saveRecordToDb(std::vector<Sptr> pKeyValue, bool preserveOriginal,
+        const std::string& encodedPayLoad) const
     {
         Key key;
         DbElement<T> dbElem;
@@ -330,11 +660,97 @@ namespace NoSqlDb {
         }
 
         if (!recordExists)
-            db_[key] = dbElem;
+        {
+            if (!encodedPayLoad.empty())
+                dbElem.lazyPayLoad(encodedPayLoad, &Persistence<T>::decodePayLoad);
+            db_.add(key, dbElem);
+        }
 
         return key;
     }
 
+    //----< calls save with the key and value node of each record of a shard >---------------------
+    /*
+    *  - a document whose root is not "shard" has no records
+    *  - pValue is nullptr for a record without a value
+    */
+    template <typename T>
+    void Persistence<T>::forEachRecord(const XmlProcessing::XmlArenaDocument& doc,
+        std::function<void(const Key& key, const XmlProcessing::XmlNode* pValue)> save) const
+    {
+        const XmlProcessing::XmlNode* pShard = doc.xmlRoot();
+        if (pShard == nullptr || pShard->tag() != "shard")
+            return;
+
+        for (const XmlProcessing::XmlNode& record : pShard->children())
+        {
+            if (record.tag() != "record")
+                continue;
+            const XmlProcessing::XmlNode* pKey = record.child("key");
+            save(Key(pKey == nullptr ? std::string_view() : pKey->childText()), record.child("value"));
+        }
+    }
+
+    //----< parses a shard into an arena document and saves its records to DB >---------------------
+    /*
+    *  - the value of a record whose key is kept by preserveOriginal is not decoded
+    *  - throws on ill-formed xml, before any record is saved
+    */
+    template <typename T>
+    typename Persistence<T>::Keys Persistence<T>::arenaXmlAndSaveToDb(std::string_view xml, bool preserveOriginal) const
+    {
+        using namespace XmlProcessing;
+
+        Keys keys;
+        XmlArenaDocument doc = XmlArenaDocument::parse(xml);
+        forEachRecord(doc, [&](const Key& key, const XmlNode* pValue) {
+            keys.push_back(key);
+            if (preserveOriginal && db_.contains(key))
+                return;
+            db_.add(key, pValue == nullptr ? DbElement<T>() : createDbElement(*pValue, xml));
+        });
+
+        return keys;
+    }
+
+    //----< parses the records of a shard on several threads and saves them to DB >---------------------
+    /*
+    *  - workers only read the db, to skip decoding values which preserveOriginal will keep;
+    *    records are merged on the calling thread once all have been parsed
+    *  - records are merged in file order, so a key repeated in the shard ends up as it
+    *    would with a streamed import
+    *  - throws on the first ill-formed record in the shard, before any record is saved
+    */
+    template <typename T>
+    typename Persistence<T>::Keys Persistence<T>::parallelXmlAndSaveToDb(std::string_view xml, bool preserveOriginal) const
+    {
+        using namespace XmlProcessing;
+
+        XmlParallelParser parser(xml, "record", importThreads_);
+        if (parser.rootTag() != "shard")
+            return Keys();
+
+        using Record = std::pair<Key, DbElement<T>>;
+        std::vector<Record> staged = parser.map<Record>([&](const XmlNode& record, std::string_view recordXml) {
+            const XmlNode* pKey = record.child("key");
+            Record parsed(Key(pKey == nullptr ? std::string_view() : pKey->childText()), DbElement<T>());
+            const XmlNode* pValue = record.child("value");
+            if (pValue != nullptr && !(preserveOriginal && db_.contains(parsed.first)))
+                parsed.second = createDbElement(*pValue, recordXml);
+            return parsed;
+        });
+
+        Keys keys;
+        keys.reserve(staged.size());
+        for (Record& record : staged)
+        {
+            keys.push_back(record.first);
+            if (!(preserveOriginal && db_.contains(record.first)))
+                db_.add(record.first, std::move(record.second));
+        }
+        return keys;
+    }
+
     //----< validates if xml document has required keys >---------------------
 
     template <typename T>
@@ -354,23 +770,325 @@ namespace NoSqlDb {
     //----< serializes selected db records to xml file >---------------------
 
     template <typename T>
-    bool Persistence<T>::writeXmlToFile(const FilePath& filePath, XmlProcessing::XmlDocument xmlDoc) const
+    bool Persistence<T>::writeXmlToFile(const FilePath& filePath, const Keys& keys) const
     {
         using OutFileStream = std::ofstream;
         using WriteMode = std::ios;
 
-        OutFileStream outf(filePath, WriteMode::trunc);
+        OutFileStream outf(filePath, WriteMode::trunc | WriteMode::binary);
         if (!outf)
         {
             return false;
         }
 
-        std::string xmlStr = xmlDoc.toString();
-        outf << xmlStr << std::endl;
-        outf.close();
+        XmlProcessing::XmlWriter writer(outf);
+        writeXml(keys, writer);
+        return writer.flush();
+    }
+
+    //----< runs task(0) .. task(tasks-1) on up to one thread per core >---------------------
+    /*
+    *  - the calling thread is one of the workers
+    *  - the first exception thrown by a task is rethrown once all have finished
+    */
+    template <typename T>
+    void Persistence<T>::runParallel(size_t tasks, std::function<void(size_t)> task)
+    {
+        size_t cores = std::max<size_t>(1, std::thread::hardware_concurrency());
+        size_t workers = std::min(tasks, cores);
+
+        std::atomic<size_t> next{ 0 };
+        std::exception_ptr pError;
+        std::mutex errorMutex;
+        auto work = [&]() {
+            for (size_t i = next++; i < tasks; i = next++)
+            {
+                try
+                {
+                    task(i);
+                }
+                catch (...)
+                {
+                    std::lock_guard<std::mutex> lock(errorMutex);
+                    if (!pError)
+                        pError = std::current_exception();
+                }
+            }
+        };
+
+        std::vector<std::thread> threads;
+        for (size_t i = 1; i < workers; ++i)
+            threads.emplace_back(work);
+        work();
+        for (std::thread& thread : threads)
+            thread.join();
 
+        if (pError)
+            std::rethrow_exception(pError);
+    }
+
+    //----< is the file a shard manifest? >---------------------
+    /*
+    *  - reads only up to the root element's start tag
+    */
+    template <typename T>
+    bool Persistence<T>::isManifest(const FilePath& filePath) const
+    {
+        class RootTag : public XmlProcessing::XmlStreamHandler
+        {
+        public:
+            void startElement(const std::string& tag, const Attribs& attribs) override { tag_ = tag; }
+            bool stopped() override { return !tag_.empty(); }
+            std::string tag_;
+        } root;
+
+        std::ifstream in(filePath, std::ios::binary);
+        if (!in.good())
+            return false;
+        XmlProcessing::XmlStreamReader(in, 1024).parse(root);
+        return root.tag_ == "manifest";
+    }
+
+    //----< splits records over shard files written in parallel, then writes the manifest >---------------------
+    /*
+    *  - elements are looked up before the workers start so that they only read the db
+    *  - shard files listed by a manifest previously at manifestPath, and not by the
+    *    new one, are removed once the new manifest has been written
+    */
+    template <typename T>
+    bool Persistence<T>::exportShards(const Keys& keys, const FilePath& manifestPath) const
+    {
+        using Record = typename DbCore<T>::DbStore::value_type;
+
+        size_t slash = manifestPath.find_last_of("/\\");
+        std::string folder = (slash == std::string::npos ? "" : manifestPath.substr(0, slash + 1));
+        std::string stem = manifestPath.substr(folder.size());
+        if (stem.size() > 4 && stem.substr(stem.size() - 4) == ".xml")
+            stem.resize(stem.size() - 4);
+
+        std::vector<std::string> previous;
+        if (isManifest(manifestPath))
+            previous = manifestFiles(manifestPath);
+
+        std::vector<std::vector<Record*>> partitions(shards_);
+        std::hash<Key> hash;
+        for (const Key& dbKey : keys)
+        {
+            typename DbCore<T>::iterator iter = db_.find(dbKey);
+            if (iter != db_.end())
+                partitions[hash(dbKey) % shards_].push_back(&*iter);
+        }
+
+        std::vector<std::string> fileNames(shards_);
+        for (size_t i = 0; i < shards_; ++i)
+            fileNames[i] = stem + "." + std::to_string(i) + ".xml";
+
+        try
+        {
+            runParallel(shards_, [&](size_t i) {
+                std::ofstream outf(folder + fileNames[i], std::ios::trunc | std::ios::binary);
+                XmlProcessing::XmlWriter writer(outf);
+                writer.startElement("shard");
+                writer.attribute("name", shardName_);
+                for (Record* pRecord : partitions[i])
+                    writeRecord(pRecord->first, pRecord->second, writer);
+                writer.endElement();
+                if (!writer.flush())
+                    throw(std::exception(("can't write shard file " + folder + fileNames[i]).c_str()));
+            });
+        }
+        catch (std::exception&)
+        {
+            return false;
+        }
+
+        std::ofstream outf(manifestPath, std::ios::trunc | std::ios::binary);
+        XmlProcessing::XmlWriter writer(outf);
+        writer.startElement("manifest");
+        writer.attribute("name", shardName_);
+        writer.attribute("shards", std::to_string(shards_));
+        for (size_t i = 0; i < shards_; ++i)
+        {
+            writer.startElement("shardfile");
+            writer.attribute("records", std::to_string(partitions[i].size()));
+            writer.text(fileNames[i]);
+            writer.endElement();
+        }
+        writer.endElement();
+        if (!writer.flush())
+            return false;
+
+        removeShardFiles(manifestPath, previous, fileNames);
         return true;
     }
+
+    //----< names of the shard files a manifest lists >---------------------
+    /*
+    *  - names are relative to the folder of the manifest
+    */
+    template <typename T>
+    std::vector<std::string> Persistence<T>::manifestFiles(const FilePath& manifestPath) const
+    {
+        using namespace XmlProcessing;
+
+        std::ifstream in(manifestPath, std::ios::binary);
+        if (!in.good())
+            throw(std::exception(("can't open source file " + manifestPath).c_str()));
+
+        std::vector<std::string> fileNames;
+        XmlSubtreeHandler manifest("shardfile", [&](Sptr pShardFile) {
+            if (pShardFile->children().size() > 0)
+                fileNames.push_back(pShardFile->children()[0]->value());
+        });
+        XmlStreamReader reader(in);
+        if (!reader.parse(manifest))
+            throw(std::exception(("ill-formed manifest: " + reader.error()).c_str()));
+        return fileNames;
+    }
+
+    //----< deletes the shard files of an earlier export that are no longer listed >---------------------
+    /*
+    *  - stale holds the files listed by the manifest the export replaced, keep the
+    *    files the new manifest lists; only files named by the old manifest are ever
+    *    removed, so unrelated files next to it are left alone
+    *  - names with a path in them are not shard files written by exportShards and
+    *    are skipped
+    */
+    template <typename T>
+    void Persistence<T>::removeShardFiles(const FilePath& manifestPath, const std::vector<std::string>& stale,
+        const std::vector<std::string>& keep)
+    {
+        size_t slash = manifestPath.find_last_of("/\\");
+        std::string folder = (slash == std::string::npos ? "" : manifestPath.substr(0, slash + 1));
+        std::string manifestName = manifestPath.substr(folder.size());
+
+        for (const std::string& fileName : stale)
+        {
+            if (fileName.empty() || fileName.find_first_of("/\\") != std::string::npos || fileName == manifestName)
+                continue;
+            if (std::find(keep.begin(), keep.end(), fileName) != keep.end())
+                continue;
+            std::remove((folder + fileName).c_str());
+        }
+    }
+
+    //----< reads the shard files listed in a manifest in parallel and merges them into the db >---------------------
+    /*
+    *  - each worker imports its file into a staging db without touching the db, using
+    *    the same import mode and lazy payload setting as a single file import;
+    *    the shards are already spread over the cores, so a parallel import of a shard
+    *    uses one thread unless importThreads() says otherwise
+    *  - the staging dbs are merged only once every file has been read, so a shard
+    *    that fails to import leaves the db as it was; the cost is holding all of
+    *    them at once
+    *  - shards hold disjoint keys, so the order in which they are merged does not
+    *    change the result; preserveOriginal applies to the db as it was before the import
+    *  - returns keys in manifest order
+    */
+    template <typename T>
+    typename Persistence<T>::Keys Persistence<T>::importShards(const FilePath& manifestPath, bool preserveOriginal) const
+    {
+        std::vector<std::string> fileNames = manifestFiles(manifestPath);
+
+        size_t slash = manifestPath.find_last_of("/\\");
+        std::string folder = (slash == std::string::npos ? "" : manifestPath.substr(0, slash + 1));
+
+        std::vector<DbCore<T>> staging(fileNames.size());
+        std::vector<Keys> shardKeys(fileNames.size());
+        runParallel(fileNames.size(), [&](size_t i) {
+            // a shard file is an ordinary export; read it the way importDb would
+            Persistence<T> shardPersistence(staging[i]);
+            shardPersistence.importMode(importMode_).lazyPayLoads(lazyPayLoads_)
+                .importThreads(importThreads_ == 0 ? 1 : importThreads_);
+            shardKeys[i] = shardPersistence.importDb(folder + fileNames[i], false);
+        });
+
+        Keys keys;
+        for (size_t i = 0; i < fileNames.size(); ++i)
+        {
+            for (const Key& key : shardKeys[i])
+            {
+                if (!(preserveOriginal && db_.contains(key)))
+                    db_.add(key, staging[i].value(key));
+                keys.push_back(key);
+            }
+            staging[i].truncate();
+        }
+        return keys;
+    }
+
+    //----< decodes a payload kept as XML text by a lazy import >---------------------
+    /*
+    *  - throws if the text is ill-formed or holds no payload element, so the caller of
+    *    DbElement<T>::payLoad() learns of it instead of getting a default payload
+    */
+    template <typename T>
+    T Persistence<T>::decodePayLoad(const std::string& xml)
+    {
+        using namespace XmlProcessing;
+
+        T payLoad;
+        std::istringstream in(xml);
+        XmlSubtreeHandler handler("payload", [&](Sptr pPayLoad) { payLoad = T::fromXmlElement(pPayLoad); });
+        XmlStreamReader reader(in, xml.size() + 1);
+        if (!reader.parse(handler))
+            throw(std::exception(("ill-formed payload XML: " + reader.error()).c_str()));
+        if (handler.count() == 0)
+            throw(std::exception("payload XML holds no payload element"));
+        return payLoad;
+    }
+
+    /////////////////////////////////////////////////////////////////////
+    // Persistence<T>::RecordHandler methods
+
+    //----< adds start tag to the record AST or to the captured payload >---------------------
+
+    template <typename T>
+    void Persistence<T>::RecordHandler::startElement(const std::string& tag, const Attribs& attribs)
+    {
+        if (depth_ == 0 && !(capture_ && tag == "payload" && records_.building()))
+        {
+            records_.startElement(tag, attribs);
+            return;
+        }
+
+        ++depth_;
+        encoded_ += '<';
+        encoded_ += tag;
+        for (auto& attrib : attribs)
+        {
+            encoded_ += ' ' + attrib.first + "=\"";
+            XmlProcessing::XmlWriter::escape(encoded_, attrib.second);
+            encoded_ += '"';
+        }
+        encoded_ += '>';
+    }
+
+    //----< closes an element of the record AST or of the captured payload >---------------------
+
+    template <typename T>
+    void Persistence<T>::RecordHandler::endElement(const std::string& tag)
+    {
+        if (depth_ == 0)
+        {
+            records_.endElement(tag);
+            return;
+        }
+
+        --depth_;
+        encoded_ += "</" + tag + ">";
+    }
+
+    //----< adds text to the record AST or to the captured payload >---------------------
+
+    template <typename T>
+    void Persistence<T>::RecordHandler::text(const std::string& text)
+    {
+        if (depth_ == 0)
+            records_.text(text);
+        else
+            XmlProcessing::XmlWriter::escape(encoded_, text);
+    }
 }
 
 #endif // !PERSISTENCE_H
@@ -1,7 +1,7 @@
 #pragma once
 ///////////////////////////////////////////////////////////////////////
 // TestPersistence.h - Implements all test cases for Persistence     //
-// ver 1.1                                                           //
+// ver 1.8                                                           //
 // Language:    C++, Visual Studio 2017                              //
 // Application: NoSqlDb, CSE687 - Object Oriented Design             //
 // Author:      Ritesh Nair (rgnair@syr.edu)                         //
@@ -20,6 +20,18 @@
 *
 * Maintenance History:
 * --------------------
+* ver 1.8 : 19 Oct 2026
+* - added test8h for parallel imports
+* ver 1.7 : 19 Oct 2026
+* - added test8g for arena imports
+* ver 1.6 : 19 Oct 2026
+* - added test8f for lazy payload decoding
+* ver 1.5 : 19 Oct 2026
+* - added test8e for sharded export and import
+* ver 1.4 : 19 Oct 2026
+* - added test8d for streaming export
+* ver 1.3 : 19 Oct 2026
+* - added test8c for streaming import
 * ver 1.2 : 15 Apr 2018
 * - Moved implementation into cpp file
 * ver 1.0 : 08 Feb 2018
@@ -47,6 +59,36 @@ namespace NoSqlDbTests {
         test8b(AbstractTest::TestTitle title) : AbstractTest(title) {  }
         virtual bool operator()(); 
     };
+    class test8c : public TestCore::AbstractTest {
+    public:
+        test8c(AbstractTest::TestTitle title) : AbstractTest(title) {  }
+        virtual bool operator()();
+    };
+    class test8d : public TestCore::AbstractTest {
+    public:
+        test8d(AbstractTest::TestTitle title) : AbstractTest(title) {  }
+        virtual bool operator()();
+    };
+    class test8e : public TestCore::AbstractTest {
+    public:
+        test8e(AbstractTest::TestTitle title) : AbstractTest(title) {  }
+        virtual bool operator()();
+    };
+    class test8f : public TestCore::AbstractTest {
+    public:
+        test8f(AbstractTest::TestTitle title) : AbstractTest(title) {  }
+        virtual bool operator()();
+    };
+    class test8g : public TestCore::AbstractTest {
+    public:
+        test8g(AbstractTest::TestTitle title) : AbstractTest(title) {  }
+        virtual bool operator()();
+    };
+    class test8h : public TestCore::AbstractTest {
+    public:
+        test8h(AbstractTest::TestTitle title) : AbstractTest(title) {  }
+        virtual bool operator()();
+    };
     class test11a : public TestCore::AbstractTest {
     public:
         test11a(AbstractTest::TestTitle title) : AbstractTest(title) {  }
@@ -1,7 +1,7 @@
 #pragma once
 ///////////////////////////////////////////////////////////////////////
 // Query.h - Implements the Query module for the NoSql database      //
-// ver 1.4                                                           //
+// ver 1.5                                                           //
 // Language:    C++, Visual Studio 2017                              //
 // Application: NoSqlDb, CSE687 - Object Oriented Design             //
 // Author:      Ritesh Nair (rgnair@syr.edu)                         //
@@ -13,14 +13,20 @@
 * This package implements below class for querying the NoSqlDb:
 * - Query class provides APIs to load a DBCore object or a partial result set
 *   and query on the keys, its metadata, children and date-time interval.
+* - When the db passed to from() collects stats (see DbInstrumentation.h)
+*   every query is timed and its rows scanned and returned are recorded
+*   against that db.
 
 * Required Files:
 * ---------------
 * DbCore.h, DbCore.cpp
+* DbInstrumentation.h
 * DateTime.h, DateTime.cpp
 *
 * Maintenance History:
 * --------------------
+* ver 1.5 : 19 Oct 2026
+* - queries are timed and their rows scanned and returned recorded in the source db's stats
 * ver 1.4 : 19 Apr 2018
 * - payload query uses lambda for criteria definition instead of functor
 * - Remove payload criteria interface
@@ -225,13 +231,24 @@ namespace NoSqlDb {
 
         Query() : where_(*this) {}
 
-        Query<T> from(DbCore<T>& db) { db_ = db; return *this; };
+        Query<T> from(DbCore<T>& db) { db_ = db; stats_ = db.statsHandle(); return *this; };
         Query<T> orThese(ResultSets queries);
         DbCore<T> end();
 
     private:
+        using Clock = DbStats::Clock;
+
         DbCore<T> db_;
         QueryTypes<T> where_;
+        std::shared_ptr<DbStats> stats_;
+
+        bool timed() const { return INSTRUMENTATION_COMPILED && (bool)stats_; }
+        Clock::time_point startTimer() const { return timed() ? Clock::now() : Clock::time_point(); }
+        void record(QueryKind kind, Clock::time_point start, size_t rowsScanned, size_t rowsReturned)
+        {
+            if (timed())
+                stats_->recordQuery(kind, start, rowsScanned, rowsReturned);
+        }
 
         Keys& keys() { return keys_; }
         void db(const DbCore<T>& db) { db_ = db; };
@@ -253,9 +270,12 @@ namespace NoSqlDb {
     template <typename T>
     Query<T> KeyQuery<T>::eq(const Key& key) const
     {
-        if (cursor_.db_.contains(key)) {
+        typename Query<T>::Clock::time_point start = cursor_.startTimer();
+        bool found = cursor_.db_.contains(key);
+        if (found) {
             cursor_.saveOne(key);
         }
+        cursor_.record(QueryKind::key, start, 1, found ? 1 : 0);
         return cursor_;
     }
 
@@ -264,6 +284,7 @@ namespace NoSqlDb {
     template <typename T>
     Query<T> KeyQuery<T>::eqRegex(const Regex& regexStr) const
     {
+        typename Query<T>::Clock::time_point start = cursor_.startTimer();
         Keys matchedKeys;
         for (Key key : cursor_.db_.keys())
         {
@@ -272,6 +293,7 @@ namespace NoSqlDb {
                 matchedKeys.push_back(key);
         }
 
+        cursor_.record(QueryKind::key, start, cursor_.db_.size(), matchedKeys.size());
         cursor_.save(matchedKeys);
         return cursor_;
     }
@@ -284,6 +306,7 @@ namespace NoSqlDb {
     template <typename T>
     Query<T> DateQuery<T>::between(DateTime from, DateTime to) const
     {
+        typename Query<T>::Clock::time_point start = cursor_.startTimer();
         Keys matchedKeys;
         DbCore<T>& db = cursor_.db_;
         for (Key key : db.keys())
@@ -293,6 +316,7 @@ namespace NoSqlDb {
                 matchedKeys.push_back(key);
         }
 
+        cursor_.record(QueryKind::dateTime, start, cursor_.db_.size(), matchedKeys.size());
         cursor_.save(matchedKeys);
         return cursor_;
     }
@@ -310,6 +334,7 @@ namespace NoSqlDb {
     template <typename T>
     Query<T> DateQuery<T>::lt(DateTime value) const
     {
+        typename Query<T>::Clock::time_point start = cursor_.startTimer();
         Keys matchedKeys;
         DbCore<T>& db = cursor_.query().db();
         for (Key key : db.keys())
@@ -319,6 +344,7 @@ namespace NoSqlDb {
                 matchedKeys.push_back(key);
         }
 
+        cursor_.record(QueryKind::dateTime, start, cursor_.db_.size(), matchedKeys.size());
         cursor_.save(matchedKeys);
         return cursor_;
     }
@@ -331,6 +357,7 @@ namespace NoSqlDb {
     template <typename T>
     Query<T> MetadataQuery<T>::eqRegex(const Regex& regexStr) const
     {
+        typename Query<T>::Clock::time_point start = cursor_.startTimer();
         Keys matchedKeys;
         DbCore<T>& db = cursor_.db_;
         for (Key key : db.keys())
@@ -343,6 +370,7 @@ namespace NoSqlDb {
                 matchedKeys.push_back(key);
         }
 
+        cursor_.record(QueryKind::metadata, start, cursor_.db_.size(), matchedKeys.size());
         cursor_.save(matchedKeys);
         return cursor_;
     }
@@ -352,6 +380,7 @@ namespace NoSqlDb {
     template <typename T>
     Query<T> MetadataQuery<T>::eqNameRegex(const Regex& regexStr) const
     {
+        typename Query<T>::Clock::time_point start = cursor_.startTimer();
         Keys matchedKeys;
         DbCore<T>& db = cursor_.db_;
         for (Key key : db.keys())
@@ -362,6 +391,7 @@ namespace NoSqlDb {
                 matchedKeys.push_back(key);
         }
 
+        cursor_.record(QueryKind::metadata, start, cursor_.db_.size(), matchedKeys.size());
         cursor_.save(matchedKeys);
         return cursor_;
     }
@@ -371,6 +401,7 @@ namespace NoSqlDb {
     template <typename T>
     Query<T> MetadataQuery<T>::eqName(const Key& name) const
     {
+        typename Query<T>::Clock::time_point start = cursor_.startTimer();
         Keys matchedKeys;
         DbCore<T>& db = cursor_.db_;
         for (Key key : db.keys())
@@ -379,6 +410,7 @@ namespace NoSqlDb {
                 matchedKeys.push_back(key);
         }
 
+        cursor_.record(QueryKind::metadata, start, cursor_.db_.size(), matchedKeys.size());
         cursor_.save(matchedKeys);
         return cursor_;
     }
@@ -391,6 +423,7 @@ namespace NoSqlDb {
     template <typename T>
     Query<T> ChildrenQuery<T>::eq(const Key& key) const
     {
+        typename Query<T>::Clock::time_point start = cursor_.startTimer();
         Keys matchedKeys;
         DbCore<T>& db = cursor_.db_;
         for (Key dbKey : db.keys())
@@ -406,6 +439,7 @@ namespace NoSqlDb {
             }
         }
 
+        cursor_.record(QueryKind::children, start, cursor_.db_.size(), matchedKeys.size());
         cursor_.save(matchedKeys);
         return cursor_;
     }
@@ -418,6 +452,7 @@ namespace NoSqlDb {
     template <typename T>
     Query<T> PayloadQuery<T>::has(const Criteria& check) const
     {
+        typename Query<T>::Clock::time_point start = cursor_.startTimer();
         Keys matchedKeys;
         for (Key key : cursor_.db_.keys())
         {
@@ -425,6 +460,7 @@ namespace NoSqlDb {
                 matchedKeys.push_back(key);
         }
 
+        cursor_.record(QueryKind::payload, start, cursor_.db_.size(), matchedKeys.size());
         cursor_.save(matchedKeys);
         return cursor_;
     }
@@ -1,7 +1,7 @@
 #pragma once
 ///////////////////////////////////////////////////////////////////////
 // TestQuery.h - Implements all test cases for Query                 //
-// ver 1.2                                                           //
+// ver 1.3                                                           //
 // Language:    C++, Visual Studio 2017                              //
 // Application: NoSqlDb, CSE687 - Object Oriented Design             //
 // Author:      Ritesh Nair (rgnair@syr.edu)                         //
@@ -18,6 +18,8 @@
 *
 * Maintenance History:
 * --------------------
+* ver 1.3 : 19 Oct 2026
+* - added test7b
 * ver 1.2 : 16 Apr 2018
 * - switched from std::string as payload to the IPayload implementation - StringPayload
 * ver 1.1 : 15 Apr 2018
@@ -56,6 +58,11 @@ namespace NoSqlDbTests {
         bool _executePart1(NoSqlDb::DbCore<NoSqlDb::StringPayload>& db);
         bool _executePart2(NoSqlDb::DbCore<NoSqlDb::StringPayload>& db);
     };
+    class test7b : public TestCore::AbstractTest {
+    public:
+        test7b(TestCore::AbstractTest::TestTitle title) : TestCore::AbstractTest(title) {  }
+        virtual bool operator()();
+    };
 
 }
 
@@ -0,0 +1,510 @@
+///////////////////////////////////////////////////////////////////
+// XmlArena.cpp - XML document with nodes in an arena            //
+// ver 1.0                                                       //
+// Language:    C++, Visual Studio 2017                          //
+// Application: NoSqlDb, CSE687 - Object Oriented Design         //
+// Author:      Ritesh Nair (rgnair@syr.edu)                     //
+///////////////////////////////////////////////////////////////////
+
+#include "XmlArena.h"
+#include "../XmlWriter/XmlWriter.h"
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <sstream>
+
+using namespace XmlProcessing;
+
+/////////////////////////////////////////////////////////////////////
+// XmlArena methods
+
+//----< construct an arena; no memory is taken until first use >------
+
+XmlArena::XmlArena(size_t blockSize) : blockSize_(blockSize < 256 ? 256 : blockSize) {}
+
+//----< move construction leaves the source empty >--------------------
+
+XmlArena::XmlArena(XmlArena&& arena)
+  : blocks_(std::move(arena.blocks_)), blockSize_(arena.blockSize_), firstSize_(arena.firstSize_),
+    next_(arena.next_), end_(arena.end_), used_(arena.used_), reserved_(arena.reserved_)
+{
+  arena.blocks_.clear();
+  arena.firstSize_ = arena.used_ = arena.reserved_ = 0;
+  arena.next_ = arena.end_ = nullptr;
+}
+//----< move assignment frees this arena's blocks >--------------------
+
+XmlArena& XmlArena::operator=(XmlArena&& arena)
+{
+  if (this == &arena)
+    return *this;
+  blocks_ = std::move(arena.blocks_);
+  blockSize_ = arena.blockSize_;
+  firstSize_ = arena.firstSize_;
+  next_ = arena.next_;
+  end_ = arena.end_;
+  used_ = arena.used_;
+  reserved_ = arena.reserved_;
+  arena.blocks_.clear();
+  arena.firstSize_ = arena.used_ = arena.reserved_ = 0;
+  arena.next_ = arena.end_ = nullptr;
+  return *this;
+}
+//----< take a new block from the heap >-------------------------------
+
+char* XmlArena::addBlock(size_t size)
+{
+  blocks_.emplace_back(new char[size]);
+  if (blocks_.size() == 1)
+    firstSize_ = size;
+  reserved_ += size;
+  return blocks_.back().get();
+}
+//----< size bytes aligned to align, a power of 2 >--------------------
+
+void* XmlArena::allocate(size_t size, size_t align)
+{
+  uintptr_t p = ((uintptr_t)next_ + align - 1) & ~(uintptr_t)(align - 1);
+  if (next_ == nullptr || p + size > (uintptr_t)end_)
+  {
+    if (size + align > blockSize_ / 4)
+    {
+      // the current block stays open for small allocations
+      char* block = addBlock(size + align);
+      used_ += size;
+      return (void*)(((uintptr_t)block + align - 1) & ~(uintptr_t)(align - 1));
+    }
+    next_ = addBlock(blockSize_);
+    end_ = next_ + blockSize_;
+    p = ((uintptr_t)next_ + align - 1) & ~(uintptr_t)(align - 1);
+  }
+  next_ = (char*)(p + size);
+  used_ += size;
+  return (void*)p;
+}
+//----< copy of text which lives as long as the arena >----------------
+
+std::string_view XmlArena::copy(std::string_view text)
+{
+  if (text.empty())
+    return std::string_view();
+  char* p = static_cast<char*>(allocate(text.size(), 1));
+  std::memcpy(p, text.data(), text.size());
+  return std::string_view(p, text.size());
+}
+//----< give back every block but the first >--------------------------
+
+void XmlArena::clear()
+{
+  if (blocks_.empty())
+    return;
+  if (firstSize_ != blockSize_)
+  {
+    blocks_.clear();
+    firstSize_ = reserved_ = used_ = 0;
+    next_ = end_ = nullptr;
+    return;
+  }
+  blocks_.resize(1);
+  reserved_ = blockSize_;
+  used_ = 0;
+  next_ = blocks_[0].get();
+  end_ = next_ + blockSize_;
+}
+
+/////////////////////////////////////////////////////////////////////
+// XmlNode methods
+
+//----< value of the first child if it is text >-----------------------
+
+std::string_view XmlNode::childText() const
+{
+  if (firstChild_ != nullptr && firstChild_->kind_ == text)
+    return firstChild_->value_;
+  return std::string_view();
+}
+//----< first child element with tag >---------------------------------
+
+const XmlNode* XmlNode::child(std::string_view tag) const
+{
+  for (const XmlNode* pChild = firstChild_; pChild != nullptr; pChild = pChild->next_)
+  {
+    if (pChild->kind_ == element && pChild->name_ == tag)
+      return pChild;
+  }
+  return nullptr;
+}
+//----< value of attribute name, empty if there is none >--------------
+
+std::string_view XmlNode::attributeValue(std::string_view name) const
+{
+  for (const XmlAttrib* pAttrib = firstAttrib_; pAttrib != nullptr; pAttrib = pAttrib->next)
+  {
+    if (pAttrib->name == name)
+      return pAttrib->value;
+  }
+  return std::string_view();
+}
+
+/////////////////////////////////////////////////////////////////////
+// XmlArenaDocument methods
+
+//----< construct an empty document >----------------------------------
+
+XmlArenaDocument::XmlArenaDocument(size_t blockSize) : arena_(blockSize)
+{
+  pDoc_ = makeNode(XmlNode::document);
+  nodes_ = 0;
+}
+//----< move construction >--------------------------------------------
+
+XmlArenaDocument::XmlArenaDocument(XmlArenaDocument&& doc)
+  : arena_(std::move(doc.arena_)), pDoc_(doc.pDoc_), nodes_(doc.nodes_)
+{
+  doc.pDoc_ = nullptr;
+  doc.nodes_ = 0;
+}
+//----< move assignment >----------------------------------------------
+
+XmlArenaDocument& XmlArenaDocument::operator=(XmlArenaDocument&& doc)
+{
+  if (this == &doc)
+    return *this;
+  arena_ = std::move(doc.arena_);
+  pDoc_ = doc.pDoc_;
+  nodes_ = doc.nodes_;
+  doc.pDoc_ = nullptr;
+  doc.nodes_ = 0;
+  return *this;
+}
+//----< drop every node, keeping the arena's first block >-------------
+
+void XmlArenaDocument::clear()
+{
+  arena_.clear();
+  pDoc_ = makeNode(XmlNode::document);
+  nodes_ = 0;
+}
+//----< the root element, nullptr if there is none >-------------------
+
+const XmlNode* XmlArenaDocument::xmlRoot() const
+{
+  for (const XmlNode& child : pDoc_->children())
+  {
+    if (child.isElement())
+      return &child;
+  }
+  return nullptr;
+}
+//----< new node, not yet in the tree >--------------------------------
+
+XmlNode* XmlArenaDocument::makeNode(XmlNode::Kind kind)
+{
+  static_assert(std::is_trivially_destructible<XmlNode>::value, "XmlNode must be trivially destructible");
+  ++nodes_;
+  return new (arena_.allocate(sizeof(XmlNode), alignof(XmlNode))) XmlNode(kind);
+}
+
+XmlNode* XmlArenaDocument::makeElement(std::string_view tag)
+{
+  XmlNode* pNode = makeNode(XmlNode::element);
+  pNode->name_ = arena_.copy(tag);
+  return pNode;
+}
+
+XmlNode* XmlArenaDocument::makeText(std::string_view text)
+{
+  XmlNode* pNode = makeNode(XmlNode::text);
+  pNode->value_ = arena_.copy(text);
+  return pNode;
+}
+
+XmlNode* XmlArenaDocument::makeComment(std::string_view text)
+{
+  XmlNode* pNode = makeNode(XmlNode::comment);
+  pNode->value_ = arena_.copy(text);
+  return pNode;
+}
+
+XmlNode* XmlArenaDocument::makeProcInstr(std::string_view target)
+{
+  XmlNode* pNode = makeNode(XmlNode::procInstr);
+  pNode->name_ = arena_.copy(target);
+  return pNode;
+}
+
+XmlNode* XmlArenaDocument::makeDeclaration()
+{
+  return makeNode(XmlNode::declaration);
+}
+//----< add pChild as the last child of pParent >----------------------
+
+XmlNode* XmlArenaDocument::append(XmlNode* pParent, XmlNode* pChild)
+{
+  pChild->parent_ = pParent;
+  pChild->next_ = nullptr;
+  if (pParent->lastChild_ == nullptr)
+    pParent->firstChild_ = pChild;
+  else
+    pParent->lastChild_->next_ = pChild;
+  pParent->lastChild_ = pChild;
+  return pChild;
+}
+//----< add <tag>text</tag> to pParent >-------------------------------
+
+XmlNode* XmlArenaDocument::addElement(XmlNode* pParent, std::string_view tag, std::string_view text)
+{
+  XmlNode* pElem = append(pParent, makeElement(tag));
+  if (!text.empty())
+    append(pElem, makeText(text));
+  return pElem;
+}
+//----< add an attribute after the node's others >---------------------
+
+void XmlArenaDocument::addAttrib(XmlNode* pNode, std::string_view name, std::string_view value)
+{
+  XmlAttrib* pAttrib = arena_.make<XmlAttrib>();
+  pAttrib->name = arena_.copy(name);
+  pAttrib->value = arena_.copy(value);
+  if (pNode->lastAttrib_ == nullptr)
+    pNode->firstAttrib_ = pAttrib;
+  else
+    pNode->lastAttrib_->next = pAttrib;
+  pNode->lastAttrib_ = pAttrib;
+}
+//----< elements with tag, all elements if tag is empty, in DFS order >
+
+std::vector<const XmlNode*> XmlArenaDocument::descendants(std::string_view tag) const
+{
+  std::vector<const XmlNode*> found;
+  auto collect = [&](const XmlNode& node) {
+    if (node.isElement() && (tag.empty() || node.tag() == tag))
+      found.push_back(&node);
+  };
+  DFS(*pDoc_, collect);
+  return found;
+}
+//----< parse xml into a new document >--------------------------------
+
+XmlArenaDocument XmlArenaDocument::parse(std::string_view xml)
+{
+  XmlArenaDocument doc;
+  doc.load(xml);
+  return doc;
+}
+//----< replace the tree with one parsed from xml >--------------------
+/*
+*  - the document is left empty if the xml is ill-formed
+*/
+void XmlArenaDocument::load(std::string_view xml)
+{
+  clear();
+
+  auto fail = [this](const std::string& msg) {
+    clear();
+    throw(std::exception(("ill-formed XML: " + msg).c_str()));
+  };
+
+  std::string scratch;
+  auto decoded = [&](std::string_view raw) {
+    if (!XmlViewToker::needsDecoding(raw))
+      return arena_.copy(raw);
+    scratch.clear();
+    XmlViewToker::decode(raw, scratch);
+    return arena_.copy(scratch);
+  };
+  auto addAttributes = [&](XmlNode* pNode, const XmlToken& token) {
+    for (const XmlToken::Attrib& attrib : token.attribs)
+    {
+      XmlAttrib* pAttrib = arena_.make<XmlAttrib>();
+      pAttrib->name = arena_.copy(attrib.first);
+      pAttrib->value = decoded(attrib.second);
+      if (pNode->lastAttrib_ == nullptr)
+        pNode->firstAttrib_ = pAttrib;
+      else
+        pNode->lastAttrib_->next = pAttrib;
+      pNode->lastAttrib_ = pAttrib;
+    }
+  };
+
+  std::vector<XmlNode*> stack{ pDoc_ };
+  bool sawRoot = false;
+
+  XmlViewToker toker(xml);
+  XmlToken token;
+  while (toker.next(token))
+  {
+    switch (token.kind)
+    {
+    case XmlToken::declaration:
+      addAttributes(append(stack.back(), makeDeclaration()), token);
+      break;
+    case XmlToken::procInstr:
+      addAttributes(append(stack.back(), makeProcInstr(token.name)), token);
+      break;
+    case XmlToken::comment:
+      append(stack.back(), makeComment(token.value));
+      break;
+    case XmlToken::startTag:
+    case XmlToken::emptyTag:
+    {
+      if (stack.size() == 1)
+      {
+        if (sawRoot)
+          fail("more than one root element");
+        sawRoot = true;
+      }
+      XmlNode* pElem = append(stack.back(), makeElement(token.name));
+      addAttributes(pElem, token);
+      pElem->sourceOffset_ = token.offset;
+      if (token.kind == XmlToken::startTag)
+        stack.push_back(pElem);
+      else
+        pElem->sourceLength_ = toker.offset() - token.offset;
+      break;
+    }
+    case XmlToken::endTag:
+      if (stack.size() == 1)
+        fail("end tag </" + std::string(token.name) + "> without start tag");
+      if (stack.back()->name_ != token.name)
+        fail("end tag </" + std::string(token.name) + "> does not match <" + std::string(stack.back()->name_) + ">");
+      stack.back()->sourceLength_ = toker.offset() - stack.back()->sourceOffset_;
+      stack.pop_back();
+      break;
+    case XmlToken::text:
+    case XmlToken::cdata:
+    {
+      if (stack.size() == 1)
+        fail("text outside the root element");
+      XmlNode* pText = makeNode(XmlNode::text);
+      pText->value_ = (token.kind == XmlToken::cdata ? arena_.copy(token.value) : decoded(token.value));
+      append(stack.back(), pText);
+      break;
+    }
+    default:
+      break;
+    }
+  }
+  if (!toker.error().empty())
+    fail(toker.error());
+  if (stack.size() > 1)
+    fail("element <" + std::string(stack.back()->name_) + "> is not closed");
+}
+//----< write a subtree >----------------------------------------------
+/*
+*  - XmlWriter has no comment or PI markup, so those nodes are skipped
+*/
+void XmlArenaDocument::write(XmlWriter& writer, const XmlNode& node) const
+{
+  switch (node.kind())
+  {
+  case XmlNode::document:
+    for (const XmlNode& child : node.children())
+      write(writer, child);
+    break;
+  case XmlNode::declaration:
+    writer.declaration();
+    break;
+  case XmlNode::element:
+    writer.startElement(std::string(node.tag()));
+    for (const XmlAttrib& attrib : node.attributes())
+      writer.attribute(std::string(attrib.name), std::string(attrib.value));
+    for (const XmlNode& child : node.children())
+      write(writer, child);
+    writer.endElement();
+    break;
+  case XmlNode::text:
+    writer.text(std::string(node.value()));
+    break;
+  default:
+    break;
+  }
+}
+//----< the document as indented XML >---------------------------------
+
+std::string XmlArenaDocument::toString() const
+{
+  std::ostringstream out;
+  {
+    XmlWriter writer(out);
+    write(writer, *pDoc_);
+  }
+  return out.str();
+}
+
+#ifdef TEST_XMLARENA
+
+#include <iostream>
+#include "../Utilities/Utilities.h"
+
+using namespace::Utilities;
+using Utils = StringHelper;
+
+int main()
+{
+  Utils::Title("Testing XmlArena");
+  putline();
+
+  std::string xml =
+    "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n"
+    "<!-- a comment -->\n"
+    "<db name=\"Titans &amp; co\">\n"
+    "  <record><key>Zeus</key>\n"
+    "    <description>a &lt; b &#x41;</description>\n"
+    "    <children/>\n"
+    "  </record>\n"
+    "  <record><key>Hera</key></record>\n"
+    "</db>\n";
+
+  Utils::title("Parsed document:");
+  XmlArenaDocument doc = XmlArenaDocument::parse(xml);
+  std::cout << "\n" << doc.toString();
+  std::cout << "\n  " << doc.size() << " nodes in " << doc.arena().bytesUsed() << " bytes of "
+    << doc.arena().bytesReserved() << " reserved";
+  putline();
+
+  Utils::title("Walking the tree:");
+  const XmlNode* pRoot = doc.xmlRoot();
+  std::cout << "\n  root <" << pRoot->tag() << "> name = \"" << pRoot->attributeValue("name") << "\"";
+  for (const XmlNode& record : pRoot->children())
+  {
+    std::cout << "\n  record key = " << record.child("key")->childText();
+    const XmlNode* pDescrip = record.child("description");
+    if (pDescrip != nullptr)
+      std::cout << ", description = " << pDescrip->childText();
+    std::cout << ", markup = " << xml.substr(record.sourceOffset(), record.sourceLength()).size() << " bytes";
+  }
+  std::cout << "\n  " << doc.descendants("key").size() << " keys, "
+    << doc.descendants().size() << " elements";
+  putline();
+
+  Utils::title("Building a document:");
+  XmlArenaDocument built;
+  built.append(built.makeDeclaration());
+  XmlNode* pDb = built.append(built.makeElement("db"));
+  built.addAttrib(pDb, "name", "built");
+  XmlNode* pRecord = built.addElement(pDb, "record");
+  built.addElement(pRecord, "key", "Athena");
+  std::cout << "\n" << built.toString();
+  putline();
+
+  Utils::title("Reusing the arena:");
+  for (int i = 0; i < 3; ++i)
+    doc.load(xml);
+  std::cout << "\n  after 3 loads: " << doc.arena().bytesReserved() << " bytes reserved";
+  putline();
+
+  Utils::title("Ill-formed XML:");
+  try
+  {
+    doc.load("<db><record></db>");
+  }
+  catch (std::exception& ex)
+  {
+    std::cout << "\n  " << ex.what();
+    std::cout << "\n  document left with " << doc.size() << " nodes";
+  }
+  std::cout << "\n\n";
+}
+
+#endif
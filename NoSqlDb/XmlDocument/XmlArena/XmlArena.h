@@ -0,0 +1,285 @@
+#ifndef XMLARENA_H
+#define XMLARENA_H
+///////////////////////////////////////////////////////////////////
+// XmlArena.h - XML document with nodes in an arena              //
+// ver 1.0                                                       //
+// Language:    C++, Visual Studio 2017                          //
+// Application: NoSqlDb, CSE687 - Object Oriented Design         //
+// Author:      Ritesh Nair (rgnair@syr.edu)                     //
+///////////////////////////////////////////////////////////////////
+/*
+* Package Operations:
+* -------------------
+* XmlDocument keeps every node in its own heap block behind a
+* std::shared_ptr, and children() returns a copy of the child vector,
+* so walking a tree allocates and bumps atomic reference counts at
+* every step.  This package is a second document model for code
+* which builds or reads many documents:
+*   XmlArena          - bump allocator; memory is taken from large
+*                       blocks and given back all at once
+*   XmlNode           - element, text, comment, PI or declaration;
+*                       children and attributes are intrusive lists
+*   XmlNodeRange,     - non-owning forward ranges over a node's
+*   XmlAttribRange      children and attributes
+*   XmlArenaDocument  - owns the arena and the tree built in it;
+*                       parses with XmlViewToker or is built with
+*                       makeElement(), append() and addAttrib()
+*
+* Nodes, attributes and the strings they hold all live in the arena
+* and have trivial destructors, so destroying or clearing a document
+* frees its blocks without visiting a single node.  Nodes are handed
+* out as plain pointers and references which are valid until the
+* document is cleared or destroyed.
+*
+* parse() follows XmlViewParser: entities are decoded, text is
+* trimmed, whitespace-only text is dropped, and ill-formed XML throws.
+* Elements parsed from a buffer remember where their markup lies in
+* it, so a caller still holding the buffer can take an element's
+* text without writing it out again.
+*
+* Required Files:
+* ---------------
+*   - XmlArena.h, XmlArena.cpp
+*   - XmlViewParser.h, XmlViewParser.cpp, XmlScanner.h, XmlScanner.cpp
+*   - XmlWriter.h, XmlWriter.cpp
+*
+* Build Process:
+* --------------
+*   define TEST_XMLARENA to build the test stub
+*
+* Maintenance History:
+* --------------------
+* ver 1.0 : 19 Oct 2026
+* - first release
+*/
+
+#include "../XmlViewParser/XmlViewParser.h"
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace XmlProcessing
+{
+  class XmlWriter;
+
+  /////////////////////////////////////////////////////////////////
+  // XmlArena
+  // - allocations larger than a quarter block get a block of their
+  //   own so they don't waste the rest of the current one
+
+  class XmlArena
+  {
+  public:
+    static const size_t DEFAULT_BLOCK_SIZE = 64 * 1024;
+
+    explicit XmlArena(size_t blockSize = DEFAULT_BLOCK_SIZE);
+    XmlArena(XmlArena&& arena);
+    XmlArena& operator=(XmlArena&& arena);
+    XmlArena(const XmlArena&) = delete;
+    XmlArena& operator=(const XmlArena&) = delete;
+
+    void* allocate(size_t size, size_t align = alignof(std::max_align_t));
+    std::string_view copy(std::string_view text);
+
+    // T must not need its destructor run
+    template <typename T, typename... Args>
+    T* make(Args&&... args)
+    {
+      static_assert(std::is_trivially_destructible<T>::value, "XmlArena: T must be trivially destructible");
+      return new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    }
+
+    // keeps the first block for reuse
+    void clear();
+
+    size_t bytesUsed() const { return used_; }
+    size_t bytesReserved() const { return reserved_; }
+
+  private:
+    char* addBlock(size_t size);
+
+    std::vector<std::unique_ptr<char[]>> blocks_;
+    size_t blockSize_;
+    size_t firstSize_ = 0;
+    char* next_ = nullptr;
+    char* end_ = nullptr;
+    size_t used_ = 0;
+    size_t reserved_ = 0;
+  };
+
+  /////////////////////////////////////////////////////////////////
+  // XmlAttrib
+
+  struct XmlAttrib
+  {
+    std::string_view name;
+    std::string_view value;
+    XmlAttrib* next = nullptr;
+  };
+
+  /////////////////////////////////////////////////////////////////
+  // XmlListRange
+  // - forward range over an intrusive list, e.g. the children of a
+  //   node; nothing is copied
+
+  template <typename T>
+  class XmlListRange
+  {
+  public:
+    class iterator
+    {
+    public:
+      using iterator_category = std::forward_iterator_tag;
+      using value_type = T;
+      using difference_type = std::ptrdiff_t;
+      using pointer = const T*;
+      using reference = const T&;
+
+      explicit iterator(const T* p = nullptr) : p_(p) {}
+      reference operator*() const { return *p_; }
+      pointer operator->() const { return p_; }
+      iterator& operator++() { p_ = nextOf(p_); return *this; }
+      iterator operator++(int) { iterator old = *this; p_ = nextOf(p_); return old; }
+      bool operator==(const iterator& it) const { return p_ == it.p_; }
+      bool operator!=(const iterator& it) const { return p_ != it.p_; }
+
+    private:
+      const T* p_;
+    };
+
+    explicit XmlListRange(const T* first = nullptr) : first_(first) {}
+    iterator begin() const { return iterator(first_); }
+    iterator end() const { return iterator(); }
+    bool empty() const { return first_ == nullptr; }
+    const T& front() const { return *first_; }
+    size_t size() const { return (size_t)std::distance(begin(), end()); }
+
+  private:
+    const T* first_;
+  };
+
+  class XmlNode;
+  using XmlNodeRange = XmlListRange<XmlNode>;
+  using XmlAttribRange = XmlListRange<XmlAttrib>;
+
+  /////////////////////////////////////////////////////////////////
+  // XmlNode
+  // - tag():       tag of an element, target of a PI
+  // - value():     content of text and comments
+  // - childText(): value of the first child if it is text, as with
+  //                children()[0]->value() on an AbstractXmlElement
+
+  class XmlNode
+  {
+  public:
+    enum Kind { document, element, text, comment, procInstr, declaration };
+
+    Kind kind() const { return kind_; }
+    bool isElement() const { return kind_ == element; }
+    std::string_view tag() const { return kind_ == element || kind_ == procInstr ? name_ : std::string_view(); }
+    std::string_view value() const { return value_; }
+    std::string_view childText() const;
+
+    const XmlNode* parent() const { return parent_; }
+    const XmlNode* firstChild() const { return firstChild_; }
+    const XmlNode* nextSibling() const { return next_; }
+    XmlNodeRange children() const { return XmlNodeRange(firstChild_); }
+    const XmlNode* child(std::string_view tag) const;   // first child element with tag, or nullptr
+
+    XmlAttribRange attributes() const { return XmlAttribRange(firstAttrib_); }
+    std::string_view attributeValue(std::string_view name) const;
+
+    // where the element's markup lies in the buffer it was parsed from;
+    // empty for nodes which were not parsed
+    size_t sourceOffset() const { return sourceOffset_; }
+    size_t sourceLength() const { return sourceLength_; }
+
+  private:
+    friend class XmlArenaDocument;
+    explicit XmlNode(Kind kind) : kind_(kind) {}
+
+    Kind kind_;
+    std::string_view name_;
+    std::string_view value_;
+    XmlNode* parent_ = nullptr;
+    XmlNode* firstChild_ = nullptr;
+    XmlNode* lastChild_ = nullptr;
+    XmlNode* next_ = nullptr;
+    XmlAttrib* firstAttrib_ = nullptr;
+    XmlAttrib* lastAttrib_ = nullptr;
+    size_t sourceOffset_ = 0;
+    size_t sourceLength_ = 0;
+  };
+
+  inline const XmlNode* nextOf(const XmlNode* pNode) { return pNode->nextSibling(); }
+  inline const XmlAttrib* nextOf(const XmlAttrib* pAttrib) { return pAttrib->next; }
+
+  /////////////////////////////////////////////////////////////////
+  // XmlArenaDocument
+  // - move only; a moved-from document may only be assigned to or
+  //   destroyed
+  // - parse throws std::exception if the XML is ill-formed
+
+  class XmlArenaDocument
+  {
+  public:
+    explicit XmlArenaDocument(size_t blockSize = XmlArena::DEFAULT_BLOCK_SIZE);
+    XmlArenaDocument(XmlArenaDocument&& doc);
+    XmlArenaDocument& operator=(XmlArenaDocument&& doc);
+    XmlArenaDocument(const XmlArenaDocument&) = delete;
+    XmlArenaDocument& operator=(const XmlArenaDocument&) = delete;
+
+    static XmlArenaDocument parse(std::string_view xml);
+    static XmlArenaDocument parse(const XmlSource& source) { return parse(source.view()); }
+
+    // replaces the tree with one parsed from xml, reusing the arena
+    void load(std::string_view xml);
+    void clear();
+
+    const XmlNode& docNode() const { return *pDoc_; }
+    const XmlNode* xmlRoot() const;
+
+    // building; strings are copied into the arena
+    XmlNode* makeElement(std::string_view tag);
+    XmlNode* makeText(std::string_view text);
+    XmlNode* makeComment(std::string_view text);
+    XmlNode* makeProcInstr(std::string_view target);
+    XmlNode* makeDeclaration();
+    XmlNode* append(XmlNode* pParent, XmlNode* pChild);
+    XmlNode* append(XmlNode* pChild) { return append(pDoc_, pChild); }
+    XmlNode* addElement(XmlNode* pParent, std::string_view tag, std::string_view text = std::string_view());
+    void addAttrib(XmlNode* pNode, std::string_view name, std::string_view value);
+
+    // queries
+    std::vector<const XmlNode*> descendants(std::string_view tag = std::string_view()) const;
+    size_t size() const { return nodes_; }
+    const XmlArena& arena() const { return arena_; }
+
+    void write(XmlWriter& writer, const XmlNode& node) const;
+    std::string toString() const;
+
+  private:
+    XmlNode* makeNode(XmlNode::Kind kind);
+
+    XmlArena arena_;
+    XmlNode* pDoc_;
+    size_t nodes_ = 0;
+  };
+
+  //----< depth first walk of a subtree >--------------------------------
+
+  template <typename CallObj>
+  void DFS(const XmlNode& node, CallObj& co)
+  {
+    co(node);
+    for (const XmlNode& child : node.children())
+      DFS(child, co);
+  }
+}
+#endif
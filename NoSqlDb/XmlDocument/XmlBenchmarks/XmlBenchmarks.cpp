@@ -0,0 +1,540 @@
+///////////////////////////////////////////////////////////////////
+// XmlBenchmarks.cpp - corpora and throughput benchmarks for the //
+//                     XmlProcessing parsers and serializers     //
+// ver 1.1                                                       //
+// Language:    C++, Visual Studio 2017                          //
+// Application: NoSqlDb, CSE687 - Object Oriented Design         //
+// Author:      Ritesh Nair (rgnair@syr.edu)                     //
+///////////////////////////////////////////////////////////////////
+
+#include "XmlBenchmarks.h"
+#include "../XmlDocument/XmlDocument.h"
+#include "../XmlViewParser/XmlViewParser.h"
+#include "../XmlArena/XmlArena.h"
+#include "../XmlScanner/XmlScanner.h"
+#include "../XmlParallelParser/XmlParallelParser.h"
+#include "../XmlPullReader/XmlPullReader.h"
+#include "../XmlWriter/XmlWriter.h"
+#include <cstdio>
+#include <exception>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <sstream>
+
+using namespace XmlProcessing;
+
+std::atomic<size_t> XmlAllocations::count{ 0 };
+std::atomic<size_t> XmlAllocations::bytes{ 0 };
+bool XmlAllocations::tracked = false;
+
+namespace
+{
+  const char* WORDS[] = {
+    "repository", "package", "version", "check-in", "check-out", "browse", "query", "record",
+    "dependency", "author", "closed", "open", "namespace", "category", "metadata", "payload",
+    "shard", "index", "parser", "element", "attribute", "document", "stream", "buffer",
+    "socket", "message", "sender", "receiver", "thread", "queue", "the", "a", "of", "and",
+    "to", "in", "is", "for", "with", "from", "each", "every", "which", "implements", "holds"
+  };
+  const size_t WORD_COUNT = sizeof(WORDS) / sizeof(WORDS[0]);
+
+  const char* DAYS[] = { "Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat" };
+  const char* MONTHS[] = { "Jan", "Feb", "Mar", "Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec" };
+
+  const size_t NAMESPACES = 50;
+  const size_t VERSIONS = 3;
+  const size_t MEGABYTE = 1024 * 1024;
+
+  // key of shard record i, as RepoUtilities::getDbKeyForVersion makes them
+  std::string keyOf(size_t record)
+  {
+    size_t file = record / VERSIONS;
+    return "ns" + std::to_string(file % NAMESPACES) + "##package" + std::to_string(file / 10)
+      + "/file" + std::to_string(file) + ".cpp#" + std::to_string(record % VERSIONS + 1);
+  }
+
+  // bytes written so far, without giving up the writer's large writes
+  size_t written(XmlWriter& writer, std::ostream& out)
+  {
+    writer.flush();
+    return (size_t)out.tellp();
+  }
+}
+
+/////////////////////////////////////////////////////////////////////
+// XmlCorpus
+
+//----< each kind gets its own stream from the seed >------------------
+
+XmlCorpus::XmlCorpus(Kind kind, size_t size, uint64_t seed)
+  : kind_(kind), size_(size), seed_(seed), rng_(seed * 4 + kind) {}
+
+std::string XmlCorpus::kindName(Kind kind)
+{
+  switch (kind)
+  {
+  case shard: return "shard";
+  case nested: return "nested";
+  case attributes: return "attributes";
+  default: return "text";
+  }
+}
+
+std::string XmlCorpus::name() const
+{
+  if (kind_ == shard)
+    return "shard." + std::to_string(size_);
+  return kindName(kind_) + "." + std::to_string(size_ / MEGABYTE) + "MB";
+}
+
+std::string XmlCorpus::queryTag() const
+{
+  switch (kind_)
+  {
+  case shard: return "key";
+  case nested: return "level";
+  case attributes: return "item";
+  default: return "para";
+  }
+}
+//----< random words >-------------------------------------------------
+
+std::string XmlCorpus::word()
+{
+  return WORDS[pick(WORD_COUNT)];
+}
+
+std::string XmlCorpus::sentence(size_t words)
+{
+  std::string text = word();
+  for (size_t i = 1; i < words; ++i)
+  {
+    text += (pick(40) == 0 ? " & " : " ");
+    text += word();
+  }
+  return text;
+}
+//----< write the corpus, returning its size in bytes >----------------
+
+size_t XmlCorpus::write(const std::string& fileSpec)
+{
+  std::ofstream out(fileSpec, std::ios::binary);
+  if (!out.good())
+    throw(std::exception(("can't open corpus file " + fileSpec).c_str()));
+
+  rng_.seed(seed_ * 4 + kind_);
+  units_ = 0;
+  {
+    XmlWriter writer(out, XmlWriter::DEFAULT_BUFFER_SIZE, kind_ != nested);
+    writer.declaration();
+    switch (kind_)
+    {
+    case shard: writeShard(writer); break;
+    case nested: writeNested(writer, out); break;
+    case attributes: writeAttributes(writer, out); break;
+    default: writeText(writer, out); break;
+    }
+    if (!writer.flush())
+      throw(std::exception(("can't write corpus file " + fileSpec).c_str()));
+  }
+  return (size_t)out.tellp();
+}
+//----< records shaped like the repository's properties db >-----------
+/*
+*  - a record depends on up to three records before it
+*/
+void XmlCorpus::writeShard(XmlWriter& writer)
+{
+  writer.startElement("shard").attribute("name", "ResourcePropertiesDb");
+  for (size_t i = 0; i < size_; ++i)
+  {
+    size_t file = i / VERSIONS;
+    writer.startElement("record");
+    writer.element("key", keyOf(i));
+    writer.startElement("value");
+
+    writer.startElement("metadata");
+    writer.element("name", "file" + std::to_string(file) + ".cpp");
+    writer.element("description", "Implements the " + sentence(3 + pick(10)));
+    std::ostringstream dateTime;
+    dateTime << DAYS[pick(7)] << " " << MONTHS[pick(12)] << " " << std::setw(2) << 1 + pick(28) << " "
+      << std::setfill('0') << std::setw(2) << pick(24) << ":" << std::setw(2) << pick(60) << ":"
+      << std::setw(2) << pick(60) << " " << 2016 + pick(3);
+    writer.element("datetime", dateTime.str());
+    writer.startElement("relationships");
+    for (size_t dep = pick(4); dep > 0 && i > 0; --dep)
+      writer.element("childkey", keyOf(pick(i)));
+    writer.endElement();
+    writer.endElement();
+
+    writer.startElement("payload");
+    writer.element("author", "author" + std::to_string(pick(200)));
+    writer.element("state", pick(3) == 0 ? "Open" : "Closed");
+    writer.element("namespace", "ns" + std::to_string(file % NAMESPACES));
+    writer.element("package", "package" + std::to_string(file / 10));
+    writer.element("version", std::to_string(i % VERSIONS + 1));
+    writer.startElement("categories");
+    for (size_t cat = 1 + pick(3); cat > 0; --cat)
+      writer.element("category", "category" + std::to_string(pick(20)));
+    writer.endElement();
+    writer.endElement();
+
+    writer.endElement();
+    writer.endElement();
+    ++units_;
+  }
+  writer.endElement();
+}
+//----< chains of elements NESTED_DEPTH deep >-------------------------
+
+void XmlCorpus::writeNested(XmlWriter& writer, std::ostream& out)
+{
+  writer.startElement("nested");
+  for (size_t chain = 0; written(writer, out) < size_; ++chain)
+  {
+    for (size_t level = 0; level < NESTED_DEPTH; ++level)
+    {
+      writer.startElement("level").attribute("n", std::to_string(level));
+      if (pick(8) == 0)
+        writer.element("note", sentence(1 + pick(4)));
+    }
+    writer.text(sentence(4 + pick(8)));
+    for (size_t level = 0; level < NESTED_DEPTH; ++level)
+      writer.endElement();
+    ++units_;
+  }
+  writer.endElement();
+}
+//----< elements which are nothing but attributes >--------------------
+
+void XmlCorpus::writeAttributes(XmlWriter& writer, std::ostream& out)
+{
+  static const char* values[] = { "a < b", "\"quoted\"", "x & y", "<tag>" };
+  writer.startElement("catalog");
+  for (size_t item = 0; item % 64 != 0 || written(writer, out) < size_; ++item)
+  {
+    writer.startElement("item").attribute("id", std::to_string(item));
+    for (size_t attr = 4 + pick(21); attr > 0; --attr)
+    {
+      std::string value = (pick(10) == 0 ? values[pick(4)] : word() + std::to_string(pick(1000)));
+      writer.attribute(word() + std::to_string(attr), value);
+    }
+    writer.endElement();
+    ++units_;
+  }
+  writer.endElement();
+}
+//----< chapters of long paragraphs >----------------------------------
+
+void XmlCorpus::writeText(XmlWriter& writer, std::ostream& out)
+{
+  writer.startElement("book");
+  for (size_t chapter = 0; written(writer, out) < size_; ++chapter)
+  {
+    writer.startElement("chapter").attribute("n", std::to_string(chapter));
+    writer.element("title", sentence(2 + pick(5)));
+    for (size_t para = 4 + pick(12); para > 0; --para)
+    {
+      std::string text = sentence(5 + pick(300));
+      writer.element("para", text.substr(0, 2000));
+    }
+    writer.endElement();
+    ++units_;
+  }
+  writer.endElement();
+}
+
+/////////////////////////////////////////////////////////////////////
+// result reporting
+
+//----< BenchResult's JSON with the corpus added >---------------------
+
+std::string XmlProcessing::toJson(const XmlBenchResult& result)
+{
+  std::string json = NoSqlDbBenchmarks::toJson(result.bench);
+  json.pop_back();   // closing brace
+
+  std::ostringstream out;
+  out << json
+    << ",\"corpus\":\"" << result.corpus << "\""
+    << ",\"seed\":" << result.seed
+    << ",\"corpusBytes\":" << result.corpusBytes;
+  if (result.allocsPerOp >= 0.0)
+    out << std::fixed << std::setprecision(1) << ",\"allocsPerOp\":" << result.allocsPerOp;
+  out << "}";
+  return out.str();
+}
+
+std::string XmlProcessing::toText(const XmlBenchResult& result)
+{
+  std::ostringstream out;
+  out << NoSqlDbBenchmarks::toText(result.bench) << "  " << result.corpus;
+  if (result.allocsPerOp >= 0.0)
+    out << "  " << std::fixed << std::setprecision(1) << result.allocsPerOp << " allocs/op";
+  return out.str();
+}
+
+/////////////////////////////////////////////////////////////////////
+// XmlBenchmarkSuite
+
+//----< shards of each size, then one corpus of each other kind >------
+
+void XmlBenchmarkSuite::run()
+{
+  for (size_t records : records_)
+  {
+    XmlCorpus corpus(XmlCorpus::shard, records, seed_);
+    runCorpus(corpus);
+  }
+  for (XmlCorpus::Kind kind : { XmlCorpus::nested, XmlCorpus::attributes, XmlCorpus::text })
+  {
+    XmlCorpus corpus(kind, megabytes_ * MEGABYTE, seed_);
+    runCorpus(corpus);
+  }
+}
+//----< number of times to parse a corpus >----------------------------
+/*
+*  - about 64 MB of input per benchmark, at least once, at most 20 times
+*/
+size_t XmlBenchmarkSuite::opsFor(size_t bytes)
+{
+  size_t ops = 64 * MEGABYTE / (bytes == 0 ? 1 : bytes);
+  return std::max<size_t>(1, std::min<size_t>(ops, 20));
+}
+
+void XmlBenchmarkSuite::report(const XmlBenchResult& result)
+{
+  results_.push_back(result);
+  out_ << (asText_ ? toText(result) : toJson(result)) << std::endl;
+}
+//----< every benchmark over one corpus >------------------------------
+/*
+*  - documents are freed inside the timed operation, as they are by a
+*    reader which parses one after another
+*/
+void XmlBenchmarkSuite::runCorpus(XmlCorpus& corpus)
+{
+  std::string fileSpec = "XmlBenchmarks." + corpus.name() + ".xml";
+  corpusBytes_ = corpus.write(fileSpec);
+  size_t ops = opsFor(corpusBytes_);
+  bool buildDom = (corpus.kind() != XmlCorpus::shard || corpus.size() <= DOM_RECORD_LIMIT);
+
+  XmlSource source = XmlSource::fromFile(fileSpec);
+  size_t seen = 0;
+  // tokenizer and raw structural scan at each scanner level the CPU has
+  for (XmlScanner::Level level : { XmlScanner::scalar, XmlScanner::sse2, XmlScanner::avx2 })
+  {
+    if (level > XmlScanner::supportedLevel())
+      break;
+    XmlScanner::useLevel(level);
+    std::string suffix = "." + XmlScanner::levelName(level);
+
+    measure("xml.tokenize.XmlViewToker" + suffix, corpus, ops, corpusBytes_, [&](size_t) {
+      XmlViewToker toker(source.view());
+      XmlToken token;
+      while (toker.next(token))
+        seen += token.value.size();
+    });
+    measure("xml.scan.structurals" + suffix, corpus, ops, corpusBytes_, [&](size_t) {
+      XmlStructuralIndex index(source.view());
+      for (size_t pos = index.next(0); pos != XmlStructuralIndex::npos; pos = index.next(pos + 1))
+        ++seen;
+    });
+  }
+  XmlScanner::useLevel(XmlScanner::supportedLevel());
+
+  measure("xml.dom.XmlArenaDocument", corpus, ops, corpusBytes_, [&](size_t) {
+    XmlArenaDocument doc = XmlArenaDocument::parse(source);
+    seen += doc.size();
+  });
+  {
+    XmlArenaDocument doc = XmlArenaDocument::parse(source);
+    auto visitNode = [&](const XmlNode& node) { seen += node.value().size(); };
+    measure("xml.walk.XmlArenaDocument", corpus, ops, corpusBytes_, [&](size_t) {
+      DFS(doc.docNode(), visitNode);
+    });
+  }
+
+  // pulling every event; for shards also only the keys, with the rest of each record skipped
+  measure("xml.pull.XmlPullReader", corpus, ops, corpusBytes_, [&](size_t) {
+    XmlPullReader reader = XmlPullReader::fromFile(fileSpec);
+    while (reader.next() != XmlPullReader::endDocument)
+      seen += reader.text().size();
+  });
+  if (corpus.kind() == XmlCorpus::shard)
+  {
+    measure("xml.pull.keys", corpus, ops, corpusBytes_, [&](size_t) {
+      XmlPullReader reader = XmlPullReader::fromFile(fileSpec);
+      reader.nextElement("shard");
+      while (reader.nextElement("record"))
+      {
+        if (reader.nextElement("key"))
+          seen += reader.readText().size();
+        reader.skipSubtree();
+      }
+    });
+
+    // record boundaries alone, then records parsed and walked on one thread per core
+    measure("xml.split.XmlRecordSplitter", corpus, ops, corpusBytes_, [&](size_t) {
+      XmlRecordSplitter splitter(source.view(), "record");
+      splitter.split();
+      seen += splitter.records().size();
+    });
+    measure("xml.dom.XmlParallelParser", corpus, ops, corpusBytes_, [&](size_t) {
+      XmlParallelParser parser(source);
+      parser.map<size_t>([](const XmlNode& record, std::string_view) {
+        size_t bytes = 0;
+        auto visitRecordNode = [&](const XmlNode& node) { bytes += node.value().size(); };
+        DFS(record, visitRecordNode);
+        return bytes;
+      });
+    });
+  }
+
+  if (buildDom && corpusBytes_ <= XMLPARSER_BYTE_LIMIT)
+  {
+    measure("xml.dom.XmlParser", corpus, ops, corpusBytes_, [&](size_t) {
+      XmlDocument doc(fileSpec, XmlDocument::file);
+    });
+  }
+
+  if (buildDom)
+  {
+    measure("xml.dom.XmlViewParser", corpus, ops, corpusBytes_, [&](size_t) {
+      std::unique_ptr<XmlDocument> pDoc(XmlViewParser(source).buildDocument());
+    });
+
+    // walking and querying the tree, then writing it out again
+    std::unique_ptr<XmlDocument> pDoc(XmlViewParser(source).buildDocument());
+    auto visitElem = [&](AbstractXmlElement& elem) { seen += elem.value().size(); };
+    measure("xml.walk.XmlDocument", corpus, ops, corpusBytes_, [&](size_t) {
+      DFS(*pDoc, visitElem);
+    });
+
+    std::string tag = corpus.queryTag();
+    measure("xml.query.descendents", corpus, ops, 0, [&](size_t) {
+      seen += pDoc->descendents(tag).select().size();
+    });
+    measure("xml.query.element.miss", corpus, ops, 0, [&](size_t) {
+      seen += pDoc->element("absent").select().size();
+    });
+    pDoc->indexTags();
+    measure("xml.query.descendents.indexed", corpus, ops, 0, [&](size_t) {
+      seen += pDoc->descendents(tag).select().size();
+    });
+    measure("xml.query.element.miss.indexed", corpus, ops, 0, [&](size_t) {
+      seen += pDoc->element("absent").select().size();
+    });
+    pDoc->indexTags(false);
+    if (corpus.kind() == XmlCorpus::shard)
+    {
+      XmlPath keyPath("shard/record/key");
+      measure("xml.query.XmlPath", corpus, ops, 0, [&](size_t) {
+        seen += pDoc->select(keyPath).size();
+      });
+    }
+
+    size_t indented = pDoc->toString().size();
+    measure("xml.toString", corpus, ops, indented, [&](size_t) {
+      seen += pDoc->toString().size();
+    });
+    size_t compact = pDoc->toString(XmlSerializer::compact).size();
+    measure("xml.toString.compact", corpus, ops, compact, [&](size_t) {
+      seen += pDoc->toString(XmlSerializer::compact).size();
+    });
+  }
+
+  if (!keep_)
+  {
+    source = XmlSource::fromString("");
+    std::remove(fileSpec.c_str());
+  }
+}
+
+#ifdef TEST_XMLBENCHMARKS
+
+#include <cstdlib>
+#include <new>
+
+//----< count every allocation the benchmarks make >-------------------
+/*
+*  - array and nothrow forms call these
+*/
+void* operator new(size_t size)
+{
+  XmlAllocations::add(size);
+  void* p = std::malloc(size == 0 ? 1 : size);
+  if (p == nullptr)
+    throw std::bad_alloc();
+  return p;
+}
+
+void operator delete(void* p) noexcept
+{
+  std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept
+{
+  std::free(p);
+}
+
+//----< comma separated list of record counts >------------------------
+
+XmlBenchmarkSuite::Sizes parseSizes(const std::string& list)
+{
+  XmlBenchmarkSuite::Sizes sizes;
+  std::istringstream in(list);
+  std::string item;
+  while (std::getline(in, item, ','))
+  {
+    if (!item.empty())
+      sizes.push_back((size_t)std::stoull(item));
+  }
+  return sizes;
+}
+
+int main(int argc, char* argv[])
+{
+  XmlAllocations::tracked = true;
+  bool asText = false;
+  XmlBenchmarkSuite::Sizes records = XmlBenchmarkSuite::defaultRecords();
+  size_t megabytes = 16;
+  uint64_t seed = XmlBenchmarkSuite::DEFAULT_SEED;
+  bool keep = false;
+
+  for (int i = 1; i < argc; ++i)
+  {
+    std::string arg = argv[i];
+    if (arg == "--records" && i + 1 < argc)
+      records = parseSizes(argv[++i]);
+    else if (arg == "--mb" && i + 1 < argc)
+      megabytes = (size_t)std::stoull(argv[++i]);
+    else if (arg == "--seed" && i + 1 < argc)
+      seed = std::stoull(argv[++i]);
+    else if (arg == "--text")
+      asText = true;
+    else if (arg == "--keep")
+      keep = true;
+    else
+    {
+      std::cout << "\n  usage: XmlBenchmarks [--records 1000,10000,...] [--mb 16] [--seed 687] [--text] [--keep]\n";
+      return 1;
+    }
+  }
+
+  try
+  {
+    XmlBenchmarkSuite suite(std::cout, asText);
+    suite.records(records).corpusMegabytes(megabytes).seed(seed).keepFiles(keep).run();
+  }
+  catch (std::exception& ex)
+  {
+    std::cout << "\n  " << ex.what() << "\n";
+    return 1;
+  }
+  return 0;
+}
+
+#endif
@@ -0,0 +1,240 @@
+#ifndef XMLBENCHMARKS_H
+#define XMLBENCHMARKS_H
+///////////////////////////////////////////////////////////////////
+// XmlBenchmarks.h - corpora and throughput benchmarks for the   //
+//                   XmlProcessing parsers and serializers       //
+// ver 1.1                                                       //
+// Language:    C++, Visual Studio 2017                          //
+// Application: NoSqlDb, CSE687 - Object Oriented Design         //
+// Author:      Ritesh Nair (rgnair@syr.edu)                     //
+///////////////////////////////////////////////////////////////////
+/*
+* Package Operations:
+* -------------------
+* NoSqlDb's Benchmarks measure XML only through exportDb and importDb.
+* This package is where the XmlProcessing packages are measured on
+* their own, over documents of several shapes, so that parser and
+* serializer changes can be compared before and after:
+*   XmlCorpus          - writes a synthetic document to a file with
+*                        XmlWriter; the same kind, size and seed always
+*                        give the same bytes
+*   XmlAllocations     - number and size of operator new calls; counted
+*                        only in the benchmark executable, which
+*                        replaces the global operator new
+*   XmlBenchmarkSuite  - for each corpus: tokenizing and the raw
+*                        structural scan at each XmlScanner level,
+*                        parsing into an XmlDocument (XmlParser and
+*                        XmlViewParser) and an XmlArenaDocument, walking
+*                        both, pulling every XmlPullReader event,
+*                        descendents() and element() queries with and
+*                        without the tag index, and toString() indented
+*                        and compact; for shards also pulling only the
+*                        keys, splitting into records, parsing with
+*                        XmlParallelParser and an XmlPath query
+*
+* Corpora:
+*   shard       - repository_state.xml: <record>s with key, metadata,
+*                 relationships and FileResourcePayload fields;
+*                 sized in records
+*   nested      - chains of elements NESTED_DEPTH deep; sized in bytes
+*   attributes  - elements with 4 to 24 attributes and no text, values
+*                 sometimes needing entities; sized in bytes
+*   text        - paragraphs of up to 2000 characters of words with
+*                 the odd entity; sized in bytes
+*
+* Results use BenchResult and measure() from NoSqlDb's Benchmarks and
+* are written one JSON object per line, with the corpus, its seed and
+* size and the allocations per operation added; "records" is the
+* number of records, chains, items or chapters in the corpus.  Throughput is of
+* the document parsed, or, for toString, of the text written.
+*
+* Required Files:
+* ---------------
+*   - XmlBenchmarks.h, XmlBenchmarks.cpp
+*   - Benchmarks.h, Benchmarks.cpp and what they require
+*   - XmlDocument.h, XmlDocument.cpp, XmlElement.h, XmlElement.cpp
+*   - XmlParser.h, XmlParser.cpp, XmlViewParser.h, XmlViewParser.cpp
+*   - XmlScanner.h, XmlScanner.cpp, XmlArena.h, XmlArena.cpp
+*   - XmlParallelParser.h, XmlParallelParser.cpp
+*   - XmlPullReader.h, XmlPullReader.cpp
+*   - XmlWriter.h, XmlWriter.cpp
+*
+* Build Process:
+* --------------
+*   The XmlBenchmarks project of RemoteCodeRepository.sln, next to
+*   NoSqlDb's Benchmarks, defines TEST_XMLBENCHMARKS; build it in
+*   Release mode.  Usage:
+*     XmlBenchmarks [--records 1000,10000,100000] [--mb 16] [--seed 687]
+*                   [--text] [--keep]
+*   Shards of up to 5M records can be asked for with --records.  Above
+*   DOM_RECORD_LIMIT records only tokenizing and the arena document are
+*   measured, as an XmlDocument of that size needs too much memory;
+*   XmlParser is only run up to XMLPARSER_BYTE_LIMIT.  --keep leaves
+*   the corpus files in the working directory.
+*
+* Maintenance History:
+* --------------------
+* ver 1.1 : 19 Oct 2026
+* - took over the XML benchmarks NoSqlDb's Benchmarks ran on its
+*   export: scanner levels, walks, pull reader, record splitting,
+*   parallel parse and XmlPath
+* - built by its own project in RemoteCodeRepository.sln
+* ver 1.0 : 19 Oct 2026
+* - first release
+*/
+
+#include "../../Benchmarks/Benchmarks.h"
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace XmlProcessing
+{
+  class XmlWriter;
+
+  /////////////////////////////////////////////////////////////////
+  // XmlAllocations
+  // - counters are relaxed atomics; counts taken around a benchmark
+  //   are only meaningful while no other thread allocates
+
+  struct XmlAllocations
+  {
+    static std::atomic<size_t> count;
+    static std::atomic<size_t> bytes;
+    static bool tracked;   // true once operator new counts
+
+    static void add(size_t size)
+    {
+      count.fetch_add(1, std::memory_order_relaxed);
+      bytes.fetch_add(size, std::memory_order_relaxed);
+    }
+  };
+
+  /////////////////////////////////////////////////////////////////
+  // XmlCorpus
+  // - random numbers are taken straight from std::mt19937_64, whose
+  //   output the standard fixes, so corpora are the same everywhere
+
+  class XmlCorpus
+  {
+  public:
+    enum Kind { shard, nested, attributes, text };
+
+    static const size_t NESTED_DEPTH = 200;
+
+    XmlCorpus(Kind kind, size_t size, uint64_t seed);
+
+    Kind kind() const { return kind_; }
+    size_t size() const { return size_; }
+    size_t units() const { return units_; }   // records, chains, items or chapters written
+    uint64_t seed() const { return seed_; }
+    std::string name() const;
+    std::string queryTag() const;   // tag with many elements
+
+    // writes the corpus to fileSpec and returns its size in bytes
+    size_t write(const std::string& fileSpec);
+
+    static std::string kindName(Kind kind);
+
+  private:
+    size_t pick(size_t n) { return (size_t)(rng_() % n); }
+    std::string word();
+    std::string sentence(size_t words);
+
+    void writeShard(XmlWriter& writer);
+    void writeNested(XmlWriter& writer, std::ostream& out);
+    void writeAttributes(XmlWriter& writer, std::ostream& out);
+    void writeText(XmlWriter& writer, std::ostream& out);
+
+    Kind kind_;
+    size_t size_;
+    uint64_t seed_;
+    size_t units_ = 0;
+    std::mt19937_64 rng_;
+  };
+
+  /////////////////////////////////////////////////////////////////
+  // XmlBenchResult
+  // - a BenchResult with the corpus it was measured on
+
+  struct XmlBenchResult
+  {
+    NoSqlDbBenchmarks::BenchResult bench;
+    std::string corpus;
+    uint64_t seed = 0;
+    size_t corpusBytes = 0;
+    double allocsPerOp = -1.0;   // negative when not counted
+  };
+
+  std::string toJson(const XmlBenchResult& result);
+  std::string toText(const XmlBenchResult& result);
+
+  /////////////////////////////////////////////////////////////////
+  // XmlBenchmarkSuite
+
+  class XmlBenchmarkSuite
+  {
+  public:
+    using Sizes = std::vector<size_t>;
+
+    static const size_t DOM_RECORD_LIMIT = 1000000;
+    static const size_t XMLPARSER_BYTE_LIMIT = 64 * 1024 * 1024;
+    static const uint64_t DEFAULT_SEED = 687;
+
+    XmlBenchmarkSuite(std::ostream& out = std::cout, bool asText = false)
+      : out_(out), asText_(asText) {}
+
+    XmlBenchmarkSuite& records(const Sizes& sizes) { records_ = sizes; return *this; }
+    XmlBenchmarkSuite& corpusMegabytes(size_t mb) { megabytes_ = mb; return *this; }
+    XmlBenchmarkSuite& seed(uint64_t seed) { seed_ = seed; return *this; }
+    XmlBenchmarkSuite& keepFiles(bool keep) { keep_ = keep; return *this; }
+
+    void run();
+    void runCorpus(XmlCorpus& corpus);
+    const std::vector<XmlBenchResult>& results() const { return results_; }
+
+    static Sizes defaultRecords() { return { 1000, 10000, 100000 }; }
+
+  private:
+    template <typename Op>
+    void measure(const std::string& name, const XmlCorpus& corpus, size_t ops, size_t bytesPerOp, Op op);
+    void report(const XmlBenchResult& result);
+    static size_t opsFor(size_t bytes);
+
+    std::ostream& out_;
+    bool asText_;
+    Sizes records_ = defaultRecords();
+    size_t megabytes_ = 16;
+    uint64_t seed_ = DEFAULT_SEED;
+    bool keep_ = false;
+    size_t corpusBytes_ = 0;
+    std::vector<XmlBenchResult> results_;
+  };
+
+  //----< time op, counting the allocations it makes, and report it >-----
+
+  template <typename Op>
+  void XmlBenchmarkSuite::measure(const std::string& name, const XmlCorpus& corpus, size_t ops, size_t bytesPerOp, Op op)
+  {
+    size_t allocs = 0;
+    auto counted = [&](size_t i) {
+      size_t before = XmlAllocations::count.load(std::memory_order_relaxed);
+      op(i);
+      allocs += XmlAllocations::count.load(std::memory_order_relaxed) - before;
+    };
+    XmlBenchResult result;
+    result.bench = NoSqlDbBenchmarks::measure(name, corpus.units(), ops, counted);
+
+    result.bench.bytesPerOp = bytesPerOp;
+    result.corpus = corpus.name();
+    result.seed = corpus.seed();
+    result.corpusBytes = corpusBytes_;
+    if (XmlAllocations::tracked)
+      result.allocsPerOp = (double)allocs / ops;
+    report(result);
+  }
+}
+#endif
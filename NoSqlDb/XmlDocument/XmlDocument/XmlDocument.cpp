@@ -1,12 +1,13 @@
 ///////////////////////////////////////////////////////////////////
 // XmlDocument.cpp - a container of XmlElement nodes             //
-// Ver 2.5                                                       //
+// Ver 2.8                                                       //
 // Application: Help for CSE687 Pr#2, Spring 2015                //
 // Platform:    Dell XPS 2720, Win 8.1 Pro, Visual Studio 2013   //
 // Author:      Jim Fawcett, CST 4-187, 443-3948                 //
 //              jfawcett@twcny.rr.com                            //
 ///////////////////////////////////////////////////////////////////
 
+#include <algorithm>
 #include <iostream>
 #include <functional>
 #include "XmlDocument.h"
@@ -19,11 +20,13 @@ using sPtr = std::shared_ptr < AbstractXmlElement > ;
 /////////////////////////////////////////////////////////////////////////////
 // Definitions of XmlDocument methods
 
-XmlProcessing::XmlDocument::XmlDocument(const std::string& src, sourceType srcType)
+XmlProcessing::XmlDocument::XmlDocument(const std::string& src, sourceType srcType, bool indexed)
 {
   XmlParser parser(src, (XmlParser::sourceType) srcType);
-  XmlDocument* pDoc = parser.buildDocument();
+  std::unique_ptr<XmlDocument> pDoc(parser.buildDocument());
   *this = std::move(*pDoc);
+  if (indexed)
+    indexTags();
 }
 //----< move constructor >---------------------------------------------------
 
@@ -31,6 +34,8 @@ XmlDocument::XmlDocument(XmlDocument&& doc)
 {
   pDocElement_ = doc.pDocElement_;
   doc.pDocElement_ = nullptr;
+  pWatch_ = std::move(doc.pWatch_);
+  pIndex_ = std::move(doc.pIndex_);
 }
 //----< move assignment >----------------------------------------------------
 
@@ -39,6 +44,8 @@ XmlDocument& XmlDocument::operator=(XmlDocument&& doc)
   if (&doc == this) return *this;
   pDocElement_ = doc.pDocElement_;
   doc.pDocElement_ = nullptr;
+  pWatch_ = std::move(doc.pWatch_);
+  pIndex_ = std::move(doc.pIndex_);
   return *this;
 }
 //----< return std::shared_ptr to XML root >---------------------------------
@@ -81,7 +88,8 @@ bool XmlDocument::find(const std::string& tag, sPtr pElem, bool findall)
 XmlDocument& XmlDocument::element(const std::string& tag)
 {
   found_.clear();
-  find(tag, pDocElement_, false);
+  if (!findIndexed(tag, pDocElement_, false))
+    find(tag, pDocElement_, false);
   return *this;
 }
 //----< find children of element with this tag >-----------------------------
@@ -111,6 +119,13 @@ XmlDocument& XmlDocument::descendents(const std::string& tag)
     found_.push_back(xmlRoot());
   sPtr pElem = found_[0];
   found_.clear();
+  TagIndex* pIndex = index();
+  if (pIndex != nullptr && pIndex->position.count(pElem.get()) > 0)
+  {
+    size_t first = pIndex->position[pElem.get()];
+    collect(tag, first + 1, pIndex->subtreeEnd[first]);
+    return *this;
+  }
   for (auto pChild : pElem->children())
     find(tag, pChild, true);
   return *this;
@@ -125,16 +140,177 @@ std::vector<sPtr> XmlDocument::select()
 
 size_t XmlDocument::size()
 {
+  TagIndex* pIndex = index();
+  if (pIndex != nullptr)
+    return pIndex->nodes.size() - 1;  // don't count docElement
   find("", pDocElement_, true);
   size_t size_ = found_.size() - 1;  // don't count docElement
   found_.clear();
   return size_;
 }
+//----< return elements matching a compiled path >--------------------------
+
+std::vector<sPtr> XmlDocument::select(const XmlPath& path)
+{
+  return path.select(pDocElement_);
+}
+//----< turn the tag index on or off >---------------------------------------
+/*
+ *  the index is built here and again, whole, on the first query after
+ *  an addChild or removeChild anywhere in the tree
+ */
+XmlDocument& XmlDocument::indexTags(bool on)
+{
+  if (!on)
+  {
+    pWatch_.reset();   // elements' watches expire with it
+    pIndex_.reset();
+    return *this;
+  }
+  if (pWatch_ == nullptr)
+    pWatch_ = std::make_shared<XmlTreeWatch>();
+  index();
+  return *this;
+}
+//----< the tag index, rebuilt if the tree has changed; nullptr if off >-----
+
+XmlDocument::TagIndex* XmlDocument::index()
+{
+  if (pWatch_ == nullptr)
+    return nullptr;
+  if (pIndex_ == nullptr || pWatch_->changed || pIndex_->pDocElement != pDocElement_.get())
+  {
+    pIndex_.reset(new TagIndex);
+    pWatch_->changed = false;
+    pIndex_->pDocElement = pDocElement_.get();
+    if (pDocElement_ != nullptr)
+      addToIndex(pDocElement_);
+  }
+  return pIndex_.get();
+}
+//----< add pElem and its descendents to the index in DFS order >------------
+
+void XmlDocument::addToIndex(const sPtr& pElem)
+{
+  size_t pos = pIndex_->nodes.size();
+  pIndex_->nodes.push_back(pElem);
+  pIndex_->subtreeEnd.push_back(pos + 1);
+  pIndex_->position[pElem.get()] = pos;
+  pElem->watch(pWatch_);
+
+  std::string tag = pElem->tag();
+  if (tag.size() > 0)
+    pIndex_->byTag[tag].push_back(pos);
+
+  for (auto pChild : pElem->children())
+    addToIndex(pChild);
+  pIndex_->subtreeEnd[pos] = pIndex_->nodes.size();
+}
+//----< find, answered from the index >--------------------------------------
+/*
+ *  returns false, finding nothing, if there is no index or pElem isn't in it
+ */
+bool XmlDocument::findIndexed(const std::string& tag, sPtr pElem, bool findall)
+{
+  TagIndex* pIndex = index();
+  if (pIndex == nullptr)
+    return false;
+  auto iter = pIndex->position.find(pElem.get());
+  if (iter == pIndex->position.end())
+    return false;
+
+  size_t first = iter->second;
+  if (!findall && (tag == "" || pElem->tag() == tag))
+    found_.push_back(pElem);
+  else
+    collect(tag, first, pIndex->subtreeEnd[first]);
+  return true;
+}
+//----< add indexed nodes first .. last-1 with tag, all if tag is "" >-------
+
+void XmlDocument::collect(const std::string& tag, size_t first, size_t last)
+{
+  if (tag == "")
+  {
+    found_.insert(found_.end(), pIndex_->nodes.begin() + first, pIndex_->nodes.begin() + last);
+    return;
+  }
+  auto tagIter = pIndex_->byTag.find(tag);
+  if (tagIter == pIndex_->byTag.end())
+    return;
+  const std::vector<size_t>& positions = tagIter->second;
+  for (auto pos = std::lower_bound(positions.begin(), positions.end(), first); pos != positions.end() && *pos < last; ++pos)
+    found_.push_back(pIndex_->nodes[*pos]);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// Definitions of XmlPath methods
+
+//----< compile path into its steps >----------------------------------------
+
+XmlPath::XmlPath(const std::string& path)
+{
+  size_t begin = 0;
+  while (begin < path.size())
+  {
+    size_t end = path.find('/', begin);
+    if (end == std::string::npos)
+      end = path.size();
+    if (end > begin)
+      steps_.push_back(path.substr(begin, end - begin));
+    begin = end + 1;
+  }
+  if (steps_.size() == 0)
+    throw(std::exception(("XmlPath has no steps: \"" + path + "\"").c_str()));
+}
+//----< elements matching the path in the document under pDocElement >------
+
+std::vector<sPtr> XmlPath::select(sPtr pDocElement) const
+{
+  std::vector<sPtr> found;
+  if (pDocElement != nullptr)
+    match(pDocElement, 0, found);
+  return found;
+}
+//----< match children of pElem against step, descending on a hit >---------
+
+void XmlPath::match(sPtr pElem, size_t step, std::vector<sPtr>& found) const
+{
+  const std::string& want = steps_[step];
+  bool lastStep = (step + 1 == steps_.size());
+  for (auto pChild : pElem->children())
+  {
+    std::string tag = pChild->tag();
+    if (tag.size() == 0 || (want != "*" && tag != want))
+      continue;
+    if (lastStep)
+      found.push_back(pChild);
+    else
+      match(pChild, step + 1, found);
+  }
+}
+//----< path as it would be written >----------------------------------------
+
+std::string XmlPath::toString() const
+{
+  std::string path;
+  for (auto& step : steps_)
+    path += (path.size() > 0 ? "/" : "") + step;
+  return path;
+}
 //----< return XML string representation of XmlDocument >--------------------
 
-std::string XmlDocument::toString()
+std::string XmlDocument::toString(XmlSerializer::Layout layout)
+{
+  return XmlSerializer::toString(*pDocElement_, layout);
+}
+//----< write XML to a stream, returns false if the stream fails >-----------
+
+bool XmlDocument::write(std::ostream& out, XmlSerializer::Layout layout)
 {
-  return pDocElement_->toString();
+  XmlSerializer serializer(out, layout);
+  serializer.write(*pDocElement_);
+  return serializer.flush();
 }
 
 std::string enQuote(std::string s) { return "\"" + s + "\""; }
@@ -292,6 +468,27 @@ int main()
   testDescendents(doc);
   testElementDescendents(doc);
 
+  title("Testing the tag index");
+  size_t walked = doc.descendents("child1").select().size();
+  doc.indexTags();
+  std::cout << "\n  descendents(\"child1\"): " << walked << " found walking the tree, "
+    << doc.descendents("child1").select().size() << " found with the index";
+  sPtr child3 = makeTaggedElement("child1");
+  doc.xmlRoot()->addChild(child3);
+  std::cout << "\n  after adding a child1 to root: " << doc.descendents("child1").select().size() << " found";
+  doc.xmlRoot()->removeChild(child3);
+  std::cout << "\n  after removing it again:      " << doc.descendents("child1").select().size() << " found";
+  std::cout << "\n  size of document = " << doc.size() << "\n";
+  testElement(doc);
+  testElementDescendents(doc);
+
+  XmlPath xpath("root/child1/child1");
+  title("Testing XmlPath(" + enQuote(xpath.toString()) + ")");
+  for (auto pElem : doc.select(xpath))
+    std::cout << "\n  found: " << pElem->tag() << ", " << pElem->children()[0]->value();
+  std::cout << "\n  root/*: " << doc.select(XmlPath("root/*")).size() << " elements";
+  std::cout << "\n";
+
   std::string path = "../XmlElementParts/LectureNote.xml";
   title("Attempting to build document from fileSpec: " + path);
 
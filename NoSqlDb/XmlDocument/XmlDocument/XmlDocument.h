@@ -2,7 +2,7 @@
 #define XMLDOCUMENT_H
 ///////////////////////////////////////////////////////////////////
 // XmlDocument.h - a container of XmlElement nodes               //
-// Ver 2.5                                                       //
+// Ver 2.8                                                       //
 // Application: Help for CSE687 Pr#2, Spring 2015                //
 // Platform:    Dell XPS 2720, Win 8.1 Pro, Visual Studio 2013   //
 // Author:      Jim Fawcett, CST 4-187, 443-3948                 //
@@ -33,6 +33,20 @@
 *   ProcInstrElement   - XML element with markup and attributes but no children
 *   XmlDeclarElement   - XML declaration element with attributes but no children
 *
+* An XmlDocument may keep an index from each tag to the elements which have it,
+* built in one pass when it is turned on, e.g. right after parsing.  element(),
+* elements(), descendents() and size() then cost O(matches) instead of a walk
+* of the whole tree.  The index is not updated in place: every element of an
+* indexed document marks it stale on an addChild or removeChild, and the next
+* query rebuilds it in one pass.  The index holds DFS positions, so one added
+* or removed subtree moves the position of every later node; rebuilding once
+* for a batch of edits costs no more than patching it after each of them.
+* Documents which are edited between many queries are better left unindexed.
+*
+* XmlPath compiles a child path like "shard/record/key" once; select() then
+* finds its matches in a single pass which only descends into elements matching
+* a prefix of the path.
+*
 * Required Files:
 * ---------------
 *   - XmlDocument.h, XmlDocument.cpp, 
@@ -44,6 +58,13 @@
 *
 * Maintenance History:
 * --------------------
+* ver 2.8 : 19 Oct 2026
+* - documented that the tag index is rebuilt after edits, not maintained
+* ver 2.7 : 19 Oct 2026
+* - toString() takes an XmlSerializer layout; added write() to a stream
+* ver 2.6 : 19 Oct 2026
+* - added the optional tag index used by element(), elements(), descendents()
+*   and size(), and XmlPath for single pass path queries
 * ver 2.5 : 02 Feb 2018
 * - completed attribute handling by adding two new methods to AbstractXmlElement
 *   and overrides of those methods in TaggedElement.
@@ -86,10 +107,33 @@
 
 #include <memory>
 #include <string>
+#include <unordered_map>
+#include <vector>
 #include "../XmlElement/XmlElement.h"
 
 namespace XmlProcessing
 {
+  ///////////////////////////////////////////////////////////////////////////
+  // XmlPath class
+  //  - steps are separated by '/'; the first matches the XML root and each
+  //    one after it a child of the element the step before matched
+  //  - "*" matches any tag
+  //  - constructor throws std::exception for a path without steps
+
+  class XmlPath
+  {
+  public:
+    using sPtr = std::shared_ptr < AbstractXmlElement > ;
+
+    explicit XmlPath(const std::string& path);
+    std::vector<sPtr> select(sPtr pDocElement) const;
+    size_t size() const { return steps_.size(); }
+    std::string toString() const;
+  private:
+    void match(sPtr pElem, size_t step, std::vector<sPtr>& found) const;
+    std::vector<std::string> steps_;
+  };
+
   ///////////////////////////////////////////////////////////////////////////
   // XmlDocument class
 
@@ -106,7 +150,7 @@ namespace XmlProcessing
       if (!pRoot)
         pDocElement_ = makeDocElement();
     }
-    XmlDocument(const std::string& src, sourceType srcType=str);
+    XmlDocument(const std::string& src, sourceType srcType=str, bool indexed=false);
     XmlDocument(const XmlDocument& doc) = delete;
     XmlDocument(XmlDocument&& doc);
     XmlDocument& operator=(const XmlDocument& doc) = delete;
@@ -124,15 +168,39 @@ namespace XmlProcessing
     XmlDocument& elements(const std::string& tag);          // found_ contains all children of first element with tag
     XmlDocument& descendents(const std::string& tag = "");  // found_ contains descendents of prior found_[0]
     std::vector<sPtr> select();                             // returns found_.  Uses std::move(found_) to clear found_
+    std::vector<sPtr> select(const XmlPath& path);          // elements matching path, leaves found_ alone
     bool find(const std::string& tag, sPtr pElem, bool findall = true);
 
+    // tag index used by the queries above
+
+    XmlDocument& indexTags(bool on = true);
+    bool indexed() const { return pWatch_ != nullptr; }
+
     size_t size();
-    std::string toString();
+    std::string toString(XmlSerializer::Layout layout = XmlSerializer::indented);
+    bool write(std::ostream& out, XmlSerializer::Layout layout = XmlSerializer::indented);
     template<typename CallObj>
     void DFS(sPtr pElem, CallObj& co);
   private:
+    // nodes in DFS order; subtreeEnd[i] is one past the last descendent of nodes[i]
+    struct TagIndex
+    {
+      AbstractXmlElement* pDocElement = nullptr;
+      std::vector<sPtr> nodes;
+      std::vector<size_t> subtreeEnd;
+      std::unordered_map<const AbstractXmlElement*, size_t> position;
+      std::unordered_map<std::string, std::vector<size_t>> byTag;
+    };
+
+    TagIndex* index();
+    void addToIndex(const sPtr& pElem);
+    bool findIndexed(const std::string& tag, sPtr pElem, bool findall);
+    void collect(const std::string& tag, size_t first, size_t last);
+
     sPtr pDocElement_;         // AST that holds procInstr, comments, XML root, and more comments
     std::vector<sPtr> found_;  // query results
+    std::shared_ptr<XmlTreeWatch> pWatch_;  // set while the index is on
+    std::unique_ptr<TagIndex> pIndex_;
   };
 
   //----< search subtree of XmlDocument >------------------------------------
@@ -1,6 +1,6 @@
 ///////////////////////////////////////////////////////////////////
 // XmlElement.cpp - define XML Element types                     //
-// ver 1.8                                                       //
+// ver 2.0                                                       //
 // Application: Help for CSE687 Pr#2, Spring 2015                //
 // Platform:    Dell XPS 2720, Win 8.1 Pro, Visual Studio 2013   //
 // Author:      Jim Fawcett, CST 4-187, 443-3948                 //
@@ -8,13 +8,12 @@
 ///////////////////////////////////////////////////////////////////
 
 #include "XmlElement.h"
+#include <algorithm>
+#include <cstring>
 #include <iostream>
 
 using namespace XmlProcessing;
 
-size_t AbstractXmlElement::count = 0;
-size_t AbstractXmlElement::tabSize = 2;
-
 //////////////////////////////////////////////////////////////////////////
 // Global Factory methods
 
@@ -111,6 +110,7 @@ bool DocElement::addChild(std::shared_ptr<AbstractXmlElement> pChild)
   if (te == nullptr) // is not a TaggedElement
   {
     children_.push_back(pChild);
+    treeChanged();
     return true;
   }
 
@@ -118,6 +118,7 @@ bool DocElement::addChild(std::shared_ptr<AbstractXmlElement> pChild)
   if (!hasXmlRoot())
   {
     children_.push_back(pChild);
+    treeChanged();
     return true;
   }
   return false;
@@ -130,6 +131,7 @@ bool DocElement::removeChild(std::shared_ptr<AbstractXmlElement> pChild)
   if (iter != end(children_))
   {
     children_.erase(iter);
+    treeChanged();
     return true;
   }
   return false;
@@ -140,12 +142,10 @@ std::string DocElement::value() { return std::string(""); }
 
 //----< generate xml string for tagged element >-----------------------------
 
-std::string DocElement::toString()
+void DocElement::serialize(XmlSerializer& out)
 {
-  std::string rtn;
-  for (auto elem : children_)
-    rtn += elem->toString();
-  return rtn;
+  for (auto& pElem : children_)
+    pElem->serialize(out);
 }
 /////////////////////////////////////////////////////////////////////////////
 // TaggedElement methods
@@ -155,6 +155,7 @@ std::string DocElement::toString()
 bool TaggedElement::addChild(std::shared_ptr<AbstractXmlElement> pChild)
 {
   children_.push_back(pChild);
+  treeChanged();
   return true;
 }
 //----< remove child from tagged element using pointer to child >------------
@@ -165,6 +166,7 @@ bool TaggedElement::removeChild(std::shared_ptr<AbstractXmlElement> pChild)
   if (iter != end(children_))
   {
     children_.erase(iter);
+    treeChanged();
     return true;
   }
   return false;
@@ -197,36 +199,21 @@ std::string TaggedElement::value() { return tag_; }
 
 //----< generate xml string for tagged element >-----------------------------
 
-std::string TaggedElement::toString()
+void TaggedElement::serialize(XmlSerializer& out)
 {
-  std::string spacer(tabSize*++count, ' ');
-  std::string xml = "\n" + spacer + "<" + tag_;
-  for (auto at : attribs_)
-  {
-    xml += " ";
-    xml += at.first;
-    xml += "=\"";
-    xml += at.second;
-    xml += "\"";
-  }
-  xml += ">";
-  for (auto pChild : children_)
-    xml += pChild->toString();
-  xml += "\n" + spacer + "</" + tag_ + ">";
-  --count;
-  return xml;
+  out.startTag(tag_, attribs_);
+  for (auto& pChild : children_)
+    pChild->serialize(out);
+  out.endTag(tag_);
 }
 /////////////////////////////////////////////////////////////////////////////
 // TextElement methods
 
 //----< generate xml string for text element >-------------------------------
 
-std::string TextElement::toString()
+void TextElement::serialize(XmlSerializer& out)
 {
-  std::string spacer(tabSize * ++count, ' ');
-  std::string xml = "\n" + spacer + text_;
-  --count;
-  return xml;
+  out.text(text_);
 }
 /////////////////////////////////////////////////////////////////////////////
 // ProcInstrElement methods
@@ -255,42 +242,18 @@ bool ProcInstrElement::removeAttrib(const std::string& name)
 }
 //----< generate xml string for ProcInstr element >--------------------------
 
-std::string ProcInstrElement::toString()
+void ProcInstrElement::serialize(XmlSerializer& out)
 {
-  std::string spacer(tabSize*++count, ' ');
-  std::string xml = "\n" + spacer + "<" + "!";
-  for (auto at : attribs_)
-  {
-    xml += " ";
-    xml += at.first;
-    xml += "=\"";
-    xml += at.second;
-    xml += "\"";
-  }
-  xml += "!>";
-  --count;
-  return xml;
+  out.markup("<!", attribs_, "!>");
 }
 /////////////////////////////////////////////////////////////////////////////
 // XmlDeclarElement methods
 
 //----< generate xml string for text element >-------------------------------
 
-std::string XmlDeclarElement::toString()
+void XmlDeclarElement::serialize(XmlSerializer& out)
 {
-  std::string spacer(tabSize * ++count, ' ');
-  std::string xml = "\n" + spacer + "<?xml";
-  for (auto at : attribs_)
-  {
-    xml += " ";
-    xml += at.first;
-    xml += "=\"";
-    xml += at.second;
-    xml += "\"";
-  }
-  xml += " ?>";
-  --count;
-  return xml;
+  out.markup("<?xml", attribs_, " ?>");
 }
 //----< add attribute to ProcInstElement >-----------------------------------
 
@@ -319,15 +282,163 @@ bool XmlDeclarElement::removeAttrib(const std::string& name)
 
 //----< generate xml string for ProcInstr element >--------------------------
 
-std::string CommentElement::toString()
+void CommentElement::serialize(XmlSerializer& out)
 {
-  std::string spacer(tabSize*++count, ' ');
-  std::string xml = "\n" + spacer + "<" + "!-- ";
-  xml += commentText_;
-  xml += " -->";
-  --count;
+  out.comment(commentText_);
+}
+/////////////////////////////////////////////////////////////////////////////
+// AbstractXmlElement methods
+
+//----< generate xml string for element and its descendents >----------------
+
+std::string AbstractXmlElement::toString()
+{
+  return XmlSerializer::toString(*this);
+}
+/////////////////////////////////////////////////////////////////////////////
+// XmlSerializer methods
+
+//----< serialize by appending to out >--------------------------------------
+
+XmlSerializer::XmlSerializer(std::string& out, Layout layout)
+  : pOut_(&out), layout_(layout) {}
+
+//----< serialize to a stream through a buffer >-----------------------------
+
+XmlSerializer::XmlSerializer(std::ostream& out, Layout layout, size_t bufferSize)
+  : pOut_(&buffer_), pStream_(&out), bufferSize_(bufferSize), layout_(layout)
+{
+  buffer_.reserve(bufferSize);
+}
+
+XmlSerializer::~XmlSerializer()
+{
+  flush();
+}
+//----< xml string for an element tree >-------------------------------------
+
+std::string XmlSerializer::toString(AbstractXmlElement& elem, Layout layout)
+{
+  std::string xml;
+  XmlSerializer(xml, layout).write(elem);
   return xml;
 }
+//----< hand buffered output to the stream >---------------------------------
+
+bool XmlSerializer::flush()
+{
+  if (pStream_ == nullptr)
+    return true;
+  pStream_->write(buffer_.data(), buffer_.size());
+  buffer_.clear();
+  pStream_->flush();
+  return pStream_->good();
+}
+//----< append to the output, spilling a full buffer to the stream >---------
+
+void XmlSerializer::put(const char* text, size_t size)
+{
+  pOut_->append(text, size);
+  if (pStream_ != nullptr && buffer_.size() >= bufferSize_)
+  {
+    pStream_->write(buffer_.data(), buffer_.size());
+    buffer_.clear();
+  }
+}
+//----< newline and indentation for level, nothing when compact >------------
+
+void XmlSerializer::newLine(size_t level)
+{
+  if (layout_ == compact)
+    return;
+  size_t size = 1 + TAB_SIZE * level;
+  if (indent_.size() < size)
+    indent_ = "\n" + std::string(std::max(2 * size, (size_t)64), ' ');
+  put(indent_.data(), size);
+}
+//----< copy src to dst, escaping markup characters >------------------------
+/*
+*  - quotes only need escaping in attribute values
+*/
+void XmlSerializer::escape(std::string& dst, const std::string& src)
+{
+  for (char ch : src)
+  {
+    switch (ch)
+    {
+    case '&': dst += "&amp;"; break;
+    case '<': dst += "&lt;"; break;
+    case '>': dst += "&gt;"; break;
+    case '"': dst += "&quot;"; break;
+    case '\'': dst += "&apos;"; break;
+    default: dst += ch;
+    }
+  }
+}
+
+void XmlSerializer::putValue(const std::string& value)
+{
+  if (!escape_ || value.find_first_of("&<>\"'") == std::string::npos)
+  {
+    put(value);
+    return;
+  }
+  escape(*pOut_, value);
+  put("", 0);
+}
+
+void XmlSerializer::putAttributes(const Attributes& attribs)
+{
+  for (const auto& attrib : attribs)
+  {
+    put(" ", 1);
+    put(attrib.first);
+    put("=\"", 2);
+    putValue(attrib.second);
+    put("\"", 1);
+  }
+}
+//----< element markup >-----------------------------------------------------
+
+void XmlSerializer::startTag(const std::string& tag, const Attributes& attribs)
+{
+  newLine(++depth_);
+  put("<", 1);
+  put(tag);
+  putAttributes(attribs);
+  put(">", 1);
+}
+
+void XmlSerializer::endTag(const std::string& tag)
+{
+  newLine(depth_--);
+  put("</", 2);
+  put(tag);
+  put(">", 1);
+}
+//----< text, comment, PI and declaration, one level below the element >-----
+
+void XmlSerializer::text(const std::string& text)
+{
+  newLine(depth_ + 1);
+  putValue(text);
+}
+
+void XmlSerializer::comment(const std::string& text)
+{
+  newLine(depth_ + 1);
+  put("<!-- ", 5);
+  put(text);
+  put(" -->", 4);
+}
+
+void XmlSerializer::markup(const char* open, const Attributes& attribs, const char* close)
+{
+  newLine(depth_ + 1);
+  put(open, strlen(open));
+  putAttributes(attribs);
+  put(close, strlen(close));
+}
 /////////////////////////////////////////////////////////////////////////////
 // Global Helper Methods
 
@@ -343,6 +454,9 @@ void XmlProcessing::title(const std::string& title, char underlineChar)
 
 #ifdef TEST_XMLELEMENT
 
+#include <sstream>
+#include <thread>
+
 int main()
 {
   title("Testing XmlElement Package", '=');
@@ -367,6 +481,42 @@ int main()
   std::cout << "\n  attribute value for name = " << "first" << " is \"" << child->attributeValue("first") << "\"\n";
   sPtr docEl = makeDocElement(root);
   std::cout << "  " << docEl->toString();
+  std::cout << "\n";
+
+  title("Compact and escaped serialization");
+  child->addAttrib("third", "a < \"b\"");
+  std::string compact;
+  XmlSerializer(compact, XmlSerializer::compact).escape(true).write(*docEl);
+  std::cout << "\n  " << compact << "\n";
+
+  title("Serializing several documents at once");
+  std::vector<sPtr> docs;
+  for (int i = 0; i < 4; ++i)
+  {
+    sPtr docRoot = makeTaggedElement("doc" + std::to_string(i));
+    for (int j = 0; j < 100; ++j)
+    {
+      sPtr item = makeTaggedElement("item");
+      item->addAttrib("id", std::to_string(j));
+      item->addChild(makeTextElement("text " + std::to_string(j)));
+      docRoot->addChild(item);
+    }
+    docs.push_back(makeDocElement(docRoot));
+  }
+  std::vector<std::string> parallel(docs.size());
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < docs.size(); ++i)
+    threads.push_back(std::thread([&, i]() { parallel[i] = docs[i]->toString(); }));
+  for (std::thread& t : threads)
+    t.join();
+  for (size_t i = 0; i < docs.size(); ++i)
+  {
+    std::ostringstream out;
+    XmlSerializer(out, XmlSerializer::indented, 256).write(*docs[i]);
+    bool same = (parallel[i] == docs[i]->toString() && out.str() == parallel[i]);
+    std::cout << "\n  document " << i << ": " << parallel[i].size() << " chars, "
+              << (same ? "same as serial" : "DIFFERS from serial");
+  }
   std::cout << "\n\n";
 }
 
@@ -2,7 +2,7 @@
 #define XMLELEMENT_H
 ///////////////////////////////////////////////////////////////////
 // XmlElement.h - define XML Element types                       //
-// ver 1.8                                                       //
+// ver 2.1                                                       //
 // Application: Help for CSE687 Pr#2, Spring 2015                //
 // Platform:    Dell XPS 2720, Win 8.1 Pro, Visual Studio 2013   //
 // Author:      Jim Fawcett, CST 4-187, 443-3948                 //
@@ -32,6 +32,10 @@
 *   CommentElement     - XML element with comment markup and text
 *   ProcInstrElement   - XML element with markup and attributes but no children
 *   XmlDeclarElement   - XML declaration
+*   XmlTreeWatch       - shared by an indexed XmlDocument and its elements so
+*                        the document learns when a child is added or removed
+*   XmlSerializer      - writes an element tree to a string or stream in one
+*                        walk; toString() of every element is built on it
 *
 * Required Files:
 * ---------------
@@ -43,6 +47,17 @@
 *
 * Maintenance History:
 * --------------------
+* ver 2.1 : 19 Oct 2026
+* - XmlSerializer::escape replaces quotes in text too, so that XmlParser
+*   can read back what it writes
+* ver 2.0 : 19 Oct 2026
+* - added XmlSerializer; elements write themselves to it with serialize()
+* - toString() is defined once, on AbstractXmlElement, using XmlSerializer,
+*   so the static count and tabSize members are gone and trees can be
+*   serialized on several threads at once
+* ver 1.9 : 19 Oct 2026
+* - added XmlTreeWatch; addChild and removeChild report changes to the
+*   watch of an indexed XmlDocument
 * ver 1.8 : 02 Feb 2018
 * - added methods:
 *   - AbstractXmlElement::attributes()
@@ -105,11 +120,22 @@
 */
 
 #include <memory>
+#include <ostream>
 #include <string>
 #include <vector>
 
 namespace XmlProcessing
 {
+  class XmlSerializer;
+
+  /////////////////////////////////////////////////////////////////////////////
+  // XmlTreeWatch - changed is set when a watched element gains or loses a child
+
+  struct XmlTreeWatch
+  {
+    bool changed = false;
+  };
+
   /////////////////////////////////////////////////////////////////////////////
   // AbstractXmlElement - base class for all concrete element types
 
@@ -129,11 +155,14 @@ namespace XmlProcessing
     virtual Attributes attributes();
     virtual std::string tag() { return ""; }
     virtual std::string value() = 0;
-    virtual std::string toString() = 0;
+    virtual void serialize(XmlSerializer& out) = 0;
+    virtual std::string toString();
     virtual ~AbstractXmlElement();
+    void watch(const std::shared_ptr<XmlTreeWatch>& pWatch) { watch_ = pWatch; }
   protected:
-    static size_t count;
-    static size_t tabSize;
+    void treeChanged();
+  private:
+    std::weak_ptr<XmlTreeWatch> watch_;
   };
 
   inline bool AbstractXmlElement::addChild(std::shared_ptr<AbstractXmlElement> pChild) { return false; }
@@ -153,6 +182,11 @@ namespace XmlProcessing
   inline bool AbstractXmlElement::addAttrib(const std::string& name, const std::string& value) { return false; }
   inline bool AbstractXmlElement::removeAttrib(const std::string& name) { return false; }
   inline AbstractXmlElement::~AbstractXmlElement() {}
+  inline void AbstractXmlElement::treeChanged()
+  {
+    if (std::shared_ptr<XmlTreeWatch> pWatch = watch_.lock())
+      pWatch->changed = true;
+  }
 
   /////////////////////////////////////////////////////////////////////////////
   // DocElement - holds the document prologue, XML tree, and epilog
@@ -168,7 +202,7 @@ namespace XmlProcessing
     virtual bool removeChild(std::shared_ptr<AbstractXmlElement> pChild);
     virtual std::vector<sPtr> children();
     virtual std::string value();
-    virtual std::string toString();
+    virtual void serialize(XmlSerializer& out);
   private:
     bool hasXmlRoot();
     std::vector<std::shared_ptr<AbstractXmlElement>> children_;
@@ -191,7 +225,7 @@ namespace XmlProcessing
     TextElement(const TextElement& te) = delete;
     TextElement& operator=(const TextElement& te) = delete;
     virtual std::string value();
-    virtual std::string toString();
+    virtual void serialize(XmlSerializer& out);
   private:
     std::string text_;
   };
@@ -219,7 +253,7 @@ namespace XmlProcessing
     virtual std::string attributeValue(const std::string& name);
     virtual std::string tag();
     virtual std::string value();
-    virtual std::string toString();
+    virtual void serialize(XmlSerializer& out);
   private:
     std::string tag_;
     std::vector<std::shared_ptr<AbstractXmlElement>> children_;
@@ -259,7 +293,7 @@ namespace XmlProcessing
     virtual ~CommentElement() {}
     CommentElement& operator=(const CommentElement& ce) = delete;
     virtual std::string value() { return commentText_; }
-    virtual std::string toString();
+    virtual void serialize(XmlSerializer& out);
   private:
     std::string commentText_ = "to be defined";
   };
@@ -280,7 +314,7 @@ namespace XmlProcessing
     virtual bool addAttrib(const std::string& name, const std::string& value);
     virtual bool removeAttrib(const std::string& name);
     virtual std::string value() { return type_; }
-    virtual std::string toString();
+    virtual void serialize(XmlSerializer& out);
   private:
     std::vector<std::pair<std::string, std::string>> attribs_;
     std::string type_ = "xml declaration";
@@ -301,7 +335,7 @@ namespace XmlProcessing
     virtual bool addAttrib(const std::string& name, const std::string& value);
     virtual bool removeAttrib(const std::string& name);
     virtual std::string value() { return ""; }
-    virtual std::string toString();
+    virtual void serialize(XmlSerializer& out);
   private:
     std::vector<std::pair<std::string, std::string>> attribs_;
     std::string type_ = "xml declaration";
@@ -309,6 +343,66 @@ namespace XmlProcessing
 
   std::shared_ptr<AbstractXmlElement> makeXmlDeclarElement();
 
+  /////////////////////////////////////////////////////////////////////////////
+  // XmlSerializer - writes an element tree to a string or a stream in one walk
+  //
+  // - indented layout is the one toString() has always produced: every tag,
+  //   text and comment on a line of its own, two spaces deeper per level
+  // - compact layout writes no whitespace between markup
+  // - text and attribute values are written as they are held unless escape(true)
+  // - escaping replaces quotes in text as well as in attributes, as
+  //   XmlParser reads a quote in text as the start of a quoted string
+  // - appends to the string as it goes; a stream gets the output in large
+  //   writes from a buffer of fixed size
+  // - each serializer keeps its own depth, so different trees can be written
+  //   on different threads at the same time
+
+  class XmlSerializer
+  {
+  public:
+    enum Layout { indented, compact };
+    using Attributes = AbstractXmlElement::Attributes;
+
+    static const size_t TAB_SIZE = 2;
+    static const size_t DEFAULT_BUFFER_SIZE = 64 * 1024;
+
+    explicit XmlSerializer(std::string& out, Layout layout = indented);
+    explicit XmlSerializer(std::ostream& out, Layout layout = indented, size_t bufferSize = DEFAULT_BUFFER_SIZE);
+    ~XmlSerializer();
+    XmlSerializer(const XmlSerializer&) = delete;
+    XmlSerializer& operator=(const XmlSerializer&) = delete;
+
+    XmlSerializer& escape(bool on) { escape_ = on; return *this; }
+    XmlSerializer& write(AbstractXmlElement& elem) { elem.serialize(*this); return *this; }
+    bool flush();
+
+    static std::string toString(AbstractXmlElement& elem, Layout layout = indented);
+    static void escape(std::string& dst, const std::string& src);
+
+    // called by the elements' serialize()
+    void startTag(const std::string& tag, const Attributes& attribs);
+    void endTag(const std::string& tag);
+    void text(const std::string& text);
+    void comment(const std::string& text);
+    void markup(const char* open, const Attributes& attribs, const char* close);
+
+  private:
+    void newLine(size_t level);
+    void put(const char* text, size_t size);
+    void put(const std::string& text) { put(text.data(), text.size()); }
+    void putValue(const std::string& value);
+    void putAttributes(const Attributes& attribs);
+
+    std::string* pOut_;
+    std::ostream* pStream_ = nullptr;
+    std::string buffer_;
+    size_t bufferSize_ = 0;
+    Layout layout_;
+    bool escape_ = false;
+    size_t depth_ = 0;
+    std::string indent_;   // newline followed by spaces, grown as needed
+  };
+
 
   void title(const std::string& title, char underlineChar = '-');
 }
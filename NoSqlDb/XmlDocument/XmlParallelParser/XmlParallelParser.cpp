@@ -0,0 +1,273 @@
+///////////////////////////////////////////////////////////////////
+// XmlParallelParser.cpp - parse the records of a flat document  //
+//                         on several threads                    //
+// ver 1.1                                                       //
+// Language:    C++, Visual Studio 2017                          //
+// Application: NoSqlDb, CSE687 - Object Oriented Design         //
+// Author:      Ritesh Nair (rgnair@syr.edu)                     //
+///////////////////////////////////////////////////////////////////
+
+#include "XmlParallelParser.h"
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <thread>
+
+using namespace XmlProcessing;
+
+namespace
+{
+  // batches dealt out per thread, so that a thread which is handed
+  // slow records doesn't hold up the rest
+  const size_t BATCHES_PER_THREAD = 4;
+
+  void fail(const std::string& msg)
+  {
+    throw(std::exception(("ill-formed XML: " + msg).c_str()));
+  }
+}
+
+/////////////////////////////////////////////////////////////////////
+// XmlRecordSplitter
+
+//----< find the range of each record >--------------------------------
+/*
+*  - only the root and its children are tokenized; each child is then
+*    skipped whole with XmlViewToker::skipElement, so elements with the
+*    record tag deeper down are left alone
+*  - stops at the end of the root; a document without a root has no
+*    records
+*/
+void XmlRecordSplitter::split()
+{
+  rootTag_ = std::string_view();
+  records_.clear();
+
+  XmlViewToker toker(src_);
+  XmlToken token;
+  bool inRoot = false;
+  while (toker.next(token))
+  {
+    if (token.kind == XmlToken::endTag)
+    {
+      if (!inRoot)
+        fail("end tag </" + std::string(token.name) + "> without start tag");
+      return;
+    }
+    if (token.kind != XmlToken::startTag && token.kind != XmlToken::emptyTag)
+      continue;
+    if (!inRoot)
+    {
+      rootTag_ = token.name;
+      if (token.kind == XmlToken::emptyTag)
+        return;
+      inRoot = true;
+      continue;
+    }
+    if (token.kind == XmlToken::startTag && !toker.skipElement())
+      break;
+    if (token.name == recordTag_)
+      records_.push_back(Range{ token.offset, toker.offset() });
+  }
+
+  if (!toker.error().empty())
+    fail(toker.error());
+  if (inRoot)
+    fail("element <" + std::string(rootTag_) + "> is not closed");
+}
+
+/////////////////////////////////////////////////////////////////////
+// XmlParallelParser
+
+//----< split the buffer into records >--------------------------------
+
+XmlParallelParser::XmlParallelParser(std::string_view xml, const std::string& recordTag, size_t threads)
+  : src_(xml), splitter_(xml, recordTag)
+{
+  threads_ = (threads == 0 ? std::max<size_t>(1, std::thread::hardware_concurrency()) : threads);
+  splitter_.split();
+}
+//----< markup of record i >-------------------------------------------
+
+std::string_view XmlParallelParser::recordXml(size_t i) const
+{
+  const Range& range = records()[i];
+  return src_.substr(range.begin, range.size());
+}
+//----< first record of each batch, followed by size() >---------------
+/*
+*  - neighbouring records are grouped until a batch holds about its
+*    share of the bytes
+*/
+std::vector<size_t> XmlParallelParser::batches() const
+{
+  std::vector<size_t> bounds{ 0 };
+  if (size() == 0)
+    return bounds;
+
+  size_t bytes = records().back().end - records().front().begin;
+  size_t target = std::max<size_t>(1, bytes / (threads_ * BATCHES_PER_THREAD));
+  size_t filled = 0;
+  for (size_t i = 0; i < size(); ++i)
+  {
+    filled += records()[i].size();
+    if (filled >= target && i + 1 < size())
+    {
+      bounds.push_back(i + 1);
+      filled = 0;
+    }
+  }
+  bounds.push_back(size());
+  return bounds;
+}
+//----< parse every record and visit it >------------------------------
+/*
+*  - the calling thread is one of the workers
+*  - a batch stops at its first ill-formed record; batches after the
+*    earliest failed one are skipped, those before it run to the end,
+*    so the exception rethrown is always that of the first ill-formed
+*    record in the document; its message names the record
+*/
+void XmlParallelParser::parse(Visitor visit) const
+{
+  std::vector<size_t> bounds = batches();
+  size_t count = bounds.size() - 1;
+  if (count == 0)
+    return;
+
+  std::vector<std::exception_ptr> errors(count);
+  std::atomic<size_t> next{ 0 };
+  std::atomic<size_t> firstFailed{ count };
+  auto work = [&]() {
+    XmlArenaDocument doc;
+    for (size_t b = next++; b < count; b = next++)
+    {
+      if (b > firstFailed)
+        continue;
+      size_t i = bounds[b];
+      try
+      {
+        for (; i < bounds[b + 1]; ++i)
+        {
+          std::string_view xml = recordXml(i);
+          doc.load(xml);
+          visit(i, *doc.xmlRoot(), xml);
+        }
+      }
+      catch (std::exception& ex)
+      {
+        std::string msg = std::string(ex.what()) + " (record " + std::to_string(i) + ")";
+        errors[b] = std::make_exception_ptr(std::exception(msg.c_str()));
+      }
+      catch (...)
+      {
+        errors[b] = std::current_exception();
+      }
+      if (errors[b])
+      {
+        size_t failed = firstFailed;
+        while (b < failed && !firstFailed.compare_exchange_weak(failed, b));
+      }
+    }
+  };
+
+  std::vector<std::thread> workers;
+  for (size_t i = 1; i < std::min(threads_, count); ++i)
+    workers.push_back(std::thread(work));
+  work();
+  for (std::thread& worker : workers)
+    worker.join();
+
+  for (std::exception_ptr& pError : errors)
+    if (pError)
+      std::rethrow_exception(pError);
+}
+
+#ifdef TEST_XMLPARALLELPARSER
+
+#include <iostream>
+#include "../Utilities/Utilities.h"
+
+using namespace::Utilities;
+using Utils = StringHelper;
+
+int main()
+{
+  Utils::Title("Testing XmlParallelParser");
+  putline();
+
+  std::string xml =
+    "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n"
+    "<shard name=\"demo\">\n"
+    "  <!-- <record><key>not a record</key></record> -->\n"
+    "  <record><key>Zeus</key><value><record>nested</record></value></record>\n"
+    "  <other/>\n"
+    "  <record note=\"a > b\"><key>Hera</key></record>\n"
+    "  <record/>\n"
+    "  <record><key><![CDATA[</record>]]></key></record>\n"
+    "</shard>\n";
+
+  Utils::title("Record ranges:");
+  XmlParallelParser parser(xml, "record", 2);
+  std::cout << "\n  root <" << parser.rootTag() << ">, " << parser.size() << " records";
+  for (size_t i = 0; i < parser.size(); ++i)
+    std::cout << "\n  " << i << ": " << parser.recordXml(i);
+  putline();
+
+  Utils::title("Keys, mapped on " + std::to_string(parser.threads()) + " threads:");
+  std::vector<std::string> keys = parser.map<std::string>([](const XmlNode& record, std::string_view) {
+    const XmlNode* pKey = record.child("key");
+    return std::string(pKey == nullptr ? "(none)" : pKey->childText());
+  });
+  for (std::string& key : keys)
+    std::cout << "\n  " << key;
+  putline();
+
+  Utils::title("Many records, results in document order:");
+  std::string big = "<shard>";
+  for (int i = 0; i < 10000; ++i)
+    big += "<record><key>" + std::to_string(i) + "</key></record>";
+  big += "</shard>";
+  XmlParallelParser bigParser(big, "record", 4);
+  std::vector<int> ids = bigParser.map<int>([](const XmlNode& record, std::string_view) {
+    return std::stoi(std::string(record.child("key")->childText()));
+  });
+  bool ordered = true;
+  for (size_t i = 0; i < ids.size(); ++i)
+    ordered = ordered && ids[i] == (int)i;
+  std::cout << "\n  " << ids.size() << " records, " << (ordered ? "in order" : "OUT OF ORDER");
+  putline();
+
+  Utils::title("Ill-formed records:");
+  std::string bad = "<shard>";
+  for (int i = 0; i < 1000; ++i)
+    bad += (i == 700 || i == 900) ? "<record><key>" + std::to_string(i) + "</value></record>"
+                                  : "<record><key>" + std::to_string(i) + "</key></record>";
+  bad += "</shard>";
+  for (int run = 0; run < 3; ++run)
+  {
+    try
+    {
+      XmlParallelParser(bad, "record", 4).parse([](size_t, const XmlNode&, std::string_view) {});
+      std::cout << "\n  no error reported";
+    }
+    catch (std::exception& ex)
+    {
+      std::cout << "\n  " << ex.what();
+    }
+  }
+  try
+  {
+    XmlParallelParser("<shard><record><key>1</key></record>", "record");
+    std::cout << "\n  no error reported";
+  }
+  catch (std::exception& ex)
+  {
+    std::cout << "\n  " << ex.what();
+  }
+  putline();
+
+  std::cout << "\n\n";
+  return 0;
+}
+#endif
@@ -0,0 +1,138 @@
+#ifndef XMLPARALLELPARSER_H
+#define XMLPARALLELPARSER_H
+///////////////////////////////////////////////////////////////////
+// XmlParallelParser.h - parse the records of a flat document    //
+//                       on several threads                      //
+// ver 1.1                                                       //
+// Language:    C++, Visual Studio 2017                          //
+// Application: NoSqlDb, CSE687 - Object Oriented Design         //
+// Author:      Ritesh Nair (rgnair@syr.edu)                     //
+///////////////////////////////////////////////////////////////////
+/*
+* Package Operations:
+* -------------------
+* A NoSqlDb shard is one root element holding a long, flat list of
+* <record> elements which don't refer to each other.  Such a document
+* can be parsed a record at a time, and the records shared out
+* between threads:
+*   XmlRecordSplitter  - one pass over the buffer which finds the byte
+*                        range of each record, i.e. of each child of
+*                        the root with the record tag; the inside of
+*                        each child is skipped without making tokens
+*   XmlParallelParser  - splits the buffer, then has worker threads
+*                        parse the records, each into an
+*                        XmlArenaDocument, and hand them to a visitor
+*                        or collect what a function makes of them
+*
+* Records are dealt out in batches of neighbouring records of about
+* the same size.  Each worker reuses one arena document, so a record
+* costs no more than it would in a single XmlArenaDocument.  map()
+* returns its results in document order, whatever the number of
+* threads, and an ill-formed record is always reported as the first
+* one in the document, so results don't depend on scheduling.
+*
+* Only the records are parsed: anything else under the root is
+* skipped, and the root's own attributes are not read.  Offsets of
+* parsed nodes are relative to the record's view.
+*
+* Required Files:
+* ---------------
+*   - XmlParallelParser.h, XmlParallelParser.cpp
+*   - XmlArena.h, XmlArena.cpp
+*   - XmlViewParser.h, XmlViewParser.cpp, XmlScanner.h, XmlScanner.cpp
+*
+* Build Process:
+* --------------
+*   define TEST_XMLPARALLELPARSER to build the test stub
+*
+* Maintenance History:
+* --------------------
+* ver 1.1 : 19 Oct 2026
+* - XmlRecordSplitter skips records with XmlViewToker::skipElement
+* ver 1.0 : 19 Oct 2026
+* - first release
+*/
+
+#include "../XmlArena/XmlArena.h"
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace XmlProcessing
+{
+  /////////////////////////////////////////////////////////////////
+  // XmlRecordSplitter
+  // - split throws std::exception if the root or a record is not
+  //   closed, or markup is not terminated; records themselves are
+  //   checked when they are parsed
+
+  class XmlRecordSplitter
+  {
+  public:
+    struct Range
+    {
+      size_t begin = 0;
+      size_t end = 0;
+      size_t size() const { return end - begin; }
+    };
+
+    XmlRecordSplitter(std::string_view xml, const std::string& recordTag)
+      : src_(xml), recordTag_(recordTag) {}
+
+    void split();
+
+    std::string_view rootTag() const { return rootTag_; }
+    const std::vector<Range>& records() const { return records_; }
+
+  private:
+    std::string_view src_;
+    std::string recordTag_;
+    std::string_view rootTag_;
+    std::vector<Range> records_;
+  };
+
+  /////////////////////////////////////////////////////////////////
+  // XmlParallelParser
+  // - threads == 0 uses one thread per core
+  // - the buffer must outlive the parser
+
+  class XmlParallelParser
+  {
+  public:
+    using Range = XmlRecordSplitter::Range;
+    using Visitor = std::function<void(size_t i, const XmlNode& record, std::string_view recordXml)>;
+
+    XmlParallelParser(std::string_view xml, const std::string& recordTag = "record", size_t threads = 0);
+    XmlParallelParser(const XmlSource& source, const std::string& recordTag = "record", size_t threads = 0)
+      : XmlParallelParser(source.view(), recordTag, threads) {}
+
+    std::string_view rootTag() const { return splitter_.rootTag(); }
+    const std::vector<Range>& records() const { return splitter_.records(); }
+    size_t size() const { return records().size(); }
+    size_t threads() const { return threads_; }
+    std::string_view recordXml(size_t i) const;
+
+    // calls visit for every record, on the worker threads; visit(i, ...)
+    // is called once for each i, in no particular order, so it may only
+    // write to state which belongs to record i
+    void parse(Visitor visit) const;
+
+    // f(record, recordXml) for each record, in document order
+    template <typename R, typename F>
+    std::vector<R> map(F f) const
+    {
+      std::vector<R> results(size());
+      parse([&](size_t i, const XmlNode& record, std::string_view xml) { results[i] = f(record, xml); });
+      return results;
+    }
+
+  private:
+    std::vector<size_t> batches() const;
+
+    std::string_view src_;
+    XmlRecordSplitter splitter_;
+    size_t threads_;
+  };
+}
+#endif
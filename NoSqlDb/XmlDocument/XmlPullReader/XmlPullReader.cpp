@@ -0,0 +1,316 @@
+///////////////////////////////////////////////////////////////////
+// XmlPullReader.cpp - read XML one event at a time, on demand   //
+// ver 1.0                                                       //
+// Language:    C++, Visual Studio 2017                          //
+// Application: NoSqlDb, CSE687 - Object Oriented Design         //
+// Author:      Ritesh Nair (rgnair@syr.edu)                     //
+///////////////////////////////////////////////////////////////////
+
+#include "XmlPullReader.h"
+#include <exception>
+
+using namespace XmlProcessing;
+
+//----< reader which owns a mapped file >------------------------------
+
+XmlPullReader::XmlPullReader(std::unique_ptr<XmlSource> pSource)
+  : pSource_(std::move(pSource)), toker_(pSource_->view()) {}
+
+XmlPullReader XmlPullReader::fromFile(const std::string& fileSpec)
+{
+  return XmlPullReader(std::unique_ptr<XmlSource>(new XmlSource(XmlSource::fromFile(fileSpec))));
+}
+//----< throw, naming the problem >------------------------------------
+
+void XmlPullReader::fail(const std::string& msg) const
+{
+  throw(std::exception(("ill-formed XML: " + msg).c_str()));
+}
+
+void XmlPullReader::expectStart(const char* caller) const
+{
+  if (event_ != startElement)
+    throw(std::exception((std::string("XmlPullReader::") + caller + " called when not at a start tag").c_str()));
+}
+//----< report the end of the innermost open element >-----------------
+
+XmlPullReader::Event XmlPullReader::endOfElement()
+{
+  depth_ = open_.size();
+  tag_ = open_.back();
+  open_.pop_back();
+  return event_ = endElement;
+}
+//----< move to the next start, end or text >--------------------------
+
+XmlPullReader::Event XmlPullReader::next()
+{
+  if (pendingEnd_)
+  {
+    pendingEnd_ = false;
+    return endOfElement();
+  }
+
+  while (toker_.next(token_))
+  {
+    switch (token_.kind)
+    {
+    case XmlToken::startTag:
+    case XmlToken::emptyTag:
+      if (open_.empty() && sawRoot_)
+        fail("more than one root element");
+      sawRoot_ = true;
+      open_.push_back(token_.name);
+      depth_ = open_.size();
+      tag_ = token_.name;
+      pendingEnd_ = (token_.kind == XmlToken::emptyTag);
+      return event_ = startElement;
+
+    case XmlToken::endTag:
+      if (open_.empty())
+        fail("end tag </" + std::string(token_.name) + "> without start tag");
+      if (open_.back() != token_.name)
+        fail("end tag </" + std::string(token_.name) + "> does not match <" + std::string(open_.back()) + ">");
+      return endOfElement();
+
+    case XmlToken::text:
+    case XmlToken::cdata:
+      if (open_.empty())
+      {
+        if (token_.kind == XmlToken::text)
+          fail("text outside the root element");
+        continue;
+      }
+      depth_ = open_.size();
+      tag_ = std::string_view();
+      return event_ = characters;
+
+    default:
+      break;
+    }
+  }
+
+  if (!toker_.error().empty())
+    fail(toker_.error());
+  if (!open_.empty())
+    fail("element <" + std::string(open_.back()) + "> is not closed");
+  depth_ = 0;
+  tag_ = std::string_view();
+  return event_ = endDocument;
+}
+//----< attributes of the current start tag >--------------------------
+
+const XmlPullReader::Attribs& XmlPullReader::attributes() const
+{
+  static const Attribs none;
+  return event_ == startElement ? token_.attribs : none;
+}
+
+std::string_view XmlPullReader::attribute(std::string_view name)
+{
+  for (const XmlToken::Attrib& attrib : attributes())
+  {
+    if (attrib.first != name)
+      continue;
+    if (!XmlViewToker::needsDecoding(attrib.second))
+      return attrib.second;
+    decoded_.clear();
+    XmlViewToker::decode(attrib.second, decoded_);
+    return decoded_;
+  }
+  return std::string_view();
+}
+//----< current text; CDATA is returned as it is >---------------------
+
+std::string_view XmlPullReader::text()
+{
+  if (event_ != characters)
+    return std::string_view();
+  if (token_.kind == XmlToken::cdata || !XmlViewToker::needsDecoding(token_.value))
+    return token_.value;
+  decoded_.clear();
+  XmlViewToker::decode(token_.value, decoded_);
+  return decoded_;
+}
+//----< all text of the current element, leaving the reader at its end >---
+/*
+*  - the element must not have child elements
+*  - a single piece of text is returned without being copied
+*/
+std::string_view XmlPullReader::readText()
+{
+  expectStart("readText");
+  std::string_view parent = tag_;
+
+  std::string_view result;
+  size_t pieces = 0;
+  for (Event e = next(); e != endElement; e = next())
+  {
+    if (e == startElement)
+      fail("element <" + std::string(tag_) + "> found where text of <" + std::string(parent) + "> was expected");
+    if (pieces == 1)
+    {
+      collected_.assign(result.data(), result.size());
+      result = collected_;
+    }
+    std::string_view piece = text();
+    if (pieces++ == 0)
+      result = piece;
+    else
+    {
+      collected_.append(piece.data(), piece.size());
+      result = collected_;
+    }
+  }
+  return result;
+}
+//----< move to the end of the current element >-----------------------
+/*
+*  - after a start, the element started is skipped; after an end or
+*    text, the rest of the element enclosing it
+*  - the reader is left at the end of the skipped element
+*/
+void XmlPullReader::skipSubtree()
+{
+  if (event_ != startElement)
+  {
+    for (Event e = next(); e != endElement && e != endDocument; e = next())
+      if (e == startElement)
+        skipSubtree();
+    return;
+  }
+  if (pendingEnd_)
+  {
+    pendingEnd_ = false;
+    endOfElement();
+    return;
+  }
+  if (!toker_.skipElement())
+    fail(toker_.error());
+  endOfElement();
+}
+//----< next element with tag at the current level >-------------------
+/*
+*  - after a start, its children are searched; otherwise the elements
+*    which follow the current event in its parent
+*  - other elements are skipped whole
+*/
+bool XmlPullReader::nextElement(std::string_view tag)
+{
+  while (true)
+  {
+    switch (next())
+    {
+    case startElement:
+      if (tag_ == tag)
+        return true;
+      skipSubtree();
+      break;
+    case endElement:
+    case endDocument:
+      return false;
+    default:
+      break;
+    }
+  }
+}
+
+#ifdef TEST_XMLPULLREADER
+
+#include <iostream>
+#include "../Utilities/Utilities.h"
+
+using namespace::Utilities;
+using Utils = StringHelper;
+
+int main()
+{
+  Utils::Title("Testing XmlPullReader");
+  putline();
+
+  std::string xml =
+    "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n"
+    "<!-- version manager backup -->\n"
+    "<shard name=\"VersionMgr\">\n"
+    "  <record>\n"
+    "    <key>ns::a.h</key>\n"
+    "    <value>\n"
+    "      <metadata><name>a.h</name><description>skipped &amp; never decoded</description></metadata>\n"
+    "      <payload><author>rgnair</author><currentVersion>3</currentVersion></payload>\n"
+    "    </value>\n"
+    "  </record>\n"
+    "  <record>\n"
+    "    <key>ns::b&amp;c.h</key>\n"
+    "    <value>\n"
+    "      <metadata><name/></metadata>\n"
+    "      <payload><author>jfawcett</author><currentVersion>1<![CDATA[2]]></currentVersion></payload>\n"
+    "    </value>\n"
+    "  </record>\n"
+    "</shard>\n";
+
+  Utils::title("Every event:");
+  XmlPullReader reader(xml);
+  for (XmlPullReader::Event e = reader.next(); e != XmlPullReader::endDocument; e = reader.next())
+  {
+    std::cout << "\n  " << std::string(2 * reader.depth(), ' ');
+    if (e == XmlPullReader::startElement)
+    {
+      std::cout << "<" << reader.tag();
+      for (auto& attrib : reader.attributes())
+        std::cout << " " << attrib.first << "=\"" << reader.attribute(attrib.first) << "\"";
+      std::cout << ">";
+    }
+    else if (e == XmlPullReader::endElement)
+      std::cout << "</" << reader.tag() << ">";
+    else
+      std::cout << reader.text();
+  }
+  putline();
+
+  Utils::title("Current version of each key, metadata skipped:");
+  XmlPullReader versions(xml);
+  versions.nextElement("shard");
+  while (versions.nextElement("record"))
+  {
+    std::string key;
+    std::string version;
+    while (versions.next() == XmlPullReader::startElement)
+    {
+      if (versions.tag() == "key")
+        key = versions.readText();
+      else if (versions.tag() == "value" && versions.nextElement("payload"))
+      {
+        if (versions.nextElement("currentVersion"))
+        {
+          version = versions.readText();
+          versions.skipSubtree();   // rest of <payload>
+        }
+        versions.skipSubtree();     // rest of <value>
+      }
+      else
+        versions.skipSubtree();
+    }
+    std::cout << "\n  " << key << " : v" << version;
+  }
+  putline();
+
+  Utils::title("Ill-formed XML:");
+  for (std::string bad : { "<a><b></a>", "<a><b>", "<a/><b/>", "<a>" "<b x=\"1></b></a>" })
+  {
+    try
+    {
+      XmlPullReader badReader(bad);
+      while (badReader.next() != XmlPullReader::endDocument);
+      std::cout << "\n  " << bad << " : no error reported";
+    }
+    catch (std::exception& ex)
+    {
+      std::cout << "\n  " << bad << " : " << ex.what();
+    }
+  }
+  putline();
+
+  std::cout << "\n\n";
+  return 0;
+}
+#endif
@@ -0,0 +1,118 @@
+#ifndef XMLPULLREADER_H
+#define XMLPULLREADER_H
+///////////////////////////////////////////////////////////////////
+// XmlPullReader.h - read XML one event at a time, on demand     //
+// ver 1.0                                                       //
+// Language:    C++, Visual Studio 2017                          //
+// Application: NoSqlDb, CSE687 - Object Oriented Design         //
+// Author:      Ritesh Nair (rgnair@syr.edu)                     //
+///////////////////////////////////////////////////////////////////
+/*
+* Package Operations:
+* -------------------
+* XmlStreamReader pushes every element of a document at a handler.
+* XmlPullReader turns that around: the caller asks for the next event
+* when it wants one, and can step over whole subtrees it has no use
+* for.  This suits reading a few fields out of a large document, e.g.
+* the current version of each key in a version manager backup.
+*
+*   next()        - moves to the next start tag, end tag or text
+*                   (characters) and returns its kind; comments, PIs,
+*                   the declaration and the DOCTYPE are passed over,
+*                   <tag/> gives a start and an end
+*   tag()         - tag of the current start or end
+*   attributes()  - raw attributes of the current start
+*   attribute()   - one attribute value, decoded
+*   text()        - the current text, decoded
+*   readText()    - after a start, all text up to its end
+*   skipSubtree() - after a start, moves to its end without making
+*                   tokens, at the speed of the structural index;
+*                   after an end or text, to the end of the element
+*                   enclosing it
+*
+* The reader works on one buffer, either a string the caller keeps or
+* a file mapped by XmlSource.  Tags, attributes and text are
+* std::string_views into the buffer; only text with entities is
+* copied, into a buffer the reader reuses, so reading allocates
+* nothing per node once its buffers have grown.  Views returned are
+* valid until the next call which moves the reader.
+*
+* Ill-formed XML throws std::exception, as XmlArenaDocument does.
+* A skipped subtree is only checked for balance, not for matching
+* names.
+*
+* Required Files:
+* ---------------
+*   - XmlPullReader.h, XmlPullReader.cpp
+*   - XmlViewParser.h, XmlViewParser.cpp, XmlScanner.h, XmlScanner.cpp
+*
+* Build Process:
+* --------------
+*   define TEST_XMLPULLREADER to build the test stub
+*
+* Maintenance History:
+* --------------------
+* ver 1.0 : 19 Oct 2026
+* - first release
+*/
+
+#include "../XmlViewParser/XmlViewParser.h"
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace XmlProcessing
+{
+  /////////////////////////////////////////////////////////////////
+  // XmlPullReader
+  // - depth() is the number of open elements, counting the one
+  //   whose start or end is the current event
+
+  class XmlPullReader
+  {
+  public:
+    enum Event { none, startElement, endElement, characters, endDocument };
+    using Attribs = std::vector<XmlToken::Attrib>;
+
+    explicit XmlPullReader(std::string_view xml) : toker_(xml) {}
+    explicit XmlPullReader(const XmlSource& source) : toker_(source.view()) {}
+    static XmlPullReader fromFile(const std::string& fileSpec);
+
+    Event next();
+    Event event() const { return event_; }
+    size_t depth() const { return depth_; }
+    size_t offset() const { return token_.offset; }
+
+    std::string_view tag() const { return tag_; }
+    const Attribs& attributes() const;
+    std::string_view attribute(std::string_view name);   // empty if absent
+    std::string_view text();
+
+    std::string_view readText();
+    void skipSubtree();
+
+    // moves to the next start of an element with tag; false at the
+    // end of the enclosing element or of the document
+    bool nextElement(std::string_view tag);
+
+  private:
+    XmlPullReader(std::unique_ptr<XmlSource> pSource);
+    Event endOfElement();
+    void expectStart(const char* caller) const;
+    void fail(const std::string& msg) const;
+
+    std::unique_ptr<XmlSource> pSource_;   // when the reader owns its buffer
+    XmlViewToker toker_;
+    XmlToken token_;
+    Event event_ = none;
+    std::string_view tag_;
+    size_t depth_ = 0;
+    std::vector<std::string_view> open_;
+    bool sawRoot_ = false;
+    bool pendingEnd_ = false;   // start of <tag/> reported, end not yet
+    std::string decoded_;
+    std::string collected_;
+  };
+}
+#endif
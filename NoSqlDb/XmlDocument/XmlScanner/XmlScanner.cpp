@@ -0,0 +1,392 @@
+///////////////////////////////////////////////////////////////////
+// XmlScanner.cpp - vectorized search for XML structural bytes   //
+// ver 1.1                                                       //
+// Language:    C++, Visual Studio 2017                          //
+// Application: NoSqlDb, CSE687 - Object Oriented Design         //
+// Author:      Ritesh Nair (rgnair@syr.edu)                     //
+///////////////////////////////////////////////////////////////////
+
+#include "XmlScanner.h"
+#include <atomic>
+#include <exception>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define XMLSCANNER_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define XMLSCANNER_AVX2
+#else
+#define XMLSCANNER_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+using namespace XmlProcessing;
+
+namespace
+{
+  //----< index of lowest set bit; mask must not be 0 >------------------
+
+  inline unsigned lowestBit(uint32_t mask)
+  {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return (unsigned)index;
+#else
+    return (unsigned)__builtin_ctz(mask);
+#endif
+  }
+  //----< write offset + index of every set bit of mask to out >--------
+
+  inline uint32_t* writeBits(uint32_t mask, uint32_t offset, uint32_t* out)
+  {
+    while (mask != 0)
+    {
+      *out++ = offset + lowestBit(mask);
+      mask &= mask - 1;
+    }
+    return out;
+  }
+
+  inline bool isSpace(char ch)
+  {
+    return ch == ' ' || ch == '\t' || ch == '\n' || ch == '\r';
+  }
+
+  /////////////////////////////////////////////////////////////////
+  // scalar implementations, also used for the tail of a block
+
+  // each returns the end of the offsets it wrote to out
+
+  uint32_t* structuralsScalar(const char* p, size_t n, uint32_t base, uint32_t* out)
+  {
+    for (size_t i = 0; i < n; ++i)
+    {
+      if (XmlScanner::isStructural(p[i]))
+        *out++ = base + (uint32_t)i;
+    }
+    return out;
+  }
+
+  size_t skipSpaceScalar(const char* p, size_t n)
+  {
+    size_t i = 0;
+    while (i < n && isSpace(p[i]))
+      ++i;
+    return i;
+  }
+
+#ifdef XMLSCANNER_X86
+
+  /////////////////////////////////////////////////////////////////
+  // SSE2, 16 bytes per step; every x64 processor has it
+
+  uint32_t* structuralsSse2(const char* p, size_t n, uint32_t base, uint32_t* out)
+  {
+    const __m128i lt = _mm_set1_epi8('<');
+    const __m128i gt = _mm_set1_epi8('>');
+    const __m128i dq = _mm_set1_epi8('"');
+    const __m128i sq = _mm_set1_epi8('\'');
+    const __m128i amp = _mm_set1_epi8('&');
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16)
+    {
+      __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+      __m128i hits = _mm_or_si128(
+        _mm_or_si128(_mm_cmpeq_epi8(block, lt), _mm_cmpeq_epi8(block, gt)),
+        _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(block, dq), _mm_cmpeq_epi8(block, sq)),
+          _mm_cmpeq_epi8(block, amp)));
+      out = writeBits((uint32_t)_mm_movemask_epi8(hits), base + (uint32_t)i, out);
+    }
+    return structuralsScalar(p + i, n - i, base + (uint32_t)i, out);
+  }
+
+  size_t skipSpaceSse2(const char* p, size_t n)
+  {
+    const __m128i space = _mm_set1_epi8(' ');
+    const __m128i tab = _mm_set1_epi8('\t');
+    const __m128i nl = _mm_set1_epi8('\n');
+    const __m128i cr = _mm_set1_epi8('\r');
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16)
+    {
+      __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+      __m128i spaces = _mm_or_si128(
+        _mm_or_si128(_mm_cmpeq_epi8(block, space), _mm_cmpeq_epi8(block, tab)),
+        _mm_or_si128(_mm_cmpeq_epi8(block, nl), _mm_cmpeq_epi8(block, cr)));
+      uint32_t others = ~(uint32_t)_mm_movemask_epi8(spaces) & 0xFFFFu;
+      if (others != 0)
+        return i + lowestBit(others);
+    }
+    return i + skipSpaceScalar(p + i, n - i);
+  }
+
+  /////////////////////////////////////////////////////////////////
+  // AVX2, 32 bytes per step; only called if the CPU has it
+
+  XMLSCANNER_AVX2 uint32_t* structuralsAvx2(const char* p, size_t n, uint32_t base, uint32_t* out)
+  {
+    const __m256i lt = _mm256_set1_epi8('<');
+    const __m256i gt = _mm256_set1_epi8('>');
+    const __m256i dq = _mm256_set1_epi8('"');
+    const __m256i sq = _mm256_set1_epi8('\'');
+    const __m256i amp = _mm256_set1_epi8('&');
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32)
+    {
+      __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i));
+      __m256i hits = _mm256_or_si256(
+        _mm256_or_si256(_mm256_cmpeq_epi8(block, lt), _mm256_cmpeq_epi8(block, gt)),
+        _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(block, dq), _mm256_cmpeq_epi8(block, sq)),
+          _mm256_cmpeq_epi8(block, amp)));
+      out = writeBits((uint32_t)_mm256_movemask_epi8(hits), base + (uint32_t)i, out);
+    }
+    _mm256_zeroupper();   // else the SSE2 tail pays for the AVX to SSE transition
+    return structuralsSse2(p + i, n - i, base + (uint32_t)i, out);
+  }
+
+  XMLSCANNER_AVX2 size_t skipSpaceAvx2(const char* p, size_t n)
+  {
+    const __m256i space = _mm256_set1_epi8(' ');
+    const __m256i tab = _mm256_set1_epi8('\t');
+    const __m256i nl = _mm256_set1_epi8('\n');
+    const __m256i cr = _mm256_set1_epi8('\r');
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32)
+    {
+      __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i));
+      __m256i spaces = _mm256_or_si256(
+        _mm256_or_si256(_mm256_cmpeq_epi8(block, space), _mm256_cmpeq_epi8(block, tab)),
+        _mm256_or_si256(_mm256_cmpeq_epi8(block, nl), _mm256_cmpeq_epi8(block, cr)));
+      uint32_t others = ~(uint32_t)_mm256_movemask_epi8(spaces);
+      if (others != 0)
+        return i + lowestBit(others);
+    }
+    _mm256_zeroupper();
+    return i + skipSpaceSse2(p + i, n - i);
+  }
+
+  //----< does the CPU and OS support AVX2? >----------------------------
+
+  bool cpuHasAvx2()
+  {
+#ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7)
+      return false;
+    __cpuid(info, 1);
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    bool avx = (info[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6)
+      return false;
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") != 0;
+#endif
+  }
+
+#endif // XMLSCANNER_X86
+
+  //----< best level this CPU supports >---------------------------------
+
+  XmlScanner::Level detectLevel()
+  {
+#ifdef XMLSCANNER_X86
+    return cpuHasAvx2() ? XmlScanner::avx2 : XmlScanner::sse2;
+#else
+    return XmlScanner::scalar;
+#endif
+  }
+
+  std::atomic<int>& currentLevel()
+  {
+    static std::atomic<int> level(detectLevel());
+    return level;
+  }
+}
+
+/////////////////////////////////////////////////////////////////////
+// XmlScanner methods
+
+//----< level in use >-------------------------------------------------
+
+XmlScanner::Level XmlScanner::level()
+{
+  return (Level)currentLevel().load(std::memory_order_relaxed);
+}
+//----< best level the CPU supports >----------------------------------
+
+XmlScanner::Level XmlScanner::supportedLevel()
+{
+  static const Level supported = detectLevel();
+  return supported;
+}
+//----< use level, or the best supported one below it >----------------
+/*
+*  - returns the level now in use
+*/
+XmlScanner::Level XmlScanner::useLevel(Level level)
+{
+  if (level > supportedLevel())
+    level = supportedLevel();
+  currentLevel().store(level, std::memory_order_relaxed);
+  return level;
+}
+
+std::string XmlScanner::levelName(Level level)
+{
+  switch (level)
+  {
+  case avx2: return "avx2";
+  case sse2: return "sse2";
+  default: return "scalar";
+  }
+}
+//----< offsets of '<', '>', quotes and '&' in p[0..n) >---------------
+/*
+*  - the block is scanned a chunk at a time into a buffer on the stack,
+*    so the scan loops write through a pointer, and only the offsets
+*    found are appended
+*  - offsets are 32 bit, so the block must be under 4 GB
+*/
+void XmlScanner::structurals(const char* p, size_t n, std::vector<uint32_t>& offsets)
+{
+  if (n > MAX_BLOCK)
+    throw(std::exception("XmlScanner::structurals: block must be under 4 GB"));
+
+  const size_t CHUNK = 4096;
+  uint32_t buffer[CHUNK];
+  for (size_t begin = 0; begin < n; begin += CHUNK)
+  {
+    size_t count = (n - begin < CHUNK) ? n - begin : CHUNK;
+    uint32_t* end;
+    switch (level())
+    {
+#ifdef XMLSCANNER_X86
+    case avx2: end = structuralsAvx2(p + begin, count, (uint32_t)begin, buffer); break;
+    case sse2: end = structuralsSse2(p + begin, count, (uint32_t)begin, buffer); break;
+#endif
+    default: end = structuralsScalar(p + begin, count, (uint32_t)begin, buffer); break;
+    }
+    offsets.insert(offsets.end(), buffer, end);
+  }
+}
+//----< length of the whitespace run at p >----------------------------
+
+size_t XmlScanner::skipSpace(const char* p, size_t n)
+{
+  // runs are often a newline and a little indentation
+  if (n == 0 || !isSpace(p[0]))
+    return 0;
+#ifdef XMLSCANNER_X86
+  switch (level())
+  {
+  case avx2: return skipSpaceAvx2(p, n);
+  case sse2: return skipSpaceSse2(p, n);
+  default: break;
+  }
+#endif
+  return skipSpaceScalar(p, n);
+}
+
+/////////////////////////////////////////////////////////////////////
+// XmlStructuralIndex methods
+
+//----< scan the window starting at begin >----------------------------
+
+void XmlStructuralIndex::fill(size_t begin)
+{
+  begin_ = begin;
+  end_ = (src_.size() - begin < window_) ? src_.size() : begin + window_;
+  offsets_.clear();
+  cursor_ = 0;
+  filled_ = true;
+  XmlScanner::structurals(src_.data() + begin_, end_ - begin_, offsets_);
+}
+//----< position of first structural byte at or after pos >------------
+
+size_t XmlStructuralIndex::next(size_t pos)
+{
+  if (pos >= src_.size())
+    return npos;
+  if (!filled_ || pos < begin_ || pos >= end_)
+    fill(pos);
+
+  while (true)
+  {
+    while (cursor_ < offsets_.size() && begin_ + offsets_[cursor_] < pos)
+      ++cursor_;
+    if (cursor_ < offsets_.size())
+      return begin_ + offsets_[cursor_];
+    if (end_ == src_.size())
+      return npos;
+    fill(end_);
+  }
+}
+
+#ifdef TEST_XMLSCANNER
+
+#include <chrono>
+#include <iostream>
+
+int main()
+{
+  std::cout << "\n  Testing XmlScanner";
+  std::cout << "\n ====================\n";
+  std::cout << "\n  supported level: " << XmlScanner::levelName(XmlScanner::supportedLevel());
+
+  std::string xml;
+  for (int i = 0; i < 20000; ++i)
+    xml += "\n  <record id=\"" + std::to_string(i) + "\">\n    <key>a &amp; b</key>\n  </record>";
+
+  // every level must find the same bytes
+  std::vector<uint32_t> expected;
+  for (size_t i = 0; i < xml.size(); ++i)
+    if (XmlScanner::isStructural(xml[i]))
+      expected.push_back((uint32_t)i);
+
+  for (XmlScanner::Level level : { XmlScanner::scalar, XmlScanner::sse2, XmlScanner::avx2 })
+  {
+    XmlScanner::Level used = XmlScanner::useLevel(level);
+    std::vector<uint32_t> offsets;
+    auto start = std::chrono::steady_clock::now();
+    XmlScanner::structurals(xml.data(), xml.size(), offsets);
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    XmlStructuralIndex index(xml, 4096);
+    std::vector<uint32_t> fromIndex;
+    for (size_t pos = index.next(0); pos != XmlStructuralIndex::npos; pos = index.next(pos + 1))
+      fromIndex.push_back((uint32_t)pos);
+
+    bool good = (offsets == expected) && (fromIndex == expected)
+      && XmlScanner::skipSpace("\n      <", 8) == 7 && XmlScanner::skipSpace("<", 1) == 0;
+    std::cout << "\n  " << XmlScanner::levelName(used) << ": " << offsets.size() << " structurals, "
+      << xml.size() / elapsed.count() / (1024 * 1024) << " MB/s, " << (good ? "correct" : "WRONG");
+  }
+  XmlScanner::useLevel(XmlScanner::supportedLevel());
+
+  // offsets past 32 bits are refused before anything is read;
+  // a 32 bit build can't be handed such a block
+  if (sizeof(size_t) > sizeof(uint32_t))
+  {
+    bool refused = false;
+    std::vector<uint32_t> offsets;
+    try
+    {
+      XmlScanner::structurals(xml.data(), (size_t)XmlScanner::MAX_BLOCK + 1, offsets);
+    }
+    catch (std::exception& ex)
+    {
+      refused = offsets.empty();
+      std::cout << "\n  block of 4 GB: " << ex.what();
+    }
+    std::cout << ", " << (refused ? "correct" : "WRONG");
+  }
+  std::cout << "\n\n";
+}
+
+#endif
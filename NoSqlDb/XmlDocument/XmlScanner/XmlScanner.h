@@ -0,0 +1,113 @@
+#ifndef XMLSCANNER_H
+#define XMLSCANNER_H
+///////////////////////////////////////////////////////////////////
+// XmlScanner.h - vectorized search for XML structural bytes     //
+// ver 1.1                                                       //
+// Language:    C++, Visual Studio 2017                          //
+// Application: NoSqlDb, CSE687 - Object Oriented Design         //
+// Author:      Ritesh Nair (rgnair@syr.edu)                     //
+///////////////////////////////////////////////////////////////////
+/*
+* Package Operations:
+* -------------------
+* Tokenizing XML is mostly a search for a few bytes: '<' and '>'
+* delimit markup, quotes delimit attribute values, '&' starts an
+* entity, and runs of whitespace between elements are dropped.  This
+* package does those searches 16 or 32 bytes per step:
+*   XmlScanner          - structurals() finds every '<', '>', '"',
+*                         '\'' and '&' in a block; skipSpace() finds
+*                         the end of a whitespace run
+*   XmlStructuralIndex  - positions of the structural bytes of a
+*                         buffer, built a window at a time as the
+*                         reader moves through it, so its memory does
+*                         not grow with the size of the buffer
+*
+* The implementation is picked once, at run time, from what the CPU
+* supports: AVX2, SSE2, or a scalar loop on other processors.
+* useLevel() can force a lower level, e.g. to compare them.
+*
+* Required Files:
+* ---------------
+*   - XmlScanner.h, XmlScanner.cpp
+*
+* Build Process:
+* --------------
+*   define TEST_XMLSCANNER to build the test stub
+*
+* Maintenance History:
+* --------------------
+* ver 1.1 : 19 Oct 2026
+* - structurals() appends only the offsets it finds, a chunk at a
+*   time, and throws for blocks of 4 GB or more
+* - XmlStructuralIndex windows are capped below 4 GB
+* ver 1.0 : 19 Oct 2026
+* - first release
+*/
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace XmlProcessing
+{
+  /////////////////////////////////////////////////////////////////
+  // XmlScanner
+  // - stateless searches over a block of bytes
+
+  class XmlScanner
+  {
+  public:
+    enum Level { scalar, sse2, avx2 };
+
+    static Level level();
+    static Level supportedLevel();
+    static Level useLevel(Level level);
+    static std::string levelName(Level level);
+
+    // largest block whose offsets fit in 32 bits
+    static const size_t MAX_BLOCK = UINT32_MAX;
+
+    // appends the offsets, from p, of each structural byte in p[0..n);
+    // throws if n > MAX_BLOCK
+    static void structurals(const char* p, size_t n, std::vector<uint32_t>& offsets);
+
+    // offset of the first byte in p[0..n) which is not whitespace, n if none
+    static size_t skipSpace(const char* p, size_t n);
+
+    static bool isStructural(char ch)
+    {
+      return ch == '<' || ch == '>' || ch == '"' || ch == '\'' || ch == '&';
+    }
+  };
+
+  /////////////////////////////////////////////////////////////////
+  // XmlStructuralIndex
+  // - next(pos) returns the position of the first structural byte
+  //   at or after pos, or npos; pos should not move backwards by
+  //   more than a window, else that window is scanned again
+
+  class XmlStructuralIndex
+  {
+  public:
+    static const size_t DEFAULT_WINDOW = 64 * 1024;
+    static const size_t npos = std::string_view::npos;
+
+    explicit XmlStructuralIndex(std::string_view src, size_t window = DEFAULT_WINDOW)
+      : src_(src), window_(window == 0 ? 1 : (window > XmlScanner::MAX_BLOCK ? XmlScanner::MAX_BLOCK : window)) {}
+
+    size_t next(size_t pos);
+
+  private:
+    void fill(size_t begin);
+
+    std::string_view src_;
+    size_t window_;
+    size_t begin_ = 0;
+    size_t end_ = 0;
+    bool filled_ = false;
+    std::vector<uint32_t> offsets_;
+    size_t cursor_ = 0;
+  };
+}
+#endif
@@ -0,0 +1,485 @@
+///////////////////////////////////////////////////////////////////
+// XmlStreamReader.cpp - event driven XML reader                 //
+// ver 1.2                                                       //
+// Language:    C++, Visual Studio 2017                          //
+// Application: NoSqlDb, CSE687 - Object Oriented Design         //
+// Author:      Ritesh Nair (rgnair@syr.edu)                     //
+///////////////////////////////////////////////////////////////////
+
+#include "XmlStreamReader.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+
+using namespace XmlProcessing;
+
+namespace
+{
+  bool isSpace(char ch)
+  {
+    return ch == ' ' || ch == '\t' || ch == '\r' || ch == '\n';
+  }
+
+  bool isNameStart(char ch)
+  {
+    return std::isalpha((unsigned char)ch) || ch == '_' || ch == ':' || (unsigned char)ch >= 0x80;
+  }
+
+  bool endsName(char ch)
+  {
+    return isSpace(ch) || ch == '>' || ch == '/' || ch == '=' || ch == '<';
+  }
+
+  std::string trim(const std::string& src)
+  {
+    size_t first = 0;
+    while (first < src.size() && isSpace(src[first]))
+      ++first;
+    size_t last = src.size();
+    while (last > first && isSpace(src[last - 1]))
+      --last;
+    return src.substr(first, last - first);
+  }
+
+  //----< append code point as UTF-8 >---------------------------------
+
+  void appendUtf8(std::string& dst, unsigned long cp)
+  {
+    if (cp < 0x80)
+      dst += (char)cp;
+    else if (cp < 0x800)
+    {
+      dst += (char)(0xC0 | (cp >> 6));
+      dst += (char)(0x80 | (cp & 0x3F));
+    }
+    else if (cp < 0x10000)
+    {
+      dst += (char)(0xE0 | (cp >> 12));
+      dst += (char)(0x80 | ((cp >> 6) & 0x3F));
+      dst += (char)(0x80 | (cp & 0x3F));
+    }
+    else
+    {
+      dst += (char)(0xF0 | (cp >> 18));
+      dst += (char)(0x80 | ((cp >> 12) & 0x3F));
+      dst += (char)(0x80 | ((cp >> 6) & 0x3F));
+      dst += (char)(0x80 | (cp & 0x3F));
+    }
+  }
+}
+
+//----< construct reader on an open stream >---------------------------
+
+XmlStreamReader::XmlStreamReader(std::istream& in, size_t bufferSize)
+  : in_(in), buffer_(bufferSize == 0 ? 1 : bufferSize) {}
+
+//----< replace entity and character references with their text >-----
+/*
+*  - an '&' that does not start a known reference is left in place
+*/
+std::string XmlStreamReader::decodeEntities(const std::string& src)
+{
+  if (src.find('&') == std::string::npos)
+    return src;
+
+  std::string dst;
+  dst.reserve(src.size());
+  for (size_t i = 0; i < src.size(); ++i)
+  {
+    size_t semi = (src[i] == '&') ? src.find(';', i + 1) : std::string::npos;
+    if (semi == std::string::npos || semi - i > 10)
+    {
+      dst += src[i];
+      continue;
+    }
+    std::string name = src.substr(i + 1, semi - i - 1);
+    if (name == "lt") dst += '<';
+    else if (name == "gt") dst += '>';
+    else if (name == "amp") dst += '&';
+    else if (name == "quot") dst += '"';
+    else if (name == "apos") dst += '\'';
+    else if (name.size() > 1 && name[0] == '#')
+    {
+      bool hex = (name[1] == 'x' || name[1] == 'X');
+      std::string digits = name.substr(hex ? 2 : 1);
+      char* pEnd = nullptr;
+      unsigned long cp = std::strtoul(digits.c_str(), &pEnd, hex ? 16 : 10);
+      if (digits.empty() || *pEnd != '\0' || cp == 0 || cp > 0x10FFFF)
+      {
+        dst += src[i];
+        continue;
+      }
+      appendUtf8(dst, cp);
+    }
+    else
+    {
+      dst += src[i];
+      continue;
+    }
+    i = semi;
+  }
+  return dst;
+}
+//----< refill buffer from stream >------------------------------------
+
+bool XmlStreamReader::fill()
+{
+  if (!in_.good())
+    return false;
+  in_.read(buffer_.data(), buffer_.size());
+  pos_ = 0;
+  end_ = (size_t)in_.gcount();
+  return end_ > 0;
+}
+//----< extract next character >---------------------------------------
+
+bool XmlStreamReader::get(char& ch)
+{
+  if (pos_ == end_ && !fill())
+    return false;
+  ch = buffer_[pos_++];
+  if (ch == '\n')
+    ++line_;
+  return true;
+}
+//----< look at next character without extracting it >----------------
+
+bool XmlStreamReader::peek(char& ch)
+{
+  if (pos_ == end_ && !fill())
+    return false;
+  ch = buffer_[pos_];
+  return true;
+}
+//----< record error and stop parsing >--------------------------------
+
+bool XmlStreamReader::fail(const std::string& msg)
+{
+  error_ = msg + " at line " + std::to_string(line_);
+  return false;
+}
+//----< extract next non-whitespace character >------------------------
+
+bool XmlStreamReader::skipSpace(char& ch)
+{
+  while (get(ch))
+  {
+    if (!isSpace(ch))
+      return true;
+  }
+  return false;
+}
+//----< read name that starts with first >-----------------------------
+
+bool XmlStreamReader::readName(std::string& name, char first)
+{
+  if (!isNameStart(first))
+    return fail(std::string("invalid name character '") + first + "'");
+  name = first;
+  char ch;
+  while (peek(ch) && !endsName(ch))
+  {
+    name += ch;
+    get(ch);
+  }
+  return true;
+}
+//----< read up to and including terminator >--------------------------
+/*
+*  - text before the terminator goes to pContent, if supplied
+*  - scans a buffer's worth at a time; only the last terminator.size()-1
+*    characters are carried over, in case the terminator spans a refill
+*/
+bool XmlStreamReader::readUntil(const std::string& terminator, std::string* pContent)
+{
+  std::string window;
+  while (pos_ < end_ || fill())
+  {
+    size_t carried = window.size();
+    window.append(&buffer_[pos_], end_ - pos_);
+    size_t found = window.find(terminator);
+    size_t used = (found == std::string::npos) ? end_ - pos_ : found + terminator.size() - carried;
+    line_ += (size_t)std::count(buffer_.begin() + pos_, buffer_.begin() + pos_ + used, '\n');
+    pos_ += used;
+    if (found != std::string::npos)
+    {
+      if (pContent)
+        pContent->append(window, 0, found);
+      return true;
+    }
+    size_t keep = std::min(window.size(), terminator.size() - 1);
+    if (pContent)
+      pContent->append(window, 0, window.size() - keep);
+    window.erase(0, window.size() - keep);
+  }
+  return fail("missing " + terminator);
+}
+//----< skip DOCTYPE including any internal subset >-------------------
+
+bool XmlStreamReader::skipDoctype()
+{
+  size_t depth = 0;
+  char ch;
+  while (get(ch))
+  {
+    if (ch == '[')
+      ++depth;
+    else if (ch == ']' && depth > 0)
+      --depth;
+    else if (ch == '>' && depth == 0)
+      return true;
+  }
+  return fail("unterminated declaration");
+}
+//----< hand accumulated text to handler >-----------------------------
+
+void XmlStreamReader::flushText(XmlStreamHandler& handler)
+{
+  if (text_.empty())
+    return;
+  std::string text = trim(text_);
+  text_.clear();
+  if (!text.empty())
+    handler.text(decodeEntities(text));
+}
+//----< read start tag, its attributes and optional "/>" >-------------
+
+bool XmlStreamReader::readStartTag(char first, XmlStreamHandler& handler)
+{
+  if (open_.empty() && sawRoot_)
+    return fail("more than one root element");
+
+  std::string tag;
+  if (!readName(tag, first))
+    return false;
+
+  XmlStreamHandler::Attribs attribs;
+  char ch;
+  while (skipSpace(ch))
+  {
+    if (ch == '>' || ch == '/')
+    {
+      bool empty = (ch == '/');
+      if (empty && (!get(ch) || ch != '>'))
+        return fail("expected '>' after '/' in <" + tag + ">");
+      sawRoot_ = true;
+      handler.startElement(tag, attribs);
+      if (empty)
+        handler.endElement(tag);
+      else
+        open_.push_back(tag);
+      return true;
+    }
+
+    std::string name;
+    if (!readName(name, ch))
+      return false;
+    if (!skipSpace(ch) || ch != '=')
+      return fail("expected '=' after attribute " + name);
+    char quote;
+    if (!skipSpace(quote) || (quote != '"' && quote != '\''))
+      return fail("expected quoted value for attribute " + name);
+    std::string value;
+    while (get(ch) && ch != quote)
+      value += ch;
+    if (ch != quote)
+      break;
+    attribs.push_back(std::make_pair(name, decodeEntities(value)));
+  }
+  return fail("unterminated start tag <" + tag + ">");
+}
+//----< read end tag and check it closes the innermost element >-------
+
+bool XmlStreamReader::readEndTag(XmlStreamHandler& handler)
+{
+  char ch;
+  std::string tag;
+  if (!get(ch) || !readName(tag, ch))
+    return fail("invalid end tag");
+  if (!skipSpace(ch) || ch != '>')
+    return fail("unterminated end tag </" + tag + ">");
+  if (open_.empty() || open_.back() != tag)
+    return fail("unexpected end tag </" + tag + ">");
+  open_.pop_back();
+  handler.endElement(tag);
+  return true;
+}
+//----< read whatever follows a '<' >----------------------------------
+/*
+*  - pending text is handed over before anything that ends it: a tag or
+*    a CDATA section. Comments and processing instructions do not split
+*    the text around them.
+*/
+bool XmlStreamReader::readMarkup(XmlStreamHandler& handler)
+{
+  char ch;
+  if (!get(ch))
+    return fail("unexpected end of input after '<'");
+
+  if (ch == '/')
+  {
+    flushText(handler);
+    return readEndTag(handler);
+  }
+  if (ch == '?')
+    return readUntil("?>");
+  if (ch != '!')
+  {
+    flushText(handler);
+    return readStartTag(ch, handler);
+  }
+
+  std::string content;
+  if (peek(ch) && ch == '-')
+  {
+    if (!readUntil("-", &content) || !get(ch) || ch != '-')
+      return fail("invalid comment");
+    return readUntil("-->");
+  }
+  if (peek(ch) && ch == '[')
+  {
+    if (!readUntil("[CDATA[", &content) || !content.empty())
+      return fail("invalid CDATA section");
+    if (open_.empty())
+      return fail("CDATA section outside root element");
+    if (!readUntil("]]>", &content))
+      return false;
+    flushText(handler);
+    if (!content.empty())
+      handler.text(content);
+    return true;
+  }
+  return skipDoctype();
+}
+//----< read the whole stream, calling handler as parts are found >----
+/*
+*  - returns false if the XML is ill-formed; error() says why
+*  - returns true early if the handler asks to stop
+*/
+bool XmlStreamReader::parse(XmlStreamHandler& handler)
+{
+  error_.clear();
+  text_.clear();
+  open_.clear();
+  sawRoot_ = false;
+
+  char ch;
+  while (!handler.stopped() && get(ch))
+  {
+    if (ch == '<')
+    {
+      if (!readMarkup(handler))
+        return false;
+    }
+    else if (!open_.empty())
+      text_ += ch;
+    else if (!isSpace(ch))
+      return fail("text outside root element");
+  }
+  if (handler.stopped())
+    return true;
+  if (!open_.empty())
+    return fail("unexpected end of input in <" + open_.back() + ">");
+  if (!sawRoot_)
+    return fail("no root element");
+  return true;
+}
+
+/////////////////////////////////////////////////////////////////////
+// XmlSubtreeHandler methods
+
+//----< start or extend the element being built >---------------------
+
+void XmlSubtreeHandler::startElement(const std::string& tag, const Attribs& attribs)
+{
+  if (rootTag_.empty())
+    rootTag_ = tag;
+  if (stack_.empty() && tag != tag_)
+    return;
+
+  sPtr pElem = makeTaggedElement(tag);
+  for (auto& attrib : attribs)
+    pElem->addAttrib(attrib.first, attrib.second);
+  if (!stack_.empty())
+    stack_.back()->addChild(pElem);
+  stack_.push_back(pElem);
+}
+//----< hand completed element to callback >---------------------------
+
+void XmlSubtreeHandler::endElement(const std::string& tag)
+{
+  if (stack_.empty())
+    return;
+  sPtr pElem = stack_.back();
+  stack_.pop_back();
+  if (stack_.empty())
+  {
+    ++count_;
+    callback_(pElem);
+  }
+}
+//----< add text to the element being built >-------------------------
+
+void XmlSubtreeHandler::text(const std::string& text)
+{
+  if (!stack_.empty())
+    stack_.back()->addChild(makeTextElement(text));
+}
+
+#ifdef TEST_XMLSTREAMREADER
+
+#include <iostream>
+#include <sstream>
+#include "../Utilities/Utilities.h"
+
+using namespace::Utilities;
+using Utils = StringHelper;
+
+class Echo : public XmlStreamHandler
+{
+public:
+  void startElement(const std::string& tag, const Attribs& attribs) override
+  {
+    std::cout << "\n  start " << tag;
+    for (auto& attrib : attribs)
+      std::cout << " " << attrib.first << "=" << attrib.second;
+  }
+  void endElement(const std::string& tag) override { std::cout << "\n  end   " << tag; }
+  void text(const std::string& text) override { std::cout << "\n  text  " << text; }
+};
+
+int main()
+{
+  Utils::Title("Testing XmlStreamReader");
+  putline();
+
+  std::string src =
+    "<?xml version=\"1.0\"?>\n<!-- comment -->\n"
+    "<db version='1.0'>\n  <record id=\"a &amp; b\">\n    <name>x &lt; y</name>\n"
+    "    <empty/>\n    before <![CDATA[<raw>]]> after<!-- note --> text\n  </record>\n"
+    "  <record id=\"c\"><name>z</name></record>\n</db>\n";
+
+  Utils::title("Events:");
+  std::istringstream in(src);
+  Echo echo;
+  XmlStreamReader reader(in, 16);
+  if (!reader.parse(echo))
+    std::cout << "\n  error: " << reader.error();
+
+  Utils::title("Subtrees:");
+  std::istringstream in2(src);
+  XmlSubtreeHandler records("record", [](XmlSubtreeHandler::sPtr pElem) {
+    std::cout << "\n" << pElem->toString();
+  });
+  XmlStreamReader(in2).parse(records);
+  std::cout << "\n  root: " << records.rootTag() << ", records: " << records.count();
+
+  Utils::title("Ill-formed input:");
+  std::istringstream in3("<db><record></db>");
+  XmlStreamReader bad(in3);
+  if (!bad.parse(echo))
+    std::cout << "\n  error: " << bad.error();
+  std::cout << "\n\n";
+}
+
+#endif
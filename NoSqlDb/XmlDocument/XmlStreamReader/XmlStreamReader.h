@@ -0,0 +1,158 @@
+#ifndef XMLSTREAMREADER_H
+#define XMLSTREAMREADER_H
+///////////////////////////////////////////////////////////////////
+// XmlStreamReader.h - event driven XML reader                   //
+// ver 1.2                                                       //
+// Language:    C++, Visual Studio 2017                          //
+// Application: NoSqlDb, CSE687 - Object Oriented Design         //
+// Author:      Ritesh Nair (rgnair@syr.edu)                     //
+///////////////////////////////////////////////////////////////////
+/*
+* Package Operations:
+* -------------------
+* XmlParser reads the whole source into memory and builds an AST for
+* all of it before the caller sees anything.  This package reads XML
+* from a stream in fixed size chunks and reports what it finds as it
+* goes, so memory use does not depend on the size of the source:
+*   XmlStreamHandler   - callbacks for start tags, end tags and text
+*   XmlStreamReader    - reads a std::istream and drives a handler
+*   XmlSubtreeHandler  - handler which builds an AST (see XmlElement.h)
+*                        for each element with a given tag and hands
+*                        it to a callback as soon as the element closes
+*
+* Text is reported with leading and trailing whitespace removed and
+* whitespace-only text is dropped, matching XmlParser.  The predefined
+* entities (&lt; &gt; &amp; &quot; &apos;) and numeric character
+* references are decoded; an '&' which does not start one is kept as
+* is.  Comments, processing instructions, the XML declaration and
+* DOCTYPE are skipped; text on either side of a comment is reported
+* as one piece.  CDATA sections are reported as text, after any text
+* that precedes them.
+*
+* Required Files:
+* ---------------
+*   - XmlStreamReader.h, XmlStreamReader.cpp
+*   - XmlElement.h, XmlElement.cpp
+*
+* Build Process:
+* --------------
+*   define TEST_XMLSTREAMREADER to build the test stub
+*
+* Maintenance History:
+* --------------------
+* ver 1.2 : 19 Oct 2026
+* - text before a CDATA section is flushed by readMarkup, ahead of the
+*   section, and is no longer split by comments
+* - readUntil scans whole buffers instead of erasing one char at a time
+* ver 1.1 : 19 Oct 2026
+* - XmlSubtreeHandler::building tells whether an element is being built
+* ver 1.0 : 19 Oct 2026
+* - first release
+*/
+
+#include "../XmlElement/XmlElement.h"
+#include <functional>
+#include <istream>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace XmlProcessing
+{
+  /////////////////////////////////////////////////////////////////
+  // XmlStreamHandler
+  // - receives the parts of a document in document order
+
+  class XmlStreamHandler
+  {
+  public:
+    using Attrib = std::pair<std::string, std::string>;
+    using Attribs = std::vector<Attrib>;
+
+    virtual ~XmlStreamHandler() {}
+    virtual void startElement(const std::string& tag, const Attribs& attribs) {}
+    virtual void endElement(const std::string& tag) {}
+    virtual void text(const std::string& text) {}
+
+    // a handler may ask the reader to stop, e.g. after finding what it needs
+    virtual bool stopped() { return false; }
+  };
+
+  /////////////////////////////////////////////////////////////////
+  // XmlStreamReader
+  // - single pass, pull-from-stream, push-to-handler XML reader
+
+  class XmlStreamReader
+  {
+  public:
+    static const size_t DEFAULT_BUFFER_SIZE = 64 * 1024;
+
+    XmlStreamReader(std::istream& in, size_t bufferSize = DEFAULT_BUFFER_SIZE);
+
+    bool parse(XmlStreamHandler& handler);
+    const std::string& error() const { return error_; }
+    size_t line() const { return line_; }
+
+    static std::string decodeEntities(const std::string& src);
+
+  private:
+    bool get(char& ch);
+    bool peek(char& ch);
+    bool fill();
+    bool fail(const std::string& msg);
+
+    bool readMarkup(XmlStreamHandler& handler);
+    bool readStartTag(char first, XmlStreamHandler& handler);
+    bool readEndTag(XmlStreamHandler& handler);
+    bool readUntil(const std::string& terminator, std::string* pContent = nullptr);
+    bool skipDoctype();
+    bool readName(std::string& name, char first);
+    bool skipSpace(char& ch);
+    void flushText(XmlStreamHandler& handler);
+
+    std::istream& in_;
+    std::vector<char> buffer_;
+    size_t pos_ = 0;
+    size_t end_ = 0;
+    size_t line_ = 1;
+    std::string text_;
+    std::vector<std::string> open_;
+    bool sawRoot_ = false;
+    std::string error_;
+  };
+
+  /////////////////////////////////////////////////////////////////
+  // XmlSubtreeHandler
+  // - builds an AST for each element with the requested tag
+  // - the callback receives the element when its end tag is read;
+  //   nothing else in the document is kept
+
+  class XmlSubtreeHandler : public XmlStreamHandler
+  {
+  public:
+    using sPtr = std::shared_ptr<AbstractXmlElement>;
+    using Callback = std::function<void(sPtr)>;
+
+    XmlSubtreeHandler(const std::string& tag, Callback callback)
+      : tag_(tag), callback_(callback) {}
+
+    virtual void startElement(const std::string& tag, const Attribs& attribs) override;
+    virtual void endElement(const std::string& tag) override;
+    virtual void text(const std::string& text) override;
+
+    // tag of the document's root element, once it has been read
+    const std::string& rootTag() const { return rootTag_; }
+    size_t count() const { return count_; }
+    // true while inside an element with the requested tag
+    bool building() const { return !stack_.empty(); }
+
+  private:
+    std::string tag_;
+    Callback callback_;
+    std::vector<sPtr> stack_;
+    std::string rootTag_;
+    size_t count_ = 0;
+  };
+}
+#endif
@@ -0,0 +1,721 @@
+///////////////////////////////////////////////////////////////////
+// XmlViewParser.cpp - parse XML in place from one buffer        //
+// ver 1.2                                                       //
+// Language:    C++, Visual Studio 2017                          //
+// Application: NoSqlDb, CSE687 - Object Oriented Design         //
+// Author:      Ritesh Nair (rgnair@syr.edu)                     //
+///////////////////////////////////////////////////////////////////
+
+#include "XmlViewParser.h"
+#include <cstdlib>
+#include <memory>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace XmlProcessing;
+
+namespace
+{
+  //----< is ch XML whitespace? >----------------------------------------
+
+  inline bool isSpace(char ch)
+  {
+    return ch == ' ' || ch == '\t' || ch == '\n' || ch == '\r';
+  }
+  //----< view without leading and trailing whitespace >-----------------
+
+  std::string_view trim(std::string_view text)
+  {
+    size_t first = 0;
+    while (first < text.size() && isSpace(text[first]))
+      ++first;
+    size_t last = text.size();
+    while (last > first && isSpace(text[last - 1]))
+      --last;
+    return text.substr(first, last - first);
+  }
+  //----< append code point as UTF-8 >-----------------------------------
+
+  void appendUtf8(std::string& dst, unsigned long cp)
+  {
+    if (cp < 0x80)
+      dst += (char)cp;
+    else if (cp < 0x800)
+    {
+      dst += (char)(0xC0 | (cp >> 6));
+      dst += (char)(0x80 | (cp & 0x3F));
+    }
+    else if (cp < 0x10000)
+    {
+      dst += (char)(0xE0 | (cp >> 12));
+      dst += (char)(0x80 | ((cp >> 6) & 0x3F));
+      dst += (char)(0x80 | (cp & 0x3F));
+    }
+    else
+    {
+      dst += (char)(0xF0 | (cp >> 18));
+      dst += (char)(0x80 | ((cp >> 12) & 0x3F));
+      dst += (char)(0x80 | ((cp >> 6) & 0x3F));
+      dst += (char)(0x80 | (cp & 0x3F));
+    }
+  }
+  //----< value of an entity name, false if it isn't one we know >-------
+
+  bool decodeEntity(std::string_view name, std::string& dst)
+  {
+    if (name == "lt") dst += '<';
+    else if (name == "gt") dst += '>';
+    else if (name == "amp") dst += '&';
+    else if (name == "quot") dst += '"';
+    else if (name == "apos") dst += '\'';
+    else if (name.size() > 1 && name[0] == '#')
+    {
+      bool hex = (name[1] == 'x' || name[1] == 'X');
+      std::string_view digits = name.substr(hex ? 2 : 1);
+      if (digits.empty())
+        return false;
+      unsigned long cp = 0;
+      for (char ch : digits)
+      {
+        int digit;
+        if (ch >= '0' && ch <= '9') digit = ch - '0';
+        else if (hex && ch >= 'a' && ch <= 'f') digit = ch - 'a' + 10;
+        else if (hex && ch >= 'A' && ch <= 'F') digit = ch - 'A' + 10;
+        else return false;
+        cp = cp * (hex ? 16 : 10) + digit;
+        if (cp > 0x10FFFF)
+          return false;
+      }
+      if (cp == 0)
+        return false;
+      appendUtf8(dst, cp);
+    }
+    else
+      return false;
+    return true;
+  }
+}
+
+/////////////////////////////////////////////////////////////////////
+// XmlSource methods
+
+//----< map a file into memory, read-only >----------------------------
+/*
+*  - an empty file gives an empty source; there is nothing to map
+*/
+XmlSource XmlSource::fromFile(const std::string& fileSpec)
+{
+  XmlSource source;
+#ifdef _WIN32
+  HANDLE file = CreateFileA(fileSpec.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL,
+    OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+  if (file == INVALID_HANDLE_VALUE)
+    throw(std::exception(("can't open source file " + fileSpec).c_str()));
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx(file, &size))
+  {
+    CloseHandle(file);
+    throw(std::exception(("can't read size of source file " + fileSpec).c_str()));
+  }
+  if (size.QuadPart == 0)
+  {
+    CloseHandle(file);
+    return source;
+  }
+  HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+  const void* pView = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+  if (pView == nullptr)
+  {
+    if (mapping)
+      CloseHandle(mapping);
+    CloseHandle(file);
+    throw(std::exception(("can't map source file " + fileSpec).c_str()));
+  }
+  source.file_ = file;
+  source.mapping_ = mapping;
+  source.data_ = static_cast<const char*>(pView);
+  source.size_ = (size_t)size.QuadPart;
+#else
+  int fd = ::open(fileSpec.c_str(), O_RDONLY);
+  if (fd < 0)
+    throw(std::exception(("can't open source file " + fileSpec).c_str()));
+  struct stat info;
+  if (::fstat(fd, &info) != 0)
+  {
+    ::close(fd);
+    throw(std::exception(("can't read size of source file " + fileSpec).c_str()));
+  }
+  if (info.st_size == 0)
+  {
+    ::close(fd);
+    return source;
+  }
+  void* pView = ::mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (pView == MAP_FAILED)
+    throw(std::exception(("can't map source file " + fileSpec).c_str()));
+  ::madvise(pView, (size_t)info.st_size, MADV_SEQUENTIAL);
+  source.mapping_ = pView;
+  source.data_ = static_cast<const char*>(pView);
+  source.size_ = (size_t)info.st_size;
+#endif
+  return source;
+}
+//----< take ownership of a string >-----------------------------------
+
+XmlSource XmlSource::fromString(std::string xml)
+{
+  XmlSource source;
+  source.owned_ = std::move(xml);
+  source.data_ = source.owned_.data();
+  source.size_ = source.owned_.size();
+  return source;
+}
+//----< move constructor >---------------------------------------------
+
+XmlSource::XmlSource(XmlSource&& source)
+{
+  *this = std::move(source);
+}
+//----< move assignment >----------------------------------------------
+/*
+*  - a short owned string lives inside the string object, so data_
+*    must be pointed at the moved-to string
+*/
+XmlSource& XmlSource::operator=(XmlSource&& source)
+{
+  if (this == &source)
+    return *this;
+  release();
+  bool owns = (source.mapping_ == nullptr && source.size_ > 0);
+  owned_ = std::move(source.owned_);
+  data_ = owns ? owned_.data() : source.data_;
+  size_ = source.size_;
+  mapping_ = source.mapping_;
+  file_ = source.file_;
+  source.data_ = "";
+  source.size_ = 0;
+  source.mapping_ = nullptr;
+  source.file_ = nullptr;
+  return *this;
+}
+//----< unmap the file, if any >---------------------------------------
+
+XmlSource::~XmlSource()
+{
+  release();
+}
+
+void XmlSource::release()
+{
+  if (mapping_ != nullptr)
+  {
+#ifdef _WIN32
+    UnmapViewOfFile(data_);
+    CloseHandle((HANDLE)mapping_);
+    CloseHandle((HANDLE)file_);
+#else
+    ::munmap(mapping_, size_);
+#endif
+  }
+  data_ = "";
+  size_ = 0;
+  mapping_ = nullptr;
+  file_ = nullptr;
+  owned_.clear();
+}
+
+/////////////////////////////////////////////////////////////////////
+// XmlViewToker methods
+
+//----< append raw to dst, decoding entities >-------------------------
+/*
+*  - an '&' which does not start a known entity is kept as is
+*/
+void XmlViewToker::decode(std::string_view raw, std::string& dst)
+{
+  size_t amp = raw.find('&');
+  if (amp == std::string_view::npos)
+  {
+    dst.append(raw.data(), raw.size());
+    return;
+  }
+  dst.reserve(dst.size() + raw.size());
+  size_t pos = 0;
+  while (amp != std::string_view::npos)
+  {
+    dst.append(raw.data() + pos, amp - pos);
+    size_t semi = raw.find(';', amp + 1);
+    if (semi != std::string_view::npos && semi - amp <= 10
+      && decodeEntity(raw.substr(amp + 1, semi - amp - 1), dst))
+      pos = semi + 1;
+    else
+    {
+      dst += '&';
+      pos = amp + 1;
+    }
+    amp = raw.find('&', pos);
+  }
+  dst.append(raw.data() + pos, raw.size() - pos);
+}
+//----< copy of raw with entities decoded >----------------------------
+
+std::string XmlViewToker::decode(std::string_view raw)
+{
+  std::string dst;
+  decode(raw, dst);
+  return dst;
+}
+//----< record error, with line number, and stop >---------------------
+
+bool XmlViewToker::fail(const std::string& msg)
+{
+  size_t line = 1;
+  for (size_t i = 0; i < pos_ && i < src_.size(); ++i)
+    if (src_[i] == '\n')
+      ++line;
+  error_ = msg + " at line " + std::to_string(line);
+  pos_ = src_.size();
+  return false;
+}
+//----< fill token with the next text or markup >----------------------
+
+bool XmlViewToker::next(XmlToken& token)
+{
+  token.attribs.clear();
+  token.name = std::string_view();
+  token.value = std::string_view();
+  token.kind = XmlToken::none;
+
+  while (pos_ < src_.size())
+  {
+    if (src_[pos_] == '<')
+      return readMarkup(token);
+
+    // text runs to the next '<'; whitespace-only runs are skipped
+    size_t stop = find('<', pos_);
+    if (stop == std::string_view::npos)
+      stop = src_.size();
+    size_t first = pos_ + XmlScanner::skipSpace(src_.data() + pos_, stop - pos_);
+    token.offset = pos_;
+    pos_ = stop;
+    if (first < stop)
+    {
+      token.kind = XmlToken::text;
+      token.value = trim(src_.substr(first, stop - first));
+      return true;
+    }
+  }
+  return false;
+}
+//----< move past the content and end tag of the element just started >---
+/*
+*  - only '<' is looked at in text, and start tags are not split into
+*    attributes, so this runs at the speed of the structural index
+*/
+bool XmlViewToker::skipElement()
+{
+  size_t depth = 1;
+  XmlToken skipped;
+  while (depth > 0)
+  {
+    size_t stop = find('<', pos_);
+    if (stop == std::string_view::npos)
+    {
+      pos_ = src_.size();
+      return fail("unexpected end of input in skipped element");
+    }
+    pos_ = stop;
+    if (src_.compare(pos_, 2, "</") == 0)
+    {
+      stop = src_.find('>', pos_);
+      if (stop == std::string_view::npos)
+        return fail("unterminated end tag");
+      --depth;
+    }
+    else if (src_.compare(pos_, 2, "<!") == 0 || src_.compare(pos_, 2, "<?") == 0)
+    {
+      if (!readMarkup(skipped))
+        return false;
+      continue;
+    }
+    else
+    {
+      stop = findTagEnd(pos_ + 1);
+      if (stop == std::string_view::npos)
+        return fail("unterminated start tag");
+      if (src_[stop - 1] != '/')
+        ++depth;
+    }
+    pos_ = stop + 1;
+  }
+  return true;
+}
+//----< position of next ch at or after pos, from the structural index >---
+/*
+*  - ch must be one of the bytes XmlScanner::isStructural accepts
+*/
+size_t XmlViewToker::find(char ch, size_t pos)
+{
+  size_t found = index_.next(pos);
+  while (found != XmlStructuralIndex::npos && src_[found] != ch)
+    found = index_.next(found + 1);
+  return found;
+}
+//----< position of the '>' ending the tag, skipping quoted values >---
+
+size_t XmlViewToker::findTagEnd(size_t pos)
+{
+  char quote = 0;
+  for (size_t found = index_.next(pos); found != XmlStructuralIndex::npos; found = index_.next(found + 1))
+  {
+    char ch = src_[found];
+    if (quote != 0)
+    {
+      if (ch == quote)
+        quote = 0;
+    }
+    else if (ch == '"' || ch == '\'')
+      quote = ch;
+    else if (ch == '>')
+      return found;
+    else if (ch == '<')
+      break;
+  }
+  return std::string_view::npos;
+}
+//----< dispatch on the characters after '<' >-------------------------
+
+bool XmlViewToker::readMarkup(XmlToken& token)
+{
+  token.offset = pos_;
+  std::string_view rest = src_.substr(pos_);
+  if (rest.compare(0, 4, "<!--") == 0)
+    return readDelimited(token, XmlToken::comment, 4, "-->");
+  if (rest.compare(0, 9, "<![CDATA[") == 0)
+    return readDelimited(token, XmlToken::cdata, 9, "]]>");
+  if (rest.compare(0, 2, "<!") == 0)
+    return readDoctype(token);
+  if (rest.compare(0, 2, "<?") == 0)
+    return readProcInstr(token);
+  if (rest.compare(0, 2, "</") == 0)
+    return readEndTag(token);
+  return readTag(token);
+}
+//----< comment or CDATA: content up to terminator >-------------------
+
+bool XmlViewToker::readDelimited(XmlToken& token, XmlToken::Kind kind, size_t skip, std::string_view terminator)
+{
+  size_t start = pos_ + skip;
+  size_t stop = src_.find(terminator, start);
+  if (stop == std::string_view::npos)
+    return fail(kind == XmlToken::comment ? "unterminated comment" : "unterminated CDATA section");
+  token.kind = kind;
+  token.value = src_.substr(start, stop - start);
+  if (kind == XmlToken::comment)
+    token.value = trim(token.value);
+  pos_ = stop + terminator.size();
+  return true;
+}
+//----< DOCTYPE, including an internal subset in [...] >---------------
+
+bool XmlViewToker::readDoctype(XmlToken& token)
+{
+  size_t start = pos_ + 2;
+  int depth = 0;
+  for (size_t i = start; i < src_.size(); ++i)
+  {
+    char ch = src_[i];
+    if (ch == '[')
+      ++depth;
+    else if (ch == ']')
+      --depth;
+    else if (ch == '>' && depth <= 0)
+    {
+      token.kind = XmlToken::doctype;
+      token.value = src_.substr(start, i - start);
+      pos_ = i + 1;
+      return true;
+    }
+  }
+  return fail("unterminated DOCTYPE");
+}
+//----< <?target pseudo="attributes"?> >-------------------------------
+
+bool XmlViewToker::readProcInstr(XmlToken& token)
+{
+  size_t start = pos_ + 2;
+  size_t stop = src_.find("?>", start);
+  if (stop == std::string_view::npos)
+    return fail("unterminated processing instruction");
+  std::string_view body = src_.substr(start, stop - start);
+  size_t pos = 0;
+  token.name = readName(body, pos);
+  if (token.name.empty())
+    return fail("processing instruction without a target");
+  token.kind = (token.name == "xml") ? XmlToken::declaration : XmlToken::procInstr;
+  token.value = trim(body.substr(pos));
+  pos_ = stop + 2;
+
+  // pseudo-attributes are optional in a PI, keep what parses
+  XmlToken::Kind kind = token.kind;
+  std::string error = error_;
+  size_t savedPos = pos_;
+  if (!readAttributes(body, pos, token))
+  {
+    token.attribs.clear();
+    error_ = error;
+    pos_ = savedPos;
+  }
+  token.kind = kind;
+  return true;
+}
+//----< </name> >------------------------------------------------------
+
+bool XmlViewToker::readEndTag(XmlToken& token)
+{
+  size_t stop = find('>', pos_ + 2);
+  if (stop == std::string_view::npos)
+    return fail("unterminated end tag");
+  std::string_view body = src_.substr(pos_ + 2, stop - pos_ - 2);
+  size_t pos = 0;
+  token.name = readName(body, pos);
+  if (token.name.empty() || !trim(body.substr(pos)).empty())
+    return fail("malformed end tag");
+  token.kind = XmlToken::endTag;
+  pos_ = stop + 1;
+  return true;
+}
+//----< <name attr="value" ...> or <name ... /> >----------------------
+
+bool XmlViewToker::readTag(XmlToken& token)
+{
+  size_t stop = findTagEnd(pos_ + 1);
+  if (stop == std::string_view::npos)
+    return fail("unterminated start tag");
+  std::string_view body = src_.substr(pos_ + 1, stop - pos_ - 1);
+  bool empty = !body.empty() && body.back() == '/';
+  if (empty)
+    body.remove_suffix(1);
+
+  size_t pos = 0;
+  token.name = readName(body, pos);
+  if (token.name.empty())
+    return fail("expected element name after '<'");
+  if (!readAttributes(body, pos, token))
+    return false;
+  if (pos != body.size())
+    return fail("unexpected '" + std::string(1, body[pos]) + "' in start tag <" + std::string(token.name) + ">");
+  token.kind = empty ? XmlToken::emptyTag : XmlToken::startTag;
+  pos_ = stop + 1;
+  return true;
+}
+//----< name="value" pairs up to '>', "/>" or the end of body >--------
+
+bool XmlViewToker::readAttributes(std::string_view body, size_t& pos, XmlToken& token)
+{
+  while (true)
+  {
+    while (pos < body.size() && isSpace(body[pos]))
+      ++pos;
+    if (pos == body.size() || body[pos] == '>' || body[pos] == '/')
+      return true;
+
+    std::string_view name = readName(body, pos);
+    if (name.empty())
+      return fail("malformed attribute");
+    while (pos < body.size() && isSpace(body[pos]))
+      ++pos;
+    if (pos == body.size() || body[pos] != '=')
+      return fail("attribute " + std::string(name) + " has no value");
+    ++pos;
+    while (pos < body.size() && isSpace(body[pos]))
+      ++pos;
+    if (pos == body.size() || (body[pos] != '"' && body[pos] != '\''))
+      return fail("attribute " + std::string(name) + " value is not quoted");
+    char quote = body[pos++];
+    size_t close = body.find(quote, pos);
+    if (close == std::string_view::npos)
+      return fail("attribute " + std::string(name) + " value is not terminated");
+    token.attribs.emplace_back(name, body.substr(pos, close - pos));
+    pos = close + 1;
+  }
+}
+//----< name starting at pos; empty if there isn't one >---------------
+
+std::string_view XmlViewToker::readName(std::string_view body, size_t& pos) const
+{
+  size_t start = pos;
+  while (pos < body.size())
+  {
+    char ch = body[pos];
+    if (isSpace(ch) || ch == '>' || ch == '/' || ch == '=' || ch == '<' || ch == '?' || ch == '"' || ch == '\'')
+      break;
+    ++pos;
+  }
+  return body.substr(start, pos - start);
+}
+
+/////////////////////////////////////////////////////////////////////
+// XmlViewParser methods
+
+//----< copy token's attributes, decoded, to element >-----------------
+
+void XmlViewParser::addAttributes(sPtr pElem, const XmlToken& token, std::string& scratch)
+{
+  for (const XmlToken::Attrib& attrib : token.attribs)
+  {
+    scratch.clear();
+    XmlViewToker::decode(attrib.second, scratch);
+    pElem->addAttrib(std::string(attrib.first), scratch);
+  }
+}
+//----< build XmlDocument from the buffer >----------------------------
+
+XmlDocument* XmlViewParser::buildDocument()
+{
+  auto fail = [](const std::string& msg) {
+    throw(std::exception(("ill-formed XML: " + msg).c_str()));
+  };
+
+  std::unique_ptr<XmlDocument> pDoc(new XmlDocument(makeDocElement()));
+  std::vector<sPtr> elemStack{ pDoc->docElement() };
+  std::vector<std::string_view> openTags;
+  bool sawRoot = false;
+
+  XmlViewToker toker(src_);
+  XmlToken token;
+  std::string scratch;
+  while (toker.next(token))
+  {
+    switch (token.kind)
+    {
+    case XmlToken::declaration:
+    {
+      sPtr pDeclar = makeXmlDeclarElement();
+      addAttributes(pDeclar, token, scratch);
+      elemStack.back()->addChild(pDeclar);
+      break;
+    }
+    case XmlToken::procInstr:
+    {
+      sPtr pProcInstr = makeProcInstrElement(std::string(token.name));
+      addAttributes(pProcInstr, token, scratch);
+      elemStack.back()->addChild(pProcInstr);
+      break;
+    }
+    case XmlToken::comment:
+      elemStack.back()->addChild(makeCommentElement(std::string(token.value)));
+      break;
+    case XmlToken::startTag:
+    case XmlToken::emptyTag:
+    {
+      if (openTags.empty())
+      {
+        if (sawRoot)
+          fail("more than one root element");
+        sawRoot = true;
+      }
+      sPtr pElem = makeTaggedElement(std::string(token.name));
+      addAttributes(pElem, token, scratch);
+      elemStack.back()->addChild(pElem);
+      if (token.kind == XmlToken::startTag)
+      {
+        elemStack.push_back(pElem);
+        openTags.push_back(token.name);
+      }
+      break;
+    }
+    case XmlToken::endTag:
+      if (openTags.empty())
+        fail("end tag </" + std::string(token.name) + "> without start tag");
+      if (openTags.back() != token.name)
+        fail("end tag </" + std::string(token.name) + "> does not match <" + std::string(openTags.back()) + ">");
+      openTags.pop_back();
+      elemStack.pop_back();
+      break;
+    case XmlToken::text:
+    case XmlToken::cdata:
+      if (openTags.empty())
+        fail("text outside the root element");
+      if (token.kind == XmlToken::cdata)
+        elemStack.back()->addChild(makeTextElement(std::string(token.value)));
+      else
+      {
+        scratch.clear();
+        XmlViewToker::decode(token.value, scratch);
+        elemStack.back()->addChild(makeTextElement(scratch));
+      }
+      break;
+    default:
+      break;
+    }
+  }
+  if (!toker.error().empty())
+    fail(toker.error());
+  if (!openTags.empty())
+    fail("element <" + std::string(openTags.back()) + "> is not closed");
+  return pDoc.release();
+}
+
+#ifdef TEST_XMLVIEWPARSER
+
+#include <iostream>
+#include "../Utilities/Utilities.h"
+
+using namespace::Utilities;
+using Utils = StringHelper;
+
+int main()
+{
+  Utils::Title("Testing XmlViewParser");
+  putline();
+
+  std::string xml =
+    "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n"
+    "<!-- a comment -->\n"
+    "<db name=\"Titans &amp; co\">\n"
+    "  <record><key>Zeus</key>\n"
+    "    <description>a &lt; b &#x41;</description>\n"
+    "    <children/>\n"
+    "  </record>\n"
+    "</db>\n";
+
+  Utils::title("Tokens:");
+  XmlViewToker toker(xml);
+  XmlToken token;
+  while (toker.next(token))
+  {
+    std::cout << "\n  kind " << token.kind << "  name \"" << token.name << "\"  value \"" << token.value << "\"";
+    for (auto& attrib : token.attribs)
+      std::cout << "  " << attrib.first << "=" << attrib.second;
+  }
+  putline();
+
+  Utils::title("Parse tree:");
+  XmlSource source = XmlSource::fromString(xml);
+  XmlViewParser parser(source);
+  std::unique_ptr<XmlDocument> pDoc(parser.buildDocument());
+  std::cout << "\n" << pDoc->toString();
+  putline();
+
+  Utils::title("Ill-formed XML:");
+  try
+  {
+    XmlViewParser("<db><record></db>").buildDocument();
+  }
+  catch (std::exception& ex)
+  {
+    std::cout << "\n  " << ex.what();
+  }
+  std::cout << "\n\n";
+}
+
+#endif
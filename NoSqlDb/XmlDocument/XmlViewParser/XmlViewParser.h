@@ -0,0 +1,185 @@
+#ifndef XMLVIEWPARSER_H
+#define XMLVIEWPARSER_H
+///////////////////////////////////////////////////////////////////
+// XmlViewParser.h - parse XML in place from one buffer          //
+// ver 1.2                                                       //
+// Language:    C++, Visual Studio 2017                          //
+// Application: NoSqlDb, CSE687 - Object Oriented Design         //
+// Author:      Ritesh Nair (rgnair@syr.edu)                     //
+///////////////////////////////////////////////////////////////////
+/*
+* Package Operations:
+* -------------------
+* XmlParser copies its source several times before it starts: into
+* a string, through compress() and enquoteText(), and then once more
+* a character at a time as the Toker builds std::string tokens.
+* This package parses a single immutable buffer where it lies:
+*   XmlSource      - the buffer; a memory mapped file or a string
+*                    the source takes ownership of
+*   XmlToken       - one piece of markup or text, as std::string_views
+*                    into the buffer
+*   XmlViewToker   - splits the buffer into XmlTokens, no copies and,
+*                    once the attribute vector has grown, no allocation;
+*                    markup and text are found through the structural
+*                    index and whitespace runs skipped with XmlScanner
+*   XmlViewParser  - builds the same XmlDocument AST as XmlParser
+*
+* Token views are raw: entities are not decoded.  decode() copies a
+* view, decoding entities, only when the caller wants the value; a
+* view without '&' can be used as it is.  XmlViewParser copies each
+* tag, attribute and text once, into the AST node which keeps it.
+*
+* Text is reported with leading and trailing whitespace removed and
+* whitespace-only text is dropped, as XmlParser does.  Unlike
+* XmlParser, the predefined entities and numeric character references
+* are decoded, <tag/> is accepted, and mismatched or unclosed tags
+* are errors.  CDATA sections are reported as they are.
+*
+* Tokens and parsers hold views of the buffer, so the XmlSource or
+* string must outlive them; the XmlDocument built does not need it.
+*
+* Required Files:
+* ---------------
+*   - XmlViewParser.h, XmlViewParser.cpp
+*   - XmlScanner.h, XmlScanner.cpp
+*   - XmlDocument.h, XmlDocument.cpp, XmlElement.h, XmlElement.cpp
+*
+* Build Process:
+* --------------
+*   define TEST_XMLVIEWPARSER to build the test stub
+*
+* Maintenance History:
+* --------------------
+* ver 1.2 : 19 Oct 2026
+* - added XmlViewToker::skipElement
+* ver 1.1 : 19 Oct 2026
+* - XmlViewToker finds markup with XmlStructuralIndex instead of
+*   searching byte by byte
+* ver 1.0 : 19 Oct 2026
+* - first release
+*/
+
+#include "../XmlDocument/XmlDocument.h"
+#include "../XmlElement/XmlElement.h"
+#include "../XmlScanner/XmlScanner.h"
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace XmlProcessing
+{
+  /////////////////////////////////////////////////////////////////
+  // XmlSource
+  // - read-only buffer holding a whole document
+
+  class XmlSource
+  {
+  public:
+    static XmlSource fromFile(const std::string& fileSpec);
+    static XmlSource fromString(std::string xml);
+
+    XmlSource(XmlSource&& source);
+    XmlSource& operator=(XmlSource&& source);
+    XmlSource(const XmlSource&) = delete;
+    XmlSource& operator=(const XmlSource&) = delete;
+    ~XmlSource();
+
+    std::string_view view() const { return std::string_view(data_, size_); }
+    bool mapped() const { return mapping_ != nullptr; }
+
+  private:
+    XmlSource() {}
+    void release();
+
+    const char* data_ = "";
+    size_t size_ = 0;
+    std::string owned_;
+    void* mapping_ = nullptr;   // platform handles of a mapped file
+    void* file_ = nullptr;
+  };
+
+  /////////////////////////////////////////////////////////////////
+  // XmlToken
+  // - name:    tag of start, end and empty tags; target of a
+  //            processing instruction
+  // - value:   content of text, CDATA, comments and DOCTYPE; the
+  //            rest of a PI after its target
+  // - attribs: attributes of start and empty tags, and the
+  //            pseudo-attributes of the declaration and PIs
+
+  struct XmlToken
+  {
+    enum Kind { none, startTag, endTag, emptyTag, text, cdata, comment, procInstr, declaration, doctype };
+    using Attrib = std::pair<std::string_view, std::string_view>;
+
+    Kind kind = none;
+    std::string_view name;
+    std::string_view value;
+    std::vector<Attrib> attribs;
+    size_t offset = 0;    // of the token in the buffer
+  };
+
+  /////////////////////////////////////////////////////////////////
+  // XmlViewToker
+  // - next() fills in the next token; returns false at the end of
+  //   the buffer or on an error, which error() then describes
+  // - skipElement(), called after a start tag, moves past the rest
+  //   of that element without making tokens; the skipped markup is
+  //   only checked for balance, not for matching names
+
+  class XmlViewToker
+  {
+  public:
+    explicit XmlViewToker(std::string_view src) : src_(src), index_(src) {}
+
+    bool next(XmlToken& token);
+    bool skipElement();
+    const std::string& error() const { return error_; }
+    size_t offset() const { return pos_; }
+
+    static bool needsDecoding(std::string_view raw) { return raw.find('&') != std::string_view::npos; }
+    static void decode(std::string_view raw, std::string& dst);
+    static std::string decode(std::string_view raw);
+
+  private:
+    bool readMarkup(XmlToken& token);
+    bool readTag(XmlToken& token);
+    bool readEndTag(XmlToken& token);
+    bool readProcInstr(XmlToken& token);
+    bool readDelimited(XmlToken& token, XmlToken::Kind kind, size_t skip, std::string_view terminator);
+    bool readDoctype(XmlToken& token);
+    bool readAttributes(std::string_view body, size_t& pos, XmlToken& token);
+    std::string_view readName(std::string_view body, size_t& pos) const;
+    size_t find(char ch, size_t pos);
+    size_t findTagEnd(size_t pos);
+    bool fail(const std::string& msg);
+
+    std::string_view src_;
+    XmlStructuralIndex index_;
+    size_t pos_ = 0;
+    std::string error_;
+  };
+
+  /////////////////////////////////////////////////////////////////
+  // XmlViewParser
+  // - builds an XmlDocument from a buffer using XmlViewToker
+  // - buildDocument throws std::exception if the XML is ill-formed
+
+  class XmlViewParser
+  {
+  public:
+    using sPtr = std::shared_ptr<AbstractXmlElement>;
+
+    explicit XmlViewParser(std::string_view src) : src_(src) {}
+    explicit XmlViewParser(const XmlSource& source) : src_(source.view()) {}
+
+    XmlDocument* buildDocument();
+
+  private:
+    void addAttributes(sPtr pElem, const XmlToken& token, std::string& scratch);
+
+    std::string_view src_;
+  };
+}
+#endif
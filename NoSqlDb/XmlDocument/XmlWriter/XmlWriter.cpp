@@ -0,0 +1,235 @@
+///////////////////////////////////////////////////////////////////
+// XmlWriter.cpp - streaming XML writer                          //
+// ver 1.3                                                       //
+// Language:    C++, Visual Studio 2017                          //
+// Application: NoSqlDb, CSE687 - Object Oriented Design         //
+// Author:      Ritesh Nair (rgnair@syr.edu)                     //
+///////////////////////////////////////////////////////////////////
+
+/*
+* Maintenance History:
+* --------------------
+* ver 1.3 : 19 Oct 2026
+* - added markup()
+* ver 1.2 : 19 Oct 2026
+* - quotes in text are escaped, through XmlSerializer::escape
+* ver 1.1 : 19 Oct 2026
+* - escape() is XmlSerializer::escape
+* ver 1.0 : 19 Oct 2026
+* - first release
+*/
+
+#include "XmlWriter.h"
+
+using namespace XmlProcessing;
+
+//----< construct writer on an open stream >---------------------------
+
+XmlWriter::XmlWriter(std::ostream& out, size_t bufferSize, bool indent)
+  : out_(out), bufferSize_(bufferSize == 0 ? 1 : bufferSize), indent_(indent)
+{
+  buffer_.reserve(bufferSize_ + 256);
+}
+//----< write whatever is left in the buffer >-------------------------
+
+XmlWriter::~XmlWriter()
+{
+  flush();
+}
+//----< append src to dst replacing markup characters >--------------
+
+void XmlWriter::escape(std::string& dst, const std::string& src)
+{
+  XmlSerializer::escape(dst, src);
+}
+//----< hand a full buffer to the stream >-----------------------------
+
+void XmlWriter::spill()
+{
+  if (buffer_.size() >= bufferSize_)
+  {
+    out_.write(buffer_.data(), buffer_.size());
+    buffer_.clear();
+  }
+}
+//----< write buffer to stream and flush it >--------------------------
+
+bool XmlWriter::flush()
+{
+  closeStartTag();
+  if (!buffer_.empty())
+  {
+    out_.write(buffer_.data(), buffer_.size());
+    buffer_.clear();
+  }
+  out_.flush();
+  return out_.good();
+}
+//----< finish "<tag attr=..." with '>' if still open >----------------
+
+void XmlWriter::closeStartTag()
+{
+  if (startTagOpen_)
+  {
+    buffer_ += '>';
+    startTagOpen_ = false;
+  }
+}
+//----< start a new line indented for depth >--------------------------
+
+void XmlWriter::newLine(size_t depth)
+{
+  if (atStart_)
+  {
+    atStart_ = false;
+    return;
+  }
+  if (!indent_)
+    return;
+  buffer_ += '\n';
+  buffer_.append(2 * depth, ' ');
+}
+//----< write the XML declaration; must come first >-------------------
+
+XmlWriter& XmlWriter::declaration()
+{
+  newLine(0);
+  buffer_ += "<?xml version=\"1.0\" encoding=\"utf-8\"?>";
+  return *this;
+}
+//----< write start tag; attributes may follow >-----------------------
+
+XmlWriter& XmlWriter::startElement(const std::string& tag)
+{
+  closeStartTag();
+  if (!open_.empty())
+    open_.back().hasElements = true;
+  newLine(open_.size());
+  buffer_ += '<';
+  buffer_ += tag;
+  startTagOpen_ = true;
+  open_.push_back({ tag, false });
+  return *this;
+}
+//----< add attribute to the element just started >--------------------
+
+XmlWriter& XmlWriter::attribute(const std::string& name, const std::string& value)
+{
+  if (!startTagOpen_)
+    throw(std::exception("XmlWriter: attribute must follow startElement"));
+  buffer_ += ' ';
+  buffer_ += name;
+  buffer_ += "=\"";
+  escape(buffer_, value);
+  buffer_ += '"';
+  return *this;
+}
+//----< write text content of the current element >--------------------
+
+XmlWriter& XmlWriter::text(const std::string& text)
+{
+  closeStartTag();
+  escape(buffer_, text);
+  spill();
+  return *this;
+}
+//----< write end tag of the current element >-------------------------
+
+XmlWriter& XmlWriter::endElement()
+{
+  if (open_.empty())
+    throw(std::exception("XmlWriter: endElement without open element"));
+  closeStartTag();
+  Open& current = open_.back();
+  if (current.hasElements)
+    newLine(open_.size() - 1);
+  buffer_ += "</";
+  buffer_ += current.tag;
+  buffer_ += '>';
+  open_.pop_back();
+  spill();
+  return *this;
+}
+//----< write <tag>text</tag> >----------------------------------------
+
+XmlWriter& XmlWriter::element(const std::string& tag, const std::string& text)
+{
+  startElement(tag);
+  this->text(text);
+  return endElement();
+}
+//----< write an element tree >----------------------------------------
+/*
+*  - tagged and text elements are written, anything else is skipped
+*/
+XmlWriter& XmlWriter::element(std::shared_ptr<AbstractXmlElement> pElem)
+{
+  if (!pElem)
+    return *this;
+  std::string tag = pElem->tag();
+  if (tag.empty())
+  {
+    if (dynamic_cast<TextElement*>(pElem.get()))
+      text(pElem->value());
+    return *this;
+  }
+  startElement(tag);
+  for (auto& attrib : pElem->attributes())
+    attribute(attrib.first, attrib.second);
+  for (auto pChild : pElem->children())
+    element(pChild);
+  return endElement();
+}
+//----< write an element that is already serialized >------------------
+/*
+*  - xml is copied as it is, so it must be one well-formed element with
+*    its text and attribute values escaped
+*  - it is placed like any child element; its own lines are kept
+*/
+XmlWriter& XmlWriter::markup(const std::string& xml)
+{
+  closeStartTag();
+  if (!open_.empty())
+    open_.back().hasElements = true;
+  newLine(open_.size());
+  buffer_ += xml;
+  spill();
+  return *this;
+}
+
+#ifdef TEST_XMLWRITER
+
+#include <iostream>
+#include <sstream>
+#include "../Utilities/Utilities.h"
+
+using namespace::Utilities;
+using Utils = StringHelper;
+
+int main()
+{
+  Utils::Title("Testing XmlWriter");
+  putline();
+
+  std::ostringstream out;
+  {
+    XmlWriter writer(out, 32);
+    writer.declaration();
+    writer.startElement("shard").attribute("name", "\"Titans\" & co");
+    writer.startElement("record");
+    writer.element("key", "a<b");
+    writer.element("description", "");
+    std::shared_ptr<AbstractXmlElement> pPayload = makeTaggedElement("payload");
+    pPayload->addChild(makeTaggedElement("filepath", "Storage/DbCore.h"));
+    writer.element(pPayload);
+    writer.endElement();
+    writer.startElement("record");
+    writer.element("key", "b");
+    writer.markup("<payload><filepath>Storage/Query.h</filepath></payload>");
+    writer.endElement();
+    writer.endElement();
+  }
+  std::cout << "\n" << out.str() << "\n\n";
+}
+
+#endif
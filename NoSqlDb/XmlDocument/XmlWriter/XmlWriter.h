@@ -0,0 +1,105 @@
+#ifndef XMLWRITER_H
+#define XMLWRITER_H
+///////////////////////////////////////////////////////////////////
+// XmlWriter.h - streaming XML writer                            //
+// ver 1.3                                                       //
+// Language:    C++, Visual Studio 2017                          //
+// Application: NoSqlDb, CSE687 - Object Oriented Design         //
+// Author:      Ritesh Nair (rgnair@syr.edu)                     //
+///////////////////////////////////////////////////////////////////
+/*
+* Package Operations:
+* -------------------
+* XmlDocument::toString builds the text of the whole document in one
+* string from a tree of elements.  XmlWriter writes XML to a
+* std::ostream as it is produced, without any tree:
+*   - startElement, attribute, text and endElement write the document
+*     in document order; element(tag, text) writes a simple element
+*   - element(pElem) writes an existing element tree, for code which
+*     still builds one
+*   - markup(xml) copies an element that is already serialized, e.g.
+*     kept as read from a file, without parsing it again
+*   - text and attribute values are escaped, quotes in text included
+*   - output is collected in a buffer of fixed size and handed to the
+*     stream in large writes
+*
+* Elements which only contain text are written on one line; elements
+* with child elements have their children indented below them.  Empty
+* elements are written as <tag></tag> since XmlParser does not accept
+* the <tag/> form, and quotes in text are escaped since XmlParser reads
+* them as the start of a quoted string.
+*
+* Required Files:
+* ---------------
+*   - XmlWriter.h, XmlWriter.cpp
+*   - XmlElement.h, XmlElement.cpp
+*
+* Build Process:
+* --------------
+*   define TEST_XMLWRITER to build the test stub
+*
+* Maintenance History:
+* --------------------
+* ver 1.3 : 19 Oct 2026
+* - added markup() to copy an element that is already serialized
+* ver 1.2 : 19 Oct 2026
+* - quotes in text are escaped
+* ver 1.1 : 19 Oct 2026
+* - escape() is XmlSerializer::escape
+* ver 1.0 : 19 Oct 2026
+* - first release
+*/
+
+#include "../XmlElement/XmlElement.h"
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace XmlProcessing
+{
+  class XmlWriter
+  {
+  public:
+    static const size_t DEFAULT_BUFFER_SIZE = 64 * 1024;
+
+    XmlWriter(std::ostream& out, size_t bufferSize = DEFAULT_BUFFER_SIZE, bool indent = true);
+    ~XmlWriter();
+    XmlWriter(const XmlWriter&) = delete;
+    XmlWriter& operator=(const XmlWriter&) = delete;
+
+    XmlWriter& declaration();
+    XmlWriter& startElement(const std::string& tag);
+    XmlWriter& attribute(const std::string& name, const std::string& value);
+    XmlWriter& text(const std::string& text);
+    XmlWriter& endElement();
+    XmlWriter& element(const std::string& tag, const std::string& text);
+    XmlWriter& element(std::shared_ptr<AbstractXmlElement> pElem);
+    XmlWriter& markup(const std::string& xml);
+
+    bool flush();
+    size_t depth() const { return open_.size(); }
+
+    static void escape(std::string& dst, const std::string& src);
+
+  private:
+    struct Open
+    {
+      std::string tag;
+      bool hasElements;
+    };
+
+    void closeStartTag();
+    void newLine(size_t depth);
+    void spill();
+
+    std::ostream& out_;
+    std::string buffer_;
+    size_t bufferSize_;
+    bool indent_;
+    bool startTagOpen_ = false;
+    bool atStart_ = true;
+    std::vector<Open> open_;
+  };
+}
+#endif
@@ -1,7 +1,7 @@
 #pragma once
 /////////////////////////////////////////////////////////////////////////////
 // MessageHandlers.h - Implements the Remote Repository Server             //
-// ver 1.1                                                                 //
+// ver 1.2                                                                 //
 // Language:    C++, Visual Studio 2017                                    //
 // Application: SoftwareRepository, CSE687 - Object Oriented Design        //
 // Author:      Ritesh Nair (rgnair@syr.edu)                               //
@@ -25,6 +25,8 @@
 *
 * Maintenance History:
 * --------------------
+* ver 1.2 : 19 Oct 2026
+* - added referToLeader handler used by follower servers
 * ver 1.1 : 30 Apr 2018
 * - message handlers use repocore for browsing packages, package files, file metadata,
 *   file text and checkout
@@ -218,6 +220,26 @@ namespace SoftwareRepository
         {
             return checkOut();
         }
+
+        // ----< handles requests a follower can not serve >--------------------
+        /*
+        *  Responds with success = false and the leader's endpoint so that
+        *  the client can resend the request there.
+        */
+
+        static HandlerFn referToLeader(MsgPassingCommunication::EndPoint leaderEp)
+        {
+            return [leaderEp](Message& message, RepoCore& repo) {
+                Message reply;
+                reply.to(message.from());
+                reply.from(message.to());
+                if (message.containsKey("requestId"))
+                    reply.attribute("responseId", message.value("requestId"));
+                reply.attribute("success", "false");
+                reply.attribute("leader", MsgPassingCommunication::EndPoint(leaderEp).toString());
+                return reply;
+            };
+        }
     };
 }
 
@@ -1,7 +1,7 @@
 #pragma once
 /////////////////////////////////////////////////////////////////////////////
 // RemoteCodeRepository.h - Implements the Remote Repository Server        //
-// ver 1.1                                                                 //
+// ver 1.5                                                                 //
 // Language:    C++, Visual Studio 2017                                    //
 // Application: SoftwareRepository, CSE687 - Object Oriented Design        //
 // Author:      Ritesh Nair (rgnair@syr.edu)                               //
@@ -15,14 +15,41 @@
 and a socket listener which are used to accept requests from remote clients
 and respond back to them.
 *
+* A server runs either as the leader (the default) or as a follower of
+* another server. Followers receive the repository dbs from the leader
+* (see Replication.h) and only serve read-only browse requests.
+* Both run a timer thread which posts replica-tick to the server itself.
+* The leader ships changes and heartbeats on it while no other message
+* arrives; a follower uses it to subscribe again when it has heard
+* nothing from the leader for a while.
+*
+* The server's receive queue holds at most DEFAULT_SERVER_RECEIVE_LIMIT
+* messages. Once it is full, further requests are rejected and Comm
+* answers each one with a "busy" message, so clients back off and post
+* again instead of the server's memory and latency growing. Each send
+* queue holds at most DEFAULT_SERVER_SEND_LIMIT replies; more are
+* dropped, so a client that stops reading holds up no one else.
+* A lost replica-tick is made up by the next one, and followers recover
+* lost replication messages as described in Replication.h.
+*
 * Required Files:
 * ---------------
 * RemoteRepositoryDefinitions.h
 * RepoCoreDefinitions.h
 * Comm.h, Comm.cpp
+* Replication.h
 *
 * Maintenance History:
 * --------------------
+* ver 1.5 : 19 Oct 2026
+* - bounded receive and send queues; overflowing requests get "busy"
+* - the quit message is posted again until the listener has stopped
+* ver 1.4 : 19 Oct 2026
+* - followers run the replication timer thread too
+* ver 1.3 : 19 Oct 2026
+* - leader runs a replication timer thread
+* ver 1.2 : 19 Oct 2026
+* - server can run as a replication leader or follower
 * ver 1.1 : 28 Apr 2018
 * - message handlers removed from this header file
 * ver 1.0 : 06 Apr 2018
@@ -35,6 +62,10 @@ and respond back to them.
 #include "RemoteCodeRepositoryDefinitions.h"
 #include "../SoftwareRepository/RepoCore/RepoCoreDefinitions.h"
 #include "../Comm/MsgPassingComm/Comm.h"
+#include "Replication.h"
+
+#include <atomic>
+#include <thread>
 
 namespace SoftwareRepository
 {
@@ -49,23 +80,33 @@ namespace SoftwareRepository
     {
     public:
         RemoteRepoServer(Address bindAddress = ADDRESS_LOCALHOST,
-            Port bindPort = DEFAULT_PORT_SERVER);
+            Port bindPort = DEFAULT_PORT_SERVER,
+            REPLICA_ROLE role = LEADER,
+            MsgPassingCommunication::EndPoint leaderEp = MsgPassingCommunication::EndPoint());
         ~RemoteRepoServer();
 
     private:
         MsgPassingCommunication::EndPoint clientEp_;
+        MsgPassingCommunication::EndPoint leaderEp_;
+        REPLICA_ROLE role_;
         std::string clientName_;
         MsgPassingCommunication::Comm comm_;
         MessageHandlers handlers_;
         std::thread messagesListenerThread_;
+        std::thread replicationTimerThread_;
+        std::atomic<bool> replicationTimerStop_{ false };
+        std::atomic<bool> listenerStopped_{ false };
 
         std::string getClientName();
         void registerMessageHandlers();
         void startMessagesListenerThread();
         void startServer();
         void stopMessagesListenerThread();
+        void startReplicationTimerThread();
+        void stopReplicationTimerThread();
         void stopServer();
-        void processMessages(RepoCore&);
+        void processMessages(RepoCore&, Replicator&);
+        void postMessages(const Messages&);
     };
 
 }
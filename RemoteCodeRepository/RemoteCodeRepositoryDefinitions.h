@@ -2,7 +2,7 @@
 ////////////////////////////////////////////////////////////////////////////////////
 // RemoteCodeRepositoryDefinitions.h - Define aliases & constants used throughout //
 //                                     the SoftwareRepository namespace           //
-// ver 1.1                                                                        //
+// ver 1.5                                                                        //
 // Language:    C++, Visual Studio 2017                                           //
 // Application: SoftwareRepository, CSE687 - Object Oriented Design               //
 // Author:      Ritesh Nair (rgnair@syr.edu)                                      //
@@ -10,6 +10,14 @@
 /*
 * Maintenance History:
 * --------------------
+* ver 1.5 : 19 Oct 2026
+* - added the server's queue limits and the quit retry interval
+* ver 1.4 : 19 Oct 2026
+* - added replication retry interval and retry limit
+* ver 1.3 : 19 Oct 2026
+* - added replication chunk size and tick interval
+* ver 1.2 : 19 Oct 2026
+* - added replica roles and replication constants
 * ver 1.1 : 28 Apr 2018
 * - changed definition of Handler function
 * ver 1.0 : 06 Apr 2018
@@ -28,6 +36,8 @@
 
 namespace SoftwareRepository
 {
+    enum REPLICA_ROLE { LEADER, FOLLOWER };
+
     // ALIASES
     using ClientName = std::string;
 
@@ -44,6 +54,15 @@ namespace SoftwareRepository
     const size_t DEFAULT_PORT_SERVER = 7790;
     const size_t DEFAULT_PORT_CLIENT = 7890;
     const bool DEFAULT_VERBOSITY_INCOMING_MESSAGE = false;
+    const size_t DEFAULT_REPLICATION_CHUNK_RECORDS = 64;
+    const size_t DEFAULT_REPLICATION_CHUNK_BYTES = 64 * 1024;
+    const size_t DEFAULT_REPLICATION_BATCH_EVENTS = 256;
+    const size_t DEFAULT_REPLICATION_TICK_MS = 200;
+    const size_t DEFAULT_REPLICATION_RETRY_MS = 2000;
+    const size_t DEFAULT_REPLICATION_MAX_RETRIES = 5;
+    const size_t DEFAULT_SERVER_RECEIVE_LIMIT = 1024;
+    const size_t DEFAULT_SERVER_SEND_LIMIT = 1024;
+    const size_t DEFAULT_QUIT_RETRY_MS = 500;
 }
 
 #endif // !REMOTEREPOSITORY_DEFINITIONS_H
@@ -0,0 +1,864 @@
+#pragma once
+/////////////////////////////////////////////////////////////////////////////
+// Replication.h - Leader/follower replication of the repository dbs      //
+// ver 1.3                                                                 //
+// Language:    C++, Visual Studio 2017                                    //
+// Application: SoftwareRepository, CSE687 - Object Oriented Design        //
+// Author:      Ritesh Nair (rgnair@syr.edu)                               //
+/////////////////////////////////////////////////////////////////////////////
+/*
+* Package Operations:
+* -------------------
+* This package replicates the NoSqlDb stores behind RepoCore (the version
+* db and the resource properties db) from a leader RemoteRepoServer to any
+* number of follower servers using the existing Comm/Message transport.
+* It contains below classes
+* - ReplicatedStore which ships/applies the records of a single DbCore<T>.
+*   On the leader it reads the db's change stream and coalesces the
+*   events into upserts (xml records) and removals (keys). On the
+*   follower it applies them to the local copy of the db.
+* - Replicator which implements the protocol for both roles. It never
+*   touches the Comm object itself; it returns the messages to be posted
+*   so the server keeps control over its transport.
+*
+* Protocol:
+* ---------
+*   follower -> leader   replica-subscribe
+*   leader -> follower   replica-snapshot-begin
+*                        replica-snapshot (one per part of a chunk of records)
+*                        replica-snapshot-end (versions-seq, props-seq)
+*                        replica-batch (one per group of changes)
+*   leader -> follower   replica-heartbeat (versions-seq, props-seq)
+*   follower -> leader   replica-ack (versions-seq, props-seq)
+*   server -> itself     replica-tick (from the server's timer)
+*   anyone -> server     get-replication-status
+*
+* Snapshot chunks hold at most DEFAULT_REPLICATION_CHUNK_RECORDS records
+* and are split into parts of at most DEFAULT_REPLICATION_CHUNK_BYTES so
+* that no message carries the whole db. The leader ships after every
+* message it processes; the tick makes sure changes also go out while
+* no other message arrives. Each tick ends with a heartbeat telling
+* every follower how far the leader has shipped to it.
+*
+* Lost messages:
+* --------------
+* Comm may drop messages, so any of them can go missing:
+* - a follower sends replica-subscribe again on its tick until a
+*   snapshot makes progress, and whenever it has heard nothing from
+*   the leader for the retry interval, e.g. because the leader
+*   restarted and no longer knows it
+* - a follower which gets a batch out of order, a heartbeat it is not
+*   in step with (a lost tail), or a snapshot part that is not the
+*   next one of the chunk it is loading, discards what it has and
+*   subscribes again
+* - the leader sends a fresh snapshot to a follower whose oldest batch
+*   is still not acknowledged after the retry interval, and forgets a
+*   follower after DEFAULT_REPLICATION_MAX_RETRIES such snapshots
+* - an ack from a follower the leader does not know is answered with
+*   a snapshot
+* A follower which falls further behind than the leader's change stream
+* can hold is sent a fresh snapshot too.
+*
+* Replication lag (in change events and in ms since the oldest batch
+* that is not acknowledged yet) is reported by get-replication-status.
+* A partial ack only retires the batches it covers.
+*
+* Required Files:
+* ---------------
+* RemoteCodeRepositoryDefinitions.h
+* DbCore.h, DbChangeStream.h
+* Persistence.h
+* SingleDigitVersionMgr.h
+* FileResourcePayload.h
+*
+* Maintenance History:
+* --------------------
+* ver 1.3 : 19 Oct 2026
+* - recovers from lost messages: followers retry subscribing, ticks
+*   carry a heartbeat, unacknowledged batches are followed by a new
+*   snapshot and snapshot parts are checked before they are applied
+* - the follower's server ticks too, to retry subscribing
+* ver 1.2 : 19 Oct 2026
+* - snapshot chunks are split into parts by size
+* - lag is measured from the oldest batch that is not acknowledged
+* - leader ships on replica-tick as well, so an idle leader ships
+* ver 1.1 : 19 Oct 2026
+* - batches no longer split the changes of a DbTransaction
+* ver 1.0 : 19 Oct 2026
+* - first release
+*/
+
+#ifndef REPLICATION_H
+#define REPLICATION_H
+
+#include "RemoteCodeRepositoryDefinitions.h"
+#include "../NoSqlDb/DbCore/DbCore.h"
+#include "../NoSqlDb/Persistence/Persistence.h"
+#include "../SoftwareRepository/VersionMgr/SingleDigitVersionMgr.h"
+#include "../SoftwareRepository/ResourceProperties/FileResourcePayload.h"
+
+#include <chrono>
+#include <deque>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace SoftwareRepository
+{
+    using Messages = std::vector<Message>;
+    using EndPoint = MsgPassingCommunication::EndPoint;
+
+    //----< escapes characters that can not travel in a message attribute >---
+    /*
+    *  Message attributes are split on ',' and '\n' so those (and the
+    *  escape character itself) are written as %XX.
+    */
+
+    inline std::string escapeAttribute(const std::string& value)
+    {
+        static const char* hex = "0123456789ABCDEF";
+        std::string escaped;
+        escaped.reserve(value.size());
+        for (char ch : value)
+        {
+            if (ch == ',' || ch == '\n' || ch == '\r' || ch == '%' || ch == ';')
+            {
+                escaped += '%';
+                escaped += hex[(ch >> 4) & 0xF];
+                escaped += hex[ch & 0xF];
+            }
+            else
+                escaped += ch;
+        }
+        return escaped;
+    }
+
+    //----< reverses escapeAttribute >-------------------------------------
+
+    inline std::string unescapeAttribute(const std::string& value)
+    {
+        std::string unescaped;
+        unescaped.reserve(value.size());
+        for (size_t i = 0; i < value.size(); ++i)
+        {
+            if (value[i] == '%' && i + 2 < value.size())
+            {
+                unescaped += (char)std::stoi(value.substr(i + 1, 2), nullptr, 16);
+                i += 2;
+            }
+            else
+                unescaped += value[i];
+        }
+        return unescaped;
+    }
+
+    //----< reads a sequence or count attribute; 0 if it is not a number >---
+
+    inline uint64_t toSequence(const std::string& value)
+    {
+        if (value.empty() || value.find_first_not_of("0123456789") != std::string::npos)
+            return 0;
+        return std::stoull(value);
+    }
+
+    //----< joins keys into a single escaped attribute value >------------
+
+    inline std::string joinKeys(const std::vector<std::string>& keys)
+    {
+        std::string joined;
+        for (const std::string& key : keys)
+        {
+            if (!joined.empty())
+                joined += ';';
+            joined += escapeAttribute(key);
+        }
+        return joined;
+    }
+
+    //----< splits an attribute value created by joinKeys >---------------
+
+    inline std::vector<std::string> splitKeys(const std::string& joined)
+    {
+        std::vector<std::string> keys;
+        size_t start = 0;
+        while (start < joined.size())
+        {
+            size_t end = joined.find(';', start);
+            if (end == std::string::npos)
+                end = joined.size();
+            keys.push_back(unescapeAttribute(joined.substr(start, end - start)));
+            start = end + 1;
+        }
+        return keys;
+    }
+
+    /////////////////////////////////////////////////////////////////////
+    // ReplicatedStore class
+    // - ships (leader) and applies (follower) the records of one db
+
+    template<typename T>
+    class ReplicatedStore
+    {
+    public:
+        using Db = NoSqlDb::DbCore<T>;
+        using Key = typename Db::Key;
+        using Keys = typename Db::Keys;
+        using Cursor = NoSqlDb::DbChangeCursor<T>;
+        using Sequence = uint64_t;
+
+        struct Changes
+        {
+            std::string upserts;        // xml shard with the records to write
+            Keys removals;              // keys to erase
+            Sequence firstSequence = 0;
+            Sequence lastSequence = 0;
+            bool empty() const { return lastSequence == 0; }
+        };
+
+        ReplicatedStore(const std::string& name, Db& db) : name_(name), db_(db) {}
+
+        const std::string& name() const { return name_; }
+        Sequence lastSequence() { return db_.changes().lastSequence(); }
+        Cursor subscribe() { return db_.changes().subscribe(); }
+
+        std::vector<std::string> snapshot(size_t recordsPerChunk);
+        bool collect(Cursor& cursor, Changes& changes, size_t maxEvents);
+
+        void clear() { db_.truncate(); }
+        void apply(const std::string& upserts, const Keys& removals);
+
+    private:
+        std::string name_;
+        Db& db_;
+    };
+
+    //----< serializes the whole db as a sequence of xml shards >---------
+
+    template<typename T>
+    std::vector<std::string> ReplicatedStore<T>::snapshot(size_t recordsPerChunk)
+    {
+        NoSqlDb::Persistence<T> persistence(db_, name_);
+        Keys keys = db_.keys();
+
+        std::vector<std::string> chunks;
+        for (size_t start = 0; start < keys.size(); start += recordsPerChunk)
+        {
+            size_t end = std::min(keys.size(), start + recordsPerChunk);
+            Keys chunkKeys(keys.begin() + start, keys.begin() + end);
+            chunks.push_back(persistence.exportDbToString(chunkKeys));
+        }
+        return chunks;
+    }
+
+    //----< reads up to maxEvents change events and coalesces them by key >---
+    /*
+    *  - Only the last change to a key is kept: a key added then removed
+    *    becomes a removal, a key removed then added becomes an upsert.
+    *  - A transaction is never split across batches, so a batch can run
+    *    past maxEvents to take in the rest of the transaction it is in.
+    *  - Returns false if the cursor fell behind the change stream; the
+    *    follower then needs a new snapshot.
+    */
+    template<typename T>
+    bool ReplicatedStore<T>::collect(Cursor& cursor, Changes& changes, size_t maxEvents)
+    {
+        db_.flushEdits();
+        Db staging;
+        std::set<Key> removed;
+
+        NoSqlDb::DbChangeEvent<T> event;
+        uint64_t lastTxId = 0;
+        for (size_t count = 0; ; ++count)
+        {
+            uint64_t position = cursor.position();
+            typename Cursor::ReadStatus status = cursor.next(event);
+            if (status == Cursor::ReadStatus::GAP)
+                return false;
+            if (status == Cursor::ReadStatus::EMPTY)
+                break;
+            if (count >= maxEvents && (event.txId == 0 || event.txId != lastTxId))
+            {
+                cursor.seek(position);
+                break;
+            }
+            lastTxId = event.txId;
+
+            if (event.type == NoSqlDb::ChangeType::removed || !event.element)
+            {
+                staging.remove(event.key);
+                removed.insert(event.key);
+            }
+            else
+            {
+                staging.add(event.key, *event.element);
+                removed.erase(event.key);
+            }
+
+            if (changes.firstSequence == 0)
+                changes.firstSequence = event.sequence;
+            changes.lastSequence = event.sequence;
+        }
+
+        if (staging.size() > 0)
+            changes.upserts = NoSqlDb::Persistence<T>(staging, name_).exportDbToString(staging.keys());
+        changes.removals.assign(removed.begin(), removed.end());
+        return true;
+    }
+
+    //----< applies shipped records to the local copy of the db >---------
+
+    template<typename T>
+    void ReplicatedStore<T>::apply(const std::string& upserts, const Keys& removals)
+    {
+        for (const Key& key : removals)
+            db_.remove(key);
+
+        if (!upserts.empty())
+            NoSqlDb::Persistence<T>(db_, name_).importDbFromString(upserts, false);
+    }
+
+    /////////////////////////////////////////////////////////////////////
+    // Replicator class
+    // - implements the replication protocol for a leader or a follower
+
+    class Replicator
+    {
+    public:
+        using Sequence = uint64_t;
+        using Clock = std::chrono::steady_clock;
+        using VersionStore = ReplicatedStore<SingleDigitVersion>;
+        using PropsStore = ReplicatedStore<FileResourcePayload>;
+
+        Replicator(REPLICA_ROLE role, EndPoint self,
+            NoSqlDb::DbCore<SingleDigitVersion>& versionsDb,
+            NoSqlDb::DbCore<FileResourcePayload>& propsDb,
+            EndPoint leader = EndPoint()) :
+            role_(role), self_(self), leader_(leader),
+            versions_("VersionMgr", versionsDb), props_("ResourcePropertiesDb", propsDb) {}
+
+        REPLICA_ROLE role() const { return role_; }
+        EndPoint self() const { return self_; }
+        void retryAfter(size_t milliseconds) { retryAfter_ = std::chrono::milliseconds(milliseconds); }
+        static bool isReplicationMessage(Message& message);
+
+        Messages start();
+        Messages process(Message& message);
+        Messages ship();
+        static Message tick(EndPoint self);
+
+    private:
+        /////////////////////////////////////////////////////////////////
+        // state kept by the leader for every follower
+
+        struct Follower
+        {
+            Follower(EndPoint endPoint, VersionStore& versions, PropsStore& props) :
+                ep(endPoint), versionsCursor(versions.subscribe()), propsCursor(props.subscribe()) {}
+
+            // sequences reached by a snapshot or batch and when it was sent
+            struct Sent
+            {
+                Sequence versions, props;
+                Clock::time_point at;
+            };
+
+            EndPoint ep;
+            VersionStore::Cursor versionsCursor;
+            PropsStore::Cursor propsCursor;
+            Sequence nextBatch = 1;
+            Sequence sentVersions = 0, sentProps = 0;
+            Sequence ackedVersions = 0, ackedProps = 0;
+            std::deque<Sent> unacked;       // oldest first
+            size_t retries = 0;             // snapshots resent since the last ack
+        };
+
+        REPLICA_ROLE role_;
+        EndPoint self_;
+        EndPoint leader_;
+        VersionStore versions_;
+        PropsStore props_;
+        std::chrono::milliseconds retryAfter_{ DEFAULT_REPLICATION_RETRY_MS };
+
+        // leader state
+        std::unordered_map<std::string, Follower> followers_;
+
+        // follower state
+        bool bootstrapped_ = false;
+        bool snapshotting_ = false;         // between snapshot-begin and -end
+        std::string snapshotParts_;
+        std::string snapshotStore_;         // store of the chunk being loaded
+        size_t snapshotPart_ = 0;           // parts of that chunk received
+        size_t snapshotChunks_ = 0;         // chunks loaded so far
+        Sequence appliedVersions_ = 0, appliedProps_ = 0;
+        Clock::time_point lastApplied_ = Clock::now();
+        Clock::time_point lastHeard_ = Clock::now();
+
+        Message makeMessage(const std::string& command, EndPoint to);
+        Messages bootstrap(Follower& follower);
+        Messages onTick();
+        Messages onSubscribe(Message& message);
+        Messages onAck(Message& message);
+        Messages onSnapshot(Message& message);
+        Messages onBatch(Message& message);
+        Messages onHeartbeat(Message& message);
+        Messages acknowledge();
+        Message status(Message& message);
+    };
+
+    /////////////////////////////////////////////////////////////////////
+    // Replicator methods
+
+    //----< is this message handled by the replicator? >------------------
+
+    inline bool Replicator::isReplicationMessage(Message& message)
+    {
+        std::string command = message.command();
+        return (command.compare(0, 8, "replica-") == 0 || command == "get-replication-status");
+    }
+
+    //----< creates a message addressed from this server >----------------
+
+    inline Message Replicator::makeMessage(const std::string& command, EndPoint to)
+    {
+        Message message;
+        message.to(to);
+        message.from(self_);
+        message.command(command);
+        return message;
+    }
+
+    //----< message the server posts to itself on every timer tick >------
+
+    inline Message Replicator::tick(EndPoint self)
+    {
+        Message message;
+        message.to(self);
+        message.from(self);
+        message.command("replica-tick");
+        return message;
+    }
+
+    //----< follower asks the leader for a snapshot >---------------------
+    /*
+    *  Also called to start over, so any partly loaded snapshot is
+    *  dropped. Its remaining parts are ignored until the next
+    *  replica-snapshot-begin.
+    */
+    inline Messages Replicator::start()
+    {
+        if (role_ != FOLLOWER)
+            return {};
+
+        bootstrapped_ = false;
+        snapshotting_ = false;
+        snapshotParts_.clear();
+        snapshotStore_.clear();
+        snapshotPart_ = 0;
+        lastHeard_ = Clock::now();
+        return { makeMessage("replica-subscribe", leader_) };
+    }
+
+    //----< dispatches an incoming replication message >-----------------
+
+    inline Messages Replicator::process(Message& message)
+    {
+        std::string command = message.command();
+
+        if (command == "get-replication-status")
+            return { status(message) };
+        if (command == "replica-tick")
+            return onTick();
+
+        if (role_ == LEADER)
+        {
+            if (command == "replica-subscribe")
+                return onSubscribe(message);
+            if (command == "replica-ack")
+                return onAck(message);
+        }
+        else
+        {
+            if (command.compare(0, 16, "replica-snapshot") == 0)
+                return onSnapshot(message);
+            if (command == "replica-batch")
+                return onBatch(message);
+            if (command == "replica-heartbeat")
+                return onHeartbeat(message);
+        }
+        return {};
+    }
+
+    //----< handles the server's timer tick >-----------------------------
+    /*
+    *  Follower: subscribes again if nothing has come from the leader
+    *  for retryAfter_.
+    *  Leader: ships, then sends a fresh snapshot to every follower whose
+    *  oldest unacknowledged snapshot or batch is older than retryAfter_,
+    *  and a heartbeat to the others. A follower still silent after
+    *  DEFAULT_REPLICATION_MAX_RETRIES snapshots is forgotten; it
+    *  subscribes again when it comes back.
+    */
+    inline Messages Replicator::onTick()
+    {
+        if (role_ == FOLLOWER)
+        {
+            if (Clock::now() - lastHeard_ < retryAfter_)
+                return {};
+            return start();
+        }
+
+        Messages messages = ship();
+        Clock::time_point now = Clock::now();
+        for (auto iter = followers_.begin(); iter != followers_.end(); )
+        {
+            Follower& follower = iter->second;
+            if (!follower.unacked.empty() && now - follower.unacked.front().at >= retryAfter_)
+            {
+                if (++follower.retries > DEFAULT_REPLICATION_MAX_RETRIES)
+                {
+                    iter = followers_.erase(iter);
+                    continue;
+                }
+                Messages snapshot = bootstrap(follower);
+                messages.insert(messages.end(), snapshot.begin(), snapshot.end());
+            }
+            else
+            {
+                Message heartbeat = makeMessage("replica-heartbeat", follower.ep);
+                heartbeat.attribute("versions-seq", std::to_string(follower.sentVersions));
+                heartbeat.attribute("props-seq", std::to_string(follower.sentProps));
+                messages.push_back(heartbeat);
+            }
+            ++iter;
+        }
+        return messages;
+    }
+
+    //----< leader: streams all records to a follower >-------------------
+    /*
+    *  The follower's cursors are positioned right after the snapshot so
+    *  every change made from here on reaches it through a batch.
+    *  Each chunk is sent in parts; the follower applies it once the last
+    *  part has arrived. The end message carries the number of chunks so
+    *  the follower can tell that none went missing.
+    */
+    inline Messages Replicator::bootstrap(Follower& follower)
+    {
+        follower.versionsCursor = versions_.subscribe();
+        follower.propsCursor = props_.subscribe();
+        follower.sentVersions = follower.versionsCursor.position() - 1;
+        follower.sentProps = follower.propsCursor.position() - 1;
+        follower.unacked.clear();
+        follower.unacked.push_back({ follower.sentVersions, follower.sentProps, Clock::now() });
+
+        Messages messages;
+        messages.push_back(makeMessage("replica-snapshot-begin", follower.ep));
+
+        auto addChunks = [&](const std::string& store, const std::vector<std::string>& chunks) {
+            for (const std::string& chunk : chunks)
+            {
+                size_t parts = (chunk.size() + DEFAULT_REPLICATION_CHUNK_BYTES - 1) / DEFAULT_REPLICATION_CHUNK_BYTES;
+                for (size_t part = 0; part < parts; ++part)
+                {
+                    Message message = makeMessage("replica-snapshot", follower.ep);
+                    message.attribute("store", store);
+                    message.attribute("part", std::to_string(part + 1));
+                    message.attribute("parts", std::to_string(parts));
+                    message.attribute("records", escapeAttribute(
+                        chunk.substr(part * DEFAULT_REPLICATION_CHUNK_BYTES, DEFAULT_REPLICATION_CHUNK_BYTES)));
+                    messages.push_back(message);
+                }
+            }
+        };
+        std::vector<std::string> versionChunks = versions_.snapshot(DEFAULT_REPLICATION_CHUNK_RECORDS);
+        std::vector<std::string> propsChunks = props_.snapshot(DEFAULT_REPLICATION_CHUNK_RECORDS);
+        addChunks(versions_.name(), versionChunks);
+        addChunks(props_.name(), propsChunks);
+
+        Message end = makeMessage("replica-snapshot-end", follower.ep);
+        end.attribute("chunks", std::to_string(versionChunks.size() + propsChunks.size()));
+        end.attribute("versions-seq", std::to_string(follower.sentVersions));
+        end.attribute("props-seq", std::to_string(follower.sentProps));
+        messages.push_back(end);
+        return messages;
+    }
+
+    //----< leader: registers a follower and sends it a snapshot >--------
+
+    inline Messages Replicator::onSubscribe(Message& message)
+    {
+        EndPoint ep = message.from();
+        std::string id = ep.toString();
+
+        followers_.erase(id);
+        Follower& follower = followers_.emplace(std::piecewise_construct,
+            std::forward_as_tuple(id), std::forward_as_tuple(ep, versions_, props_)).first->second;
+        return bootstrap(follower);
+    }
+
+    //----< leader: records how far a follower has applied the changes >--
+    /*
+    *  Retires the snapshot and batches the ack covers. Lag is then
+    *  measured from the oldest one still outstanding.
+    *  A follower the leader does not know, e.g. because the leader has
+    *  restarted since it subscribed, is sent a snapshot.
+    */
+    inline Messages Replicator::onAck(Message& message)
+    {
+        auto iter = followers_.find(message.from().toString());
+        if (iter == followers_.end())
+            return onSubscribe(message);
+
+        Follower& follower = iter->second;
+        follower.ackedVersions = toSequence(message.value("versions-seq"));
+        follower.ackedProps = toSequence(message.value("props-seq"));
+        follower.retries = 0;
+        while (!follower.unacked.empty()
+            && follower.unacked.front().versions <= follower.ackedVersions
+            && follower.unacked.front().props <= follower.ackedProps)
+        {
+            follower.unacked.pop_front();
+        }
+        return {};
+    }
+
+    //----< leader: sends pending changes to every follower >-------------
+    /*
+    *  Called by the server after each message it processes and on every
+    *  replica-tick, so changes made while no message arrives go out too.
+    */
+    inline Messages Replicator::ship()
+    {
+        Messages messages;
+        if (role_ != LEADER)
+            return messages;
+
+        for (auto& item : followers_)
+        {
+            Follower& follower = item.second;
+            while (true)
+            {
+                VersionStore::Changes versionChanges;
+                PropsStore::Changes propsChanges;
+                bool inRing = versions_.collect(follower.versionsCursor, versionChanges, DEFAULT_REPLICATION_BATCH_EVENTS)
+                    && props_.collect(follower.propsCursor, propsChanges, DEFAULT_REPLICATION_BATCH_EVENTS);
+                if (!inRing)
+                {
+                    Messages snapshot = bootstrap(follower);
+                    messages.insert(messages.end(), snapshot.begin(), snapshot.end());
+                    break;
+                }
+                if (versionChanges.empty() && propsChanges.empty())
+                    break;
+
+                Message batch = makeMessage("replica-batch", follower.ep);
+                batch.attribute("batch", std::to_string(follower.nextBatch++));
+                if (!versionChanges.empty())
+                {
+                    batch.attribute("versions-from", std::to_string(versionChanges.firstSequence));
+                    batch.attribute("versions-seq", std::to_string(versionChanges.lastSequence));
+                    batch.attribute("versions-upserts", escapeAttribute(versionChanges.upserts));
+                    batch.attribute("versions-removals", joinKeys(versionChanges.removals));
+                    follower.sentVersions = versionChanges.lastSequence;
+                }
+                if (!propsChanges.empty())
+                {
+                    batch.attribute("props-from", std::to_string(propsChanges.firstSequence));
+                    batch.attribute("props-seq", std::to_string(propsChanges.lastSequence));
+                    batch.attribute("props-upserts", escapeAttribute(propsChanges.upserts));
+                    batch.attribute("props-removals", joinKeys(propsChanges.removals));
+                    follower.sentProps = propsChanges.lastSequence;
+                }
+                follower.unacked.push_back({ follower.sentVersions, follower.sentProps, Clock::now() });
+                messages.push_back(batch);
+            }
+        }
+        return messages;
+    }
+
+    //----< follower: loads the snapshot sent by the leader >-------------
+    /*
+    *  Each part must be the next one of the chunk being loaded, and of
+    *  the same store; the first part of a chunk must follow a complete
+    *  one. Anything else (a lost, repeated or reordered part) drops the
+    *  partial snapshot and subscribes again, as does an end message
+    *  arriving mid-chunk or after fewer chunks than the leader sent.
+    */
+    inline Messages Replicator::onSnapshot(Message& message)
+    {
+        std::string command = message.command();
+        if (command == "replica-snapshot-begin")
+        {
+            bootstrapped_ = false;
+            snapshotting_ = true;
+            snapshotParts_.clear();
+            snapshotStore_.clear();
+            snapshotPart_ = 0;
+            snapshotChunks_ = 0;
+            versions_.clear();
+            props_.clear();
+            lastHeard_ = Clock::now();
+            return {};
+        }
+        if (!snapshotting_)
+            return {};
+
+        if (command == "replica-snapshot")
+        {
+            std::string store = message.value("store");
+            size_t part = (size_t)toSequence(message.value("part"));
+            size_t parts = (size_t)toSequence(message.value("parts"));
+            bool knownStore = (store == versions_.name() || store == props_.name());
+            bool nextPart = (part == snapshotPart_ + 1 && part <= parts
+                && (part == 1 || store == snapshotStore_));
+            if (!knownStore || !nextPart)
+                return start();
+
+            snapshotStore_ = store;
+            snapshotPart_ = part;
+            snapshotParts_ += unescapeAttribute(message.value("records"));
+            lastHeard_ = Clock::now();
+            if (part < parts)
+                return {};
+
+            std::string records;
+            records.swap(snapshotParts_);
+            if (store == versions_.name())
+                versions_.apply(records, {});
+            else
+                props_.apply(records, {});
+            snapshotStore_.clear();
+            snapshotPart_ = 0;
+            ++snapshotChunks_;
+        }
+        else if (command == "replica-snapshot-end")
+        {
+            if (snapshotPart_ != 0 || snapshotChunks_ != toSequence(message.value("chunks")))
+                return start();
+
+            snapshotting_ = false;
+            appliedVersions_ = toSequence(message.value("versions-seq"));
+            appliedProps_ = toSequence(message.value("props-seq"));
+            bootstrapped_ = true;
+            lastApplied_ = Clock::now();
+            lastHeard_ = lastApplied_;
+            return acknowledge();
+        }
+        return {};
+    }
+
+    //----< follower: applies a batch of changes >------------------------
+    /*
+    *  Batches arrive in order over a single connection. If one does not
+    *  continue where the previous one stopped (e.g. the leader restarted)
+    *  the follower asks for a new snapshot.
+    */
+    inline Messages Replicator::onBatch(Message& message)
+    {
+        if (!bootstrapped_)
+            return {};
+        lastHeard_ = Clock::now();
+
+        bool inOrder =
+            (!message.containsKey("versions-from") || std::stoull(message.value("versions-from")) == appliedVersions_ + 1)
+            && (!message.containsKey("props-from") || std::stoull(message.value("props-from")) == appliedProps_ + 1);
+        if (!inOrder)
+            return start();
+
+        if (message.containsKey("versions-seq"))
+        {
+            versions_.apply(unescapeAttribute(message.value("versions-upserts")),
+                splitKeys(message.value("versions-removals")));
+            appliedVersions_ = std::stoull(message.value("versions-seq"));
+        }
+        if (message.containsKey("props-seq"))
+        {
+            props_.apply(unescapeAttribute(message.value("props-upserts")),
+                splitKeys(message.value("props-removals")));
+            appliedProps_ = std::stoull(message.value("props-seq"));
+        }
+        lastApplied_ = Clock::now();
+        return acknowledge();
+    }
+
+    //----< follower: checks it has everything the leader shipped >-------
+    /*
+    *  The heartbeat follows the batches of the same tick on the same
+    *  connection, so a follower behind it has lost the tail of those
+    *  batches and subscribes again. One in step acknowledges, which
+    *  also replaces an ack that went missing.
+    *  Heartbeats are ignored until a snapshot has been loaded; the
+    *  follower's own tick retries subscribing meanwhile.
+    */
+    inline Messages Replicator::onHeartbeat(Message& message)
+    {
+        if (!bootstrapped_)
+            return {};
+        lastHeard_ = Clock::now();
+
+        if (toSequence(message.value("versions-seq")) != appliedVersions_
+            || toSequence(message.value("props-seq")) != appliedProps_)
+            return start();
+        return acknowledge();
+    }
+
+    //----< follower: tells the leader how far it has applied changes >---
+
+    inline Messages Replicator::acknowledge()
+    {
+        Message ack = makeMessage("replica-ack", leader_);
+        ack.attribute("versions-seq", std::to_string(appliedVersions_));
+        ack.attribute("props-seq", std::to_string(appliedProps_));
+        return { ack };
+    }
+
+    //----< replies with the replication state and lag metrics >----------
+
+    inline Message Replicator::status(Message& message)
+    {
+        using namespace std::chrono;
+
+        Message reply;
+        reply.to(message.from());
+        reply.from(message.to());
+        if (message.containsKey("requestId"))
+            reply.attribute("responseId", message.value("requestId"));
+
+        if (role_ == FOLLOWER)
+        {
+            reply.attribute("role", "follower");
+            reply.attribute("leader", leader_.toString());
+            reply.attribute("bootstrapped", bootstrapped_ ? "true" : "false");
+            reply.attribute("versions-seq", std::to_string(appliedVersions_));
+            reply.attribute("props-seq", std::to_string(appliedProps_));
+            reply.attribute("last-applied-ms", std::to_string(
+                duration_cast<milliseconds>(Clock::now() - lastApplied_).count()));
+            return reply;
+        }
+
+        Sequence versionsSeq = versions_.lastSequence();
+        Sequence propsSeq = props_.lastSequence();
+        reply.attribute("role", "leader");
+        reply.attribute("versions-seq", std::to_string(versionsSeq));
+        reply.attribute("props-seq", std::to_string(propsSeq));
+        reply.attribute("followers", std::to_string(followers_.size()));
+
+        int count = 1;
+        for (auto& item : followers_)
+        {
+            Follower& follower = item.second;
+            Sequence lagEvents = (versionsSeq - follower.ackedVersions) + (propsSeq - follower.ackedProps);
+            long long lagMs = follower.unacked.empty() ? 0 :
+                duration_cast<milliseconds>(Clock::now() - follower.unacked.front().at).count();
+
+            std::string prefix = "follower-" + std::to_string(count++);
+            reply.attribute(prefix, follower.ep.toString());
+            reply.attribute(prefix + "-lag-events", std::to_string(lagEvents));
+            reply.attribute(prefix + "-lag-ms", std::to_string(lagMs));
+        }
+        return reply;
+    }
+}
+
+#endif // !REPLICATION_H
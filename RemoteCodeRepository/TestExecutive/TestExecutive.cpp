@@ -0,0 +1,54 @@
+///////////////////////////////////////////////////////////////////////////
+// TestExecutive.cpp - Executes the Remote Code Repository Test Suites   //
+// ver 1.0                                                               //
+// Language:    C++, Visual Studio 2017                                  //
+// Application: SoftwareRepository, CSE687 - Object Oriented Design      //
+// Author:      Ritesh Nair (rgnair@syr.edu)                             //
+///////////////////////////////////////////////////////////////////////////
+/*
+* Package Operations:
+* -------------------
+* Runs the tests of the packages which sit above the NoSqlDb and
+* SoftwareRepository layers, so the NoSqlDb TestExecutive need not
+* know about them. For now that is the replication of the repository
+* dbs between a leader and its followers.
+*
+* Required Files:
+* ---------------
+* TestReplication.h, Replication.h
+* TestCore.h, TestCore.cpp
+* DbCore.h, Persistence.h, Message.h, Message.cpp
+* VersionMgr.cpp, ResourceProperties.cpp
+*
+* Maintenance History:
+* --------------------
+* ver 1.0 : 19 Oct 2026
+* - first release, takes over the replication test from the NoSqlDb
+*   TestExecutive
+*/
+
+#include "../TestReplication.h"
+
+using namespace TestCore;
+using namespace RemoteCodeRepositoryTests;
+
+//----< test stub >----------------------------------------------------
+
+#ifdef TEST_TESTEXECUTIVE
+
+int main()
+{
+    TestSuite replicationTestSuite("Testing Replication - The Repository databases");
+    TestReplicationConverges converges("Demonstrating leader/follower replication");
+    TestReplicationRecovers recovers("Demonstrating recovery from lost messages");
+    TestReplicationSnapshotChecks snapshotChecks("Demonstrating checks on snapshot parts");
+    replicationTestSuite.registerEx({ converges, recovers, snapshotChecks });
+
+    TestExecutor executor;
+    executor.registerEx(replicationTestSuite);
+    executor.executeAll();
+
+    return 0;
+}
+
+#endif // TEST_TESTEXECUTIVE
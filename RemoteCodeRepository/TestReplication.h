@@ -0,0 +1,398 @@
+#pragma once
+///////////////////////////////////////////////////////////////////////
+// TestReplication.h - Implements the test cases for Replication     //
+// ver 1.1                                                           //
+// Language:    C++, Visual Studio 2017                              //
+// Application: SoftwareRepository, CSE687 - Object Oriented Design  //
+// Author:      Ritesh Nair (rgnair@syr.edu)                         //
+///////////////////////////////////////////////////////////////////////
+/*
+* Package Operations:
+* -------------------
+* This file implements the test functors for the leader/follower
+* replication of the repository dbs. The leader and the follower run
+* in-process and their messages are handed over directly, so the tests
+* need no sockets. A test can pass the messages through a Network which
+* loses, repeats or alters some of them. As Replication.h is header
+* only, so are its tests.
+*
+* Required Files:
+* ---------------
+* Replication.h
+* TestCore.h, TestCore.cpp
+* Message.h, Message.cpp
+* VersionMgr.cpp, ResourceProperties.cpp (payload conversions)
+*
+* Maintenance History:
+* --------------------
+* ver 1.1 : 19 Oct 2026
+* - moved to the RemoteCodeRepository TestExecutive; test14 is now
+*   TestReplicationConverges
+* - added tests for lost messages, a restarted leader and damaged
+*   snapshots
+* ver 1.0 : 19 Oct 2026
+* - first release
+*/
+
+#ifndef TEST_REPLICATION_H
+#define TEST_REPLICATION_H
+
+#include "../NoSqlDb/TestCore/TestCore.h"
+#include "Replication.h"
+
+#include <algorithm>
+#include <deque>
+#include <functional>
+#include <thread>
+
+namespace RemoteCodeRepositoryTests
+{
+    /////////////////////////////////////////////////////////////////////
+    // test functors
+    // - Implements test cases to demonstrate replication
+
+    class TestReplicationConverges : public TestCore::AbstractTest {
+    public:
+        TestReplicationConverges(AbstractTest::TestTitle title) : AbstractTest(title) {  }
+        virtual bool operator()();
+    };
+
+    class TestReplicationRecovers : public TestCore::AbstractTest {
+    public:
+        TestReplicationRecovers(AbstractTest::TestTitle title) : AbstractTest(title) {  }
+        virtual bool operator()();
+    };
+
+    class TestReplicationSnapshotChecks : public TestCore::AbstractTest {
+    public:
+        TestReplicationSnapshotChecks(AbstractTest::TestTitle title) : AbstractTest(title) {  }
+        virtual bool operator()();
+    };
+
+    // what the network does to a message: deliver, lose, repeat or alter it
+    using Network = std::function<SoftwareRepository::Messages(const SoftwareRepository::Message&)>;
+
+    //----< hands messages to an in-process leader and follower >--------
+    /*
+    *  - runs until neither side has anything left to send
+    *  - messages go to whichever replicator they are addressed to
+    *  - the leader ships after every message, as the server does
+    */
+    inline size_t deliverReplication(SoftwareRepository::Replicator& leader,
+        SoftwareRepository::Replicator& follower, const SoftwareRepository::Messages& messages,
+        Network network = nullptr)
+    {
+        std::deque<SoftwareRepository::Message> pending(messages.begin(), messages.end());
+        size_t delivered = 0;
+        while (!pending.empty())
+        {
+            SoftwareRepository::Message sent = pending.front();
+            pending.pop_front();
+            SoftwareRepository::Messages arrived = network ? network(sent) : SoftwareRepository::Messages{ sent };
+
+            for (SoftwareRepository::Message& message : arrived)
+            {
+                ++delivered;
+                SoftwareRepository::Messages replies;
+                if (message.to().toString() == leader.self().toString())
+                {
+                    replies = leader.process(message);
+                    SoftwareRepository::Messages shipped = leader.ship();
+                    replies.insert(replies.end(), shipped.begin(), shipped.end());
+                }
+                else
+                {
+                    replies = follower.process(message);
+                }
+                pending.insert(pending.end(), replies.begin(), replies.end());
+            }
+        }
+        return delivered;
+    }
+
+    //----< network which loses every message with command >-------------
+
+    inline Network lose(const std::string& command)
+    {
+        return [command](const SoftwareRepository::Message& message) {
+            return (message.command() == command) ? SoftwareRepository::Messages{}
+                : SoftwareRepository::Messages{ message };
+        };
+    }
+
+    //----< are both dbs holding the same records? >---------------------
+
+    template<typename T>
+    bool sameRecords(NoSqlDb::DbCore<T>& leaderDb, NoSqlDb::DbCore<T>& followerDb)
+    {
+        typename NoSqlDb::DbCore<T>::Keys leaderKeys = leaderDb.keys(), followerKeys = followerDb.keys();
+        std::sort(leaderKeys.begin(), leaderKeys.end());
+        std::sort(followerKeys.begin(), followerKeys.end());
+        if (leaderKeys != followerKeys)
+            return false;
+
+        for (const std::string& key : leaderKeys)
+        {
+            std::string leaderRecord = NoSqlDb::Persistence<T>(leaderDb, "db").exportDbToString({ key });
+            std::string followerRecord = NoSqlDb::Persistence<T>(followerDb, "db").exportDbToString({ key });
+            if (leaderRecord != followerRecord)
+                return false;
+        }
+        return true;
+    }
+
+    //----< fills the leader's dbs with enough text for multi-part snapshots >---
+
+    inline void fillReplicationDbs(NoSqlDb::DbCore<SoftwareRepository::SingleDigitVersion>& versions,
+        NoSqlDb::DbCore<SoftwareRepository::FileResourcePayload>& props)
+    {
+        using namespace SoftwareRepository;
+        using namespace NoSqlDb;
+
+        for (int i = 0; i < 40; ++i)
+        {
+            std::string key = "ns::file" + std::to_string(i) + ".h#1";
+            DbElement<FileResourcePayload> element;
+            element.metadata().name("file" + std::to_string(i) + ".h");
+            element.metadata().descrip(std::string(4096, 'a' + i % 26));
+            element.payLoad(FileResourcePayload().setNamespace("ns").setAuthor("ritesh").setVersion(1));
+            props.add(key, element);
+
+            DbElement<SingleDigitVersion> version;
+            version.payLoad().setCurrentVersion(1);
+            version.payLoad().setAuthorId("ritesh");
+            versions.add("ns::file" + std::to_string(i) + ".h", version);
+        }
+    }
+
+    //----< demo of a follower converging on its leader >----------------
+
+    inline bool TestReplicationConverges::operator()()
+    {
+        using namespace SoftwareRepository;
+        using namespace NoSqlDb;
+
+        DbCore<SingleDigitVersion> leaderVersions, followerVersions;
+        DbCore<FileResourcePayload> leaderProps, followerProps;
+        EndPoint leaderEp("localhost", 9091), followerEp("localhost", 9092);
+        Replicator leader(LEADER, leaderEp, leaderVersions, leaderProps);
+        Replicator follower(FOLLOWER, followerEp, followerVersions, followerProps, leaderEp);
+        fillReplicationDbs(leaderVersions, leaderProps);
+
+        size_t delivered = deliverReplication(leader, follower, follower.start());
+        std::cout << "\n  snapshot of " << leaderProps.size() << " records took " << delivered << " messages";
+        if (delivered < 5 || !sameRecords(leaderVersions, followerVersions) || !sameRecords(leaderProps, followerProps))
+        {
+            setMessage("follower did not converge on the snapshot");
+            return false;
+        }
+
+        // changes made while the leader is idle go out on the next tick
+        leaderProps.modify("ns::file3.h#1", ChangeType::payloadChanged,
+            [](DbElement<FileResourcePayload>& el) { el.payLoad().addCategory("core"); });
+        leaderProps.remove("ns::file4.h#1");
+        leaderVersions["ns::file3.h"].payLoad().setCurrentVersion(2);
+        leaderVersions.flushEdits();
+
+        delivered = deliverReplication(leader, follower, { Replicator::tick(leaderEp) });
+        std::cout << "\n  changes made by an idle leader shipped on tick in " << delivered << " messages";
+        if (!sameRecords(leaderVersions, followerVersions) || !sameRecords(leaderProps, followerProps))
+        {
+            setMessage("follower did not converge on the changes");
+            return false;
+        }
+
+        Message request;
+        request.to(leaderEp);
+        request.from(followerEp);
+        request.command("get-replication-status");
+        Message status = leader.process(request).front();
+        std::cout << "\n  leader status: lag " << status.value("follower-1-lag-events") << " events, "
+            << status.value("follower-1-lag-ms") << " ms\n\n";
+        if (status.value("follower-1-lag-events") != "0" || status.value("follower-1-lag-ms") != "0")
+        {
+            setMessage("acknowledged follower reported as lagging");
+            return false;
+        }
+
+        setMessage("Leader/follower replication");
+        return true;
+    }
+
+    //----< demo of a follower catching up after lost messages >---------
+    /*
+    *  - retry intervals are shortened so the test need not wait for the
+    *    defaults; waitToRetry lets one pass
+    */
+    inline bool TestReplicationRecovers::operator()()
+    {
+        using namespace SoftwareRepository;
+        using namespace NoSqlDb;
+
+        const size_t RetryMs = 20;
+        auto waitToRetry = [RetryMs]() { std::this_thread::sleep_for(std::chrono::milliseconds(2 * RetryMs)); };
+
+        DbCore<SingleDigitVersion> leaderVersions, followerVersions;
+        DbCore<FileResourcePayload> leaderProps, followerProps;
+        EndPoint leaderEp("localhost", 9091), followerEp("localhost", 9092);
+        Replicator leader(LEADER, leaderEp, leaderVersions, leaderProps);
+        Replicator follower(FOLLOWER, followerEp, followerVersions, followerProps, leaderEp);
+        leader.retryAfter(RetryMs);
+        follower.retryAfter(RetryMs);
+        fillReplicationDbs(leaderVersions, leaderProps);
+
+        auto converged = [&]() {
+            return sameRecords(leaderVersions, followerVersions) && sameRecords(leaderProps, followerProps);
+        };
+        auto change = [&](int i) {
+            leaderVersions["ns::file" + std::to_string(i) + ".h"].payLoad().setCurrentVersion(2);
+            leaderVersions.flushEdits();
+            leaderProps.remove("ns::file" + std::to_string(i) + ".h#1");
+        };
+
+        // the first subscribe is lost; the follower's tick sends it again
+        deliverReplication(leader, follower, follower.start(), lose("replica-subscribe"));
+        bool lostSubscribe = !converged();
+        waitToRetry();
+        deliverReplication(leader, follower, { Replicator::tick(followerEp) });
+        std::cout << "\n  lost subscribe retried on tick: " << (lostSubscribe && converged() ? "converged" : "failed");
+        if (!lostSubscribe || !converged())
+        {
+            setMessage("follower did not retry a lost subscribe");
+            return false;
+        }
+
+        // the last batch is lost; the next heartbeat shows the follower is behind
+        change(1);
+        deliverReplication(leader, follower, leader.ship(), lose("replica-batch"));
+        bool lostTail = !converged();
+        deliverReplication(leader, follower, { Replicator::tick(leaderEp) });
+        std::cout << "\n  lost tail found by heartbeat: " << (lostTail && converged() ? "converged" : "failed");
+        if (!lostTail || !converged())
+        {
+            setMessage("follower did not notice a lost tail");
+            return false;
+        }
+
+        // batch and heartbeat are both lost; the leader resends once the batch is overdue
+        Message leaderTick = Replicator::tick(leaderEp);
+        change(2);
+        leader.process(leaderTick);
+        waitToRetry();
+        deliverReplication(leader, follower, { Replicator::tick(leaderEp) });
+        std::cout << "\n  unacknowledged batch followed by a snapshot: " << (converged() ? "converged" : "failed");
+        if (!converged())
+        {
+            setMessage("leader did not resend an unacknowledged batch");
+            return false;
+        }
+
+        // the leader restarts and no longer knows its follower
+        Replicator restarted(LEADER, leaderEp, leaderVersions, leaderProps);
+        restarted.retryAfter(RetryMs);
+        change(3);
+        waitToRetry();
+        deliverReplication(restarted, follower, { Replicator::tick(leaderEp), Replicator::tick(followerEp) });
+        std::cout << "\n  follower resubscribed to restarted leader: " << (converged() ? "converged" : "failed");
+        if (!converged())
+        {
+            setMessage("follower did not resubscribe to a restarted leader");
+            return false;
+        }
+
+        // a follower which never answers is forgotten
+        change(4);
+        for (size_t i = 0; i <= DEFAULT_REPLICATION_MAX_RETRIES + 1; ++i)
+        {
+            restarted.process(leaderTick);
+            waitToRetry();
+        }
+        Message request;
+        request.to(leaderEp);
+        request.from(followerEp);
+        request.command("get-replication-status");
+        std::string followers = restarted.process(request).front().value("followers");
+        std::cout << "\n  followers after " << DEFAULT_REPLICATION_MAX_RETRIES << " unanswered snapshots: " << followers << "\n\n";
+        if (followers != "0")
+        {
+            setMessage("leader kept a follower which never answered");
+            return false;
+        }
+
+        setMessage("Replication recovers from lost messages");
+        return true;
+    }
+
+    //----< demo of a follower refusing a damaged snapshot >-------------
+    /*
+    *  - each case damages one snapshot message once; the follower must
+    *    subscribe a second time and converge on the next snapshot
+    */
+    inline bool TestReplicationSnapshotChecks::operator()()
+    {
+        using namespace SoftwareRepository;
+        using namespace NoSqlDb;
+
+        DbCore<SingleDigitVersion> leaderVersions;
+        DbCore<FileResourcePayload> leaderProps;
+        EndPoint leaderEp("localhost", 9091), followerEp("localhost", 9092);
+        Replicator leader(LEADER, leaderEp, leaderVersions, leaderProps);
+        fillReplicationDbs(leaderVersions, leaderProps);
+
+        auto isPart = [&](const Message& message, const std::string& store, const std::string& part) {
+            return message.command() == "replica-snapshot" && message.value("store") == store
+                && message.value("part") == part;
+        };
+
+        struct Case
+        {
+            std::string name;
+            std::function<Messages(const Message&, bool&)> damage;     // sets the flag once it has
+        };
+        std::vector<Case> cases = {
+            { "lost part", [&](const Message& m, bool& done) {
+                if (done || !isPart(m, "ResourcePropertiesDb", "2")) return Messages{ m };
+                done = true; return Messages{}; } },
+            { "repeated part", [&](const Message& m, bool& done) {
+                if (done || !isPart(m, "ResourcePropertiesDb", "2")) return Messages{ m };
+                done = true; return Messages{ m, m }; } },
+            { "part of another store", [&](const Message& m, bool& done) {
+                if (done || !isPart(m, "ResourcePropertiesDb", "2")) return Messages{ m };
+                done = true; Message other = m; other.attribute("store", "VersionMgr"); return Messages{ other }; } },
+            { "lost chunk", [&](const Message& m, bool& done) {
+                if (done || !isPart(m, "VersionMgr", "1")) return Messages{ m };
+                done = true; return Messages{}; } },
+        };
+
+        for (Case& test : cases)
+        {
+            DbCore<SingleDigitVersion> followerVersions;
+            DbCore<FileResourcePayload> followerProps;
+            Replicator follower(FOLLOWER, followerEp, followerVersions, followerProps, leaderEp);
+
+            bool damaged = false;
+            size_t subscribes = 0;
+            Network network = [&](const Message& message) {
+                if (message.command() == "replica-subscribe")
+                    ++subscribes;
+                return test.damage(message, damaged);
+            };
+            deliverReplication(leader, follower, follower.start(), network);
+
+            bool converged = sameRecords(leaderVersions, followerVersions) && sameRecords(leaderProps, followerProps);
+            std::cout << "\n  " << test.name << ": " << subscribes << " subscribes, "
+                << (converged ? "converged" : "failed");
+            if (!damaged || subscribes != 2 || !converged)
+            {
+                setMessage("follower accepted a snapshot with a " + test.name);
+                return false;
+            }
+        }
+        std::cout << "\n\n";
+
+        setMessage("Damaged snapshots are refused");
+        return true;
+    }
+}
+
+#endif // !TEST_REPLICATION_H
@@ -1,6 +1,6 @@
 ﻿/////////////////////////////////////////////////////////////////////////////////
 // RepoServerCommService.cs - Implements the communication service for the GUI //
-// ver 1.1                                                                     //
+// ver 1.2                                                                     //
 // Language:    C#, Visual Studio 2017                                         //
 // Application: SoftwareRepository, CSE687 - Object Oriented Design            //
 // Author:      Ritesh Nair (rgnair@syr.edu)                                   //
@@ -11,6 +11,8 @@
 * This package implements the communication layer for the GUI.
 * It starts a socket server and a socket listener which are used to send requests 
 * to the repository server and handle corresponding responses.
+* A "busy" reply from the server is handed to RepoServerRequests, which posts
+* the request it names again after backing off.
 *
 * Required Packages:
 * ------------------
@@ -19,6 +21,8 @@
 *
 * Maintenance History:
 * --------------------
+* ver 1.2 : 19 Oct 2026
+* - busy replies are retried through RepoServerRequests.RetryBusy
 * ver 1.1 : 26 Apr 2018
 * - added API to disconnect the comm service
 * ver 1.0 : 11 Apr 2018
@@ -103,6 +107,7 @@ namespace RepoClientGUI.Services.RepoServerComm
             if (message.containsKey("responseId"))
             {
                 string uniqueId = message.value("responseId");
+                requests_.Answered(uniqueId);
                 if (dispatcher_.ContainsKey(uniqueId))
                     dispatcher_[uniqueId].Invoke(message);
             }
@@ -130,6 +135,13 @@ namespace RepoClientGUI.Services.RepoServerComm
                             && "__quit" == message.value("command"))
                         break;
 
+                    if (message.containsKey("command")
+                            && "busy" == message.value("command"))
+                    {
+                        requests_.RetryBusy(message);
+                        continue;
+                    }
+
                     HandleIncomingRequest(message);
                 }
 
@@ -1,6 +1,6 @@
 ﻿/////////////////////////////////////////////////////////////////////////////////
 // RepoServerRequests.cs                                                       //
-// ver 1.3                                                                     //
+// ver 1.4                                                                     //
 // Language:    C#, Visual Studio 2017                                         //
 // Application: SoftwareRepository, CSE687 - Object Oriented Design            //
 // Author:      Ritesh Nair (rgnair@syr.edu)                                   //
@@ -19,6 +19,11 @@
 * Apart from these it also has an API which Requests to shutdown the client's comm system
 * - PostQuit
 *
+* A server whose receive queue is full answers a request with a "busy" message
+* named after the request. Each request is kept until it is answered, and
+* RetryBusy posts it again after BusyRetryDelayMs, doubling the delay on each
+* busy reply, for at most BusyMaxRetries times.
+*
 * Required Packages:
 * ------------------
 * MsgPassingCommunication
@@ -26,6 +31,8 @@
 *
 * Maintenance History:
 * --------------------
+* ver 1.4 : 19 Oct 2026
+* - requests are named by their id and posted again when the server is busy
 * ver 1.3 : 30 Apr 2018
 * - get package list request now searches based on category
 * ver 1.2 : 28 Apr 2018
@@ -49,8 +56,18 @@ namespace RepoClientGUI.Services.RepoServerComm
 {
     public class RepoServerRequests
     {
+        public const int BusyRetryDelayMs = 250;
+        public const int BusyMaxRetries = 5;
+
+        private class PendingRequest
+        {
+            public CsMessage Message;
+            public int Retries;
+        }
+
         private Translater translater_;
         private Dictionary<string, Action<CsMessage>> dispatcher_;
+        private Dictionary<string, PendingRequest> pending_ = new Dictionary<string, PendingRequest>();
         private CsEndPoint endPoint_;
         private CsEndPoint serverEndPoint_;
 
@@ -106,7 +123,7 @@ namespace RepoClientGUI.Services.RepoServerComm
             msg.add("namespace", ns);
             msg.add("filename", filename);
             msg.add("version", version.ToString());
-            translater_.postMessage(msg);
+            Post(uniqueId, msg);
         }
 
         public void GetFileText(String package, String ns, String filename,
@@ -133,7 +150,7 @@ namespace RepoClientGUI.Services.RepoServerComm
             msg.add("namespace", ns);
             msg.add("filename", filename);
             msg.add("version", version.ToString());
-            translater_.postMessage(msg);
+            Post(uniqueId, msg);
         }
 
         public void GetPackageFiles(String packageName,
@@ -168,7 +185,7 @@ namespace RepoClientGUI.Services.RepoServerComm
             if (verbose)
                 msg.add("verbose", "yes");
             msg.add("package", packageName);
-            translater_.postMessage(msg);
+            Post(uniqueId, msg);
         }
 
         public void GetRepoPackages(String category, String userId,
@@ -201,7 +218,7 @@ namespace RepoClientGUI.Services.RepoServerComm
             if (verbose)
                 msg.add("verbose", "yes");
             msg.add("category", category);
-            translater_.postMessage(msg);
+            Post(uniqueId, msg);
         }
 
         // ----< posts check-in request to the server for every file within the selected package folder >--------------------
@@ -247,7 +264,7 @@ namespace RepoClientGUI.Services.RepoServerComm
                 if (!String.IsNullOrEmpty(category))
                     msg.add("category", category);
                 msg.add("file", fileInfo.Item1);
-                translater_.postMessage(msg);
+                Post(uniqueId, msg);
             }
         }
 
@@ -275,7 +292,7 @@ namespace RepoClientGUI.Services.RepoServerComm
             msg.add("version", version.ToString());
             if (withDep)
                 msg.add("include-deps", "true");
-            translater_.postMessage(msg);
+            Post(uniqueId, msg);
         }
 
         public void PostQuit(Action<CsMessage> onQuit, bool verbose = false)
@@ -311,9 +328,50 @@ namespace RepoClientGUI.Services.RepoServerComm
             msg.add("requestId", uniqueId);
             if (verbose)
                 msg.add("verbose", "yes");
+            Post(uniqueId, msg);
+        }
+
+        // ----< posts a request to the server, keeping it until it is answered >--------------------
+        private void Post(string uniqueId, CsMessage msg)
+        {
+            msg.add("name", uniqueId);
+            lock (pending_)
+                pending_[uniqueId] = new PendingRequest { Message = msg, Retries = 0 };
             translater_.postMessage(msg);
         }
 
+        // ----< forgets a request once its response has arrived >--------------------
+        public void Answered(string uniqueId)
+        {
+            lock (pending_)
+                pending_.Remove(uniqueId);
+        }
+
+        // ----< posts the request a busy reply names again, after backing off >--------------------
+        public void RetryBusy(CsMessage busy)
+        {
+            if (!busy.containsKey("name"))
+                return;
+
+            string uniqueId = busy.value("name");
+            PendingRequest request;
+            int delay;
+            lock (pending_)
+            {
+                if (!pending_.TryGetValue(uniqueId, out request))
+                    return;
+                if (request.Retries == BusyMaxRetries)
+                {
+                    pending_.Remove(uniqueId);
+                    Console.WriteLine($"  --> Server busy, giving up on {request.Message.value("command")} request {uniqueId}");
+                    return;
+                }
+                delay = BusyRetryDelayMs << request.Retries;
+                request.Retries++;
+            }
+            Task.Delay(delay).ContinueWith(_ => translater_.postMessage(request.Message));
+        }
+
         private string GetUniqueId()
         {
             // reference: https://msdn.microsoft.com/en-us/library/system.guid.newguid.aspx
@@ -2,7 +2,7 @@
 //////////////////////////////////////////////////////////////////////////
 // CheckInMgr.h - Interacts with Properties DB and Repository Store to  //
 //                provide repository's checkin functionality            //
-// ver 1.0                                                              //
+// ver 1.1                                                              //
 // Language:    C++, Visual Studio 2017                                 //
 // Application: SoftwareRepository, CSE687 - Object Oriented Design     //
 // Author:      Ritesh Nair (rgnair@syr.edu)                            //
@@ -12,6 +12,8 @@
 * -------------------
 * This package implements the checkin semantics. It contains below classes:
 * - CheckInMgr which provides APIs to check-in new resource and commit a particular resource version.
+*   A check-in updates the version and properties dbs in one DbTransaction
+*   which is rolled back if the file cannot be saved to the store.
 *
 * Required Files:
 * ---------------
@@ -23,6 +25,8 @@
 *
 * Maintenance History:
 * --------------------
+* ver 1.1 : 19 Oct 2026
+* - documented transactional check-in
 * ver 1.0 : 10 Mar 2018
 * - first release
 */
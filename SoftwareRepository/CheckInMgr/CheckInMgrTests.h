@@ -1,7 +1,7 @@
 #pragma once
 ///////////////////////////////////////////////////////////////////////
 // CheckInMgrTests.h - Implements all test cases for CheckInMgr      //
-// ver 1.0                                                           //
+// ver 1.1                                                           //
 // Language:    C++, Visual Studio 2017                              //
 // Application: SoftwareRepository, CSE687 - Object Oriented Design  //
 // Author:      Ritesh Nair (rgnair@syr.edu)                         //
@@ -17,6 +17,8 @@
 *
 * Maintenance History:
 * --------------------
+* ver 1.1 : 19 Oct 2026
+* - added TestCheckInRollback
 * ver 1.0 : 10 Mar 2018
 * - first release
 */
@@ -45,6 +47,12 @@ namespace SoftwareRepositoryTests
         virtual bool operator()();
     };
 
+    class TestCheckInRollback : public TestCore::AbstractTest {
+    public:
+        TestCheckInRollback(AbstractTest::TestTitle title) : AbstractTest(title) {  }
+        virtual bool operator()();
+    };
+
     class TestCommitValidations : public TestCore::AbstractTest {
     public:
         TestCommitValidations(AbstractTest::TestTitle title) : AbstractTest(title) {  }
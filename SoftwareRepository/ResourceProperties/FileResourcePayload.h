@@ -2,7 +2,7 @@
 ///////////////////////////////////////////////////////////////////////
 // FileResourcePayload.h - Implements payload from a properties DB   //
 //                         which supports file-based storage         //
-// ver 1.1                                                           //
+// ver 1.5                                                           //
 // Language:    C++, Visual Studio 2017                              //
 // Application: SoftwareRepository, CSE687 - Object Oriented Design  //
 // Author:      Ritesh Nair (rgnair@syr.edu)                         //
@@ -22,6 +22,15 @@
 *
 * Maintenance History:
 * --------------------
+* ver 1.5 : 19 Oct 2026
+* - decoded categories skip duplicates, as addCategory does
+* - version and state have defaults, kept when the decoded data lacks them
+* ver 1.4 : 19 Oct 2026
+* - XML, binary and attribute conversions are generated from schema()
+* ver 1.3 : 19 Oct 2026
+* - writes itself straight to an XmlWriter
+* ver 1.2 : 19 Oct 2026
+* - added payloadBytes for footprint reporting
 * ver 1.1 : 30 Apr 2018
 * - implements the IPayload interface and can now be persisted
 * ver 1.0 : 24 Feb 2018
@@ -33,10 +42,53 @@
 
 #include "../RepoCore/RepoCoreDefinitions.h"
 #include "../RepoUtilities/RepoUtilities.h"
-#include "../../NoSqlDb/Payloads/IPayload.h"
+#include "../../NoSqlDb/Payloads/PayloadSchema.h"
 
 #include <algorithm>
 
+namespace NoSqlDb
+{
+    /////////////////////////////////////////////////////////////////////
+    // FieldCodec for the resource state
+    // - text form is the display string from STATE_STRINGS, binary form
+    //   is the enum value
+
+    template <>
+    struct FieldCodec<SoftwareRepository::RESOURCE_STATE>
+    {
+        using State = SoftwareRepository::RESOURCE_STATE;
+
+        static const std::string& toText(const State& value, std::string&)
+        {
+            return SoftwareRepository::STATE_STRINGS[value];
+        }
+
+        // unknown strings read as OPEN, as the old lookup table did
+        static void fromText(const std::string& text, State& value)
+        {
+            value = SoftwareRepository::OPEN;
+            for (size_t i = 0; i < SoftwareRepository::STATE_STRINGS.size(); ++i)
+            {
+                if (SoftwareRepository::STATE_STRINGS[i] == text)
+                    value = static_cast<State>(i);
+            }
+        }
+
+        static void toBinary(std::string& dst, const State& value)
+        {
+            PayloadBinary::putVarint(dst, static_cast<uint64_t>(value));
+        }
+
+        static void fromBinary(const char*& pos, const char* end, State& value)
+        {
+            uint64_t raw = PayloadBinary::getVarint(pos, end);
+            if (raw >= SoftwareRepository::STATE_STRINGS.size())
+                throw(std::exception("PayloadCodec: invalid resource state in binary payload"));
+            value = static_cast<State>(raw);
+        }
+    };
+}
+
 namespace SoftwareRepository
 {
 
@@ -50,8 +102,9 @@ namespace SoftwareRepository
     //   - state        int
     //   - version      int
     // - provides API to remove a category
+    // - XML, binary and attribute forms are generated from schema()
 
-    class FileResourcePayload : public NoSqlDb::IPayload<FileResourcePayload>
+    class FileResourcePayload : public NoSqlDb::SchemaPayload<FileResourcePayload>
     {
     public:
         // methods to access payload's details
@@ -126,27 +179,42 @@ namespace SoftwareRepository
             return os << payload.toString();
         };
 
+        // bytes held by the payload, used by DbCore<T>::footprint()
+        friend size_t payloadBytes(const FileResourcePayload& payload)
+        {
+            size_t bytes = sizeof(payload) + payload.author_.capacity()
+                + payload.namespace_.capacity() + payload.package_.capacity();
+            for (const Category& category : payload.categories_)
+                bytes += sizeof(category) + category.capacity();
+            return bytes;
+        }
+
         virtual std::string toString() override { return toString(); }
-        virtual NoSqlDb::IPayload<FileResourcePayload>::Sptr toXmlElement() override;
-        static FileResourcePayload fromXmlElement(NoSqlDb::IPayload<FileResourcePayload>::Sptr);
 
     private:
+        friend class NoSqlDb::PayloadCodec<FileResourcePayload>;
+
+        static constexpr auto schema()
+        {
+            return std::make_tuple(
+                NoSqlDb::field("author", &FileResourcePayload::author_),
+                NoSqlDb::field("state", &FileResourcePayload::state_),
+                NoSqlDb::field("namespace", &FileResourcePayload::namespace_),
+                NoSqlDb::field("package", &FileResourcePayload::package_),
+                NoSqlDb::field("version", &FileResourcePayload::version_),
+                NoSqlDb::uniqueListField("categories", "category", &FileResourcePayload::categories_)
+            );
+        }
 
         AuthorId author_;
-        State state_; // see: RESOURCE_STATE in RepoCoreDefinitions.h
+        State state_ = OPEN; // see: RESOURCE_STATE in RepoCoreDefinitions.h
         Categories categories_;
         Namespace namespace_;
         PackageName package_;
-        ResourceVersion version_;
+        ResourceVersion version_ = 0;
 
         std::string toString() const;
         std::string stringifyCategories() const;
-
-        static std::unordered_map<std::string, RESOURCE_STATE> reverseStateLookup() {
-            return {
-                { STATE_STRINGS[OPEN], OPEN },{ STATE_STRINGS[CLOSED], CLOSED },{ STATE_STRINGS[CLOSE_PENDING], CLOSE_PENDING }
-            };
-        }
     };
 }
 
@@ -1,7 +1,7 @@
 #pragma once
 /////////////////////////////////////////////////////////////////////////////
 // ResourceProperties.h - Implements the properties object                 //
-// ver 1.0                                                                 //
+// ver 1.1                                                                 //
 // Language:    C++, Visual Studio 2017                                    //
 // Application: SoftwareRepository, CSE687 - Object Oriented Design        //
 // Author:      Ritesh Nair (rgnair@syr.edu)                               //
@@ -20,6 +20,8 @@
 *
 * Maintenance History:
 * --------------------
+* ver 1.1 : 19 Oct 2026
+* - const getters read through DbCore::value
 * ver 1.0 : 23 Apr 2018
 * - first release
 */
@@ -60,23 +62,23 @@ namespace SoftwareRepository
         // methods to access data from the db element
 
         AuthorId& getAuthorId() { return db_[dbKey_].payLoad().getAuthor(); }
-        AuthorId getAuthorId() const { return db_[dbKey_].payLoad().getAuthor(); }
+        AuthorId getAuthorId() const { return db_.value(dbKey_).payLoad().getAuthor(); }
 
         Categories& getCategories() { return db_[dbKey_].payLoad().getCategories(); }
-        Categories getCategories() const { return db_[dbKey_].payLoad().getCategories(); }
+        Categories getCategories() const { return db_.value(dbKey_).payLoad().getCategories(); }
 
         Dependencies getDependencies() const;
 
         ResourceDescription& getDescription() { return db_[dbKey_].metadata().descrip(); }
-        ResourceDescription getDescription() const { return db_[dbKey_].metadata().descrip(); }
+        ResourceDescription getDescription() const { return db_.value(dbKey_).metadata().descrip(); }
 
         ResourceName& getName() { return db_[dbKey_].metadata().name(); }
-        ResourceName getName() const { return db_[dbKey_].metadata().name(); }
+        ResourceName getName() const { return db_.value(dbKey_).metadata().name(); }
 
         Namespace& getNamespace() { return db_[dbKey_].payLoad().getNamespace(); }
-        Namespace getNamespace() const { return db_[dbKey_].payLoad().getNamespace(); }
+        Namespace getNamespace() const { return db_.value(dbKey_).payLoad().getNamespace(); }
 
-        FileResourcePayload getRawPayload() { return db_[dbKey_].payLoad(); }
+        FileResourcePayload getRawPayload() { return db_.value(dbKey_).payLoad(); }
 
         // methods to set data to the db element
 
@@ -1,7 +1,7 @@
 #pragma once
 /////////////////////////////////////////////////////////////////////////////////////////
 // ResourcePropertiesTests.h - Implements all test cases for ResourceProperties        //
-// ver 1.1                                                                             //
+// ver 1.2                                                                             //
 // Language:    C++, Visual Studio 2017                                                //
 // Application: SoftwareRepository, CSE687 - Object Oriented Design                    //
 // Author:      Ritesh Nair (rgnair@syr.edu)                                           //
@@ -17,6 +17,8 @@
 *
 * Maintenance History:
 * --------------------
+* ver 1.2 : 19 Oct 2026
+* - added TestFileResourcePayloadDecoding
 * ver 1.1 : 23 Apr 2018
 * - first release
 */
@@ -44,6 +46,12 @@ namespace SoftwareRepositoryTests
         TestModifyFileResourceProperties(AbstractTest::TestTitle title) : AbstractTest(title) {  }
         virtual bool operator()();
     };
+
+    class TestFileResourcePayloadDecoding : public TestCore::AbstractTest {
+    public:
+        TestFileResourcePayloadDecoding(AbstractTest::TestTitle title) : AbstractTest(title) {  }
+        virtual bool operator()();
+    };
 }
 
 #endif // !RESOURCEPROPERTIES_TESTS_H
\ No newline at end of file
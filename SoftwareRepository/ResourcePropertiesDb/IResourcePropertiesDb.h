@@ -1,7 +1,7 @@
 #pragma once
 //////////////////////////////////////////////////////////////////////////
 // IResourcePropertiesDb.h - Defines the Properties DB interface        //
-// ver 1.2                                                              //
+// ver 1.3                                                              //
 // Language:    C++, Visual Studio 2017                                 //
 // Application: SoftwareRepository, CSE687 - Object Oriented Design     //
 // Author:      Ritesh Nair (rgnair@syr.edu)                            //
@@ -16,9 +16,12 @@
 * Required Files:
 * ---------------
 * RepoCoreDefinitions.h
+* DbTransaction.h
 *
 * Maintenance History:
 * --------------------
+* ver 1.3 : 19 Oct 2026
+* - added enlist so property updates can join a DbTransaction
 * ver 1.2 : 30 Apr 2018
 * - added backup and restore functionality
 * ver 1.1 : 23 Apr 2018
@@ -34,6 +37,7 @@
 #include "../ResourceProperties/IResourceProperties.h"
 #include "../RepoBrowser/IRepoBrowser.h"
 #include "../../NoSqlDb/Query/Query.h"
+#include "../../NoSqlDb/DbCore/DbTransaction.h"
 
 namespace SoftwareRepository
 {
@@ -62,6 +66,7 @@ namespace SoftwareRepository
         virtual void showDb() = 0;
         virtual void loadDb(const SourceLocation&) = 0;
         virtual void saveDb(const SourceLocation&) = 0;
+        virtual void enlist(NoSqlDb::DbTransaction&) = 0;
     };
 }
 
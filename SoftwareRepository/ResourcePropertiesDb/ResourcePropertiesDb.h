@@ -2,7 +2,7 @@
 /////////////////////////////////////////////////////////////////////////////
 // ResourcePropertiesDb.h - Implements the properties object and database  //
 //                          for holding the properties                     //
-// ver 1.2                                                                 //
+// ver 1.5                                                                 //
 // Language:    C++, Visual Studio 2017                                    //
 // Application: SoftwareRepository, CSE687 - Object Oriented Design        //
 // Author:      Ritesh Nair (rgnair@syr.edu)                               //
@@ -25,6 +25,13 @@
 *
 * Maintenance History:
 * --------------------
+* ver 1.5 : 19 Oct 2026
+* - sharded saves are opt-in, with a shard count fixed by the caller; saveDb
+*   writes a single file by default, as before
+* ver 1.4 : 19 Oct 2026
+* - saveDb writes the db as one shard file per core plus a manifest
+* ver 1.3 : 19 Oct 2026
+* - implements enlist
 * ver 1.2 : 30 Apr 2018
 * - added backup and restore functionality
 * ver 1.1 : 23 Apr 2018
@@ -62,8 +69,13 @@ namespace SoftwareRepository
         using Filters = BrowseFilters<Filter>;
         using FileResources = std::vector<FileResource>;
 
-        ResourcePropertiesDb(IVersionMgr *pVersionMgr) : 
-            pVersionMgr_(pVersionMgr), browser_(db_), persistence_(db_, "ResourcePropertiesDb") {};
+        // shards > 1 saves the db as that many files plus a manifest; the default
+        // keeps the single file format. loadDb reads either.
+        ResourcePropertiesDb(IVersionMgr *pVersionMgr, size_t shards = DEFAULT_SHARD_COUNT) : 
+            pVersionMgr_(pVersionMgr), browser_(db_), persistence_(db_, "ResourcePropertiesDb")
+        {
+            persistence_.shards(shards);
+        }
 
         virtual bool createEntry(FileResource, AuthorId) override;
         virtual bool exists(ResourceIdentity) override;
@@ -81,6 +93,7 @@ namespace SoftwareRepository
 
         virtual void loadDb(const SourceLocation&) override;
         virtual void saveDb(const SourceLocation&) override;
+        virtual void enlist(NoSqlDb::DbTransaction& tx) override { tx.enlist(db_); }
 
     private:
         NoSqlDb::DbCore<FileResourcePayload> db_;
@@ -3,7 +3,7 @@
 // IVersionMgr.h - Defines contract for a Version Manager which maintains  //
 //                 the Respositorie's resource versioning and ownership    //
 //                 policy                                                  //
-// ver 1.0                                                                 //
+// ver 1.1                                                                 //
 // Language:    C++, Visual Studio 2017                                    //
 // Application: SoftwareRepository, CSE687 - Object Oriented Design        //
 // Author:      Ritesh Nair (rgnair@syr.edu)                               //
@@ -23,9 +23,12 @@
 * Required Files:
 * ---------------
 * RepoCoreDefinitions.h
+* DbTransaction.h
 *
 * Maintenance History:
 * --------------------
+* ver 1.1 : 19 Oct 2026
+* - added enlist so version updates can join a DbTransaction
 * ver 1.2 : 30 Apr 2018
 * - added backup and restore functionality
 * ver 1.0 : 24 Feb 2018
@@ -36,6 +39,7 @@
 #define IVERSIONMGR_H
 
 #include "../RepoCore/RepoCoreDefinitions.h"
+#include "../../NoSqlDb/DbCore/DbTransaction.h"
 
 namespace SoftwareRepository
 {
@@ -53,6 +57,7 @@ namespace SoftwareRepository
         virtual bool hasPermission(ResourceIdentity, AuthorId, Action = DEFAULT_RESOURCE_MODIFY_ACTION) = 0;
         virtual void loadDb(const SourceLocation&) = 0;
         virtual void saveDb(const SourceLocation&) = 0;
+        virtual void enlist(NoSqlDb::DbTransaction&) = 0;
     };
 }
 
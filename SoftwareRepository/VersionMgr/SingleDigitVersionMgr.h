@@ -2,7 +2,7 @@
 //////////////////////////////////////////////////////////////////////////
 // SingleDigitVersionMgr.h - Implements a single digit based versioning //
 //                           system                                     //
-// ver 1.1                                                              //
+// ver 1.7                                                              //
 // Language:    C++, Visual Studio 2017                                 //
 // Application: SoftwareRepository, CSE687 - Object Oriented Design     //
 // Author:      Ritesh Nair (rgnair@syr.edu)                            //
@@ -16,9 +16,23 @@
 * ---------------
 * IVersionMgr.h
 * DbCore.h, DbCore.cpp
+* XmlPullReader.h, XmlPullReader.cpp
 *
 * Maintenance History:
 * --------------------
+* ver 1.7 : 19 Oct 2026
+* - loadDb reads the backup with XmlPullReader; readVersions is gone
+* - SingleDigitVersion starts at version 0
+* ver 1.6 : 19 Oct 2026
+* - added readVersions, which pulls versions out of a backup with XmlPullReader
+* ver 1.5 : 19 Oct 2026
+* - SingleDigitVersion conversions are generated from schema()
+* ver 1.4 : 19 Oct 2026
+* - SingleDigitVersion writes itself straight to an XmlWriter
+* ver 1.3 : 19 Oct 2026
+* - implements enlist
+* ver 1.2 : 19 Oct 2026
+* - exposes the underlying db (getDb) so it can be replicated
 * ver 1.1 : 30 Apr 2018
 * - SingleDigitVersion implements the IPayload interface and can now be persisted
 * - added backup and restore functionality
@@ -31,7 +45,7 @@
 
 #include "IVersionMgr.h"
 #include "../../NoSqlDb/DbCore/DbCore.h"
-#include "../../NoSqlDb/Payloads/IPayload.h"
+#include "../../NoSqlDb/Payloads/PayloadSchema.h"
 #include "../../NoSqlDb/Persistence/Persistence.h"
 
 namespace SoftwareRepository
@@ -40,8 +54,9 @@ namespace SoftwareRepository
     // SingleDigitVersion class
     // - payload for the NoSqlDb instance used by SingleDigitVersionMgr
     // - maintains the current version and owner information for a resource
+    // - XML, binary and attribute forms are generated from schema()
 
-    class SingleDigitVersion : public NoSqlDb::IPayload<SingleDigitVersion>
+    class SingleDigitVersion : public NoSqlDb::SchemaPayload<SingleDigitVersion>
     {
     public:
         int getCurrentVersion() { return currentVersion_; }
@@ -55,11 +70,19 @@ namespace SoftwareRepository
         };
 
         virtual std::string toString() override { return toString(); }
-        virtual NoSqlDb::IPayload<SingleDigitVersion>::Sptr toXmlElement() override;
-        static SingleDigitVersion fromXmlElement(NoSqlDb::IPayload<SingleDigitVersion>::Sptr);
 
     private:
-        ResourceVersion currentVersion_;
+        friend class NoSqlDb::PayloadCodec<SingleDigitVersion>;
+
+        static constexpr auto schema()
+        {
+            return std::make_tuple(
+                NoSqlDb::field("author", &SingleDigitVersion::authorId_),
+                NoSqlDb::field("currentVersion", &SingleDigitVersion::currentVersion_)
+            );
+        }
+
+        ResourceVersion currentVersion_ = 0;
         AuthorId authorId_;
 
         std::string toString() const;
@@ -82,10 +105,12 @@ namespace SoftwareRepository
         virtual bool isValidVersion(ResourceIdentity, ResourceVersion) override;
         virtual bool hasPermission(ResourceIdentity, AuthorId, Action = DEFAULT_RESOURCE_MODIFY_ACTION) override;
         ResourcePropsDbSize size() { return db_.size(); }
+        NoSqlDb::DbCore<SingleDigitVersion>& getDb() { return db_; }
         void showKeys() { NoSqlDb::showKeys(db_); }
 
         virtual void loadDb(const SourceLocation&) override;
         virtual void saveDb(const SourceLocation&) override;
+        virtual void enlist(NoSqlDb::DbTransaction& tx) override { tx.enlist(db_); }
 
     private:
         NoSqlDb::DbCore<SingleDigitVersion> db_;
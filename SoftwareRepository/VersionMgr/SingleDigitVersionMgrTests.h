@@ -1,7 +1,7 @@
 #pragma once
 ///////////////////////////////////////////////////////////////////////////////////////////
 // SingleDigitVersionMgrTests.h - Implements all test cases for SingleDigitVersionMgr    //
-// ver 1.0                                                                               //
+// ver 1.2                                                                               //
 // Language:    C++, Visual Studio 2017                                                  //
 // Application: SoftwareRepository, CSE687 - Object Oriented Design                      //
 // Author:      Ritesh Nair (rgnair@syr.edu)                                             //
@@ -17,6 +17,10 @@
 *
 * Maintenance History:
 * --------------------
+* ver 1.2 : 19 Oct 2026
+* - TestReadingVersionsFromBackup is now TestLoadingVersionsFromBackup
+* ver 1.1 : 19 Oct 2026
+* - added TestReadingVersionsFromBackup
 * ver 1.0 : 10 Mar 2018
 * - first release
 */
@@ -50,6 +54,12 @@ namespace SoftwareRepositoryTests
         TestCheckingValidVersion(AbstractTest::TestTitle title) : AbstractTest(title) {  }
         virtual bool operator()();
     };
+
+    class TestLoadingVersionsFromBackup : public TestCore::AbstractTest {
+    public:
+        TestLoadingVersionsFromBackup(AbstractTest::TestTitle title) : AbstractTest(title) {  }
+        virtual bool operator()();
+    };
 }
 
 #endif // !INTEGER_VERSION_MGR_TESTS_H